@@ -107,6 +107,14 @@ uint32_t specbleach_adaptive_get_latency(SpectralBleachHandle instance);
 bool specbleach_adaptive_process(SpectralBleachHandle instance,
                                  uint32_t number_of_samples, const float* input,
                                  float* output);
+/**
+ * Sets a function that is called with the FFT size whenever FFTW plans are
+ * made (single precision, FFTW_R2HC and FFTW_HC2R). from_wisdom is false if
+ * no measured wisdom was available for that size, so the application can
+ * have it generated. Pass NULL to remove the hook.
+ */
+void specbleach_set_fft_plan_hook(void (*hook)(uint32_t fft_size,
+                                               bool from_wisdom));
 
 #ifdef __cplusplus
 }
@@ -20,6 +20,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "fft_transform.h"
 #include "../utils/general_utils.h"
+#include "specbleach_adenoiser.h"
 
 #include <fftw3.h>
 #include <stdlib.h>
@@ -28,6 +29,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 static uint32_t calculate_fft_size(FftTransform* self);
 static bool allocate_fftw(FftTransform* self);
 
+static void (*fft_plan_hook)(uint32_t fft_size, bool from_wisdom) = NULL;
+
+void specbleach_set_fft_plan_hook(void (*hook)(uint32_t fft_size,
+                                               bool from_wisdom)) {
+  fft_plan_hook = hook;
+}
+
 struct FftTransform {
   fftwf_plan forward;
   fftwf_plan backward;
@@ -95,12 +103,29 @@ static bool allocate_fftw(FftTransform* self) {
   memset(self->input_fft_buffer, 0, self->fft_size * sizeof(float));
   memset(self->output_fft_buffer, 0, self->fft_size * sizeof(float));
 
-  self->forward =
-      fftwf_plan_r2r_1d((int)self->fft_size, self->input_fft_buffer,
-                        self->output_fft_buffer, FFTW_R2HC, FFTW_ESTIMATE);
-  self->backward =
-      fftwf_plan_r2r_1d((int)self->fft_size, self->output_fft_buffer,
-                        self->input_fft_buffer, FFTW_HC2R, FFTW_ESTIMATE);
+  // Use measured wisdom if the application provides it, otherwise plan
+  // quickly and let the application know about the size.
+  self->forward = fftwf_plan_r2r_1d(
+      (int)self->fft_size, self->input_fft_buffer, self->output_fft_buffer,
+      FFTW_R2HC, FFTW_MEASURE | FFTW_WISDOM_ONLY);
+  self->backward = fftwf_plan_r2r_1d(
+      (int)self->fft_size, self->output_fft_buffer, self->input_fft_buffer,
+      FFTW_HC2R, FFTW_MEASURE | FFTW_WISDOM_ONLY);
+  bool from_wisdom = self->forward && self->backward;
+
+  if (!self->forward) {
+    self->forward =
+        fftwf_plan_r2r_1d((int)self->fft_size, self->input_fft_buffer,
+                          self->output_fft_buffer, FFTW_R2HC, FFTW_ESTIMATE);
+  }
+  if (!self->backward) {
+    self->backward =
+        fftwf_plan_r2r_1d((int)self->fft_size, self->output_fft_buffer,
+                          self->input_fft_buffer, FFTW_HC2R, FFTW_ESTIMATE);
+  }
+  if (fft_plan_hook) {
+    fft_plan_hook(self->fft_size, from_wisdom);
+  }
 
   return self->forward && self->backward;
 }
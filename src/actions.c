@@ -448,7 +448,7 @@ int process_action(gpointer data) {
     }
     break;
   case AF_GAIN_RX2:
-    if (receivers == 2 && (a->mode == ABSOLUTE || a->mode == RELATIVE)) {
+    if (receivers > 1 && (a->mode == ABSOLUTE || a->mode == RELATIVE)) {
       value = KnobOrWheel(a, receiver[1]->volume, -40.0, 0.0, 1.0);
       radio_set_af_gain(1, value);
     }
@@ -478,7 +478,7 @@ int process_action(gpointer data) {
     }
     break;
   case AGC_GAIN_RX2:
-    if (receivers == 2 && (a->mode == ABSOLUTE || a->mode == RELATIVE)) {
+    if (receivers > 1 && (a->mode == ABSOLUTE || a->mode == RELATIVE)) {
       value = KnobOrWheel(a, receiver[1]->agc_gain, -20.0, 120.0, 1.0);
       radio_set_agc_gain(1, value);
     }
@@ -959,7 +959,7 @@ int process_action(gpointer data) {
     }
     break;
   case MENU_DIVERSITY:
-    if (a->mode == PRESSED && RECEIVERS == 2 && n_adc > 1) {
+    if (a->mode == PRESSED && RECEIVERS > 1 && n_adc > 1) {
       start_diversity_menu();
     }
     break;
@@ -1297,7 +1297,7 @@ int process_action(gpointer data) {
     }
     break;
   case RF_GAIN_RX2:
-    if (have_rx_gain && receivers == 2 && (a->mode == ABSOLUTE || a->mode == RELATIVE)) {
+    if (have_rx_gain && receivers > 1 && (a->mode == ABSOLUTE || a->mode == RELATIVE)) {
       value = KnobOrWheel(a, adc[receiver[1]->adc].gain, adc[receiver[1]->adc].min_gain, adc[receiver[1]->adc].max_gain, 1.0);
       radio_set_rf_gain(1, value);
     }
@@ -1400,12 +1400,12 @@ int process_action(gpointer data) {
     }
     break;
   case RX1:
-    if (a->mode == PRESSED && receivers == 2) {
+    if (a->mode == PRESSED && receivers > 1) {
       rx_set_active(receiver[0]);
     }
     break;
   case RX2:
-    if (a->mode == PRESSED && receivers == 2) {
+    if (a->mode == PRESSED && receivers > 1) {
       rx_set_active(receiver[1]);
     }
     break;
@@ -1450,15 +1450,15 @@ int process_action(gpointer data) {
     }
     break;
   case SQUELCH_RX2:
-    if (receivers == 2 && (a->mode == ABSOLUTE || a->mode == RELATIVE)) {
+    if (receivers > 1 && (a->mode == ABSOLUTE || a->mode == RELATIVE)) {
       value = KnobOrWheel(a, receiver[1]->squelch, 0.0, 100.0, 1.0);
       radio_set_squelch(1, value);
     }
     break;
   case SWAP_RX:
     if (a->mode == PRESSED) {
-      if (receivers == 2) {
-        rx_set_active(receiver[active_receiver->id == 1 ? 0 : 1]);
+      if (receivers > 1) {
+        rx_set_active(receiver[(active_receiver->id + 1) % receivers]);
       }
     }
     break;
@@ -123,7 +123,7 @@ int andromeda_execute_button(int v, int p) {
       schedule_action(FILTER_CUT_DEFAULT, (v == 0) ? PRESSED : RELEASED, 0);
       break;
     case 7: // Diversity Enable
-      if (RECEIVERS == 2 && n_adc > 1) {
+      if (RECEIVERS > 1 && n_adc > 1) {
         schedule_action(DIV, (v == 0) ? PRESSED : RELEASED, 0);
       }
       break;
@@ -203,7 +203,7 @@ int andromeda_execute_button(int v, int p) {
       }
       break;
     case 43: // switch receivers
-      if (receivers == 2) {
+      if (receivers > 1) {
         if (v == 0) {
           if (active_receiver->id == 0) {
             schedule_action(RX2, PRESSED, 0);
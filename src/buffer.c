@@ -24,62 +24,175 @@
 // P2: 1500 bytes).                                                           //
 //                                                                            //
 // Buffers are allocated once and stay alive during the whole duration        //
-// of the program. They are put in a linear linked list, such that            //
-// the search for a free buffer can take much time (cycling through           //
-// the whole list). But this seemingly dumb method has two advantages:        //
-// - no malloc/free/mutex/atomic test-and-set during allocating and release,  //
-// - in normal operation, when only few buffers are used, the same            //
-//   buffers are used again and again so they stay in L1 cache                //
+// of the program. Each buffer class has its own pool, and each pool          //
+// is only used by a single thread for getting buffers (e.g. the P2           //
+// receive thread), while buffers may be released from any thread.            //
+// This allows for a simple lock-free scheme without ABA problems:            //
 //                                                                            //
-// To address possible problems with the "O(N)" cycling through the           //
-// buffer list, each buffer lists exists as eight siblings which are          //
-// used in a round-robin fashion.                                             //
+// - released buffers are pushed onto a "shared" stack (compare-and-swap)     //
+// - the allocating thread pops buffers from its "local" free list, which     //
+//   needs no synchronization. If it is empty, the whole shared stack is      //
+//   taken over with a single atomic exchange.                                //
+//                                                                            //
+// Both operations are O(1), and since the most recently released buffers     //
+// are re-used first, they are likely still in the cache.                     //
+// Pools are pre-sized when the protocol starts, new buffers are only         //
+// allocated if a pool is exhausted (this is counted, and reported).          //
+//                                                                            //
+// We use the gcc/clang __atomic builtins since they also work if the         //
+// compiler does not provide stdatomic.h                                      //
 //                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <gtk/gtk.h>
+#include <time.h>
+
 #include "buffer.h"
 #include "main.h"
 #include "message.h"
 
+typedef struct _bufpool {
+  const char *name;
+  size_t size;                   // size of a buffer, including the header
+  int grow;                      // number of buffers to add if exhausted
+  BUFHDR *local;                 // free list, only used by the allocating thread
+  BUFHDR *shared;                // stack of released buffers
+  BUFHDR *all;                   // list of all buffers in this pool
+  int num;                       // number of buffers in this pool
+  int inuse;                     // number of buffers currently in use
+  int highwater;                 // max. number of buffers in use
+  long exhausted;                // number of exhaustion events
+  long long residency;           // sum of residency times (usec)
+  long long released;            // number of released buffers
+} BUFPOOL;
+
+static long long buffer_usec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return 1000000LL * ts.tv_sec + ts.tv_nsec / 1000;
+}
+
+static void pool_grow(BUFPOOL *pool, int num) {
+  //
+  // Add num buffers to the pool. They are allocated in one
+  // chunk and put into the local free list.
+  //
+  unsigned char *chunk = g_malloc0(num * pool->size);
+  if (!chunk) {
+    fatal_error("FATAL: out of memory");
+    return;
+  }
+  for (int i = 0; i < num; i++) {
+    BUFHDR *bp = (BUFHDR *) (chunk + i * pool->size);
+    bp->pool = pool;
+    bp->free = 1;
+    bp->all = pool->all;
+    pool->all = bp;
+    bp->next = pool->local;
+    pool->local = bp;
+  }
+  pool->num += num;
+}
+
+static BUFHDR *pool_get(BUFPOOL *pool) {
+  //
+  // Get a buffer from the pool. Must only be called from a single thread.
+  //
+  BUFHDR *bp = pool->local;
+  if (bp == NULL) {
+    //
+    // Take over all buffers released so far
+    //
+    bp = __atomic_exchange_n(&pool->shared, NULL, __ATOMIC_ACQUIRE);
+    if (bp == NULL) {
+      //
+      // Pool exhausted: this should not happen in normal operation
+      //
+      pool->exhausted++;
+      pool_grow(pool, pool->grow);
+      t_print("%s: pool exhausted, number of %s buffers increased to %d\n", __func__, pool->name, pool->num);
+      bp = pool->local;
+    }
+  }
+  pool->local = bp->next;
+  bp->next = NULL;
+  bp->stamp = buffer_usec();
+  __atomic_store_n(&bp->free, 0, __ATOMIC_RELAXED);
+  int inuse = __atomic_add_fetch(&pool->inuse, 1, __ATOMIC_RELAXED);
+  if (inuse > pool->highwater) { pool->highwater = inuse; }
+  return bp;
+}
+
+static void pool_release(BUFHDR *bp) {
+  //
+  // Return a buffer to its pool. This may be called from any thread.
+  // Releasing a buffer that is already free has no effect.
+  //
+  if (__atomic_exchange_n(&bp->free, 1, __ATOMIC_ACQ_REL)) { return; }
+  BUFPOOL *pool = bp->pool;
+  __atomic_sub_fetch(&pool->inuse, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&pool->residency, buffer_usec() - bp->stamp, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&pool->released, 1, __ATOMIC_RELAXED);
+  BUFHDR *head = __atomic_load_n(&pool->shared, __ATOMIC_RELAXED);
+  do {
+    bp->next = head;
+  } while (!__atomic_compare_exchange_n(&pool->shared, &head, bp, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static void pool_prealloc(BUFPOOL *pool, int num) {
+  //
+  // Take care the pool contains at least num buffers
+  //
+  if (pool->num < num) {
+    pool_grow(pool, num - pool->num);
+    t_print("%s: number of %s buffers: %d\n", __func__, pool->name, pool->num);
+  }
+}
+
+static void pool_mark_free(BUFPOOL *pool) {
+  //
+  // Mark all buffers of this pool as free, and re-build the free list.
+  // This must only be called if the thread getting buffers from this pool
+  // is not running.
+  //
+  __atomic_store_n(&pool->shared, NULL, __ATOMIC_RELAXED);
+  pool->local = NULL;
+  for (BUFHDR *bp = pool->all; bp; bp = bp->all) {
+    __atomic_store_n(&bp->free, 1, __ATOMIC_RELAXED);
+    bp->next = pool->local;
+    pool->local = bp;
+  }
+  __atomic_store_n(&pool->inuse, 0, __ATOMIC_RELEASE);
+}
+
+static void pool_print_stats(BUFPOOL *pool) {
+  if (pool->num > 0) {
+    long long released = __atomic_load_n(&pool->released, __ATOMIC_RELAXED);
+    long long residency = __atomic_load_n(&pool->residency, __ATOMIC_RELAXED);
+    t_print("%s: %s buffers: num=%d high-water=%d exhausted=%ld avg. residency=%lld usec\n",
+            __func__, pool->name, pool->num, pool->highwater, pool->exhausted,
+            released > 0 ? residency / released : 0LL);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
 //                             METIS buffers                                  //
 //                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
-static metisbuffer *metisbuflist[8];
-static unsigned int nummetisbuf;
-static unsigned int metisbufcnt = 7;
+static BUFPOOL metispool = { .name = "METIS", .size = sizeof(metisbuffer), .grow = 64 };
 
 metisbuffer *get_metisbuffer(void) {
-  //
-  // Allocate a buffer from the METIS buffer queue
-  //
-  metisbufcnt = (metisbufcnt + 1) & 7;
-  metisbuffer *bp = metisbuflist[metisbufcnt];
-  while (bp) {
-    if (bp->free) {
-      bp->free = 0;
-      return bp;
-    }
-    bp = bp->next;
-  }
-  // no free buffer found. Allocate 64 new ones
-  for (unsigned int i = 0; i < 64; i++) {
-    bp = g_new(metisbuffer, 1);
-    if (!bp) {
-      fatal_error("FATAL: P1: out of memory");
-    } else {
-      bp->free = 1;
-      bp->next = metisbuflist[metisbufcnt];
-      metisbuflist[metisbufcnt] = bp;
-      nummetisbuf++;
-    }
-  }
-  t_print("%s(%d): number of METIS buffers increased to %u\n",
-          __func__, metisbufcnt, nummetisbuf);
-  metisbuflist[metisbufcnt]->free = 0;
-  return metisbuflist[metisbufcnt];
+  return (metisbuffer *) pool_get(&metispool);
+}
+
+void release_metisbuffer(metisbuffer *bp) {
+  pool_release(&bp->hdr);
+}
+
+void prealloc_metisbuffers(int num) {
+  pool_prealloc(&metispool, num);
 }
 
 #ifdef USBOZY
@@ -89,39 +202,18 @@ metisbuffer *get_metisbuffer(void) {
 //                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
-static ozybuffer *ozybuflist[8];
-static unsigned int numozybuf;
-static unsigned int ozybufcnt = 7;
+static BUFPOOL ozypool = { .name = "OZY", .size = sizeof(ozybuffer), .grow = 32 };
 
 ozybuffer *get_ozybuffer(void) {
-  //
-  // Allocate a buffer from the OZY buffer queue
-  //
-  ozybufcnt = (ozybufcnt + 1) & 7;
-  ozybuffer *bp = ozybuflist[ozybufcnt];
-  while (bp) {
-    if (bp->free) {
-      bp->free = 0;
-      return bp;
-    }
-    bp = bp->next;
-  }
-  // no free buffer found. Allocate 32 new ones
-  for (unsigned int i = 0; i < 32; i++) {
-    bp = g_new(ozybuffer, 1);
-    if (!bp) {
-      fatal_error("FATAL: P1: out of memory");
-    } else {
-      bp->free = 1;
-      bp->next = ozybuflist[ozybufcnt];
-      ozybuflist[ozybufcnt] = bp;
-      numozybuf++;
-    }
-  }
-  t_print("%s(%d): number of OZY buffers increased to %u\n",
-          __func__, ozybufcnt, numozybuf);
-  ozybuflist[ozybufcnt]->free = 0;
-  return ozybuflist[ozybufcnt];
+  return (ozybuffer *) pool_get(&ozypool);
+}
+
+void release_ozybuffer(ozybuffer *bp) {
+  pool_release(&bp->hdr);
+}
+
+void prealloc_ozybuffers(int num) {
+  pool_prealloc(&ozypool, num);
 }
 
 #endif
@@ -132,73 +224,26 @@ ozybuffer *get_ozybuffer(void) {
 //                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
-static p2buffer *p2buflist[8];
-static unsigned int p2numbuf;
-static unsigned int p2bufcnt = 7;
+static BUFPOOL p2pool = { .name = "P2", .size = sizeof(p2buffer), .grow = 64 };
 
 p2buffer *get_p2buffer(void) {
-  //
-  // Allocate a buffer from the P2 buffer queue
-  //
-  p2bufcnt = (p2bufcnt + 1) & 7;
-  p2buffer *bp = p2buflist[p2bufcnt];
-  while (bp) {
-    if (bp->free) {
-      // found free buffer. Mark as used and return that one.
-      bp->free = 0;
-      return bp;
-    }
-    bp = bp->next;
-  }
-  //
-  // no free buffer found, allocate a bunch of new ones
-  // and add to the head of the list
-  //
-  for (unsigned int i = 0; i < 64; i++) {
-    bp = g_new(p2buffer, 1);
-    if (!bp) {
-      fatal_error("FATAL: P2: out of memory");
-    } else {
-      bp->free = 1;
-      bp->next = p2buflist[p2bufcnt];
-      p2buflist[p2bufcnt] = bp;
-      p2numbuf++;
-    }
-  }
-  t_print("%s(%d): number of P2 buffers increased to %u\n",
-          __func__, p2bufcnt, p2numbuf);
-  // Mark the first buffer in list as used and return that one.
-  p2buflist[p2bufcnt]->free = 0;
-  return p2buflist[p2bufcnt];
+  return (p2buffer *) pool_get(&p2pool);
 }
 
-void prealloc_p2buffers(void) {
+void release_p2buffer(p2buffer *bp) {
   //
-  // Take care buffers are allocated in all buffer lists
-  // To this end, allocate 8 buffers (they then come from
-  // all buffer lists), then mark them free.
+  // This works for all P2 buffers, including the XDMA ones,
+  // since each buffer knows the pool it belongs to.
   //
-  p2buffer *bp[8];
-  for (unsigned int i = 0; i < 8; i++) {
-    bp[i] = get_p2buffer();
-  }
-  for (unsigned int i = 0; i < 8; i++) {
-    bp[i]->free = 1;
-  }
+  pool_release(&bp->hdr);
+}
+
+void prealloc_p2buffers(int num) {
+  pool_prealloc(&p2pool, num);
 }
 
 void mark_p2buffers_free(void) {
-  //
-  // This must only be called if the thread calling get_p2buffer()
-  // is not running
-  //
-  for (unsigned int i = 0; i < 8; i++) {
-    p2buffer *bp = p2buflist[i];
-    while (bp) {
-      bp->free = 1;
-      bp = bp->next;
-    }
-  }
+  pool_mark_free(&p2pool);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -210,177 +255,56 @@ void mark_p2buffers_free(void) {
 // The XDMA code allocates buffers from three independend threads
 // HighPrio, MicAudio, and a combined thread for all DDCs).
 //
-// To avoid thread synchronization (mutexes), different buffer pools
-// must be used for the three cases. We use three different functions so we can
-// do pre-allocation in different amounts.  // We allocate buffers in bunches of 64 for the DDC thread, and in smaller
-// bunches of 16 for the HP and MicAudio thread. So the minimum number of
-// buffers allocated at program start is 512 for DDC, 128 for HP, and 128 for MicAudio.
+// Since each pool must only be used by a single thread for getting buffers,
+// different buffer pools must be used for the three cases.
+// The HP and MicAudio pools are pre-allocated with 128 buffers each, and
+// grow in bunches of 16, while the DDC pool grows in bunches of 64.
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-static p2buffer *satrxbuflist[8];   // for XMDA DDC thread buffers
-static p2buffer *sathpbuflist[8];   // for XDMA high-prio thread buffers
-static p2buffer *satmicbuflist[8];  // for XDMA mic-audio thread buffers
-static unsigned int satnumrxbuf;
-static unsigned int satnumhpbuf;
-static unsigned int satnummicbuf;
-static unsigned int satrxbufcnt = 7;
-static unsigned int sathpbufcnt = 7;
-static unsigned int satmicbufcnt = 7;
+static BUFPOOL satrxpool  = { .name = "XDMA RX",  .size = sizeof(p2buffer), .grow = 64 };
+static BUFPOOL sathppool  = { .name = "XDMA HP",  .size = sizeof(p2buffer), .grow = 16 };
+static BUFPOOL satmicpool = { .name = "XDMA MIC", .size = sizeof(p2buffer), .grow = 16 };
 
 p2buffer *get_satrxbuffer() {
-  //
-  // Allocate a buffer from the RX buffer queue
-  //
-  satrxbufcnt = (satrxbufcnt + 1) & 7;
-  p2buffer *bp = satrxbuflist[satrxbufcnt];
-  while (bp) {
-    if (bp->free) {
-      // found free buffer. Mark as used and return that one.
-      bp->free = 0;
-      return bp;
-    }
-    bp = bp->next;
-  }
-  //
-  // no free buffer found, allocate a bunch of new ones
-  // and add to the head of the list
-  //
-  for (int i = 0; i < 64; i++) {
-    bp = g_new(p2buffer, 1);
-    if (!bp) {
-      fatal_error("FATAL: P2: out of memory");
-    } else {
-      bp->free = 1;
-      bp->next = satrxbuflist[satrxbufcnt];
-      satrxbuflist[satrxbufcnt] = bp;
-      satnumrxbuf++;
-    }
-  }
-  t_print("%s(%d): number of RX buffers increased to %u\n",
-          __func__, satrxbufcnt, satnumrxbuf);
-  // Mark the first buffer in list as used and return that one.
-  satrxbuflist[satrxbufcnt]->free = 0;
-  return satrxbuflist[satrxbufcnt];
-
+  return (p2buffer *) pool_get(&satrxpool);
 }
 
 p2buffer *get_sathpbuffer() {
-  //
-  // Allocate a buffer from the HP buffer queue
-  //
-  sathpbufcnt = (sathpbufcnt + 1) & 7;
-  p2buffer *bp = sathpbuflist[sathpbufcnt];
-  while (bp) {
-    if (bp->free) {
-      // found free buffer. Mark as used and return that one.
-      bp->free = 0;
-      return bp;
-    }
-    bp = bp->next;
-  }
-  //
-  // no free buffer found, allocate a bunch of new ones
-  // and add to the head of the list
-  //
-  for (int i = 0; i < 16; i++) {
-    bp = g_new(p2buffer, 1);
-    if (!bp) {
-      fatal_error("FATAL: P2: out of memory");
-    } else {
-      bp->free = 1;
-      bp->next = sathpbuflist[sathpbufcnt];
-      sathpbuflist[sathpbufcnt] = bp;
-      satnumhpbuf++;
-    }
-  }
-  t_print("%s(%d): number of HP buffers increased to %u\n",
-          __func__, sathpbufcnt, satnumhpbuf);
-  // Mark the first buffer in list as used and return that one.
-  sathpbuflist[sathpbufcnt]->free = 0;
-  return sathpbuflist[sathpbufcnt];
-
+  return (p2buffer *) pool_get(&sathppool);
 }
 
 p2buffer *get_satmicbuffer() {
-  //
-  // Allocate a buffer from the MIC buffer queue
-  //
-  satmicbufcnt = (satmicbufcnt + 1) & 7;
-  p2buffer *bp = satmicbuflist[satmicbufcnt];
-  while (bp) {
-    if (bp->free) {
-      // found free buffer. Mark as used and return that one.
-      bp->free = 0;
-      return bp;
-    }
-    bp = bp->next;
-  }
-  //
-  // no free buffer found, allocate a bunch of new ones
-  // and add to the head of the list
-  //
-  for (int i = 0; i < 16; i++) {
-    bp = g_new(p2buffer, 1);
-    if (!bp) {
-      fatal_error("FATAL: P2: out of memory");
-    } else {
-      bp->free = 1;
-      bp->next = satmicbuflist[satmicbufcnt];
-      satmicbuflist[satmicbufcnt] = bp;
-      satnummicbuf++;
-    }
-  }
-  t_print("%s(%d): number of MIC buffers increased to %u\n",
-          __func__, satmicbufcnt, satnummicbuf);
-  // Mark the first buffer in list as used and return that one.
-  satmicbuflist[satmicbufcnt]->free = 0;
-  return satmicbuflist[satmicbufcnt];
+  return (p2buffer *) pool_get(&satmicpool);
 }
 
-void prealloc_satbuffers(void) {
+void prealloc_satbuffers(int num) {
   //
-  // Take care buffers are allocated in all buffer lists
-  // To this end, allocate 8 buffers (they then come from
-  // all buffer lists) then then mark them free.
-  // This function does the job for all three buffer queues (RX, HP, MIC)
+  // num is the number of buffers for the DDC pool.
   //
-  p2buffer *rxbuf[8], *hpbuf[8], *micbuf[8];
-  for (unsigned int i = 0; i < 8; i++) {
-    rxbuf[i] = get_satrxbuffer();
-    hpbuf[i] = get_sathpbuffer();
-    micbuf[i] = get_satmicbuffer();
-  }
-  for (unsigned int i = 0; i < 8; i++) {
-    rxbuf[i]->free = 1;
-    hpbuf[i]->free = 1;
-    micbuf[i]->free = 1;
-  }
+  pool_prealloc(&satrxpool, num);
+  pool_prealloc(&sathppool, 128);
+  pool_prealloc(&satmicpool, 128);
 }
 
 void mark_satbuffers_free(void) {
   //
   // This must only be called if the threads allocating the buffers
   // are not running.
-  // This function does the job for all three buffer queues (RX, HP, MIC)
+  // This function does the job for all three buffer pools (RX, HP, MIC)
   //
-  p2buffer *bp;
+  pool_mark_free(&satrxpool);
+  pool_mark_free(&sathppool);
+  pool_mark_free(&satmicpool);
+}
 
-  for (unsigned int i = 0; i < 8; i++) {
-    bp = satrxbuflist[i];
-    while (bp) {
-      bp->free = 1;
-      bp = bp->next;
-    }
-    bp = sathpbuflist[i];
-    while (bp) {
-      bp->free = 1;
-      bp = bp->next;
-    }
-    bp = satmicbuflist[i];
-    while (bp) {
-      bp->free = 1;
-      bp = bp->next;
-    }
-  }
+void print_buffer_stats(void) {
+  pool_print_stats(&metispool);
+#ifdef USBOZY
+  pool_print_stats(&ozypool);
+#endif
+  pool_print_stats(&p2pool);
+  pool_print_stats(&satrxpool);
+  pool_print_stats(&sathppool);
+  pool_print_stats(&satmicpool);
 }
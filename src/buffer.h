@@ -23,49 +23,59 @@
 // P2: 1500 bytes).
 //
 // Buffers are allocated once and stay alive during the whole duration
-// of the program. They are put in a linear linked list, such that
-// the search for a free buffer can take much time (cycling through
-// the whole list). But this seemingly dumb method has two advantages:
-// - no malloc/free/mutex/atomic test-and-set during allocating and release,
-// - in normal operation, when only few buffers are used, the same
-//   buffers are used again and again so they stay in L1 cache
+// of the program. Each buffer class has its own pool, which is pre-sized
+// when the protocol is started. Getting a buffer from, and releasing a buffer
+// to the pool is O(1) and lock-free.
 //
-// To address possible problems with the "O(N)" cycling through the
-// buffer list, each buffer lists exists as eight siblings which are
-// used in a round-robin fashion.
+// Each pool must only be used by a single thread for *getting* buffers,
+// while buffers can be released from any thread.
 //
 
-#include "atomic.h"
-
 #ifndef _BUFFER_H_
 #define _BUFFER_H_
 
+struct _bufpool;
+
+//
+// Common header of all buffers. The fields are managed by buffer.c,
+// but "free" may be inspected elsewhere to detect stale buffers
+// after a protocol restart.
+//
+typedef struct _bufhdr {
+  struct _bufhdr *next;          // link in the free list
+  struct _bufhdr *all;           // link in the list of all buffers of this pool
+  struct _bufpool *pool;         // pool this buffer belongs to
+  long long stamp;               // time (usec) this buffer was handed out
+  int free;                      // buffer is free
+} BUFHDR;
+
 #define METIS_BUFFER_SIZE 1032
 struct metisbuffer_ {
-  struct metisbuffer_ *next;
-  volatile atomic_int free;
+  BUFHDR hdr;
   unsigned char buffer[METIS_BUFFER_SIZE];
 };
 
 typedef struct metisbuffer_ metisbuffer;
 extern metisbuffer *get_metisbuffer(void);
+extern void release_metisbuffer(metisbuffer *bp);
+extern void prealloc_metisbuffers(int num);
 
 #ifdef USBOZY
 #define EP6_BUFFER_SIZE   2048
 struct ozybuffer_ {
-  struct ozybuffer_ *next;
-  volatile atomic_int free;
+  BUFHDR hdr;
   unsigned char buffer[EP6_BUFFER_SIZE];
 };
 
 typedef struct ozybuffer_ ozybuffer;
 extern ozybuffer *get_ozybuffer(void);
+extern void release_ozybuffer(ozybuffer *bp);
+extern void prealloc_ozybuffers(int num);
 #endif
 
 #define P2_BUFFER_SIZE    1500
 struct p2buffer_ {
-  struct p2buffer_ *next;
-  volatile atomic_int free;
+  BUFHDR hdr;
   unsigned char buffer[P2_BUFFER_SIZE];
 };
 
@@ -74,9 +84,12 @@ extern p2buffer *get_p2buffer(void);
 extern p2buffer *get_satrxbuffer(void);
 extern p2buffer *get_sathpbuffer(void);
 extern p2buffer *get_satmicbuffer(void);
-extern void prealloc_p2buffers(void);
-extern void prealloc_satbuffers(void);
+extern void release_p2buffer(p2buffer *bp);
+extern void prealloc_p2buffers(int num);
+extern void prealloc_satbuffers(int num);
 extern void mark_p2buffers_free(void);
 extern void mark_satbuffers_free(void);
 
+extern void print_buffer_stats(void);
+
 #endif
@@ -543,6 +543,7 @@ void send_rx_data(int sock, int id) {
   data.low_latency             = rx->low_latency;
   data.pan                     = rx->pan;
   data.fm_limiter              = rx->fm_limiter;
+  data.dsp_pipeline            = rx->dsp_pipeline;
   //
   data.anf_taps                = to_16(rx->anf_taps);
   data.anf_delay               = to_16(rx->anf_delay);
@@ -1276,6 +1277,7 @@ void send_rx_fft(int s, const RECEIVER *rx) {
   command.header.b1 = rx->id;
   command.header.b2 = rx->low_latency;
   command.header.s1 = to_16(rx->nbp_window);
+  command.header.s2 = to_16(rx->dsp_pipeline);
   command.u32 = to_32(rx->fft_size);
   send_tcp(s, (char *)&command, sizeof(command));
 }
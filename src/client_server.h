@@ -149,9 +149,10 @@ enum _header_type_enum {
   CLIENT_SERVER_COMMANDS,
 };
 
-#define CLIENT_SERVER_VERSION 0x01300006 // 32-bit version number
+#define CLIENT_SERVER_VERSION 0x01300008 // 32-bit version number
 #define SPECTRUM_DATA_SIZE 4096          // Maximum width of a panadapter
 #define AUDIO_DATA_SIZE 512              // 512 (mono) samples
+#define REMOTE_RECEIVERS 2               // Max. number of receivers a client can handle
 
 typedef struct _remote_client {
   int running;
@@ -652,6 +653,7 @@ typedef struct __attribute__((__packed__)) _receiver_data {
   uint8_t nbp_window;
   uint8_t multi_notch_enable[3];
   uint8_t fm_limiter;
+  uint8_t dsp_pipeline;
 } RECEIVER_DATA;
 
 //
@@ -846,14 +846,15 @@ static gpointer client_tcp_thread(gpointer arg) {
   transmitter = g_new(TRANSMITTER, 1);
   memset(radio,       0, sizeof(DISCOVERED));
   memset(transmitter, 0, sizeof(TRANSMITTER));
-  RECEIVERS = 2;
-  PS_TX_FEEDBACK = 2;
-  PS_RX_FEEDBACK = 3;
+  RECEIVERS = REMOTE_RECEIVERS;
+  PS_TX_FEEDBACK = MAX_RECEIVERS;
+  PS_RX_FEEDBACK = MAX_RECEIVERS + 1;
   radio->network.address = server_address;
-  for (int i = 0; i < 2; i++) {
+  for (int i = 0; i < RECEIVERS; i++) {
     RECEIVER *rx = receiver[i] = g_new(RECEIVER, 1);
     memset(rx, 0, sizeof(RECEIVER));
     g_mutex_init(&rx->display_mutex);
+    g_mutex_init(&rx->render_mutex);
     g_mutex_init(&rx->mutex);
     g_mutex_init(&rx->audio_mutex);
     rx->id = i;
@@ -1206,6 +1207,7 @@ static gpointer client_tcp_thread(gpointer arg) {
       rx->eq_enable               = data.eq_enable;
       rx->smetermode              = data.smetermode;
       rx->low_latency             = data.low_latency;
+      rx->dsp_pipeline            = data.dsp_pipeline;
       rx->pan                     = data.pan;
       //
       rx->fps                     = from_16(data.fps);
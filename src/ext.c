@@ -75,6 +75,11 @@ int ext_radio_set_mox(gpointer data) {
   return G_SOURCE_REMOVE;
 }
 
+int ext_radio_change_receivers(gpointer data) {
+  radio_change_receivers(GPOINTER_TO_INT(data));
+  return G_SOURCE_REMOVE;
+}
+
 // cppcheck-suppress constParameterPointer
 int ext_radio_set_vox(gpointer data) {
   int state = GPOINTER_TO_INT(data);
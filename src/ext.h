@@ -30,6 +30,7 @@ extern int ext_start_radio(gpointer data);
 extern int ext_vfo_update(gpointer data);
 extern int ext_radio_set_tune(gpointer data);
 extern int ext_radio_set_mox(gpointer data);
+extern int ext_radio_change_receivers(gpointer data);
 extern int ext_start_tx_menu(gpointer data);
 extern int ext_start_rx_menu(gpointer data);
 extern int ext_start_mode_menu(gpointer data);
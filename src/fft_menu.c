@@ -54,6 +54,13 @@ static void binaural_cb(GtkWidget *widget, gpointer data) {
   rx_set_af_binaural(rx);
 }
 
+static void pipeline_cb(GtkWidget *widget, gpointer data) {
+  int id = GPOINTER_TO_INT(data);
+  RECEIVER *rx = receiver[id];
+  rx->dsp_pipeline = gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (widget));
+  rx_set_fft_params(rx);
+}
+
 static void filter_type_cb(GtkToggleButton *widget, gpointer data) {
   int type = gtk_combo_box_get_active (GTK_COMBO_BOX(widget));
   int channel  = GPOINTER_TO_INT(data);
@@ -138,6 +145,10 @@ void fft_menu(GtkWidget *parent) {
   gtk_widget_set_name(w, "boldlabel");
   gtk_widget_set_halign(w, GTK_ALIGN_END);
   gtk_grid_attach(GTK_GRID(grid), w, 0, 5, 1, 1);
+  w = gtk_label_new("Pipelined");
+  gtk_widget_set_name(w, "boldlabel");
+  gtk_widget_set_halign(w, GTK_ALIGN_END);
+  gtk_grid_attach(GTK_GRID(grid), w, 0, 6, 1, 1);
   int col = 1;
   for (int i = 0; i <= receivers; i++) {
     // i == receivers means "TX"
@@ -217,13 +228,18 @@ void fft_menu(GtkWidget *parent) {
     my_combo_attach(GTK_GRID(grid), w, col, 3, 1, 1);
     g_signal_connect(w, "changed", G_CALLBACK(filter_size_cb), GINT_TO_POINTER(chan));
     //
-    // RX only: binaural
+    // RX only: binaural, pipelined execution (one more DSP buffer latency, but
+    // the work is distributed over two CPU cores)
     //
     if (i < receivers) {
       w = gtk_check_button_new();
       gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(w), receiver[i]->binaural);
       gtk_grid_attach(GTK_GRID(grid), w, col, 5, 1, 1);
       g_signal_connect(w, "toggled", G_CALLBACK(binaural_cb), GINT_TO_POINTER(chan));
+      w = gtk_check_button_new();
+      gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(w), receiver[i]->dsp_pipeline);
+      gtk_grid_attach(GTK_GRID(grid), w, col, 6, 1, 1);
+      g_signal_connect(w, "toggled", G_CALLBACK(pipeline_cb), GINT_TO_POINTER(chan));
     }
     col++;
   }
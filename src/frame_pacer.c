@@ -0,0 +1,127 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <string.h>
+#include "frame_pacer.h"
+#include "wdsp.h"
+
+void pacer_init(FRAME_PACER *p, GSourceFunc update, gpointer data) {
+  memset(p, 0, sizeof(FRAME_PACER));
+  g_mutex_init(&p->mutex);
+  p->update = update;
+  p->data = data;
+  p->disp = -1;
+  p->stat_start = g_get_monotonic_time();
+}
+
+//
+// Connect to a WDSP analyzer, or change the frame rate if already connected
+//
+void pacer_start(FRAME_PACER *p, int disp, int fps) {
+  p->fps = fps;
+  if (p->disp != disp) {
+    pacer_stop(p);
+    p->disp = disp;
+    SetAnalyzerNotify(disp, pacer_notify, p);
+  }
+}
+
+void pacer_stop(FRAME_PACER *p) {
+  if (p->disp >= 0) {
+    SetAnalyzerNotify(p->disp, NULL, NULL);
+    p->disp = -1;
+  }
+}
+
+static gboolean pacer_run(gpointer arg) {
+  FRAME_PACER *p = (FRAME_PACER *)arg;
+  g_mutex_lock(&p->mutex);
+  p->pending = 0;
+  p->last_update = g_get_monotonic_time();
+  p->frame_time = p->spectrum_time;
+  g_mutex_unlock(&p->mutex);
+  p->update(p->data);
+  return G_SOURCE_REMOVE;
+}
+
+//
+// Schedule an update, if none is pending. If the previous update
+// has been made less than 1/fps seconds ago, it is scheduled such
+// that this interval is kept.
+//
+void pacer_request(FRAME_PACER *p) {
+  g_mutex_lock(&p->mutex);
+  if (!p->pending) {
+    gint64 wait = 0;
+    p->pending = 1;
+    if (p->fps > 0) {
+      wait = p->last_update + 1000000 / p->fps - g_get_monotonic_time();
+    }
+    if (wait > 999) {
+      g_timeout_add_full(G_PRIORITY_HIGH_IDLE, (guint)(wait / 1000), pacer_run, p, NULL);
+    } else {
+      g_idle_add_full(G_PRIORITY_HIGH_IDLE, pacer_run, p, NULL);
+    }
+  }
+  g_mutex_unlock(&p->mutex);
+}
+
+//
+// Called by the analyzer (in a WDSP thread) when a new spectrum is available
+//
+void pacer_notify(void *arg) {
+  FRAME_PACER *p = (FRAME_PACER *)arg;
+  g_mutex_lock(&p->mutex);
+  p->spectrum_time = g_get_monotonic_time();
+  p->stat_spectra++;
+  g_mutex_unlock(&p->mutex);
+  pacer_request(p);
+}
+
+void pacer_frame_shown(FRAME_PACER *p) {
+  g_mutex_lock(&p->mutex);
+  p->stat_frames++;
+  if (p->frame_time > 0) {
+    gint64 latency = g_get_monotonic_time() - p->frame_time;
+    p->latency_sum += latency;
+    if (latency > p->latency_max) { p->latency_max = latency; }
+  }
+  g_mutex_unlock(&p->mutex);
+}
+
+//
+// Frames per second, average and max. latency (msec) from the analyzer
+// to the screen, and the number of spectra that have not been shown,
+// since the previous call
+//
+void pacer_get_stats(FRAME_PACER *p, double *fps, double *avg, double *max, long *skipped) {
+  g_mutex_lock(&p->mutex);
+  gint64 now = g_get_monotonic_time();
+  double secs = 1.0E-6 * (double)(now - p->stat_start);
+  *fps = (secs > 0.0) ? (double)p->stat_frames / secs : 0.0;
+  *avg = (p->stat_frames > 0) ? 0.001 * (double)p->latency_sum / (double)p->stat_frames : 0.0;
+  *max = 0.001 * (double)p->latency_max;
+  *skipped = (p->stat_spectra > p->stat_frames) ? p->stat_spectra - p->stat_frames : 0;
+  p->stat_start = now;
+  p->stat_spectra = 0;
+  p->stat_frames = 0;
+  p->latency_sum = 0;
+  p->latency_max = 0;
+  g_mutex_unlock(&p->mutex);
+}
@@ -0,0 +1,63 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// Frame pacing for the panadapters.
+//
+// Instead of polling the analyzer at a fixed rate, a display is updated
+// when the WDSP analyzer has published a new spectrum: the analyzer calls
+// pacer_notify(), which schedules one call of the update function on the
+// GTK thread. Spectra that arrive before that call has been made are
+// coalesced into one frame, and the update rate is limited to "fps".
+//
+// The update function calls pacer_frame_shown() when the frame is
+// visible, which records the latency from the publication of the
+// spectrum to the screen.
+//
+
+#ifndef _FRAME_PACER_H_
+#define _FRAME_PACER_H_
+
+#include <gtk/gtk.h>
+
+typedef struct _frame_pacer {
+  GSourceFunc update;          // draws a frame, called on the GTK thread
+  gpointer data;               // argument of update()
+  int disp;                    // WDSP analyzer, -1 if not connected
+  int fps;                     // max. number of frames per second, 0: no limit
+  GMutex mutex;                // protects everything below
+  int pending;                 // an update has been scheduled
+  gint64 last_update;          // time of the last update
+  gint64 spectrum_time;        // time the newest spectrum has been published
+  gint64 frame_time;           // time the spectrum being drawn has been published
+  gint64 stat_start;           // statistics since stat_start
+  long stat_spectra;           // number of spectra published
+  long stat_frames;            // number of frames shown
+  gint64 latency_sum;          // sum of the latencies of the frames shown
+  gint64 latency_max;          // max. latency of a frame shown
+} FRAME_PACER;
+
+extern void pacer_init(FRAME_PACER *p, GSourceFunc update, gpointer data);
+extern void pacer_start(FRAME_PACER *p, int disp, int fps);
+extern void pacer_stop(FRAME_PACER *p);
+extern void pacer_notify(void *arg);
+extern void pacer_request(FRAME_PACER *p);
+extern void pacer_frame_shown(FRAME_PACER *p);
+extern void pacer_get_stats(FRAME_PACER *p, double *fps, double *avg, double *max, long *skipped);
+
+#endif
@@ -84,6 +84,7 @@
 
 #define EXTERN
 #include "hpsdrsim.h"
+#include "simsignal.h"
 
 /*
  * These variables store the state of the "old protocol" SDR.
@@ -275,7 +276,7 @@ int main(int argc, char *argv[]) {
   int udp_retries = 0;
   int bytes_read, bytes_left;
   uint32_t *code0 = (uint32_t *) buffer;  // fast access to code of first buffer
-  double run, off, off2, inc;
+  double off, off2;
   struct timeval tvzero = {0, 0};
   fd_set fds;
   int fd;
@@ -464,15 +465,11 @@ int main(int argc, char *argv[]) {
   //
   t_print(".... producing random noise\n");
   // Produce some noise
-  j = RAND_MAX / 2;
   //
   // Note noise amplitude has to be multiplied with
   // sqrt(sample_rate/48k)
   //
-  for (i = 0; i < LENNOISE; i++) {
-    noiseItab[i] = ((double) rand_r(&seed) / j - 1.0) * 1.41421E-6;
-    noiseQtab[i] = ((double) rand_r(&seed) / j - 1.0) * 1.41421E-6;
-  }
+  sim_noise_table(noiseItab, noiseQtab, LENNOISE, &seed);
   //
   // Use only one buffer, so diversity and
   // noise blanker testing are mutually exclusive
@@ -488,27 +485,8 @@ int main(int argc, char *argv[]) {
     //
     t_print("DIVERSITY testing activated!\n");
     t_print(".... producing some man-made noise\n");
-    memset(divtab, 0, LENDIV * sizeof(double));
-    for (j = 1; j <= 200; j++) {
-      run = 0.0;
-      off = 0.25 * j * j;
-      inc = j * 0.00039269908169872415480783042290994;
-      for (i = 0; i < LENDIV; i++) {
-        divtab[i] += cos(run + off);
-        run += inc;
-      }
-    }
-    // normalise
-    off = 0.0;
-    for (i = 0; i < LENDIV; i++) {
-      if ( divtab[i] > off) { off = divtab[i]; }
-      if (-divtab[i] > off) { off = -divtab[i]; }
-    }
-    off = 1.0 / off;
+    off = sim_comb_table(divtab, LENDIV);
     t_print("(normalizing with %f)\n", off);
-    for (i = 0; i < LENDIV; i++) {
-      divtab[i] = divtab[i] * off;
-    }
   }
   if (diversity && noiseblank) {
     //
@@ -517,13 +495,9 @@ int main(int argc, char *argv[]) {
     // m samples wide
     // about -80 dBm in 1000 Hz
     //
-    off = sqrt(0.05 / (nb_pulse * nb_width));
-    memset(divtab, 0, LENDIV * sizeof(double));
     t_print("NOISE BLANKER test activated: %d pulses of width %d within %d samples\n",
             nb_pulse, nb_width, LENDIV);
-    for (i = 0; i < nb_pulse; i++) {
-      for (j = (i * LENDIV) / nb_pulse; j < (i * LENDIV) / nb_pulse + nb_width; j++) { divtab[j] = off; }
-    }
+    sim_impulse_table(divtab, LENDIV, nb_pulse, nb_width);
   }
   have_rxiq = 0;
   fd = open("RXIQDUMP", O_RDONLY);
@@ -41,6 +41,7 @@
 #include "mode.h"
 #include "new_protocol.h"
 #include "radio.h"
+#include "threads.h"
 #include "transmitter.h"
 #include "vfo.h"
 
@@ -349,6 +350,7 @@ static void* keyer_thread(void *arg) {
   int moxbefore;
   int cwvox;
   t_print("%s: running= %d\n", __func__, running);
+  thread_register("KEYER", THREAD_ROLE_KEYER);
   while (running) {
     enforce_cw_vox = 0;
 #ifdef __APPLE__
@@ -356,6 +358,7 @@ static void* keyer_thread(void *arg) {
 #else
     sem_wait(&cw_event);
 #endif
+    thread_wakeup();
     // swallow any cw_events posted during the last "cw hang" time.
     if (!kcwl && !kcwr) { continue; }
     //
@@ -607,5 +610,6 @@ static void* keyer_thread(void *arg) {
     }
   }
   t_print("%s: EXIT\n", __func__);
+  thread_unregister();
   return NULL;
 }
@@ -0,0 +1,477 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MacOS.h"
+#include "discovered.h"
+#include "iqfile.h"
+#include "message.h"
+#include "radio.h"
+#include "receiver.h"
+#include "threads.h"
+#include "vfo.h"
+
+#define IQREC_NBLOCKS 8        // blocks per recorder, that is, 8 MB
+#define IQPLAY_CHUNK  1024     // IQ pairs fed to the RX engine per call
+
+enum _iqblock_state {
+  IQBLOCK_FREE = 0,            // owned by the producer
+  IQBLOCK_FULL                 // owned by the writer thread
+};
+
+typedef struct _iqrec {
+  int fd;
+  GThread *thread;
+  int running;
+  unsigned char *block[IQREC_NBLOCKS];
+  atomic_int state[IQREC_NBLOCKS];
+  int fill;                    // block being filled by the producer
+  int drain;                   // next block to be written by the writer
+  int64_t index;               // sample number of the next sample
+  long long written;           // bytes written to disk
+  long dropped;                // packets lost because the writer was too slow
+  int error;
+#ifdef __APPLE__
+  sem_t *sem;
+#else
+  sem_t sem;
+#endif
+} IQREC;
+
+typedef struct _iqplay {
+  RECEIVER *rx;
+  GThread *thread;
+  atomic_int running;
+  int realtime;
+  unsigned char *map;
+  size_t size;
+  size_t pos;                  // byte offset of the current block
+  long long samples;           // samples fed so far
+  long skipped;                // blocks skipped because of a sample rate mismatch
+  double speed;                // playback speed relative to real time
+} IQPLAY;
+
+atomic_int iqplay_active[MAX_RECEIVERS];
+atomic_int iqplay_ack[MAX_RECEIVERS];
+atomic_int iqrec_active[MAX_RECEIVERS];
+
+static IQREC *recorder[MAX_RECEIVERS] = { NULL };
+static GMutex iqrec_mutex[MAX_RECEIVERS];  // serializes producer and iqrec_start/stop
+static IQPLAY *player[MAX_RECEIVERS] = { NULL };
+
+//////////////////////////////////////////////////////////////////////////////////////
+//
+// Recorder
+//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static gpointer iqrec_thread(gpointer data) {
+  IQREC *rec = (IQREC *)data;
+  //
+  // Write full blocks in the order they have been filled. A block
+  // is written with a single write() call, this is much
+  // more efficient than writing single packets.
+  //
+  for (;;) {
+#ifdef __APPLE__
+    sem_wait(rec->sem);
+#else
+    sem_wait(&rec->sem);
+#endif
+    thread_wakeup();
+    if (rec->state[rec->drain] != IQBLOCK_FULL) {
+      if (!rec->running) { break; }
+      continue;
+    }
+    if (!rec->error) {
+      ssize_t rc = write(rec->fd, rec->block[rec->drain], IQFILE_BLOCKSIZE);
+      if (rc != IQFILE_BLOCKSIZE) {
+        t_print("%s: write error: %s\n", __func__, rc < 0 ? strerror(errno) : "disk full");
+        rec->error = 1;
+      } else {
+        rec->written += IQFILE_BLOCKSIZE;
+      }
+    }
+    rec->state[rec->drain] = IQBLOCK_FREE;
+    rec->drain = (rec->drain + 1) % IQREC_NBLOCKS;
+  }
+  return NULL;
+}
+
+static void iqrec_flush(IQREC *rec) {
+  //
+  // Hand over the block being filled (if not empty) to the writer
+  //
+  IQFILE_BLOCK *blk = (IQFILE_BLOCK *)rec->block[rec->fill];
+  if (rec->state[rec->fill] != IQBLOCK_FREE || blk->samples == 0) { return; }
+  rec->state[rec->fill] = IQBLOCK_FULL;
+  rec->fill = (rec->fill + 1) % IQREC_NBLOCKS;
+#ifdef __APPLE__
+  sem_post(rec->sem);
+#else
+  sem_post(&rec->sem);
+#endif
+}
+
+void iqrec_add_block(const RECEIVER *rx, const double *iq, int n) {
+  //
+  // Called from the RX engine for each incoming block of IQ samples.
+  // Samples are stored as float32, a new block is started if the
+  // current one is full, or if sample rate or frequency have changed.
+  // If the writer is lagging behind such that no free block is
+  // available, samples are dropped.
+  //
+  IQREC *rec;
+  long long freq = vfo[rx->id].frequency;
+  g_mutex_lock(&iqrec_mutex[rx->id]);
+  rec = recorder[rx->id];
+  while (rec != NULL && iqrec_active[rx->id] && n > 0) {
+    if (rec->state[rec->fill] != IQBLOCK_FREE) {
+      rec->dropped++;
+      rec->index += n;
+      break;
+    }
+    IQFILE_BLOCK *blk = (IQFILE_BLOCK *)rec->block[rec->fill];
+    if (blk->samples > 0 && (blk->sample_rate != (uint32_t) rx->sample_rate || blk->frequency != freq)) {
+      iqrec_flush(rec);
+      continue;
+    }
+    if (blk->samples == 0) {
+      memcpy(blk->magic, IQFILE_BLKMAGIC, 4);
+      blk->sample_rate = rx->sample_rate;
+      blk->frequency = freq;
+      blk->time = g_get_real_time();
+      blk->index = rec->index;
+    }
+    float *dst = (float *)(rec->block[rec->fill] + sizeof(IQFILE_BLOCK)) + 2 * blk->samples;
+    int chunk = IQFILE_BLOCK_SAMPLES - blk->samples;
+    if (chunk > n) { chunk = n; }
+    for (int i = 0; i < 2 * chunk; i++) {
+      dst[i] = (float) iq[i];
+    }
+    blk->samples += chunk;
+    rec->index += chunk;
+    iq += 2 * chunk;
+    n -= chunk;
+    if (blk->samples >= IQFILE_BLOCK_SAMPLES) {
+      iqrec_flush(rec);
+    }
+  }
+  g_mutex_unlock(&iqrec_mutex[rx->id]);
+}
+
+int iqrec_start(const RECEIVER *rx, const char *filename) {
+  ASSERT_SERVER(0);
+  int id = rx->id;
+  if (id >= MAX_RECEIVERS || recorder[id] != NULL) { return 0; }
+  IQREC *rec = g_new0(IQREC, 1);
+  unsigned char *hdrbuf;
+  //
+  // Large blocks, aligned to the page size, are most efficiently written
+  //
+  for (int i = 0; i < IQREC_NBLOCKS; i++) {
+    if (posix_memalign((void **)&rec->block[i], 4096, IQFILE_BLOCKSIZE) != 0) {
+      t_print("%s: out of memory\n", __func__);
+      for (int j = 0; j < i; j++) { free(rec->block[j]); }
+      g_free(rec);
+      return 0;
+    }
+    memset(rec->block[i], 0, IQFILE_BLOCKSIZE);
+  }
+  rec->fd = open(filename, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+  if (rec->fd < 0) {
+    t_perror("IQ recorder open:");
+    for (int i = 0; i < IQREC_NBLOCKS; i++) { free(rec->block[i]); }
+    g_free(rec);
+    return 0;
+  }
+  //
+  // The file header occupies a full page, such that all blocks
+  // are page-aligned in the file
+  //
+  hdrbuf = g_malloc0(IQFILE_HDRSIZE);
+  IQFILE_HEADER *hdr = (IQFILE_HEADER *)hdrbuf;
+  memcpy(hdr->magic, IQFILE_MAGIC, sizeof(hdr->magic));
+  hdr->version = IQFILE_VERSION;
+  hdr->hdrsize = IQFILE_HDRSIZE;
+  hdr->blocksize = IQFILE_BLOCKSIZE;
+  hdr->format = IQFILE_FMT_FLOAT32;
+  hdr->rx = id;
+  hdr->adc = rx->adc;
+  hdr->sample_rate = rx->sample_rate;
+  hdr->frequency = vfo[id].frequency;
+  hdr->start_time = g_get_real_time();
+  snprintf(hdr->radio, sizeof(hdr->radio), "%s", radio->name);
+  if (write(rec->fd, hdrbuf, IQFILE_HDRSIZE) != IQFILE_HDRSIZE) {
+    t_perror("IQ recorder write:");
+    rec->error = 1;
+  }
+  g_free(hdrbuf);
+  rec->written = IQFILE_HDRSIZE;
+#ifdef __APPLE__
+  char sname[16];
+  snprintf(sname, sizeof(sname), "IQREC%03d", id);
+  sem_unlink(sname);
+  rec->sem = sem_open(sname, O_CREAT | O_EXCL, 0700, 0);
+  if (rec->sem == SEM_FAILED) {
+    t_perror("IQ recorder sem_open:");
+  }
+#else
+  (void)sem_init(&rec->sem, 0, 0);
+#endif
+  rec->running = 1;
+  //
+  // The writer is not time-critical, so it runs with the GUI settings
+  //
+  rec->thread = thread_new("IQ writer", THREAD_ROLE_GUI, iqrec_thread, rec);
+  g_mutex_lock(&iqrec_mutex[id]);
+  recorder[id] = rec;
+  iqrec_active[id] = 1;
+  g_mutex_unlock(&iqrec_mutex[id]);
+  t_print("%s: RX%d recording to %s\n", __func__, id + 1, filename);
+  return 1;
+}
+
+void iqrec_stop(const RECEIVER *rx) {
+  int id = rx->id;
+  if (id >= MAX_RECEIVERS || recorder[id] == NULL) { return; }
+  IQREC *rec = recorder[id];
+  //
+  // Once we hold the mutex and have cleared iqrec_active,
+  // the producer will not touch the blocks any more.
+  //
+  g_mutex_lock(&iqrec_mutex[id]);
+  iqrec_active[id] = 0;
+  iqrec_flush(rec);
+  recorder[id] = NULL;
+  g_mutex_unlock(&iqrec_mutex[id]);
+  rec->running = 0;
+#ifdef __APPLE__
+  sem_post(rec->sem);
+#else
+  sem_post(&rec->sem);
+#endif
+  g_thread_join(rec->thread);
+  close(rec->fd);
+  t_print("%s: RX%d: %lld bytes written, %ld packets dropped\n", __func__, id + 1, rec->written, rec->dropped);
+#ifdef __APPLE__
+  sem_close(rec->sem);
+#else
+  sem_destroy(&rec->sem);
+#endif
+  for (int i = 0; i < IQREC_NBLOCKS; i++) { free(rec->block[i]); }
+  g_free(rec);
+}
+
+void iqrec_get_status(const RECEIVER *rx, char *status, int len) {
+  const IQREC *rec = rx->id < MAX_RECEIVERS ? recorder[rx->id] : NULL;
+  if (rec == NULL) {
+    snprintf(status, len, "idle");
+  } else {
+    snprintf(status, len, "%0.1f MB written, %ld packets dropped%s", 1.0E-6 * rec->written, rec->dropped,
+             rec->error ? ", WRITE ERROR" : "");
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+//
+// Player
+//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static gpointer iqplay_thread(gpointer data) {
+  IQPLAY *play = (IQPLAY *)data;
+  RECEIVER *rx = play->rx;
+  int id = rx->id;
+  struct timespec ts;
+  double t0;
+  long long paced = 0;         // samples fed since t0
+  long long pass = 0;          // samples fed since the start of the file
+  //
+  // Take over the RX engine from the radio. Normally the
+  // radio acknowledges within milliseconds, but if the radio
+  // does not send data there is nobody to acknowledge.
+  //
+  iqplay_ack[id] = 0;
+  iqplay_active[id] = 1;
+  for (int i = 0; i < 100 && !iqplay_ack[id]; i++) {
+    g_usleep(2000);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  t0 = ts.tv_sec + 1.0E-9 * ts.tv_nsec;
+  play->pos = IQFILE_HDRSIZE;
+  while (play->running) {
+    if (play->pos + IQFILE_BLOCKSIZE > play->size) {
+      //
+      // End of file. In real-time mode, start over,
+      // otherwise report the speed and stop.
+      //
+      if (play->realtime && pass > 0) {
+        play->pos = IQFILE_HDRSIZE;
+        pass = 0;
+        continue;
+      }
+      if (play->realtime) {
+        //
+        // Starting over would spin: no block could be played
+        //
+        t_print("%s: RX%d: no block with %d samples/sec in file, %ld blocks skipped, stopping\n", __func__, id + 1,
+                rx->sample_rate, play->skipped);
+        break;
+      }
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      double dt = ts.tv_sec + 1.0E-9 * ts.tv_nsec - t0;
+      if (dt > 0.0) { play->speed = paced / (dt * rx->sample_rate); }
+      t_print("%s: RX%d: %lld samples in %0.3f sec, %0.2f times real time\n", __func__, id + 1,
+              play->samples, dt, play->speed);
+      break;
+    }
+    const IQFILE_BLOCK *blk = (const IQFILE_BLOCK *)(play->map + play->pos);
+    const float *src = (const float *)(play->map + play->pos + sizeof(IQFILE_BLOCK));
+    int n = blk->samples;
+    play->pos += IQFILE_BLOCKSIZE;
+    if (memcmp(blk->magic, IQFILE_BLKMAGIC, 4) != 0 || n > IQFILE_BLOCK_SAMPLES) { continue; }
+    if (blk->sample_rate != (uint32_t) rx->sample_rate) {
+      play->skipped++;
+      continue;
+    }
+    while (n > 0 && play->running) {
+      int chunk = n > IQPLAY_CHUNK ? IQPLAY_CHUNK : n;
+      double iq[2 * chunk];
+      for (int i = 0; i < 2 * chunk; i++) {
+        iq[i] = src[i];
+      }
+      rx_feed_iq_block(rx, iq, chunk);
+      src += 2 * chunk;
+      n -= chunk;
+      play->samples += chunk;
+      paced += chunk;
+      pass += chunk;
+      if (play->realtime) {
+        //
+        // Sleep until the wall clock has caught up with the samples fed
+        //
+        double t = t0 + (double) paced / rx->sample_rate;
+        ts.tv_sec = (time_t) t;
+        ts.tv_nsec = (long) ((t - ts.tv_sec) * 1.0E9);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+      }
+    }
+  }
+  iqplay_active[id] = 0;
+  play->running = 0;
+  return NULL;
+}
+
+int iqplay_start(RECEIVER *rx, const char *filename, int realtime) {
+  ASSERT_SERVER(0);
+  int id = rx->id;
+  struct stat st;
+  if (id >= MAX_RECEIVERS) { return 0; }
+  iqplay_stop(rx);
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    t_perror("IQ player open:");
+    return 0;
+  }
+  if (fstat(fd, &st) < 0 || st.st_size < IQFILE_HDRSIZE) {
+    t_print("%s: %s is not an IQ file\n", __func__, filename);
+    close(fd);
+    return 0;
+  }
+  unsigned char *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    t_perror("IQ player mmap:");
+    return 0;
+  }
+  const IQFILE_HEADER *hdr = (const IQFILE_HEADER *)map;
+  if (memcmp(hdr->magic, IQFILE_MAGIC, sizeof(hdr->magic)) != 0 || hdr->version != IQFILE_VERSION
+      || hdr->hdrsize != IQFILE_HDRSIZE || hdr->blocksize != IQFILE_BLOCKSIZE
+      || hdr->format != IQFILE_FMT_FLOAT32) {
+    t_print("%s: %s is not an IQ file or has an unsupported format\n", __func__, filename);
+    munmap(map, st.st_size);
+    return 0;
+  }
+  if (hdr->sample_rate != (uint32_t) rx->sample_rate) {
+    t_print("%s: %s was recorded at %u Hz but RX%d runs at %d Hz\n", __func__, filename,
+            hdr->sample_rate, id + 1, rx->sample_rate);
+    munmap(map, st.st_size);
+    return 0;
+  }
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+  t_print("%s: RX%d playing %s (recorded from %s, RX%u, %lld Hz)\n", __func__, id + 1, filename,
+          hdr->radio, hdr->rx + 1, (long long) hdr->frequency);
+  IQPLAY *play = g_new0(IQPLAY, 1);
+  play->rx = rx;
+  play->map = map;
+  play->size = st.st_size;
+  play->realtime = realtime;
+  play->running = 1;
+  player[id] = play;
+  play->thread = thread_new("IQ player", THREAD_ROLE_RXIQ, iqplay_thread, play);
+  return 1;
+}
+
+void iqplay_stop(const RECEIVER *rx) {
+  int id = rx->id;
+  if (id >= MAX_RECEIVERS || player[id] == NULL) { return; }
+  IQPLAY *play = player[id];
+  play->running = 0;
+  g_thread_join(play->thread);
+  munmap(play->map, play->size);
+  player[id] = NULL;
+  g_free(play);
+}
+
+int iqplay_is_running(const RECEIVER *rx) {
+  return rx->id < MAX_RECEIVERS && player[rx->id] != NULL && player[rx->id]->running;
+}
+
+void iqplay_get_status(const RECEIVER *rx, char *status, int len) {
+  const IQPLAY *play = rx->id < MAX_RECEIVERS ? player[rx->id] : NULL;
+  if (play == NULL) {
+    snprintf(status, len, "idle");
+  } else {
+    double total = play->size > IQFILE_HDRSIZE ? (double) (play->size - IQFILE_HDRSIZE) : 1.0;
+    snprintf(status, len, "%s %0.0f%%, %lld samples%s", play->running ? "playing" : "done",
+             100.0 * (play->pos - IQFILE_HDRSIZE) / total, play->samples,
+             play->skipped ? ", blocks skipped (sample rate)" : "");
+    if (!play->running && !play->realtime && play->speed > 0.0) {
+      int l = strlen(status);
+      snprintf(status + l, len - l, ", %0.1f x real time", play->speed);
+    }
+  }
+}
+
+void iqfile_stop_all(void) {
+  for (int id = 0; id < MAX_RECEIVERS; id++) {
+    if (player[id] != NULL) { iqplay_stop(player[id]->rx); }
+    if (recorder[id] != NULL && receiver[id] != NULL) { iqrec_stop(receiver[id]); }
+  }
+}
@@ -0,0 +1,106 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// Recording and playback of wide-band receiver IQ data.
+//
+// The recorder taps the block ingest path of a receiver (rx_add_iq_block)
+// and hands filled blocks to a writer thread. The player memory-maps
+// a recorded file and feeds its samples into the RX engine of a receiver,
+// either in real time or as fast as possible. While a file is played,
+// the IQ samples from the radio are discarded for that receiver.
+//
+// File format (all numbers in host byte order, that is, little endian
+// on all platforms supported by piHPSDR):
+//
+// - a file header (IQFILE_HEADER), padded to IQFILE_HDRSIZE bytes
+// - a sequence of IQFILE_BLOCKSIZE blocks, each consisting of a
+//   block header (IQFILE_BLOCK) followed by up to IQFILE_BLOCK_SAMPLES
+//   interleaved IQ pairs in IEEE float32 format.
+//
+// All blocks have the full size on disk, only the last one may contain
+// less samples. A new block is also started if the sample rate or
+// the centre frequency changes, so each block has its own metadata.
+//
+
+#ifndef _IQFILE_H_
+#define _IQFILE_H_
+
+#include <stdint.h>
+
+#include "atomic.h"
+#include "receiver.h"
+
+#define IQFILE_MAGIC       "piHPSDR-IQ-File"
+#define IQFILE_BLKMAGIC    "IQBK"
+#define IQFILE_VERSION     1
+#define IQFILE_FMT_FLOAT32 1
+#define IQFILE_HDRSIZE     4096
+#define IQFILE_BLOCKSIZE   (1024 * 1024)
+#define IQFILE_BLOCK_SAMPLES ((IQFILE_BLOCKSIZE - (int) sizeof(IQFILE_BLOCK)) / 8)
+
+typedef struct _iqfile_header {
+  char     magic[16];              // IQFILE_MAGIC
+  uint32_t version;                // IQFILE_VERSION
+  uint32_t hdrsize;                // IQFILE_HDRSIZE
+  uint32_t blocksize;              // IQFILE_BLOCKSIZE
+  uint32_t format;                 // IQFILE_FMT_FLOAT32
+  uint32_t rx;                     // receiver id
+  uint32_t adc;                    // ADC the receiver was connected to
+  uint32_t sample_rate;            // sample rate at start of recording
+  uint32_t reserved;
+  int64_t  frequency;              // centre frequency (Hz) at start of recording
+  int64_t  start_time;             // start of recording (usec since the epoch)
+  char     radio[64];              // name of the radio
+} IQFILE_HEADER;
+
+typedef struct _iqfile_block {
+  char     magic[4];               // IQFILE_BLKMAGIC
+  uint32_t samples;                // number of IQ pairs in this block
+  uint32_t sample_rate;
+  uint32_t reserved;
+  int64_t  frequency;              // centre frequency (Hz)
+  int64_t  time;                   // arrival time of first sample (usec since the epoch)
+  int64_t  index;                  // sample number of first sample
+  char     pad[24];                // pad to 64 bytes
+} IQFILE_BLOCK;
+
+//
+// iqplay_active[id] is non-zero while the IQ samples from the radio
+// are to be discarded since a file is being played. The radio
+// acknowledges this by setting iqplay_ack[id], after which the player
+// may feed the RX engine. iqrec_active[id] is non-zero while the
+// receiver is being recorded.
+//
+extern atomic_int iqplay_active[MAX_RECEIVERS];
+extern atomic_int iqplay_ack[MAX_RECEIVERS];
+extern atomic_int iqrec_active[MAX_RECEIVERS];
+
+extern int  iqrec_start(const RECEIVER *rx, const char *filename);
+extern void iqrec_stop(const RECEIVER *rx);
+extern void iqrec_add_block(const RECEIVER *rx, const double *iq, int n);
+extern void iqrec_get_status(const RECEIVER *rx, char *status, int len);
+
+extern int  iqplay_start(RECEIVER *rx, const char *filename, int realtime);
+extern void iqplay_stop(const RECEIVER *rx);
+extern int  iqplay_is_running(const RECEIVER *rx);
+extern void iqplay_get_status(const RECEIVER *rx, char *status, int len);
+
+extern void iqfile_stop_all(void);
+
+#endif
@@ -0,0 +1,181 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+
+#include "iqfile.h"
+#include "iqfile_menu.h"
+#include "new_menu.h"
+#include "radio.h"
+#include "receiver.h"
+
+static GtkWidget *dialog = NULL;
+static GtkWidget *rec_b;
+static GtkWidget *play_b;
+static GtkWidget *rec_status;
+static GtkWidget *play_status;
+static RECEIVER *myrx;
+static int realtime = 1;
+static guint status_timer_id = 0;
+
+static int status_update(gpointer arg) {
+  char text[128];
+  iqrec_get_status(myrx, text, sizeof(text));
+  gtk_label_set_text(GTK_LABEL(rec_status), text);
+  iqplay_get_status(myrx, text, sizeof(text));
+  gtk_label_set_text(GTK_LABEL(play_status), text);
+  gtk_button_set_label(GTK_BUTTON(play_b), iqplay_is_running(myrx) ? "Stop Playback" : "Play File");
+  return G_SOURCE_CONTINUE;
+}
+
+static void cleanup(void) {
+  if (status_timer_id != 0) {
+    g_source_remove(status_timer_id);
+    status_timer_id = 0;
+  }
+  if (dialog != NULL) {
+    GtkWidget *tmp = dialog;
+    dialog = NULL;
+    gtk_widget_destroy(tmp);
+    sub_menu = NULL;
+    active_menu  = NO_MENU;
+  }
+}
+
+static gboolean close_cb(void) {
+  cleanup();
+  return TRUE;
+}
+
+static void rec_cb(GtkWidget *widget, gpointer data) {
+  if (!gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget))) {
+    iqrec_stop(myrx);
+    return;
+  }
+  GtkWidget *fc = gtk_file_chooser_dialog_new(
+                    "Record IQ to file", GTK_WINDOW(dialog),
+                    GTK_FILE_CHOOSER_ACTION_SAVE,
+                    "_Cancel", GTK_RESPONSE_CANCEL,
+                    "_Save",   GTK_RESPONSE_ACCEPT, NULL);
+  char name[64];
+  GDateTime *now = g_date_time_new_now_local();
+  char *stamp = g_date_time_format(now, "%Y%m%d-%H%M%S");
+  snprintf(name, sizeof(name), "rx%d-%s.iq", myrx->id + 1, stamp);
+  g_free(stamp);
+  g_date_time_unref(now);
+  gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(fc), TRUE);
+  gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(fc), name);
+  int ok = 0;
+  if (gtk_dialog_run(GTK_DIALOG(fc)) == GTK_RESPONSE_ACCEPT) {
+    char *path = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(fc));
+    ok = iqrec_start(myrx, path);
+    g_free(path);
+  }
+  gtk_widget_destroy(fc);
+  if (!ok) {
+    g_signal_handlers_block_by_func(widget, G_CALLBACK(rec_cb), NULL);
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widget), FALSE);
+    g_signal_handlers_unblock_by_func(widget, G_CALLBACK(rec_cb), NULL);
+  }
+}
+
+// cppcheck-suppress constParameterCallback
+static gboolean play_cb(GtkWidget *widget, GdkEventButton *event, gpointer data) {
+  if (iqplay_is_running(myrx)) {
+    iqplay_stop(myrx);
+    status_update(NULL);
+    return TRUE;
+  }
+  GtkWidget *fc = gtk_file_chooser_dialog_new(
+                    "Play IQ file", GTK_WINDOW(dialog),
+                    GTK_FILE_CHOOSER_ACTION_OPEN,
+                    "_Cancel", GTK_RESPONSE_CANCEL,
+                    "_Open",   GTK_RESPONSE_ACCEPT, NULL);
+  if (gtk_dialog_run(GTK_DIALOG(fc)) == GTK_RESPONSE_ACCEPT) {
+    char *path = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(fc));
+    iqplay_start(myrx, path, realtime);
+    g_free(path);
+  }
+  gtk_widget_destroy(fc);
+  status_update(NULL);
+  return TRUE;
+}
+
+static void realtime_cb(GtkWidget *widget, gpointer data) {
+  realtime = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+}
+
+void iqfile_menu(GtkWidget *parent) {
+  char text[64];
+  GtkWidget *label;
+  myrx = active_receiver;
+  dialog = gtk_dialog_new();
+  gtk_window_set_transient_for(GTK_WINDOW(dialog), GTK_WINDOW(parent));
+  GtkWidget *headerbar = gtk_header_bar_new();
+  gtk_window_set_titlebar(GTK_WINDOW(dialog), headerbar);
+  gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(headerbar), TRUE);
+  snprintf(text, sizeof(text), "piHPSDR - IQ Record/Playback (RX%d)", myrx->id + 1);
+  gtk_header_bar_set_title(GTK_HEADER_BAR(headerbar), text);
+  g_signal_connect (dialog, "delete_event", G_CALLBACK (close_cb), NULL);
+  g_signal_connect (dialog, "destroy", G_CALLBACK (close_cb), NULL);
+  GtkWidget *content = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+  GtkWidget *grid = gtk_grid_new();
+  gtk_grid_set_column_spacing (GTK_GRID(grid), 10);
+  gtk_grid_set_row_spacing (GTK_GRID(grid), 10);
+  GtkWidget *close_b = gtk_button_new_with_label("Close");
+  gtk_widget_set_name(close_b, "close_button");
+  g_signal_connect (close_b, "button-press-event", G_CALLBACK(close_cb), NULL);
+  gtk_grid_attach(GTK_GRID(grid), close_b, 0, 0, 1, 1);
+  //
+  label = gtk_label_new("Recording");
+  gtk_widget_set_name(label, "boldlabel");
+  gtk_widget_set_halign(label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), label, 0, 1, 1, 1);
+  rec_b = gtk_toggle_button_new_with_label("Record");
+  gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(rec_b), myrx->id < MAX_RECEIVERS && iqrec_active[myrx->id]);
+  gtk_grid_attach(GTK_GRID(grid), rec_b, 1, 1, 1, 1);
+  g_signal_connect(rec_b, "toggled", G_CALLBACK(rec_cb), NULL);
+  rec_status = gtk_label_new(NULL);
+  gtk_widget_set_halign(rec_status, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), rec_status, 2, 1, 2, 1);
+  //
+  label = gtk_label_new("Playback");
+  gtk_widget_set_name(label, "boldlabel");
+  gtk_widget_set_halign(label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), label, 0, 2, 1, 1);
+  play_b = gtk_button_new_with_label("Play File");
+  g_signal_connect (play_b, "button-press-event", G_CALLBACK(play_cb), NULL);
+  gtk_grid_attach(GTK_GRID(grid), play_b, 1, 2, 1, 1);
+  GtkWidget *realtime_b = gtk_check_button_new_with_label("Real time");
+  gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(realtime_b), realtime);
+  gtk_grid_attach(GTK_GRID(grid), realtime_b, 2, 2, 1, 1);
+  g_signal_connect(realtime_b, "toggled", G_CALLBACK(realtime_cb), NULL);
+  play_status = gtk_label_new(NULL);
+  gtk_widget_set_halign(play_status, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), play_status, 3, 2, 1, 1);
+  //
+  label = gtk_label_new("Real time playback loops until stopped, otherwise the file\n"
+                        "is played once as fast as possible and the speed is reported.");
+  gtk_widget_set_halign(label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), label, 0, 3, 4, 1);
+  gtk_container_add(GTK_CONTAINER(content), grid);
+  sub_menu = dialog;
+  gtk_widget_show_all(dialog);
+  status_update(NULL);
+  status_timer_id = g_timeout_add(500, status_update, NULL);
+}
@@ -27,7 +27,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
-#include <wdsp.h>    // only needed for WDSPwisdom() and wisdom_get_status()
+#include <wdsp.h>    // only needed for WDSPwisdom(), wisdom_get_status() and the impulse cache
 
 #include "actions.h"
 #include "appearance.h"
@@ -55,6 +55,7 @@
 #endif
 #include "startup.h"
 #include "test_menu.h"
+#include "threads.h"
 #include "version.h"
 #include "vfo.h"
 
@@ -94,17 +95,40 @@ void status_text(const char *text) {
 
 static pthread_t wisdom_thread_id;
 static int wisdom_running = 0;
+static char impulse_cache_file[1040];
 
 static void* wisdom_thread(void *arg) {
   if (WDSPwisdom ((char *)arg)) {
-    t_print("%s: WDSP wisdom file has been rebuilt.\n", __func__);
+    t_print("%s: No WDSP wisdom file yet, FFT sizes are optimised when first used.\n", __func__);
   } else {
     t_print("%s: Re-using existing WDSP wisdom file.\n", __func__);
   }
+  //
+  // The WDSP impulse cache (filter impulse responses) is kept beside the
+  // wisdom file, so filter and mode changes need not re-calculate the
+  // impulse responses after a restart.
+  //
+  init_impulse_cache(1);
+  snprintf(impulse_cache_file, sizeof(impulse_cache_file), "%swdspImpulseCache", (char *)arg);
+  if (read_impulse_cache(impulse_cache_file) == 0) {
+    t_print("%s: WDSP impulse cache loaded.\n", __func__);
+  }
   wisdom_running = 0;
   return NULL;
 }
 
+void impulse_cache_save(void) {
+  long hits, misses;
+  int entries;
+  if (*impulse_cache_file == 0) { return; }
+  get_impulse_cache_stats(&hits, &misses, &entries);
+  t_print("%s: %d entries, %ld hits, %ld misses, hit rate %.1f%%\n", __func__, entries, hits, misses,
+          hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0);
+  if (save_impulse_cache(impulse_cache_file) != 0) {
+    t_print("%s: could not write %s\n", __func__, impulse_cache_file);
+  }
+}
+
 // cppcheck-suppress constParameterCallback
 static gboolean main_delete (GtkWidget *widget) {
   if (radio != NULL) {
@@ -120,6 +144,10 @@ static int init(gpointer data) {
   t_print("LC_ALL=%s\n", setlocale(LC_ALL, NULL));
   t_print("LC_NUMERIC=%s\n", setlocale(LC_NUMERIC, NULL));
   //
+  // Register the GTK main thread and install the WDSP thread hooks
+  //
+  threads_init();
+  //
   // We want to intercept some key strokes
   //
   gtk_widget_add_events(top_window, GDK_KEY_PRESS_MASK);
@@ -129,9 +157,9 @@ static int init(gpointer data) {
   cursor_watch = gdk_cursor_new(GDK_WATCH);
   gdk_window_set_cursor(gtk_widget_get_window(top_window), cursor_watch);
   //
-  // Let WDSP (via FFTW) check for wisdom file in current dir
-  // If there is one, the "wisdom thread" takes no time
-  // Depending on the WDSP version, the file is wdspWisdom or wdspWisdom00.
+  // Let WDSP (via FFTW) load the wisdom file from the current dir.
+  // FFT sizes without wisdom are optimised in the background by WDSP
+  // when they are first used, and added to the wisdom file.
   //
   (void) getcwd(text, sizeof(text));
   snprintf(wisdom_directory, sizeof(wisdom_directory), "%s/", text);
@@ -146,9 +174,6 @@ static int init(gpointer data) {
     while (gtk_events_pending ()) {
       gtk_main_iteration ();
     }
-    snprintf(text, sizeof(text), "Do not close window until wisdom plans are completed ...\n\n... %s",
-             wisdom_get_status());
-    status_text(text);
   }
   //
   // If requested, try to quickly start in client mode
@@ -42,4 +42,5 @@ extern void status_text(const char *text);
 extern gulong keypress_signal_id;
 extern int fatal_error(gpointer data);
 extern int run_curl(const char *url, char *buf, size_t buflen, int time);
+extern void impulse_cache_save(void);
 #endif
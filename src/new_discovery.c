@@ -359,12 +359,16 @@ static gpointer p2_discover_receive_thread(gpointer data) {
     discovered[devices].network.interface_length = sizeof(interface_addr);
     snprintf(discovered[devices].network.interface_name, sizeof(discovered[devices].network.interface_name), "%s",
              interface_name);
-    discovered[devices].supported_receivers = 2;
+    //
+    // buffer[20] is the number of DDCs. On ANGELIA and beyond, DDC0/1
+    // are reserved for PureSignal/DIVERSITY so the number of "normal"
+    // receivers is two less. The final decision is made in radio.c.
+    //
+    discovered[devices].supported_receivers = MAX(2, (buffer[20] & 0xFF) - 2);
     //
     // Info not yet made use of:
     //
     // buffer[12]: P2 version supported (e.g. 39 for 3.9)
-    // buffer[20]: number of DDCs
     // buffer[23]: beta version number (if nonzero)
     //             E.g. if buffer[13] is 21 and buffer[23] is 18 this
     //             means firmware Version 2.1.18
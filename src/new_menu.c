@@ -42,6 +42,7 @@
 #include "filter_menu.h"
 #include "g2panel_menu.h"
 #include "gpio.h"
+#include "iqfile_menu.h"
 #include "main.h"
 #include "meter_menu.h"
 #ifdef MIDI
@@ -67,6 +68,7 @@
 #include "store_menu.h"
 #include "switch_menu.h"
 #include "theme_menu.h"
+#include "threads_menu.h"
 #include "toolbar_menu.h"
 #include "tx_menu.h"
 #include "xvtr_menu.h"
@@ -504,6 +506,28 @@ static gboolean dxspots_cb (GtkWidget *widget, GdkEventButton *event, gpointer d
   return TRUE;
 }
 
+static void start_iqfile_menu(void) {
+  cleanup();
+  iqfile_menu(top_window);
+}
+
+// cppcheck-suppress constParameterCallback
+static gboolean iqfile_cb (GtkWidget *widget, GdkEventButton *event, gpointer data) {
+  start_iqfile_menu();
+  return TRUE;
+}
+
+static void start_threads_menu(void) {
+  cleanup();
+  threads_menu(top_window);
+}
+
+// cppcheck-suppress constParameterCallback
+static gboolean threads_cb (GtkWidget *widget, GdkEventButton *event, gpointer data) {
+  start_threads_menu();
+  return TRUE;
+}
+
 #ifdef MIDI
 static void start_midi_menu(void) {
   cleanup();
@@ -574,7 +598,7 @@ void new_menu(void) {
     col = 0;
     //
     // Special menu:
-    // Cat, Server, DX, Spots
+    // Cat, Server, DX, Spots, Threads, IQ File
     //
     btn = gtk_button_new_with_label("Screen");
     g_signal_connect (btn, "button-press-event", G_CALLBACK(screen_cb), NULL);
@@ -598,6 +622,16 @@ void new_menu(void) {
     btn = gtk_button_new_with_label("Spots");
     g_signal_connect (btn, "button-press-event", G_CALLBACK(dxspots_cb), NULL);
     gtk_grid_attach(GTK_GRID(grid), btn, col, row, 1, 1);
+    row++;
+    if (!radio_is_remote) {
+      btn = gtk_button_new_with_label("Threads");
+      g_signal_connect (btn, "button-press-event", G_CALLBACK(threads_cb), NULL);
+      gtk_grid_attach(GTK_GRID(grid), btn, col, row, 1, 1);
+      row++;
+      btn = gtk_button_new_with_label("IQ File");
+      g_signal_connect (btn, "button-press-event", G_CALLBACK(iqfile_cb), NULL);
+      gtk_grid_attach(GTK_GRID(grid), btn, col, row, 1, 1);
+    }
     row = 2;
     col++;
     //
@@ -681,7 +715,7 @@ void new_menu(void) {
     g_signal_connect (btn, "button-press-event", G_CALLBACK(agc_cb), NULL);
     gtk_grid_attach(GTK_GRID(grid), btn, col, row, 1, 1);
     row++;
-    if (RECEIVERS == 2 && n_adc > 1) {
+    if (RECEIVERS > 1 && n_adc > 1) {
       btn = gtk_button_new_with_label("DIV");
       g_signal_connect (btn, "button-press-event", G_CALLBACK(diversity_cb), NULL);
       gtk_grid_attach(GTK_GRID(grid), btn, col, row, 1, 1);
@@ -17,6 +17,10 @@
 *
 */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE   // needed for recvmmsg()
+#endif
+
 #include <gtk/gtk.h>
 
 #include <errno.h>
@@ -57,6 +61,8 @@
 #include "receiver.h"
 #include "rigctl.h"
 #include "saturnmain.h"
+#include "sendqueue.h"
+#include "threads.h"
 #include "toolbar.h"
 #include "transmitter.h"
 #include "vfo.h"
@@ -71,6 +77,13 @@
 
 #define PI 3.1415926535897932F
 
+//
+// Batched UDP receive is only available on LINUX
+//
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+  #define P2_RECVMMSG
+#endif
+
 /*
  * A new 'action table' defines what to to
  * with a sample packet received from a DDC
@@ -112,6 +125,13 @@ static int audio_addr_length;
 static struct sockaddr_in iq_addr;
 static int iq_addr_length;
 
+//
+// Send queues for RX audio and TX IQ packets, used only by the
+// RX audio and TX IQ thread, respectively.
+//
+static SENDQUEUE rxaudio_sendq;
+static SENDQUEUE txiq_sendq;
+
 static GThread *new_protocol_thread_id;
 static GThread *new_protocol_rxaudio_thread_id;
 static GThread *new_protocol_txiq_thread_id;
@@ -192,6 +212,13 @@ static volatile int rxaudio_flag          = 2;  // 0: RX or duplex, 1: TX withou
 
 static pthread_mutex_t send_rxaudio_mutex   = PTHREAD_MUTEX_INITIALIZER;
 
+//
+// Statistics for the receive thread: number of recvfrom/recvmmsg calls
+// and number of packets received.
+//
+static long p2_rx_syscalls = 0;
+static long p2_rx_packets = 0;
+
 /////////////////////////////////////////////////////////////////////////////
 //
 // PEDESTRIAN BUFFER MANAGEMENT
@@ -324,22 +351,21 @@ static void update_action_table(void) {
   // flag=     1   receive , DIVERSITY, olddev:    does not occur, use DDC0/1 pair for DIVERSITY
   // flag=   100   no DUPLEX, xmit, olddev:        skip samples
   // flag=   110   no DUPLEX, PS, xmit, olddev:    use DDC0/1 pair for PS
-  // flag=  1000   receive, newdev, no DIVERSITY:  use DDC2 for RX1, DDC3 for RX2
-  // flag=  1001   receive, DIVERSITY, newdev:     use DDC0/1 pair for DIVERSITY
+  // flag=  1000   receive, newdev, no DIVERSITY:  use DDC2 for RX1, DDC3 for RX2, etc.
+  // flag=  1001   receive, DIVERSITY, newdev:     use DDC0/1 pair for DIVERSITY, DDC4 for RX3, etc.
   // flag=  1100   no DUPLEX, xmit, newdev:        skip samples
   // flag=  1110   no DUPLEX, PS, xmit, newdev:    use DDC0/1 pair for PS
   // flag= 10100   DUPLEX, xmit, olddev:           use DDC0 for RX1, DDC1 for RX2
   // flag= 10110   DUPLEX, PS, xmit, olddev:       ignore DUPLEX and use DDC0/1 pair for PS
-  // flag= 11100   DUPLEX, xmit, newdev:           use DDC2 for RX1, DDC3 for RX2
-  // flag= 11110   DUPLEX, PS, xmit, newdev:       use DDC0/1 pair for PS, DDC2 for RX1, DDC3 for RX2
+  // flag= 11100   DUPLEX, xmit, newdev:           use DDC2 for RX1, DDC3 for RX2, etc.
+  // flag= 11110   DUPLEX, PS, xmit, newdev:       use DDC0/1 pair for PS, DDC2 for RX1, DDC3 for RX2, etc.
   //
   // Set up rxcase and rxid for each of the 12 cases
   // note that rxid[i] can be left unspecified if rxcase[i] == RXACTION_SKIP
   //
-  rxcase[0] = RXACTION_SKIP;
-  rxcase[1] = RXACTION_SKIP;
-  rxcase[2] = RXACTION_SKIP;
-  rxcase[3] = RXACTION_SKIP;
+  for (int ddc = 0; ddc < MAX_DDC; ddc++) {
+    rxcase[ddc] = RXACTION_SKIP;
+  }
   switch (flag) {
   case       0:                                                       // HERMES, RX, no DIVERSITY
   case   10100:                                                       // HERMES, TX, no PureSignal, DUPLEX
@@ -354,6 +380,14 @@ static void update_action_table(void) {
   case  1001:                                                         // ORION, RX, DIVERSITY
     rxid[0] = 0;
     rxcase[0] = RXACTION_DIV;
+    //
+    // RX1 and RX2 are fed from the DIVERSITY pair,
+    // RX3 and beyond from their own DDCs
+    //
+    for (int id = 2; id < receivers; id++) {
+      rxid[id + 2] = id;
+      rxcase[id + 2] = RXACTION_NORMAL;
+    }
     break;
   case  100:                                                          // HERMES, TX, no PureSignal, no DUPLEX
   case 1100:                                                          // ORION, TX, no PureSignal, no DUPLEX
@@ -369,11 +403,9 @@ static void update_action_table(void) {
     __attribute__((fallthrough));
   case 1000:                                                          // ORION, RX, no DIVERSITY
   case 11100:                                                         // ORION, TX, no PureSignal, DUPLEX
-    rxid[2] = 0;
-    rxcase[2] = RXACTION_NORMAL;
-    if (receivers > 1) {
-      rxid[3] = 1;
-      rxcase[3] = RXACTION_NORMAL;
+    for (int id = 0; id < receivers; id++) {
+      rxid[id + 2] = id;
+      rxcase[id + 2] = RXACTION_NORMAL;
     }
     break;
   default:
@@ -421,12 +453,12 @@ void new_protocol_init(void) {
     (void)sem_init(&iq_sem[i], 0, 0); // check return value!
   }
 #endif
-  high_priority_thread_id = g_thread_new( "P2 HP", high_priority_thread, NULL);
-  mic_line_thread_id = g_thread_new( "P2 MIC", mic_line_thread, NULL);
+  high_priority_thread_id = thread_new("P2 HP", THREAD_ROLE_NET, high_priority_thread, NULL);
+  mic_line_thread_id = thread_new("P2 MIC", THREAD_ROLE_NET, mic_line_thread, NULL);
   for (i = 0; i < MAX_DDC; i++) {
     char text[16];
     snprintf(text, sizeof(text), "P2 DDC%d", i);
-    iq_thread_id[i] = g_thread_new(text, iq_thread, GINT_TO_POINTER(i));
+    iq_thread_id[i] = thread_new(text, THREAD_ROLE_RXIQ, iq_thread, GINT_TO_POINTER(i));
   }
   //
   // Setup communication (this is also done *once*)
@@ -601,7 +633,7 @@ static void new_protocol_general(void) {
 static void new_protocol_high_priority(void) {
   ASSERT_SERVER();
   int rxant, txant;
-  long long DDCfrequency[2];  // DDC frequencies of the radio
+  long long DDCfrequency[MAX_RECEIVERS];  // DDC frequencies of the radio
   long long DUCfrequency;     // DUC frequency of the radio
   long long txfreq;           // frequency used for out-of-band detection
   long long HPFfreq;          // frequency determining the HPF filters
@@ -623,7 +655,6 @@ static void new_protocol_high_priority(void) {
   int xmit     = radio_is_transmitting() | hpsdr_ptt;
   int txvfo    = vfo_get_tx_vfo();    // VFO governing the TX frequency
   int rxvfo    = active_receiver->id; // id of the active receiver
-  int othervfo = 1 - rxvfo;           // id of the "other" receiver (only valid if receivers > 1)
   int txmode   = vfo_get_tx_mode();
   const BAND *txband = band_get_band(vfo[txvfo].band);
   const BAND *rxband = band_get_band(vfo[rxvfo].band);
@@ -656,9 +687,9 @@ static void new_protocol_high_priority(void) {
     }
   }
   //
-  //  Set DDC frequencies for RX1 and RX2
+  //  Set DDC frequencies for all receivers
   //
-  for (int id = 0; id < 2; id++) {
+  for (int id = 0; id < receivers; id++) {
     // apply *relative* frequency calibration to the DDC frequency
     freq = vfo[id].frequency - vfo[id].lo;  // uncorrected DDC freq
     DDCfrequency[id] = calibrated_frequency(freq);
@@ -704,20 +735,19 @@ static void new_protocol_high_priority(void) {
       high_priority_buffer_to_radio[16] = (phase      ) & 0xFF;
     }
     //
-    //
-    // For ANGELIA and beyond, copy DDC0/1 to DDC2/3 freq (if only
-    // one RX, DDC1 freq is zero and it is OK to copy to DDC3)
+    // For ANGELIA and beyond, receiver[i] uses DDC(i+2). Note the
+    // first two of these frequencies are copies of DDC0/1.
     //
     if (device == NEW_DEVICE_ANGELIA  || device == NEW_DEVICE_ORION ||
         device == NEW_DEVICE_ORION2 || device == NEW_DEVICE_SATURN) {
-      high_priority_buffer_to_radio[17] = high_priority_buffer_to_radio[ 9];
-      high_priority_buffer_to_radio[18] = high_priority_buffer_to_radio[10];
-      high_priority_buffer_to_radio[19] = high_priority_buffer_to_radio[11];
-      high_priority_buffer_to_radio[20] = high_priority_buffer_to_radio[12];
-      high_priority_buffer_to_radio[21] = high_priority_buffer_to_radio[13];
-      high_priority_buffer_to_radio[22] = high_priority_buffer_to_radio[14];
-      high_priority_buffer_to_radio[23] = high_priority_buffer_to_radio[15];
-      high_priority_buffer_to_radio[24] = high_priority_buffer_to_radio[16];
+      for (int id = 0; id < receivers; id++) {
+        int ddc = 2 + id;
+        phase = (uint32_t)(((double)DDCfrequency[id]) * 34.952533333333333333333333333333);
+        high_priority_buffer_to_radio[ 9 + 4 * ddc] = (phase >> 24) & 0xFF;
+        high_priority_buffer_to_radio[10 + 4 * ddc] = (phase >> 16) & 0xFF;
+        high_priority_buffer_to_radio[11 + 4 * ddc] = (phase >>  8) & 0xFF;
+        high_priority_buffer_to_radio[12 + 4 * ddc] = (phase      ) & 0xFF;
+      }
     }
   }
   //
@@ -927,9 +957,9 @@ static void new_protocol_high_priority(void) {
     // ADC0 band pass
     //
     BPFfreq = 0LL;
-    if (receivers > 1) {
-      if (receiver[othervfo]->adc == 0) {
-        BPFfreq = DDCfrequency[othervfo];   // Take frequency of non-active receiver
+    for (int id = 0; id < receivers; id++) {
+      if (id != rxvfo && receiver[id]->adc == 0) {
+        BPFfreq = DDCfrequency[id];         // Take frequency of a non-active receiver
       }
     }
     if (receiver[rxvfo]->adc == 0) {
@@ -960,9 +990,9 @@ static void new_protocol_high_priority(void) {
     // ADC1 band pass
     //
     BPFfreq = 0LL;
-    if (receivers > 1) {
-      if (receiver[othervfo]->adc == 1) {
-        BPFfreq = DDCfrequency[othervfo];   // Take frequency of non-active receiver
+    for (int id = 0; id < receivers; id++) {
+      if (id != rxvfo && receiver[id]->adc == 1) {
+        BPFfreq = DDCfrequency[id];         // Take frequency of a non-active receiver
       }
     }
     if (receiver[rxvfo]->adc == 1) {
@@ -1001,16 +1031,14 @@ static void new_protocol_high_priority(void) {
   default:
     //
     //      Old (ANAN-100/200) high-pass filters
-    //      If both RX are active and use ADC0,
-    //      HPF filter settings depend on MIN(rx1freq,rx2freq)
+    //      If several RX are active and use ADC0,
+    //      HPF filter settings depend on the lowest of their frequencies
     //
     HPFfreq = 0LL;
-    if (receiver[0]->adc == 0) {
-      HPFfreq = DDCfrequency[0];
-    }
-    if (receivers > 1) {
-      if (receiver[1]->adc == 0 && DDCfrequency[1] < DDCfrequency[0]) {
-        HPFfreq = DDCfrequency[1];
+    for (int id = 0, first = 1; id < receivers; id++) {
+      if (receiver[id]->adc == 0 && (first || DDCfrequency[id] < HPFfreq)) {
+        HPFfreq = DDCfrequency[id];
+        first = 0;
       }
     }
     // Bypass HPFs if using EXT1 for PureSignal feedback!
@@ -1049,12 +1077,10 @@ static void new_protocol_high_priority(void) {
       && (device != NEW_DEVICE_ORION2 && device != NEW_DEVICE_SATURN && device != NEW_DEVICE_G2E)
       && adc[0].antenna < 3) {
     LPFfreq = 40000000LL;  // disable the LPF
-    if (receiver[0]->adc == 0) {
-      LPFfreq = DDCfrequency[0];
-    }
-    if (receivers > 1) {
-      if (receiver[1]->adc == 0 && DDCfrequency[1] > DDCfrequency[0]) {
-        LPFfreq = DDCfrequency[1];
+    for (int id = 0, first = 1; id < receivers; id++) {
+      if (receiver[id]->adc == 0 && (first || DDCfrequency[id] > LPFfreq)) {
+        LPFfreq = DDCfrequency[id];
+        first = 0;
       }
     }
     if (adc[0].filter_bypass) {
@@ -1385,17 +1411,18 @@ static void new_protocol_receive_specific(void) {
   receive_specific_buffer[6] = adc[0].random | (adc[1].random << 1);
   for (i = 0; i < receivers; i++) {
     // note that for HERMES, receiver[i] is associated with DDC(i) but beyond
-    // (that is, ANGELIA, ORION, ORION2, G2) receiver[i] is associated with DDC(i+2)
+    // (that is, ANGELIA, ORION, ORION2, G2) receiver[i] is associated with DDC(i+2).
+    // The DDC enable bits of DDC8 and beyond are in the next byte(s).
     int ddc = i;
     if (device == NEW_DEVICE_ANGELIA  || device == NEW_DEVICE_ORION ||
         device == NEW_DEVICE_ORION2 || device == NEW_DEVICE_SATURN) { ddc = 2 + i; }
-    if (!xmit && !diversity_enabled) {
-      // normal RX without diversity
-      receive_specific_buffer[7] |= (1 << ddc); // DDC enable
+    if (!xmit && (!diversity_enabled || i > 1)) {
+      // normal RX without diversity, or RX3 and beyond with diversity
+      receive_specific_buffer[7 + ddc / 8] |= (1 << (ddc % 8)); // DDC enable
     }
     if (xmit && duplex) {
       // transmitting with duplex
-      receive_specific_buffer[7] |= (1 << ddc); // DDC enable
+      receive_specific_buffer[7 + ddc / 8] |= (1 << (ddc % 8)); // DDC enable
     }
     receive_specific_buffer[17 + (ddc * 6)] = receiver[i]->adc;
     receive_specific_buffer[18 + (ddc * 6)] = ((receiver[i]->sample_rate / 1000) >> 8) & 0xFF;
@@ -1440,7 +1467,7 @@ static void new_protocol_receive_specific(void) {
     receive_specific_buffer[25] = ((receiver[0]->sample_rate / 1000)     ) & 0xFF; // sample rate LSB
     receive_specific_buffer[26] = 24;                                              // bits per sample
     receive_specific_buffer[1363] = 0x02;                                          // sync DDC1 to DDC0
-    receive_specific_buffer[7] = 1;                                                // enable  DDC0 but disable all others
+    receive_specific_buffer[7] |= 1;                                               // enable  DDC0, DDC2/3 stay disabled
   }
   //t_print("new_protocol_receive_specific: %s:%d enable=%02X\n",inet_ntoa(receiver_addr.sin_addr),ntohs(receiver_addr.sin_port),receive_specific_buffer[7]);
   if (have_saturn_xdma) {
@@ -1492,6 +1519,7 @@ void new_protocol_menu_stop(void) {
     g_thread_join(new_protocol_thread_id);
   }
   g_thread_join(new_protocol_timer_thread_id);
+  print_buffer_stats();
   new_protocol_high_priority();
   // let the FPGA rest a while
   usleep(200000); // 200 ms
@@ -1518,6 +1546,19 @@ void new_protocol_menu_stop(void) {
   }
 }
 
+static int new_protocol_pool_size(void) {
+  //
+  // Number of DDC buffers needed to hold 100 msec of data (238 samples per packet),
+  // for all receivers and the two PureSignal DDCs (192k)
+  // Buffers for HighPrio and Mic packets are not included here.
+  //
+  int packets = 2 * 192000 / 238;
+  for (int i = 0; i < receivers; i++) {
+    packets += receiver[i]->sample_rate / 238;
+  }
+  return packets / 10;
+}
+
 //
 // Function available e.g. to rigctl to (re-) start the new protocol
 //
@@ -1559,10 +1600,10 @@ void new_protocol_menu_start(void) {
   memset(rxid, 0, sizeof(rxid));
   update_action_table();
   if (have_saturn_xdma) {
-    prealloc_satbuffers();
+    prealloc_satbuffers(new_protocol_pool_size());
     mark_satbuffers_free();
   } else {
-    prealloc_p2buffers();
+    prealloc_p2buffers(new_protocol_pool_size() + HPRIORINGBUFLEN + MICRINGBUFLEN + UDP_RX_BATCH_MAX);
     mark_p2buffers_free();
   }
   P2running = 1;
@@ -1576,13 +1617,13 @@ void new_protocol_menu_start(void) {
   (void)sem_init(&txiq_sem, 0, 0); // check return value!
   (void)sem_init(&rxaudio_sem, 0, 0); // check return value!
 #endif
-  new_protocol_rxaudio_thread_id = g_thread_new( "P2 SPKR", new_protocol_rxaudio_thread, NULL);
-  new_protocol_txiq_thread_id = g_thread_new( "P2 TXIQ", new_protocol_txiq_thread, NULL);
+  new_protocol_rxaudio_thread_id = thread_new("P2 SPKR", THREAD_ROLE_TXOUT, new_protocol_rxaudio_thread, NULL);
+  new_protocol_txiq_thread_id = thread_new("P2 TXIQ", THREAD_ROLE_TXOUT, new_protocol_txiq_thread, NULL);
   if (!have_saturn_xdma) {
     //
     // Spawn of "ethernet listening" thread
     //
-    new_protocol_thread_id = g_thread_new( "P2 main", new_protocol_thread, NULL);
+    new_protocol_thread_id = thread_new("P2 main", THREAD_ROLE_NET, new_protocol_thread, NULL);
   }
   new_protocol_general();           // Send general data, including port numbers
   usleep(100000);                   // let FPGA digest the port numbers
@@ -1595,12 +1636,47 @@ void new_protocol_menu_start(void) {
   //
   // Spawn off a thread that will periodicall send HighPrio, RxSpec, TxSpec, and General packets
   //
-  new_protocol_timer_thread_id = g_thread_new( "P2 task", new_protocol_timer_thread, NULL);
+  new_protocol_timer_thread_id = thread_new("P2 task", THREAD_ROLE_TXOUT, new_protocol_timer_thread, NULL);
+}
+
+static int new_protocol_get_rxaudio(unsigned char *audiobuffer) {
+  //
+  // Fetch 64 RX audio samples from the ring buffer and put them,
+  // together with the sequence number, into audiobuffer (260 bytes).
+  // return 0 if the ring buffer is empty
+  //
+  // I think we have to use a lock here for the new implementation
+  // of draining. Suppose the producer drains the buffer immediately
+  // *after* the following statement so we miss it. As a consequence,
+  // the data from outptr is shipped out while the producer is
+  // writing into the same location. We need the lock only a short
+  // time, while copying out the data and updating the outptr
+  //
+  pthread_mutex_lock(&send_rxaudio_mutex);
+  //
+  // If the producer resets the buffer, the semaphore
+  // may have accumulated some events, so we can end
+  // up here with en empty ring buffer
+  //
+  if (rxaudio_outptr == rxaudio_inptr) {
+    pthread_mutex_unlock(&send_rxaudio_mutex);
+    return 0;
+  }
+  memcpy(&audiobuffer[4], &RXAUDIORINGBUF[rxaudio_outptr], 256);
+  int nptr = (rxaudio_outptr + 256) & RXAUDIORINGBUFMASK;
+  MEMORY_BARRIER;
+  rxaudio_outptr = nptr;
+  pthread_mutex_unlock(&send_rxaudio_mutex);
+  audiobuffer[0] = (audio_sequence >> 24) & 0xFF;
+  audiobuffer[1] = (audio_sequence >> 16) & 0xFF;
+  audiobuffer[2] = (audio_sequence >>  8) & 0xFF;
+  audiobuffer[3] = (audio_sequence      ) & 0xFF;
+  audio_sequence++;
+  return 1;
 }
 
 static gpointer new_protocol_rxaudio_thread(gpointer data) {
   ASSERT_SERVER(NULL);
-  int nptr;
   unsigned char audiobuffer[260];
   //
   // Ideally, a RX audio buffer with 64 samples is sent every 1333 usecs.
@@ -1609,41 +1685,16 @@ static gpointer new_protocol_rxaudio_thread(gpointer data) {
   // After sending a packet in network mode, wait a little bit before
   // attempting to send the next one.
   //
+  sendq_init(&rxaudio_sendq);
   while (P2running) {
 #ifdef __APPLE__
     sem_wait(rxaudio_sem);
 #else
     sem_wait(&rxaudio_sem);
 #endif
+    thread_wakeup();
     if (!P2running) { break; }
-    //
-    // I think we have to use a lock here for the new implementation
-    // of draining. Suppose the producer drains the buffer immediately
-    // *after* the following statement so we miss it. As a consequence,
-    // the data from outptr is shipped out while the producer is
-    // writing into the same location. We need the lock only a short
-    // time, while copying out the data and updating the outptr
-    //
-    pthread_mutex_lock(&send_rxaudio_mutex);
-    //
-    // If the producer resets the buffer, the semaphore
-    // may have accumulated some events, so we can end
-    // up here with en empty ring buffer
-    //
-    if (rxaudio_outptr == rxaudio_inptr) {
-      pthread_mutex_unlock(&send_rxaudio_mutex);
-      continue;
-    }
-    memcpy(&audiobuffer[4], &RXAUDIORINGBUF[rxaudio_outptr], 256);
-    nptr = (rxaudio_outptr + 256) & RXAUDIORINGBUFMASK;
-    MEMORY_BARRIER;
-    rxaudio_outptr = nptr;
-    pthread_mutex_unlock(&send_rxaudio_mutex);
-    audiobuffer[0] = (audio_sequence >> 24) & 0xFF;
-    audiobuffer[1] = (audio_sequence >> 16) & 0xFF;
-    audiobuffer[2] = (audio_sequence >>  8) & 0xFF;
-    audiobuffer[3] = (audio_sequence      ) & 0xFF;
-    audio_sequence++;
+    if (!new_protocol_get_rxaudio(audiobuffer)) { continue; }
     if (have_saturn_xdma) {
       saturn_handle_speaker_audio(audiobuffer);
     } else {
@@ -1691,45 +1742,67 @@ static gpointer new_protocol_rxaudio_thread(gpointer data) {
         clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
       }
       FIFO += 64.0;  // number of samples in THIS packet
-      ssize_t rc = sendto(data_socket, audiobuffer, sizeof(audiobuffer), 0,
-                          (struct sockaddr*)&audio_addr, audio_addr_length);
-      if (rc < 0) {
+      sendq_add(&rxaudio_sendq, audiobuffer, sizeof(audiobuffer), &audio_addr, audio_addr_length);
+      //
+      // If more packets are ready *and* would be sent without any
+      // delay anyway (FIFO low), collect them and send them with
+      // a single system call.
+      //
+      while (FIFO <= 250.0 && sendq_can_add(&rxaudio_sendq)) {
+#ifdef __APPLE__
+        if (sem_trywait(rxaudio_sem) != 0) { break; }
+#else
+        if (sem_trywait(&rxaudio_sem) != 0) { break; }
+#endif
+        if (!new_protocol_get_rxaudio(audiobuffer)) { continue; }
+        FIFO += 64.0;
+        sendq_add(&rxaudio_sendq, audiobuffer, sizeof(audiobuffer), &audio_addr, audio_addr_length);
+      }
+      if (sendq_flush(&rxaudio_sendq, data_socket) < 0) {
         g_idle_add(fatal_error, "FATAL: P2 Audio send failed (Network down?)");
         P2running = 0;
-      } else if (rc != sizeof(audiobuffer)) {
-        t_print("sendto socket failed for %ld bytes of audio: %d\n", (long)sizeof(audiobuffer), rc);
       }
     }
   }
+  sendq_print_stats(&rxaudio_sendq, "P2 RX audio");
   return NULL;
 }
 
+static void new_protocol_get_txiq(unsigned char *iqbuffer) {
+  //
+  // Fetch 240 TX IQ samples from the ring buffer and put them,
+  // together with the sequence number, into iqbuffer (1444 bytes).
+  //
+  iqbuffer[0] = (tx_iq_sequence >> 24) & 0xFF;
+  iqbuffer[1] = (tx_iq_sequence >> 16) & 0xFF;
+  iqbuffer[2] = (tx_iq_sequence >>  8) & 0xFF;
+  iqbuffer[3] = (tx_iq_sequence      ) & 0xFF;
+  tx_iq_sequence++;
+  int nptr = txiq_outptr + 1440;
+  if (nptr >= TXIQRINGBUFLEN) { nptr = 0; }
+  memcpy(&iqbuffer[4], &TXIQRINGBUF[txiq_outptr], 1440);
+  MEMORY_BARRIER;
+  txiq_outptr = nptr;
+}
+
 static gpointer new_protocol_txiq_thread(gpointer data) {
   ASSERT_SERVER(NULL);
-  int nptr;
   unsigned char iqbuffer[1444];
   //
   // Ideally, a TX IQ buffer with 240 sample is sent every 1250 usecs.
   // We thus wait until we have 240 samples, and then send
   // a packet (in network mode) or start DMA (in xdma mode).
   //
+  sendq_init(&txiq_sendq);
   while (P2running) {
 #ifdef __APPLE__
     sem_wait(txiq_sem);
 #else
     sem_wait(&txiq_sem);
 #endif
+    thread_wakeup();
     if (!P2running) { break; }
-    iqbuffer[0] = (tx_iq_sequence >> 24) & 0xFF;
-    iqbuffer[1] = (tx_iq_sequence >> 16) & 0xFF;
-    iqbuffer[2] = (tx_iq_sequence >>  8) & 0xFF;
-    iqbuffer[3] = (tx_iq_sequence      ) & 0xFF;
-    tx_iq_sequence++;
-    nptr = txiq_outptr + 1440;
-    if (nptr >= TXIQRINGBUFLEN) { nptr = 0; }
-    memcpy(&iqbuffer[4], &TXIQRINGBUF[txiq_outptr], 1440);
-    MEMORY_BARRIER;
-    txiq_outptr = nptr;
+    new_protocol_get_txiq(iqbuffer);
     if (have_saturn_xdma) {
       saturn_handle_duc_iq(iqbuffer);
     } else {
@@ -1769,18 +1842,119 @@ static gpointer new_protocol_txiq_thread(gpointer data) {
         clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
       }
       FIFO += 240.0;  // number of samples in THIS packet
-      ssize_t rc = sendto(data_socket, iqbuffer, sizeof(iqbuffer), 0, (struct sockaddr * )&iq_addr, iq_addr_length);
-      if (rc < 0) {
+      sendq_add(&txiq_sendq, iqbuffer, sizeof(iqbuffer), &iq_addr, iq_addr_length);
+      //
+      // Collect more packets that are ready and would be sent without
+      // delay anyway (typically at the RX/TX transition, when the
+      // FIFO is empty), and send them with a single system call.
+      //
+      while (FIFO <= 1250.0 && sendq_can_add(&txiq_sendq)) {
+#ifdef __APPLE__
+        if (sem_trywait(txiq_sem) != 0) { break; }
+#else
+        if (sem_trywait(&txiq_sem) != 0) { break; }
+#endif
+        new_protocol_get_txiq(iqbuffer);
+        FIFO += 240.0;
+        sendq_add(&txiq_sendq, iqbuffer, sizeof(iqbuffer), &iq_addr, iq_addr_length);
+      }
+      if (sendq_flush(&txiq_sendq, data_socket) < 0) {
         g_idle_add(fatal_error, "FATAL: P2 TX IQ send failed (Network down?)");
         P2running = 0;
-      } else if (rc != sizeof(iqbuffer)) {
-        t_print("sendto socket for TX IQ: %ld rather than %ld\n", (long) rc, (long)sizeof(iqbuffer));
       }
     }
   }
+  sendq_print_stats(&txiq_sendq, "P2 TX IQ");
   return NULL;
 }
 
+static void new_protocol_dispatch(p2buffer *mybuf, int sourceport) {
+  ASSERT_SERVER();
+  //
+  // Put an incoming packet into the ring buffer of the thread
+  // that will process it.
+  //
+  if (sourceport >= RX_IQ_TO_HOST_PORT_0 && sourceport < RX_IQ_TO_HOST_PORT_0 + MAX_DDC) {
+    saturn_post_iq_data(sourceport - RX_IQ_TO_HOST_PORT_0, mybuf);
+    return;
+  }
+  switch (sourceport) {
+  case COMMAND_RESPONSE_TO_HOST_PORT:
+    //
+    // Ignore these packets silently. They occur when
+    // flashing a new firmware using the new protocol
+    // programmer. But this should be done in a separate
+    // program.
+    //
+    release_p2buffer(mybuf);
+    break;
+  case HIGH_PRIORITY_TO_HOST_PORT:
+    saturn_post_high_priority(mybuf);
+    break;
+  case MIC_LINE_TO_HOST_PORT:
+    saturn_post_micaudio(mybuf);
+    break;
+  default:
+    t_print("new_protocol_thread: Unknown port %d\n", sourceport);
+    release_p2buffer(mybuf);
+    break;
+  }
+}
+
+#ifdef P2_RECVMMSG
+static void new_protocol_batch_receive(void) {
+  ASSERT_SERVER();
+  //
+  // Batched version of the receive loop in new_protocol_thread():
+  // up to udp_rx_batch buffers are taken from the buffer pool, and
+  // filled with a single recvmmsg() call. The call returns as soon
+  // as no more data is waiting (MSG_WAITFORONE), or when the batch is
+  // full, or when more than udp_rx_batch_timeout usec have been spent.
+  // Buffers not filled in one call are kept for the next one.
+  //
+  p2buffer *bufs[UDP_RX_BATCH_MAX] = { NULL };
+  struct mmsghdr msgs[UDP_RX_BATCH_MAX];
+  struct iovec iovs[UDP_RX_BATCH_MAX];
+  struct sockaddr_in from[UDP_RX_BATCH_MAX];
+  while (P2running) {
+    int batch = udp_rx_batch;
+    if (batch > UDP_RX_BATCH_MAX) { batch = UDP_RX_BATCH_MAX; }
+    if (batch < 2) { break; }
+    for (int i = 0; i < batch; i++) {
+      if (bufs[i] == NULL) { bufs[i] = get_p2buffer(); }
+      iovs[i].iov_base = bufs[i]->buffer;
+      iovs[i].iov_len = P2_BUFFER_SIZE;
+      memset(&msgs[i], 0, sizeof(struct mmsghdr));
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_name = &from[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
+    struct timespec ts;
+    ts.tv_sec = udp_rx_batch_timeout / 1000000;
+    ts.tv_nsec = 1000 * (udp_rx_batch_timeout % 1000000);
+    int n = recvmmsg(data_socket, msgs, batch, MSG_WAITFORONE, &ts);
+    if (!P2running) { break; }
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) { continue; }
+      t_perror("recvmmsg socket failed for new_protocol_thread");
+      g_idle_add(fatal_error, "FATAL: P2 receive (Network problem?)");
+      P2running = 0;
+      break;
+    }
+    p2_rx_syscalls++;
+    p2_rx_packets += n;
+    for (int i = 0; i < n; i++) {
+      new_protocol_dispatch(bufs[i], ntohs(from[i].sin_port));
+      bufs[i] = NULL;
+    }
+  }
+  for (int i = 0; i < UDP_RX_BATCH_MAX; i++) {
+    if (bufs[i] != NULL) { release_p2buffer(bufs[i]); }
+  }
+}
+#endif
+
 static gpointer new_protocol_thread(gpointer data) {
   ASSERT_SERVER(NULL);
   //
@@ -1792,9 +1966,16 @@ static gpointer new_protocol_thread(gpointer data) {
   // locking in this "hot path". We have to do, however sem_posts, to keep
   // the consumers from "busy spinning".
   //
+  p2_rx_syscalls = 0;
+  p2_rx_packets = 0;
+#ifdef P2_RECVMMSG
+  //
+  // Use batched receive if requested. This function only returns
+  // if the protocol is stopped, or if batching has been switched off.
+  //
+  new_protocol_batch_receive();
+#endif
   while (P2running) {
-    int ddc;
-    int sourceport;
     int bytesread;
     p2buffer *mybuf = get_p2buffer();
     bytesread = recvfrom(data_socket, mybuf->buffer, P2_BUFFER_SIZE, 0, (struct sockaddr*)&addr, &length);
@@ -1805,12 +1986,12 @@ static gpointer new_protocol_thread(gpointer data) {
       // we were doing "recvfrom". In this case, we want to let the main
       // thread terminate gracefully, including writing the props files.
       //
-      mybuf->free = 1;
+      release_p2buffer(mybuf);
       break;
     }
     if (bytesread < 0) {
       if (errno == EAGAIN || errno == EWOULDBLOCK) {
-        mybuf->free = 1;
+        release_p2buffer(mybuf);
         continue;
       }
       t_perror("recvfrom socket failed for new_protocol_thread");
@@ -1818,35 +1999,13 @@ static gpointer new_protocol_thread(gpointer data) {
       P2running = 0;
       break;
     }
-    sourceport = ntohs(addr.sin_port);
-    switch (sourceport) {
-    case RX_IQ_TO_HOST_PORT_0:
-    case RX_IQ_TO_HOST_PORT_1:
-    case RX_IQ_TO_HOST_PORT_2:
-    case RX_IQ_TO_HOST_PORT_3:
-      ddc = sourceport - RX_IQ_TO_HOST_PORT_0;
-      saturn_post_iq_data(ddc, mybuf);
-      break;
-    case COMMAND_RESPONSE_TO_HOST_PORT:
-      //
-      // Ignore these packets silently. They occur when
-      // flashing a new firmware using the new protocol
-      // programmer. But this should be done in a separate
-      // program.
-      //
-      mybuf->free = 1;
-      break;
-    case HIGH_PRIORITY_TO_HOST_PORT:
-      saturn_post_high_priority(mybuf);
-      break;
-    case MIC_LINE_TO_HOST_PORT:
-      saturn_post_micaudio(mybuf);
-      break;
-    default:
-      t_print("new_protocol_thread: Unknown port %d\n", sourceport);
-      mybuf->free = 1;
-      break;
-    }
+    p2_rx_syscalls++;
+    p2_rx_packets++;
+    new_protocol_dispatch(mybuf, ntohs(addr.sin_port));
+  }
+  if (p2_rx_syscalls > 0) {
+    t_print("%s: %ld packets received in %ld system calls (%.2f packets/call)\n", __func__,
+            p2_rx_packets, p2_rx_syscalls, (double) p2_rx_packets / (double) p2_rx_syscalls);
   }
   return NULL;
 }
@@ -1861,13 +2020,14 @@ static gpointer high_priority_thread(gpointer data) {
 #else
     sem_wait(&high_priority_sem);
 #endif
+    thread_wakeup();
     nptr = (high_priority_outptr + 1) & HPRIORINGBUFMASK;
     mybuf = (p2buffer *) high_priority_ring[high_priority_outptr];
     MEMORY_BARRIER;
     high_priority_outptr = nptr;
-    if (mybuf->free) { continue; }
+    if (mybuf->hdr.free) { continue; }
     process_high_priority(mybuf->buffer);
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
   }
   return NULL;
 }
@@ -1886,13 +2046,14 @@ static gpointer mic_line_thread(gpointer data) {
 #else
     sem_wait(&mic_line_sem);
 #endif
+    thread_wakeup();
     nptr = (mic_outptr + 1) & MICRINGBUFMASK;
     mybuf = (p2buffer *) mic_line_buffer[mic_outptr];
     MEMORY_BARRIER;
     mic_outptr = nptr;
-    if (mybuf->free) { continue; }
+    if (mybuf->hdr.free) { continue; }
     process_mic_data(mybuf->buffer);
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
   }
   return NULL;
 }
@@ -1913,7 +2074,7 @@ void saturn_post_high_priority(p2buffer *buffer) {
   //
   int nptr;
   if (!P2running) {
-    buffer->free = 1;
+    release_p2buffer(buffer);
     return;
   }
   nptr = (high_priority_inptr + 1) & HPRIORINGBUFMASK;
@@ -1934,7 +2095,7 @@ void saturn_post_high_priority(p2buffer *buffer) {
     // do not skip further packets in order to drain ring buffer.
     //
     t_print("%s: ring buffer overflow.\n", __func__);
-    buffer->free = 1;
+    release_p2buffer(buffer);
   }
 }
 
@@ -1946,7 +2107,7 @@ void saturn_post_micaudio(p2buffer *mybuf) {
   // possible. So but UDP packet in mic ring buffer and that's it.
   //
   if (!P2running) {
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
     return;
   }
   //
@@ -1956,7 +2117,7 @@ void saturn_post_micaudio(p2buffer *mybuf) {
   //
   if (mic_count < 0) {
     mic_count++;
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
     return;
   }
   int nptr = (mic_inptr + 1) & MICRINGBUFMASK;
@@ -1975,7 +2136,7 @@ void saturn_post_micaudio(p2buffer *mybuf) {
 #endif
   } else {
     t_print("%s: ring buffer overflow.\n", __func__);
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
     mic_count = -(MICRINGBUFLEN / 4); // number of buffers to be skipped
   }
 }
@@ -1990,11 +2151,11 @@ void saturn_post_iq_data(int ddc, p2buffer *mybuf) {
   //
   if (ddc < 0 || ddc >= MAX_DDC) {
     t_print("%s: invalid DDC(%d) seen!\n", __func__, ddc);
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
     return;
   }
   if (!P2running) {
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
     return;
   }
   //
@@ -2003,7 +2164,7 @@ void saturn_post_iq_data(int ddc, p2buffer *mybuf) {
   //
   if (iq_count[ddc] < 0) {
     iq_count[ddc]++;
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
     return;
   }
   //
@@ -2022,7 +2183,7 @@ void saturn_post_iq_data(int ddc, p2buffer *mybuf) {
 #endif
   } else {
     t_print("%s: DDC(%d) ring buffer overflow.\n", __func__, ddc);
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
     iq_count[ddc] = -(RXIQRINGBUFLEN / 4); // number of packets to be skipped
   }
 }
@@ -2031,7 +2192,7 @@ static gpointer iq_thread(gpointer data) {
   ASSERT_SERVER(NULL);
   int ddc = GPOINTER_TO_INT(data);
   int nptr;
-  volatile p2buffer *mybuf;
+  p2buffer *mybuf;
   const unsigned char *buffer;
   //
   // At a regular pace, a buffer with 238 samples arrives
@@ -2046,12 +2207,13 @@ static gpointer iq_thread(gpointer data) {
 #else
     sem_wait(&iq_sem[ddc]);
 #endif
+    thread_wakeup();
     nptr = (iq_outptr[ddc] + 1) &RXIQRINGBUFMASK;
-    mybuf = iq_buffer[ddc][iq_outptr[ddc]];
+    mybuf = (p2buffer *) iq_buffer[ddc][iq_outptr[ddc]];
     MEMORY_BARRIER;
     iq_outptr[ddc] = nptr;
     // This can happen when restarting the protocol
-    if (mybuf->free) { continue; }
+    if (mybuf->hdr.free) { continue; }
     buffer = (unsigned char *) mybuf->buffer;
     //
     // Check sequence
@@ -2084,7 +2246,7 @@ static gpointer iq_thread(gpointer data) {
       process_div_iq_data(buffer);
       break;
     }
-    mybuf->free = 1;
+    release_p2buffer(mybuf);
   }
   return NULL;
 }
@@ -2107,9 +2269,8 @@ static void process_iq_data(const unsigned char *buffer, RECEIVER *rx) {
   int b;
   int leftsample;
   int rightsample;
-  double leftsampledouble;
-  double rightsampledouble;
   int samplesperframe = ((buffer[14] & 0xFF) << 8) + (buffer[15] & 0xFF);
+  if (samplesperframe > (P2_BUFFER_SIZE - 16) / 6) { samplesperframe = (P2_BUFFER_SIZE - 16) / 6; }
 #ifdef P2IQDEBUG
   long long timestamp =
     ((long long)(buffer[4] & 0xFF) << 56)
@@ -2140,6 +2301,10 @@ static void process_iq_data(const unsigned char *buffer, RECEIVER *rx) {
     }
   }
 #endif
+  //
+  // Convert the whole packet, then hand it over to the RX engine in one call
+  //
+  double iq[2 * samplesperframe];
   b = 16;
   for (int i = 0; i < samplesperframe; i++) {
     leftsample   = (int)((signed char) buffer[b++]) << 16;
@@ -2149,10 +2314,10 @@ static void process_iq_data(const unsigned char *buffer, RECEIVER *rx) {
     rightsample |= (int)((((unsigned char)buffer[b++]) << 8) & 0xFF00);
     rightsample |= (int)((unsigned char)buffer[b++] & 0xFF);
     // The "obscure" constant 1.1920928955078125E-7 is 1/(2^23)
-    leftsampledouble = (double)leftsample * 1.1920928955078125E-7;
-    rightsampledouble = (double)rightsample * 1.1920928955078125E-7;
-    rx_add_iq_samples(rx, leftsampledouble, rightsampledouble);
+    iq[2 * i    ] = (double)leftsample * 1.1920928955078125E-7;
+    iq[2 * i + 1] = (double)rightsample * 1.1920928955078125E-7;
   }
+  rx_add_iq_block(rx, iq, samplesperframe);
 }
 
 //
@@ -2164,13 +2329,10 @@ static void process_div_iq_data(const unsigned char*buffer) {
   int b;
   int leftsample0;
   int rightsample0;
-  double leftsampledouble0;
-  double rightsampledouble0;
   int leftsample1;
   int rightsample1;
-  double leftsampledouble1;
-  double rightsampledouble1;
   int samplesperframe = ((buffer[14] & 0xFF) << 8) + (buffer[15] & 0xFF);
+  if (samplesperframe > (P2_BUFFER_SIZE - 16) / 6) { samplesperframe = (P2_BUFFER_SIZE - 16) / 6; }
 #ifdef P2IQDEBUG
   long long timestamp =
     ((long long)(buffer[4] & 0xFF) << 56)
@@ -2184,35 +2346,41 @@ static void process_div_iq_data(const unsigned char*buffer) {
   int bitspersample = ((buffer[12] & 0xFF) << 8) + (buffer[13] & 0xFF);
   t_print("%s: rx=%d bitspersample=%d samplesperframe=%d\n", __func__, rx->id, bitspersample, samplesperframe);
 #endif
+  //
+  // Convert the whole packet into two IQ streams (ADC1 and ADC2),
+  // then hand them over to the RX engine
+  //
+  int n = samplesperframe / 2;
+  double iq0[2 * n];
+  double iq1[2 * n];
   b = 16;
-  int i;
-  for (i = 0; i < samplesperframe; i += 2) {
+  for (int i = 0; i < n; i++) {
     leftsample0   = (int)((signed char) buffer[b++]) << 16;
     leftsample0  |= (int)((((unsigned char)buffer[b++]) << 8) & 0xFF00);
     leftsample0  |= (int)((unsigned char)buffer[b++] & 0xFF);
     rightsample0  = (int)((signed char)buffer[b++]) << 16;
     rightsample0 |= (int)((((unsigned char)buffer[b++]) << 8) & 0xFF00);
     rightsample0 |= (int)((unsigned char)buffer[b++] & 0xFF);
-    leftsampledouble0 = (double)leftsample0 * 1.1920928955078125E-7;
-    rightsampledouble0 = (double)rightsample0 * 1.1920928955078125E-7;
+    iq0[2 * i    ] = (double)leftsample0 * 1.1920928955078125E-7;
+    iq0[2 * i + 1] = (double)rightsample0 * 1.1920928955078125E-7;
     leftsample1   = (int)((signed char) buffer[b++]) << 16;
     leftsample1  |= (int)((((unsigned char)buffer[b++]) << 8) & 0xFF00);
     leftsample1  |= (int)((unsigned char)buffer[b++] & 0xFF);
     rightsample1  = (int)((signed char)buffer[b++]) << 16;
     rightsample1 |= (int)((((unsigned char)buffer[b++]) << 8) & 0xFF00);
     rightsample1 |= (int)((unsigned char)buffer[b++] & 0xFF);
-    leftsampledouble1 = (double)leftsample1 * 1.1920928955078125E-7;
-    rightsampledouble1 = (double)rightsample1 * 1.1920928955078125E-7;
-    //
-    // Feed ADC1 and ADC2 data to the DIVERSITY mixer
-    //
-    rx_add_div_iq_samples(receiver[0], leftsampledouble0, rightsampledouble0, leftsampledouble1, rightsampledouble1);
-    //
-    // if RX2 exists, feed ADC2 data to  RX2
-    //
-    if (receivers > 1 && (receiver[0]->sample_rate == receiver[1]->sample_rate)) {
-      rx_add_iq_samples(receiver[1], leftsampledouble1, rightsampledouble1);
-    }
+    iq1[2 * i    ] = (double)leftsample1 * 1.1920928955078125E-7;
+    iq1[2 * i + 1] = (double)rightsample1 * 1.1920928955078125E-7;
+  }
+  //
+  // Feed ADC1 and ADC2 data to the DIVERSITY mixer
+  //
+  rx_add_div_iq_block(receiver[0], iq0, iq1, n);
+  //
+  // if RX2 exists, feed ADC2 data to  RX2
+  //
+  if (receivers > 1 && (receiver[0]->sample_rate == receiver[1]->sample_rate)) {
+    rx_add_iq_block(receiver[1], iq1, n);
   }
 }
 
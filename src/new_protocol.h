@@ -24,7 +24,11 @@
 #include "buffer.h"
 #include "receiver.h"
 
-#define MAX_DDC 4
+//
+// Max. number of DDCs we can handle. Two of them (DDC0/1) are
+// reserved for PureSignal and DIVERSITY on ANGELIA and beyond.
+//
+#define MAX_DDC (MAX_RECEIVERS + 2)
 
 // port definitions from host
 #define GENERAL_REGISTERS_FROM_HOST_PORT              1024
@@ -40,10 +44,7 @@
 #define HIGH_PRIORITY_TO_HOST_PORT                    1025
 #define MIC_LINE_TO_HOST_PORT                         1026
 #define WIDE_BAND_TO_HOST_PORT                        1027
-#define RX_IQ_TO_HOST_PORT_0                          1035
-#define RX_IQ_TO_HOST_PORT_1                          1036
-#define RX_IQ_TO_HOST_PORT_2                          1037
-#define RX_IQ_TO_HOST_PORT_3                          1038
+#define RX_IQ_TO_HOST_PORT_0                          1035    // DDC(n) uses port 1035+n
 
 #define MIC_SAMPLES 64
 
@@ -17,6 +17,10 @@
 *
 */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE   // needed for recvmmsg()
+#endif
+
 #include <gtk/gtk.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -52,11 +56,20 @@
 #include "old_protocol.h"
 #include "radio.h"
 #include "receiver.h"
+#include "sendqueue.h"
+#include "threads.h"
 #include "transmitter.h"
 #include "vfo.h"
 
 #define min(x,y) (x<y?x:y)
 
+//
+// Batched UDP receive is only available on LINUX
+//
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+  #define P1_RECVMMSG
+#endif
+
 #define SYNC0 0
 #define SYNC1 1
 #define SYNC2 2
@@ -125,6 +138,21 @@ static int tx_fifo_flag = 0;
 
 static int current_rx = 0;
 
+//
+// Statistics: number of 512-byte frames decoded as a whole (fast path)
+// and number of frames decoded byte-by-byte (slow path, only used
+// to re-gain sync).
+//
+static long p1_fast_frames = 0;
+static long p1_slow_frames = 0;
+
+//
+// Statistics for the METIS receive thread: number of
+// recvfrom/recvmmsg calls and number of packets received.
+//
+static long p1_rx_syscalls = 0;
+static long p1_rx_packets = 0;
+
 static int mic_samples = 0;
 static int mic_sample_divisor = 1;
 
@@ -145,6 +173,7 @@ static void metis_send_buffer(const unsigned char* buffer, int length);
 static void open_tcp_socket(void);
 static void open_udp_socket(void);
 static int how_many_receivers(void);
+static int metis_check_packet(const unsigned char *buffer, int bytes_read);
 
 //
 // "HermesLite-II I/O Bord detected" flag
@@ -180,10 +209,12 @@ static int mercury_software_version[2] = { 0, 0 };
 #endif
 //
 // TXIQ/audio data can be sent from two different threads, namely
-// from the RX thread (old_protocol_audio_samples(), when sending RX audio)
-// and from the TX thread (old_protocol_iq_samples(), when sending
-// TXIQ data and side tone). This is mutex protected to prevent
-// race conditions when updating TQIQ ring buffer pointers.
+// from the RX thread (old_protocol_audio_block(), when sending RX audio)
+// and from the TX thread (old_protocol_iq_block(), when sending
+// TXIQ data and side tone). Near a RX/TX transition, both may be
+// active, so the producer side of the TX ring buffer is protected
+// by this mutex. It is taken once per block (not per sample), and
+// never by the consumer (the TX IQ thread).
 //
 static pthread_mutex_t audio_mutex   = PTHREAD_MUTEX_INITIALIZER;
 
@@ -199,6 +230,15 @@ static pthread_mutex_t audio_mutex   = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t send_mutex   = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t recv_mutex   = PTHREAD_MUTEX_INITIALIZER;
 
+//
+// Outgoing METIS packets are collected in p1_sendq (and sent with
+// one system call) while metis_sendq is non-NULL. This is only
+// the case while the TX IQ thread holds the send_mutex, and
+// only for UDP connections.
+//
+static SENDQUEUE p1_sendq;
+static SENDQUEUE *metis_sendq = NULL;
+
 
 //
 // Ring buffer for outgoing samples.
@@ -225,12 +265,28 @@ static pthread_mutex_t recv_mutex   = PTHREAD_MUTEX_INITIALIZER;
 // TXRINGBUFLEN must be a multiple of 1008 bytes (126 samples)
 // (so it cannot be a power of two)
 //
+// This is a single-producer/single-consumer ring buffer: txring_inptr
+// is only written by the producer, txring_outptr only by the consumer.
+// The producer fills a chunk of 126 samples and then publishes it by
+// advancing txring_inptr.
+// At a RX/TX transition, the data still in the ring buffer shall be
+// discarded (for minimum latency). Since the producer must not touch
+// txring_outptr, it stores the current txring_inptr in txring_discard_ptr
+// and then increments txring_discard_seq. The consumer then advances
+// txring_outptr to txring_discard_ptr (but never backwards).
+// The consumer only waits on txring_sem if the ring buffer is empty,
+// and then sets txring_waiting. The producer only posts txring_sem
+// if this flag is set.
+//
 #define TXRINGBUFLEN 32256     // 80 msec
 static unsigned char *TXRINGBUF = NULL;
-static volatile atomic_int txring_inptr  = 0;  // pointer updated when writing into the ring buffer
-static volatile atomic_int txring_outptr = 0;  // pointer updated when reading from the ring buffer
-static volatile int txring_flag   = 0;  // 0: RX, 1: TX
-static volatile int txring_count  = 0;  // a sample counter
+static volatile atomic_int txring_inptr  = 0;        // pointer updated when writing into the ring buffer
+static volatile atomic_int txring_outptr = 0;        // pointer updated when reading from the ring buffer
+static volatile atomic_int txring_discard_ptr = 0;   // discard data up to here
+static volatile atomic_int txring_discard_seq = 0;   // incremented for each discard request
+static volatile atomic_int txring_waiting = 0;       // consumer waits on txring_sem
+static int txring_flag   = 0;  // 0: RX, 1: TX (producer only)
+static int txring_count  = 0;  // a sample counter (producer only)
 
 //
 // If we want to store samples of about 75msec, this
@@ -253,6 +309,64 @@ static volatile int metis_skip_count = 0;          // an overflow recovery point
   static volatile int ozy_skip_count = 0;           // an overflow recovery pointer
 #endif
 
+static int old_protocol_get_txring(unsigned char *ozy_buf1, unsigned char *ozy_buf2) {
+  //
+  // Fetch 126 samples from the TX ring buffer into two OZY buffers.
+  // return 0 if the ring buffer is empty.
+  //
+  static int discard_seq = 0;
+  int optr = txring_outptr;
+  if (discard_seq != txring_discard_seq) {
+    //
+    // The producer wants the data up to txring_discard_ptr be discarded.
+    // Do this only if this moves outptr forward, i.e. the discard pointer
+    // lies between outptr and inptr. inptr must be read after the discard
+    // pointer, since the producer may have written more data after posting
+    // the discard request.
+    //
+    discard_seq = txring_discard_seq;
+    MEMORY_BARRIER;
+    int dptr = txring_discard_ptr;
+    MEMORY_BARRIER;
+    int iptr = txring_inptr;
+    if ((dptr - optr + TXRINGBUFLEN) % TXRINGBUFLEN <= (iptr - optr + TXRINGBUFLEN) % TXRINGBUFLEN) {
+      optr = dptr;
+      txring_outptr = optr;
+    }
+  }
+  int iptr = txring_inptr;
+  if (iptr == optr) {
+    return 0;
+  }
+  int nptr = optr + 1008;
+  if (nptr >= TXRINGBUFLEN) { nptr = 0; }
+  MEMORY_BARRIER;
+  memcpy(ozy_buf1 + 8, &TXRINGBUF[optr      ], 504);
+  memcpy(ozy_buf2 + 8, &TXRINGBUF[optr + 504], 504);
+  MEMORY_BARRIER;
+  txring_outptr = nptr;
+  return 1;
+}
+
+static void old_protocol_wait_txring(void) {
+  //
+  // Wait until the producer has published a chunk. The ring buffer is
+  // checked again after setting txring_waiting, such that a chunk
+  // published in between cannot be missed.
+  //
+  txring_waiting = 1;
+  MEMORY_BARRIER;
+  if (P1running && txring_inptr != txring_outptr) {
+    txring_waiting = 0;
+    return;
+  }
+#ifdef __APPLE__
+  sem_wait(txring_sem);
+#else
+  sem_wait(&txring_sem);
+#endif
+}
+
 static gpointer old_protocol_txiq_thread(gpointer data) {
   ASSERT_SERVER(NULL);
   unsigned char ozy_buf1[P1_BUFSIZE];
@@ -270,30 +384,11 @@ static gpointer old_protocol_txiq_thread(gpointer data) {
   // When TXing, a bunch of 1024 TX IQ samples is produced every 21.3 msec.
   //
   for (;;) {
-#ifdef __APPLE__
-    sem_wait(txring_sem);
-#else
-    sem_wait(&txring_sem);
-#endif
-    if (!P1running) { continue; }
-    //
-    // The audio_mutex lock here is needed to avoid race
-    // conditions with buffer draining. After having copied
-    // the data into the local buffer, the lock can be
-    // released.
-    //
-    pthread_mutex_lock(&audio_mutex);
-    if (txring_inptr == txring_outptr) {
-      pthread_mutex_unlock(&audio_mutex);
+    if (!P1running || !old_protocol_get_txring(ozy_buf1, ozy_buf2)) {
+      old_protocol_wait_txring();
       continue;
     }
-    int nptr = txring_outptr + 1008;
-    if (nptr >= TXRINGBUFLEN) { nptr = 0; }
-    memcpy(ozy_buf1 + 8, &TXRINGBUF[txring_outptr      ], 504);
-    memcpy(ozy_buf2 + 8, &TXRINGBUF[txring_outptr + 504], 504);
-    MEMORY_BARRIER;
-    txring_outptr = nptr;
-    pthread_mutex_unlock(&audio_mutex);
+    thread_wakeup();
     //
     // We used to have a fixed sleeping time of 2000 usec, and
     // observed that the sleep was sometimes too long, especially
@@ -348,8 +443,29 @@ static gpointer old_protocol_txiq_thread(gpointer data) {
       // send out data
       //
       FIFO += 126.0;  // number of samples in THIS packet
+      if (tcp_socket < 0 && data_socket >= 0) {
+        metis_sendq = &p1_sendq;
+      }
       ozy_send_buffer(ozy_buf1);
       ozy_send_buffer(ozy_buf2);
+      if (metis_sendq != NULL) {
+        //
+        // If more packets are ready *and* would be sent without any
+        // delay anyway (FIFO low), collect them and send them with
+        // a single system call.
+        //
+        while (FIFO <= 300.0 && sendq_can_add(metis_sendq)) {
+          if (!old_protocol_get_txring(ozy_buf1, ozy_buf2)) { break; }
+          FIFO += 126.0;
+          ozy_send_buffer(ozy_buf1);
+          ozy_send_buffer(ozy_buf2);
+        }
+        metis_sendq = NULL;
+        if (sendq_flush(&p1_sendq, data_socket) < 0) {
+          g_idle_add(fatal_error, "FATAL: P1 send failed (Network down?)");
+          P1running = 0;
+        }
+      }
       pthread_mutex_unlock(&send_mutex);
     }
   }
@@ -358,7 +474,13 @@ static gpointer old_protocol_txiq_thread(gpointer data) {
 
 void old_protocol_stop(void) {
   ASSERT_SERVER();
-  t_print("%s\n", __func__);
+  t_print("%s: frames decoded: fast=%ld slow=%ld\n", __func__, p1_fast_frames, p1_slow_frames);
+  if (p1_rx_syscalls > 0) {
+    t_print("%s: %ld packets received in %ld system calls (%.2f packets/call)\n", __func__,
+            p1_rx_packets, p1_rx_syscalls, (double) p1_rx_packets / (double) p1_rx_syscalls);
+  }
+  sendq_print_stats(&p1_sendq, "P1 TX");
+  print_buffer_stats();
   P1running = 0;
   if (device != DEVICE_OZY) {
     pthread_mutex_lock(&send_mutex);
@@ -390,8 +512,9 @@ void old_protocol_init(int rate) {
   (void) sem_init(&rxring_sem, 0, 0);
 #endif
   old_protocol_set_mic_sample_rate(rate);
-  g_thread_new("P1 out", old_protocol_txiq_thread, NULL);
-  g_thread_new("P1 proc", process_ozy_input_buffer_thread, NULL);
+  sendq_init(&p1_sendq);
+  thread_new("P1 out", THREAD_ROLE_TXOUT, old_protocol_txiq_thread, NULL);
+  thread_new("P1 proc", THREAD_ROLE_RXIQ, process_ozy_input_buffer_thread, NULL);
   //
   // if we have a USB interfaced Ozy device:
   //
@@ -399,16 +522,11 @@ void old_protocol_init(int rate) {
 #ifdef USBOZY
     t_print("old_protocol_init: initialise ozy on USB\n");
     //
-    // Pre-Allocate OZY buffers. Do this 8 times
-    // to allocate in all 8 lists. Then, mark them free.
+    // Pre-Allocate OZY buffers for 100 msec of data (four frames per buffer),
+    // but not more than the ring buffer can hold.
     //
-    ozybuffer *ob[8];
-    for (unsigned int i = 0; i < 8; i++) {
-      ob[i] = get_ozybuffer(); // this will pre-allocate
-    }
-    for (unsigned int i = 0; i < 8; i++) {
-      ob[i]->free = 1;
-    }
+    int num = rate / (4 * (504 / (6 * how_many_receivers() + 2))) / 10 + 8;
+    prealloc_ozybuffers(MIN(num, OZYRINGBUFLEN + 8));
     ozy_initialise();
     P1running = 1;
     start_usb_receive_threads();
@@ -416,22 +534,17 @@ void old_protocol_init(int rate) {
   } else {
     t_print("old_protocol starting receive thread\n");
     //
-    // Pre-Allocate METIS buffers. Do this 8 times
-    // to allocate in all 8 lists. Then, mark them free.
+    // Pre-Allocate METIS buffers for 100 msec of data (two frames per buffer),
+    // but not more than the ring buffer can hold.
     //
-    metisbuffer *mb[8];
-    for (unsigned int i = 0; i < 8; i++) {
-      mb[i] = get_metisbuffer(); // this will pre-allocate
-    }
-    for (unsigned int i = 0; i < 8; i++) {
-      mb[i]->free = 1;
-    }
+    int num = rate / (2 * (504 / (6 * how_many_receivers() + 2))) / 10 + UDP_RX_BATCH_MAX;
+    prealloc_metisbuffers(MIN(num, METISRINGBUFLEN + UDP_RX_BATCH_MAX));
     if (radio->use_tcp) {
       open_tcp_socket();
     } else  {
       open_udp_socket();
     }
-    g_thread_new( "METIS", metis_receive_thread, NULL);
+    thread_new("METIS", THREAD_ROLE_NET, metis_receive_thread, NULL);
   }
   old_protocol_run();
 }
@@ -445,8 +558,8 @@ void old_protocol_init(int rate) {
 static void start_usb_receive_threads(void) {
   ASSERT_SERVER();
   t_print("old_protocol starting USB receive thread\n");
-  g_thread_new( "OZYEP6", ozy_ep6_rx_thread, NULL);
-  g_thread_new( "OZYI2C", ozy_i2c_thread, NULL);
+  thread_new("OZYEP6", THREAD_ROLE_NET, ozy_ep6_rx_thread, NULL);
+  thread_new("OZYI2C", THREAD_ROLE_NET, ozy_i2c_thread, NULL);
 }
 
 //
@@ -524,7 +637,7 @@ static void queue_ozy_buffer(ozybuffer *ob) {
     //
     // There was a recent buffer overflow
     //
-    ob->free = 1;
+    release_ozybuffer(ob);
     ozy_skip_count++;
     return;
   }
@@ -561,17 +674,17 @@ static gpointer ozy_ep6_rx_thread(gpointer arg) {
     // If the protocol has been stopped, just swallow all incoming packets
     //
     if (!P1running) {
-      ob->free = 1;
+      release_ozybuffer(ob);
       continue;
     }
     if (bytes == 0) {
       t_print("old_protocol_ep6_read: ozy_read returned 0 bytes... retrying\n");
-      ob->free = 1;
+      release_ozybuffer(ob);
       continue;
     } else if (bytes != EP6_BUFFER_SIZE) {
       t_print("old_protocol_ep6_read: OzyBulkRead failed %d bytes\n", bytes);
       t_perror("ozy_read(EP6 read failed");
-      ob->free = 1;
+      release_ozybuffer(ob);
     } else {
       // process the received data normally
       queue_ozy_buffer(ob);
@@ -782,7 +895,7 @@ static int metis_read(unsigned char *buffer, int len) {
   struct sockaddr_in addr;
   socklen_t length = sizeof(addr);
   int bytes_read;
-  int ret = -1;
+  int ret;
   if (tcp_socket > 0) {
     // TCP messages may be split, so collect exactly one buffer.
     // Remember, this is a STREAMING protocol.
@@ -809,6 +922,20 @@ static int metis_read(unsigned char *buffer, int len) {
     usleep(100000);
     bytes_read = 0;
   }
+  if (bytes_read > 0) {
+    p1_rx_syscalls++;
+    p1_rx_packets++;
+  }
+  return metis_check_packet(buffer, bytes_read);
+}
+
+static int metis_check_packet(const unsigned char *buffer, int bytes_read) {
+  //
+  // Check whether a packet is a valid METIS data frame,
+  // and check the sequence number.
+  // return 0 for a valid data frame, -1 otherwise
+  //
+  int ret = -1;
   if (bytes_read == METIS_BUFFER_SIZE && buffer[0] == 0xEF && buffer[1] == 0xFE && buffer[3] == 6) {
     //
     // This is the data frame we are looking for
@@ -829,6 +956,49 @@ static int metis_read(unsigned char *buffer, int len) {
   return ret;
 }
 
+#ifdef P1_RECVMMSG
+static int metis_read_batch(metisbuffer **mbs, int *lens, int batch) {
+  //
+  // Batched version of metis_read() for UDP: fill up to batch buffers
+  // with a single recvmmsg() call. The call returns as soon as no more
+  // data is waiting (MSG_WAITFORONE), or when the batch is full, or when
+  // more than udp_rx_batch_timeout usec have been spent.
+  // Return the number of packets received, the length of each packet
+  // is stored in lens[].
+  //
+  struct mmsghdr msgs[UDP_RX_BATCH_MAX];
+  struct iovec iovs[UDP_RX_BATCH_MAX];
+  struct timespec ts;
+  for (int i = 0; i < batch; i++) {
+    iovs[i].iov_base = mbs[i]->buffer;
+    iovs[i].iov_len = METIS_BUFFER_SIZE;
+    memset(&msgs[i], 0, sizeof(struct mmsghdr));
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  ts.tv_sec = udp_rx_batch_timeout / 1000000;
+  ts.tv_nsec = 1000 * (udp_rx_batch_timeout % 1000000);
+  int n = recvmmsg(data_socket, msgs, batch, MSG_WAITFORONE, &ts);
+  if (n < 0) {
+    if (errno != EAGAIN && errno != EINTR) {
+      //
+      // A persistent error (e.g. network down) would otherwise make
+      // the receive thread spin, so wait a little before the next try
+      //
+      t_perror("old_protocol recvmmsg UDP");
+      usleep(100000);
+    }
+    return 0;
+  }
+  p1_rx_syscalls++;
+  p1_rx_packets += n;
+  for (int i = 0; i < n; i++) {
+    lens[i] = msgs[i].msg_len;
+  }
+  return n;
+}
+#endif
+
 static void queue_metis_buffer(metisbuffer *mb) {
   ASSERT_SERVER();
   //
@@ -840,7 +1010,7 @@ static void queue_metis_buffer(metisbuffer *mb) {
     //
     // There was a recent buffer overflow
     //
-    mb->free = 1;
+    release_metisbuffer(mb);
     metis_skip_count++;
     return;
   }
@@ -865,6 +1035,9 @@ static void queue_metis_buffer(metisbuffer *mb) {
 static gpointer metis_receive_thread(gpointer arg) {
   ASSERT_SERVER(NULL);
   int ret;
+#ifdef P1_RECVMMSG
+  metisbuffer *batch_mbs[UDP_RX_BATCH_MAX] = { NULL };
+#endif
   t_print( "old_protocol: %s\n", __func__);
   if (device == DEVICE_OZY) { return NULL; }  // should not happen
   for (;;) {
@@ -880,13 +1053,38 @@ static gpointer metis_receive_thread(gpointer arg) {
     // this thread, e.g. when restarting the protocol
     //
     if (pthread_mutex_trylock(&recv_mutex) == 0) {
+#ifdef P1_RECVMMSG
+      int batch = udp_rx_batch;
+      if (batch > UDP_RX_BATCH_MAX) { batch = UDP_RX_BATCH_MAX; }
+      if (batch > 1 && tcp_socket < 0 && data_socket >= 0) {
+        //
+        // Batched receive. Buffers that have not been filled
+        // are kept for the next call.
+        //
+        int lens[UDP_RX_BATCH_MAX];
+        for (int i = 0; i < batch; i++) {
+          if (batch_mbs[i] == NULL) { batch_mbs[i] = get_metisbuffer(); }
+        }
+        int n = P1running ? metis_read_batch(batch_mbs, lens, batch) : 0;
+        for (int i = 0; i < n; i++) {
+          if (metis_check_packet(batch_mbs[i]->buffer, lens[i]) == 0) {
+            queue_metis_buffer(batch_mbs[i]);
+          } else {
+            release_metisbuffer(batch_mbs[i]);
+          }
+          batch_mbs[i] = NULL;
+        }
+        pthread_mutex_unlock(&recv_mutex);
+        continue;
+      }
+#endif
       metisbuffer *mb = get_metisbuffer();
       ret = P1running ? metis_read(mb->buffer, METIS_BUFFER_SIZE) : -1;
       pthread_mutex_unlock(&recv_mutex);
       if (ret >= 0) {
         queue_metis_buffer(mb);
       } else {
-        mb->free = 1;
+        release_metisbuffer(mb);
       }
     }
   }
@@ -1343,6 +1541,7 @@ static void process_ozy_byte(int b) {
   case CONTROL_4:
     control_in[4] = b;
     process_control_bytes();
+    p1_slow_frames++;
     nreceiver = 0;
     iq_samples = (512 - 8) / ((st_num_hpsdr_receivers * 6) + 2);
     nsamples = 0;
@@ -1450,6 +1649,114 @@ static void process_ozy_byte(int b) {
   }
 }
 
+//
+// Frame decoder (fast path).
+//
+// If we are in sync (state == SYNC_0) and a 512-byte frame starts with
+// the three sync bytes, the frame is decoded as a whole: the control
+// bytes are processed once, then all IQ and mic samples are unpacked
+// in a tight loop into per-receiver arrays, and only then they are
+// fed to the RX/TX engines. This saves the state machine overhead and,
+// more importantly, calling radio_is_transmitting() for each sample.
+//
+// A frame contains at most 63 samples (one HPSDR receiver), and there
+// are at most 8 HPSDR receivers.
+//
+#define P1_MAX_FRAME_SAMPLES 63
+#define P1_MAX_FRAME_RX       8
+
+static int32_t frame_raw[P1_MAX_FRAME_RX][2 * P1_MAX_FRAME_SAMPLES];
+static double  frame_iq[P1_MAX_FRAME_RX][2 * P1_MAX_FRAME_SAMPLES];
+static int16_t frame_mic[P1_MAX_FRAME_SAMPLES];
+
+static void p1_deinterleave(const unsigned char *p, int nrx, int nsamp) {
+  //
+  // Unpack 24-bit big-endian IQ triplets and 16-bit mic samples.
+  // The sign extension is done by placing the 24 bits into the upper
+  // part of a 32-bit word followed by an arithmetic right shift.
+  //
+  for (int j = 0; j < nsamp; j++) {
+    for (int r = 0; r < nrx; r++) {
+      frame_raw[r][2 * j    ] = (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8)) >> 8;
+      frame_raw[r][2 * j + 1] = (int32_t)(((uint32_t)p[3] << 24) | ((uint32_t)p[4] << 16) | ((uint32_t)p[5] << 8)) >> 8;
+      p += 6;
+    }
+    frame_mic[j] = (int16_t)((p[0] << 8) | p[1]);
+    p += 2;
+  }
+  //
+  // Integer-to-double conversion on contiguous arrays,
+  // this loop is vectorized by the compiler.
+  //
+  for (int r = 0; r < nrx; r++) {
+    const int32_t *in = frame_raw[r];
+    double *out = frame_iq[r];
+    for (int k = 0; k < 2 * nsamp; k++) {
+      out[k] = (double)in[k] * 1.1920928955078125E-7;
+    }
+  }
+}
+
+static void process_ozy_frame(const unsigned char *frame) {
+  ASSERT_SERVER();
+  int nrx = st_num_hpsdr_receivers;
+  int nsamp = (512 - 8) / ((nrx * 6) + 2);
+  memcpy(control_in, frame + 3, 5);
+  process_control_bytes();
+  p1_deinterleave(frame + 8, nrx, nsamp);
+  //
+  // The TX/RX state and the PS/DIVERSITY settings are
+  // evaluated once per frame, not once per sample
+  //
+  int xmit = radio_is_transmitting();
+  int do_ps = xmit && transmitter->puresignal && st_rxfdbk < nrx && st_txfdbk < nrx;
+  int do_div = !xmit && diversity_enabled;
+  int do_rx = (!xmit || duplex) && !diversity_enabled;
+  if (do_ps) {
+    const double *fbrx = frame_iq[st_rxfdbk];
+    const double *fbtx = frame_iq[st_txfdbk];
+    for (int j = 0; j < nsamp; j++) {
+      tx_add_ps_iq_samples(transmitter, fbtx[2 * j], fbtx[2 * j + 1], fbrx[2 * j], fbrx[2 * j + 1]);
+    }
+  }
+  if (do_div && nrx > 1) {
+    rx_add_div_iq_block(receiver[0], frame_iq[0], frame_iq[1], nsamp);
+    if (receivers > 1) { rx_add_iq_block(receiver[1], frame_iq[1], nsamp); }
+  }
+  if (do_rx) {
+    rx_add_iq_block(receiver[0], frame_iq[0], nsamp);
+    if (nrx > 1 && receivers > 1) { rx_add_iq_block(receiver[1], frame_iq[1], nsamp); }
+  }
+  for (int j = 0; j < nsamp; j++) {
+    mic_samples++;
+    if (mic_samples >= mic_sample_divisor) { // reduce to 48000
+      tx_add_mic_sample(transmitter, frame_mic[j] * 0.00003051);
+      mic_samples = 0;
+    }
+  }
+  p1_fast_frames++;
+}
+
+static void process_ozy_block(const unsigned char *buf, int len) {
+  ASSERT_SERVER();
+  //
+  // Process a block of data that consists of 512-byte frames.
+  // Whenever in sync, use the frame decoder. The byte-by-byte
+  // state machine is only used to (re-)gain sync.
+  //
+  int i = 0;
+  while (i < len) {
+    if (state == SYNC_0 && len - i >= P1_BUFSIZE && buf[i] == SYNC && buf[i + 1] == SYNC && buf[i + 2] == SYNC
+        && st_num_hpsdr_receivers <= P1_MAX_FRAME_RX) {
+      process_ozy_frame(buf + i);
+      i += P1_BUFSIZE;
+    } else {
+      process_ozy_byte(buf[i] & 0xFF);
+      i++;
+    }
+  }
+}
+
 static gpointer process_ozy_input_buffer_thread(gpointer arg) {
   ASSERT_SERVER(NULL);
   //
@@ -1467,6 +1774,7 @@ static gpointer process_ozy_input_buffer_thread(gpointer arg) {
 #else
     sem_wait(&rxring_sem);
 #endif
+    thread_wakeup();
     //
     // This data must not change while processing a buffer
     //
@@ -1478,10 +1786,8 @@ static gpointer process_ozy_input_buffer_thread(gpointer arg) {
       if (ozy_ring_outptr != ozy_ring_inptr) {
         int nptr = (ozy_ring_outptr + 1) & OZYRINGBUFMASK;
         ozybuffer *ob = ozy_ringbuf[ozy_ring_outptr];
-        for (int i = 0; i < EP6_BUFFER_SIZE; i++) {
-          process_ozy_byte(ob->buffer[i] & 0xFF);
-        }
-        ob->free = 1;
+        process_ozy_block(ob->buffer, EP6_BUFFER_SIZE);
+        release_ozybuffer(ob);
         MEMORY_BARRIER;
         ozy_ring_outptr = nptr;
       }
@@ -1490,10 +1796,8 @@ static gpointer process_ozy_input_buffer_thread(gpointer arg) {
       if (metis_ring_inptr != metis_ring_outptr) {
         int nptr = (metis_ring_outptr + 1) & METISRINGBUFMASK;
         metisbuffer *mb = metis_ringbuf[metis_ring_outptr];
-        for (int i = 8; i < METIS_BUFFER_SIZE; i++) {
-          process_ozy_byte(mb->buffer[i] & 0xFF);
-        }
-        mb->free = 1;
+        process_ozy_block(mb->buffer + 8, METIS_BUFFER_SIZE - 8);
+        release_metisbuffer(mb);
         MEMORY_BARRIER;
         metis_ring_outptr = nptr;
       }
@@ -1502,89 +1806,118 @@ static gpointer process_ozy_input_buffer_thread(gpointer arg) {
   return NULL;
 }
 
-void old_protocol_audio_samples(double left, double right) {
-  ASSERT_SERVER();
-  if (!radio_is_transmitting()) {
-    pthread_mutex_lock(&audio_mutex);
-    if (txring_count < 0) {
-      txring_count++;
-      pthread_mutex_unlock(&audio_mutex);
-      return;
-    }
-    if (txring_flag) {
-      //
-      // First time we arrive here after a TX->RX transition:
-      // reset buffer
-      //
-      txring_inptr = txring_outptr;
-      txring_flag = 0;
-    }
-    int iptr = txring_inptr + 8 * txring_count;
-    //
-    // The HL2 makes no use of audio samples, but instead
-    // uses them to write to extended addrs which we do not
-    // want to do un-intentionally, therefore send zeros.
-    // Note special variants of the HL2 *do* have an audio codec!
-    //
-    int32_t ls = (int32_t)(left  * 32766.672 + 32767.5) - 32767;
-    int32_t rs = (int32_t)(right * 32766.672 + 32767.5) - 32767;
-    if (device == DEVICE_HERMES_LITE2 && !hl2_audio_codec) {
-      TXRINGBUF[iptr++] = 0;
-      TXRINGBUF[iptr++] = 0;
-      TXRINGBUF[iptr++] = 0;
-      TXRINGBUF[iptr++] = 0;
-    } else {
-      TXRINGBUF[iptr++] = (ls >> 8) & 0xFF;
-      TXRINGBUF[iptr++] = (ls     ) & 0xFF;
-      TXRINGBUF[iptr++] = (rs >> 8) & 0xFF;
-      TXRINGBUF[iptr++] = (rs     ) & 0xFF;
-    }
-    TXRINGBUF[iptr++] = 0;
-    TXRINGBUF[iptr++] = 0;
-    TXRINGBUF[iptr++] = 0;
-    TXRINGBUF[iptr++] = 0;
-    txring_count++;
-    if (txring_count >= 126) {
-      int nptr = txring_inptr + 1008;
-      if (nptr >= TXRINGBUFLEN) { nptr = 0; }
-      if (nptr != txring_outptr) {
-        MEMORY_BARRIER;
-        txring_inptr = nptr;
-        MEMORY_BARRIER;
+static void old_protocol_txring_mode(int flag) {
+  //
+  // RX/TX transition: if the "mode" of the producer changes,
+  // request the consumer to discard all data still in the ring
+  // buffer, for minimum (CW side tone) latency.
+  // This also cancels an incomplete chunk and an overflow back-off.
+  //
+  if (txring_flag != flag) {
+    txring_discard_ptr = txring_inptr;
+    MEMORY_BARRIER;
+    txring_discard_seq++;
+    txring_flag = flag;
+    txring_count = 0;
+  }
+}
+
+static void old_protocol_txring_commit(const char *caller) {
+  //
+  // One sample has been written to the ring buffer. If the
+  // chunk is complete, publish it and wake up the consumer if
+  // it is waiting.
+  // If the ring buffer is full, the next 1260 samples are dropped
+  // (txring_count < 0).
+  //
+  txring_count++;
+  if (txring_count >= 126) {
+    int nptr = txring_inptr + 1008;
+    if (nptr >= TXRINGBUFLEN) { nptr = 0; }
+    if (nptr != txring_outptr) {
+      MEMORY_BARRIER;
+      txring_inptr = nptr;
+      MEMORY_BARRIER;
+      txring_count = 0;
+      if (txring_waiting) {
+        txring_waiting = 0;
 #ifdef __APPLE__
         sem_post(txring_sem);
 #else
         sem_post(&txring_sem);
 #endif
-        txring_count = 0;
-      } else {
-        t_print("%s: output buffer overflow.\n", __func__);
-        txring_count = -1260;
       }
+    } else {
+      t_print("%s: output buffer overflow.\n", caller);
+      txring_count = -1260;
     }
-    pthread_mutex_unlock(&audio_mutex);
   }
 }
 
-void old_protocol_iq_samples(double isample, double qsample, double side) {
+void old_protocol_audio_block(const double *audio, int n) {
+  //
+  // Put n (interleaved left/right) RX audio samples into the TX ring buffer.
+  //
   ASSERT_SERVER();
-  if (radio_is_transmitting()) {
-    pthread_mutex_lock(&audio_mutex);
+  if (radio_is_transmitting()) { return; }
+  //
+  // The HL2 makes no use of audio samples, but instead
+  // uses them to write to extended addrs which we do not
+  // want to do un-intentionally, therefore send zeros.
+  // Note special variants of the HL2 *do* have an audio codec!
+  //
+  int zero = (device == DEVICE_HERMES_LITE2 && !hl2_audio_codec);
+  pthread_mutex_lock(&audio_mutex);
+  old_protocol_txring_mode(0);
+  for (int j = 0; j < n; j++) {
     if (txring_count < 0) {
       txring_count++;
-      pthread_mutex_unlock(&audio_mutex);
-      return;
+      continue;
     }
-    if (!txring_flag) {
-      //
-      // First time we arrive here after a RX->TX transition:
-      // rest txiq ring buffer(which also contains the audio samples)
-      // for minimum CW side tone latency.
-      //
-      txring_inptr = txring_outptr;
-      txring_flag = 1;
+    unsigned char *p = &TXRINGBUF[txring_inptr + 8 * txring_count];
+    if (zero) {
+      memset(p, 0, 4);
+    } else {
+      int32_t ls = (int32_t)(audio[2 * j    ] * 32766.672 + 32767.5) - 32767;
+      int32_t rs = (int32_t)(audio[2 * j + 1] * 32766.672 + 32767.5) - 32767;
+      p[0] = (ls >> 8) & 0xFF;
+      p[1] = (ls     ) & 0xFF;
+      p[2] = (rs >> 8) & 0xFF;
+      p[3] = (rs     ) & 0xFF;
+    }
+    memset(p + 4, 0, 4);
+    old_protocol_txring_commit(__func__);
+  }
+  pthread_mutex_unlock(&audio_mutex);
+}
+
+void old_protocol_iq_block(const double *isample, const double *qsample, int stride, const double *side,
+                           double gain, int n) {
+  //
+  // Put n TX IQ samples, together with the side tone, into the TX ring buffer.
+  // The I and Q samples are taken from isample[j*stride] and qsample[j*stride]
+  // and multiplied with gain. If qsample is NULL, Q is zero.
+  //
+  ASSERT_SERVER();
+  if (!radio_is_transmitting()) { return; }
+  int zero = (device == DEVICE_HERMES_LITE2 && !hl2_audio_codec);
+  //
+  // The "CWX" method in the HL2 firmware behaves erroneously
+  // if the CW input from the KEY/PTT jack is activated.
+  // To make piHPSDR immune to this problem, the least significant
+  // bit of the I (and Q) samples are cleared.
+  // The resolution of the IQ samples is thus reduced from 16 to 15 bits,
+  // but since the HL2 DAC is 12-bit this is no problem.
+  //
+  int lsbmask = (device == DEVICE_HERMES_LITE2) ? 0xFE : 0xFF;
+  pthread_mutex_lock(&audio_mutex);
+  old_protocol_txring_mode(1);
+  for (int j = 0; j < n; j++) {
+    if (txring_count < 0) {
+      txring_count++;
+      continue;
     }
-    int iptr = txring_inptr + 8 * txring_count;
+    unsigned char *p = &TXRINGBUF[txring_inptr + 8 * txring_count];
     //
     // In P1, TX samples are signed 16-bit quantities.
     // The following conversion implicitly scales IQ samples with 0.99999,
@@ -1593,66 +1926,25 @@ void old_protocol_iq_samples(double isample, double qsample, double side) {
     //
     // Note the side tone is mono and used for left+right
     //
-    int32_t is = (int32_t)(isample * 32766.672 + 32767.5) - 32767;
-    int32_t qs = (int32_t)(qsample * 32766.672 + 32767.5) - 32767;
-    int32_t sd = (int32_t)(side    * 32766.672 + 32767.5) - 32767;
-    //
-    // The HL2 makes no use of audio samples, but instead
-    // uses them to write to extended addrs which we do not
-    // want to do un-intentionally, therefore send zeros.
-    // Note special variants of the HL2 *do* have an audio codec!
-    //
-    if (device == DEVICE_HERMES_LITE2 && !hl2_audio_codec) {
-      TXRINGBUF[iptr++] = 0;
-      TXRINGBUF[iptr++] = 0;
-      TXRINGBUF[iptr++] = 0;
-      TXRINGBUF[iptr++] = 0;
+    double q = (qsample == NULL) ? 0.0 : gain * qsample[j * stride];
+    int32_t is = (int32_t)(gain * isample[j * stride] * 32766.672 + 32767.5) - 32767;
+    int32_t qs = (int32_t)(q * 32766.672 + 32767.5) - 32767;
+    if (zero) {
+      memset(p, 0, 4);
     } else {
-      TXRINGBUF[iptr++] = (sd >> 8) & 0xFF;
-      TXRINGBUF[iptr++] = (sd     ) & 0xFF;
-      TXRINGBUF[iptr++] = (sd >> 8) & 0xFF;
-      TXRINGBUF[iptr++] = (sd     ) & 0xFF;
-    }
-    if (device == DEVICE_HERMES_LITE2) {
-      //
-      // The "CWX" method in the HL2 firmware behaves erroneously
-      // if the CW input from the KEY/PTT jack is activated.
-      // To make piHPSDR immune to this problem, the least significant
-      // bit of the I (and Q) samples are cleared.
-      // The resolution of the IQ samples is thus reduced from 16 to 15 bits,
-      // but since the HL2 DAC is 12-bit this is no problem.
-      //
-      TXRINGBUF[iptr++] = (is >> 8) & 0xFF;
-      TXRINGBUF[iptr++] = (is     ) & 0xFE;
-      TXRINGBUF[iptr++] = (qs >> 8) & 0xFF;
-      TXRINGBUF[iptr++] = (qs     ) & 0xFE;
-    } else {
-      TXRINGBUF[iptr++] = (is >> 8) & 0xFF;
-      TXRINGBUF[iptr++] = (is     ) & 0xFF;
-      TXRINGBUF[iptr++] = (qs >> 8) & 0xFF;
-      TXRINGBUF[iptr++] = (qs     ) & 0xFF;
-    }
-    txring_count++;
-    if (txring_count >= 126) {
-      int nptr = txring_inptr + 1008;
-      if (nptr >= TXRINGBUFLEN) { nptr = 0; }
-      if (nptr != txring_outptr) {
-        MEMORY_BARRIER;
-        txring_inptr = nptr;
-        MEMORY_BARRIER;
-#ifdef __APPLE__
-        sem_post(txring_sem);
-#else
-        sem_post(&txring_sem);
-#endif
-        txring_count = 0;
-      } else {
-        t_print("%s: output buffer overflow.\n", __func__);
-        txring_count = -1260;
-      }
-    }
-    pthread_mutex_unlock(&audio_mutex);
+      int32_t sd = (int32_t)(side[j] * 32766.672 + 32767.5) - 32767;
+      p[0] = (sd >> 8) & 0xFF;
+      p[1] = (sd     ) & 0xFF;
+      p[2] = (sd >> 8) & 0xFF;
+      p[3] = (sd     ) & 0xFF;
+    }
+    p[4] = (is >> 8) & 0xFF;
+    p[5] = (is     ) & lsbmask;
+    p[6] = (qs >> 8) & 0xFF;
+    p[7] = (qs     ) & lsbmask;
+    old_protocol_txring_commit(__func__);
   }
+  pthread_mutex_unlock(&audio_mutex);
 }
 
 static void ozy_send_buffer(unsigned char *buffer) {
@@ -2701,6 +2993,20 @@ static void metis_send_buffer(const unsigned char* buffer, int length) {
     //
     // UDP connection active
     //
+    if (metis_sendq != NULL) {
+      if (sendq_add(metis_sendq, buffer, length, &data_addr, sizeof(data_addr)) == 0) {
+        return;
+      }
+      //
+      // Queue full: send what is queued first, such that
+      // the packets go out in sequence-number order
+      //
+      if (sendq_flush(metis_sendq, data_socket) < 0) {
+        g_idle_add(fatal_error, "FATAL: P1 send failed (Network down?)");
+        P1running = 0;
+        return;
+      }
+    }
     int bytes_sent;
     bytes_sent = sendto(data_socket, buffer, length, 0, (struct sockaddr*)&data_addr, sizeof(data_addr));
     if (bytes_sent != length) {
@@ -23,5 +23,6 @@ extern void old_protocol_run(void);
 extern void old_protocol_init(int rate);
 extern void old_protocol_set_mic_sample_rate(int rate);
 
-extern void old_protocol_audio_samples(double left, double right);
-extern void old_protocol_iq_samples(double isample, double qsample, double side);
+extern void old_protocol_audio_block(const double *audio, int n);
+extern void old_protocol_iq_block(const double *isample, const double *qsample, int stride, const double *side,
+                                  double gain, int n);
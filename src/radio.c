@@ -43,6 +43,7 @@
 #include "g2panel.h"
 #include "gpio.h"
 #include "iambic.h"
+#include "iqfile.h"
 #include "main.h"
 #include "meter.h"
 #include "message.h"
@@ -66,6 +67,7 @@
 #endif
 #include "test_menu.h"
 #include "theme.h"
+#include "threads.h"
 #include "toolbar.h"
 #include "transmitter.h"
 #include "tts.h"
@@ -117,7 +119,7 @@ int radio_is_remote = FALSE;
 static char property_path[128];
 static GMutex property_mutex;
 
-RECEIVER *receiver[8];
+RECEIVER *receiver[MAX_RECEIVERS + 2];
 RECEIVER *active_receiver;
 TRANSMITTER *transmitter = NULL;
 
@@ -224,6 +226,14 @@ int new_pa_board = 1; // Indicates Rev.24 PA board for HERMES/ANGELIA/ORION
 int tx_fifo_underrun = 0;
 int tx_fifo_overrun = 0;
 int sequence_errors = 0;
+
+//
+// Batched UDP receive (P1 and P2, only where recvmmsg() is available):
+// maximum number of packets fetched with one system call (1 means: no
+// batching), and maximum time (in usec) spent collecting a batch.
+//
+int udp_rx_batch = 16;
+int udp_rx_batch_timeout = 2000;
 int high_swr_seen = 0;
 
 //
@@ -408,10 +418,10 @@ gboolean radio_keypress_cb(GtkWidget *widget, GdkEventKey *event, gpointer data)
   // (useful for split operation)
   //
   case  GDK_KEY_U:
-    vfo_id_step(1 - active_receiver->id, 10);
+    vfo_id_step(active_receiver->id == VFO_A ? VFO_B : VFO_A, 10);
     break;
   case  GDK_KEY_D:
-    vfo_id_step(1 - active_receiver->id, -10);
+    vfo_id_step(active_receiver->id == VFO_A ? VFO_B : VFO_A, -10);
     break;
   //
   // pressing 'm' or 'M' can now be used to open the main menu.
@@ -989,6 +999,8 @@ void radio_stop_program(void) {
   dxcluster_shutdown(); // save spots, close sqLITE
   t_print("%s: DX Cluster closed\n", __func__);
   if (!radio_is_remote) {
+    iqfile_stop_all();
+    t_print("%s: IQ files closed\n", __func__);
     radio_protocol_stop();
     t_print("%s: protocol stopped\n", __func__);
     radio_stop_radio();
@@ -1000,6 +1012,7 @@ void radio_stop_program(void) {
   }
   radio_save_state();
   t_print("%s: radio state saved\n", __func__);
+  impulse_cache_save();
 }
 
 void radio_exit_program(void) {
@@ -1520,18 +1533,39 @@ void radio_start_radio(void) {
     if (radio->soapy.rx_channels > 1) {
       RECEIVERS = 2;
     }
-    PS_TX_FEEDBACK = RECEIVERS;
-    PS_RX_FEEDBACK = RECEIVERS + 1;
     t_print("%s: setup %d receivers for SoapySDR\n", __func__, RECEIVERS);
     break;
+  case NEW_PROTOCOL:
+    //
+    // ANGELIA and beyond use DDC0/1 for PureSignal/DIVERSITY, so all
+    // but two DDCs can be used for normal receivers.
+    //
+    RECEIVERS = 2;
+    if (device == NEW_DEVICE_ANGELIA  || device == NEW_DEVICE_ORION ||
+        device == NEW_DEVICE_ORION2 || device == NEW_DEVICE_SATURN) {
+      RECEIVERS = MIN(radio->supported_receivers, MAX_DDC - 2);
+      RECEIVERS = MAX(RECEIVERS, 2);
+      RECEIVERS = MIN(RECEIVERS, MAX_RECEIVERS);
+    }
+    t_print("%s: setup %d receivers for P2\n", __func__, RECEIVERS);
+    break;
   default:
     t_print("%s: default setup for 2 receivers\n", __func__);
     RECEIVERS = 2;
-    PS_TX_FEEDBACK = (RECEIVERS);
-    PS_RX_FEEDBACK = (RECEIVERS + 1);
     break;
   }
-  receivers = RECEIVERS;
+  //
+  // The PureSignal feedback receivers use fixed slots behind the
+  // "normal" receivers, such that their (WDSP) ids do not depend
+  // on the radio
+  //
+  PS_TX_FEEDBACK = MAX_RECEIVERS;
+  PS_RX_FEEDBACK = MAX_RECEIVERS + 1;
+  //
+  // Even if the radio supports more, start with two receivers
+  // unless the props file says otherwise
+  //
+  receivers = MIN(RECEIVERS, 2);
   radio_restore_state();
   radio_change_region(region);
   radio_create_visual();
@@ -1730,30 +1764,32 @@ void radio_change_receivers(int r) {
       old_protocol_stop();
     }
   }
-  switch (r) {
-  case 1:
-    receiver[1]->displaying = 0;
-    rx_set_displaying(receiver[1]);
-    gtk_container_remove(GTK_CONTAINER(fixed), receiver[1]->panel);
-    receivers = 1;
-    break;
-  case 2:
-    gtk_fixed_put(GTK_FIXED(fixed), receiver[1]->panel, 0, 0);
-    receiver[1]->displaying = 1;
-    rx_set_displaying(receiver[1]);
-    receivers = 2;
+  //
+  // Remove the panels of receivers that are switched off, and
+  // add the panels of receivers that are switched on
+  //
+  for (int id = r; id < receivers; id++) {
+    receiver[id]->displaying = 0;
+    rx_set_displaying(receiver[id]);
+    gtk_container_remove(GTK_CONTAINER(fixed), receiver[id]->panel);
+  }
+  for (int id = receivers; id < r; id++) {
+    gtk_fixed_put(GTK_FIXED(fixed), receiver[id]->panel, 0, 0);
+    receiver[id]->displaying = 1;
+    rx_set_displaying(receiver[id]);
     //
     // Make sure RX2 shares the sample rate  with RX1 when running P1.
     //
-    if (protocol == ORIGINAL_PROTOCOL && receiver[1]->sample_rate != receiver[0]->sample_rate) {
-      rx_change_sample_rate(receiver[1], receiver[0]->sample_rate);
+    if (protocol == ORIGINAL_PROTOCOL && receiver[id]->sample_rate != receiver[0]->sample_rate) {
+      rx_change_sample_rate(receiver[id], receiver[0]->sample_rate);
     }
-    break;
   }
+  receivers = r;
   radio_reconfigure_screen();
   rx_set_active(receiver[0]);
   if (!radio_is_remote) {
     schedule_high_priority();
+    schedule_receive_specific();
     if (protocol == ORIGINAL_PROTOCOL) {
       old_protocol_run();
     }
@@ -2056,7 +2092,7 @@ void radio_set_zoom(int id, int value) {
   rx->zoom = value;
   rx_update_zoom(rx);
   g_idle_add(sliders_zoom, GINT_TO_POINTER(100 + id));
-  if (diversity_enabled && receivers > 1) {
+  if (diversity_enabled && receivers > 1 && id < 2) {
     int sid = 1 - id;
     rx = receiver[sid];
     rx->zoom = value;
@@ -2072,7 +2108,7 @@ void radio_set_pan(int id, int value) {
   rx->pan = value;
   rx_update_pan(rx);
   g_idle_add(sliders_pan, GINT_TO_POINTER(100 + id));
-  if (diversity_enabled && receivers > 1) {
+  if (diversity_enabled && receivers > 1 && id < 2) {
     int sid = 1 - id;
     rx = receiver[sid];
     rx->pan = value;
@@ -2292,7 +2328,7 @@ void radio_set_diversity(int state) {
     // the pandapters must have like sample rate, zoom, pan.
     // Enforce RX2 running the same sample rate as RX1
     //
-    if (protocol == NEW_PROTOCOL && receivers == 2 && diversity_enabled) {
+    if (protocol == NEW_PROTOCOL && receivers > 1 && diversity_enabled) {
       rx_change_sample_rate(receiver[1], receiver[0]->sample_rate);
     }
     //
@@ -3097,6 +3133,8 @@ static void radio_restore_state(void) {
   GetPropS0("radio.duckdns_host",                            duckdns_host);
   GetPropS0("radio.duckdns_token",                           duckdns_token);
   GetPropI0("radio.server_port_fwd",                         server_port_fwd);
+  GetPropI0("radio.udp_rx_batch",                            udp_rx_batch);
+  GetPropI0("radio.udp_rx_batch_timeout",                    udp_rx_batch_timeout);
 #ifdef TCI
   GetPropI0("tci_enable",                                    tci_enable);
   GetPropI0("tci_port",                                      tci_port);
@@ -3210,6 +3248,7 @@ static void radio_restore_state(void) {
   midi_restore_state();
 #endif
   dxcluster_restore_state();
+  threads_restore_state();
   t_print("%s: radio state (except receiver/transmitter) restored.\n", __func__);
   //
   // Some post-restore operations and sanity checks.
@@ -3249,6 +3288,12 @@ static void radio_restore_state(void) {
     gtk_window_move(GTK_WINDOW(top_window), window_x_pos, window_y_pos);
   }
   //
+  // Assert that the number of active receivers is within range
+  //
+  if (receivers < 1 || receivers > RECEIVERS) {
+    receivers = MIN(RECEIVERS, 2);
+  }
+  //
   // If the radio does not have 2 ADCs, there is no DIVERSITY
   //
   if (RECEIVERS < 2 || n_adc < 2) {
@@ -3321,6 +3366,8 @@ void radio_save_state(void) {
   SetPropI0("radio.hpsdr_server.listen_port",                listen_port);
   SetPropI0("radio.server_duckdns",                          server_duckdns);
   SetPropI0("radio.server_port_fwd",                         server_port_fwd);
+  SetPropI0("radio.udp_rx_batch",                            udp_rx_batch);
+  SetPropI0("radio.udp_rx_batch_timeout",                    udp_rx_batch_timeout);
   SetPropS0("radio.duckdns_host",                            duckdns_host);
   SetPropS0("radio.duckdns_token",                           duckdns_token);
 #ifdef TCI
@@ -3429,6 +3476,7 @@ void radio_save_state(void) {
   midi_save_state();
 #endif
   dxcluster_save_state();
+  threads_save_state();
   saveProperties(property_path);
   g_mutex_unlock(&property_mutex);
 }
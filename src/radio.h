@@ -216,6 +216,10 @@ extern int tx_fifo_overrun;
 extern int high_swr_seen;
 extern int sequence_errors;
 
+#define UDP_RX_BATCH_MAX 64
+extern int udp_rx_batch;
+extern int udp_rx_batch_timeout;
+
 extern unsigned int exciter_power;
 extern unsigned int alex_forward_power; // Avg
 extern unsigned int alex_forward_max;   // PEP
@@ -438,9 +438,10 @@ void radio_menu(GtkWidget *parent) {
   gtk_widget_set_halign(label, GTK_ALIGN_END);
   gtk_grid_attach(GTK_GRID(grid), label, 0, row, 1, 1);
   GtkWidget *receivers_combo = gtk_combo_box_text_new();
-  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(receivers_combo), NULL, "1");
-  if (radio->supported_receivers > 1) {
-    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(receivers_combo), NULL, "2");
+  for (int i = 1; i <= MIN(RECEIVERS, radio->supported_receivers); i++) {
+    char text[8];
+    snprintf(text, sizeof(text), "%d", i);
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(receivers_combo), NULL, text);
   }
   gtk_combo_box_set_active(GTK_COMBO_BOX(receivers_combo), receivers - 1);
   my_combo_attach(GTK_GRID(grid), receivers_combo, 1, row, 1, 1);
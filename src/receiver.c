@@ -31,6 +31,7 @@
 #include "discovered.h"
 #include "ext.h"
 #include "filter.h"
+#include "iqfile.h"
 #include "main.h"
 #include "meter.h"
 #include "message.h"
@@ -51,6 +52,7 @@
   #include "tci.h"
   #include "tci_audio.h"
 #endif
+#include "threads.h"
 #include "transmitter.h"
 #include "vfo.h"
 #include "waterfall.h"
@@ -304,6 +306,7 @@ void rx_save_state(const RECEIVER *rx) {
   if (!radio_is_remote) {
     SetPropI1("receiver.%d.smetermode", rx->id,                 rx->smetermode);
     SetPropI1("receiver.%d.low_latency", rx->id,                rx->low_latency);
+    SetPropI1("receiver.%d.dsp_pipeline", rx->id,               rx->dsp_pipeline);
     SetPropI1("receiver.%d.fft_size", rx->id,                   rx->fft_size);
     SetPropI1("receiver.%d.sample_rate", rx->id,                rx->sample_rate);
     SetPropI1("receiver.%d.filter_low", rx->id,                 rx->filter_low);
@@ -376,7 +379,12 @@ void rx_restore_state(RECEIVER *rx) {
   // For a PS_RX_FEEDBACK, we only store/restore the ADC
   // This is currently hard-wired to ADC0, but can be changed
   // by manually editing the props file.
+  // Older versions used id=3 for the PS_RX_FEEDBACK receiver, so
+  // read this one first.
   //
+  if (rx->id == PS_RX_FEEDBACK) {
+    GetPropI0("receiver.3.adc",                               rx->adc);
+  }
   GetPropI1("receiver.%d.adc", rx->id,                        rx->adc);
   if (rx->id == PS_RX_FEEDBACK) { return; }
   //
@@ -408,6 +416,7 @@ void rx_restore_state(RECEIVER *rx) {
   if (!radio_is_remote) {
     GetPropI1("receiver.%d.smetermode", rx->id,                 rx->smetermode);
     GetPropI1("receiver.%d.low_latency", rx->id,                rx->low_latency);
+    GetPropI1("receiver.%d.dsp_pipeline", rx->id,               rx->dsp_pipeline);
     GetPropI1("receiver.%d.fft_size", rx->id,                   rx->fft_size);
     GetPropI1("receiver.%d.sample_rate", rx->id,                rx->sample_rate);
     //
@@ -481,7 +490,7 @@ void rx_restore_state(RECEIVER *rx) {
     }
   }
   // Sanity Checks
-  if (n_adc == 1) { rx->adc = 0; }
+  if (n_adc == 1 || rx->adc >= n_adc) { rx->adc = 0; }
 }
 
 void rx_reconfigure(RECEIVER *rx, int height) {
@@ -540,6 +549,76 @@ void rx_reconfigure(RECEIVER *rx, int height) {
   gtk_widget_show_all(rx->panel);
 }
 
+//
+// The panadapter is rendered by a thread of its own into a second surface,
+// which is swapped with the visible one when the frame is complete. A frame
+// is requested by the display update timer, which skips (and counts) an
+// update if the previous frame has not yet been shown. The waterfall only
+// writes one row of pixels per update, this is done on the GTK thread when
+// the new frame is shown.
+//
+static int rx_render_done(gpointer data) {
+  RECEIVER *rx = (RECEIVER *)data;
+  g_mutex_lock(&rx->render_mutex);
+  if (rx->display_panadapter && rx->panadapter_back != NULL) {
+    cairo_surface_t *tmp = rx->panadapter_surface;
+    rx->panadapter_surface = rx->panadapter_back;
+    rx->panadapter_back = tmp;
+  }
+  gint64 dt = rx->render_time_last;
+  g_mutex_unlock(&rx->render_mutex);
+  if (rx->display_panadapter && rx->panadapter != NULL) {
+    rx_panadapter_messages(rx);
+    gtk_widget_queue_draw(rx->panadapter);
+  }
+  if (rx->display_waterfall) {
+    g_mutex_lock(&rx->display_mutex);
+    waterfall_update(rx);
+    g_mutex_unlock(&rx->display_mutex);
+  }
+  pacer_frame_shown(&rx->pacer);
+  rx->render_frames++;
+  rx->render_time_sum += dt;
+  rx->render_time_num++;
+  if (dt > rx->render_time_max) { rx->render_time_max = dt; }
+  rx->render_busy = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer rx_render_thread(gpointer data) {
+  RECEIVER *rx = (RECEIVER *)data;
+  for (;;) {
+    g_mutex_lock(&rx->render_mutex);
+    while (!rx->render_request) {
+      g_cond_wait(&rx->render_cond, &rx->render_mutex);
+    }
+    thread_wakeup();
+    rx->render_request = 0;
+    gint64 t0 = g_get_monotonic_time();
+    if (rx->display_panadapter && rx->panadapter_back != NULL) {
+      rx_panadapter_render(rx, rx->panadapter_back);
+    }
+    rx->render_time_last = g_get_monotonic_time() - t0;
+    g_mutex_unlock(&rx->render_mutex);
+    g_idle_add(rx_render_done, rx);
+  }
+  return NULL;
+}
+
+//
+// Frames shown and display updates skipped so far, and the average
+// and maximum render time (msec) since the previous call
+//
+void rx_get_render_stats(RECEIVER *rx, long *frames, long *dropped, double *avg, double *max) {
+  *frames = rx->render_frames;
+  *dropped = rx->render_dropped;
+  *avg = (rx->render_time_num > 0) ? 0.001 * (double)rx->render_time_sum / (double)rx->render_time_num : 0.0;
+  *max = 0.001 * (double)rx->render_time_max;
+  rx->render_time_sum = 0;
+  rx->render_time_num = 0;
+  rx->render_time_max = 0;
+}
+
 static int rx_update_display(gpointer data) {
   ASSERT_SERVER(0);
   RECEIVER *rx = (RECEIVER *)data;
@@ -569,38 +648,74 @@ static int rx_update_display(gpointer data) {
       rx->rxlvl = level;
       rxmeter_update(rx->fps, rx->rxlvl, vox_get_peak(), rx->curragc, rx->currout);
     }
-    g_mutex_lock(&rx->display_mutex);
-    rx_get_pixels(rx);
-    if (rx->pixels_available || rx->analyzer_initializing) {
-      rx->analyzer_initializing = 0;
-      if (remoteclient.running) {
-        send_rxspectrum(rx->id);
-      }
-      if (rx->display_panadapter) {
-        rx_panadapter_update(rx);
-      }
-      if (rx->display_waterfall) {
-        waterfall_update(rx);
-      }
+    if (rx->analyzer_initializing) {
+      //
+      // Draw the panadapter once even if there is no spectrum yet
+      //
+      pacer_request(&rx->pacer);
     }
-    g_mutex_unlock(&rx->display_mutex);
     return TRUE;
   }
   return FALSE;
 }
 
+//
+// The display update timer only serves the meter. The panadapter and
+// waterfall are updated through the frame pacer, that is, each time
+// the analyzer has a new spectrum, but not more often than "fps" times
+// per second.
+//
+static gboolean rx_update_spectrum(gpointer data) {
+  RECEIVER *rx = (RECEIVER *)data;
+  if (!rx->displaying || rx->pixels <= 0) {
+    return G_SOURCE_REMOVE;
+  }
+  if (rx->render_busy) {
+    //
+    // The previous frame has not yet been shown, and the
+    // render thread may still read the pixel samples
+    //
+    rx->render_dropped++;
+    return G_SOURCE_REMOVE;
+  }
+  g_mutex_lock(&rx->display_mutex);
+  rx_get_pixels(rx);
+  if (rx->pixels_available || rx->analyzer_initializing) {
+    rx->analyzer_initializing = 0;
+    if (remoteclient.running) {
+      send_rxspectrum(rx->id);
+    }
+    if (rx->display_panadapter || rx->display_waterfall) {
+      rx->render_busy = 1;
+      g_mutex_lock(&rx->render_mutex);
+      rx->render_request = 1;
+      g_cond_signal(&rx->render_cond);
+      g_mutex_unlock(&rx->render_mutex);
+    }
+  }
+  g_mutex_unlock(&rx->display_mutex);
+  return G_SOURCE_REMOVE;
+}
+
 void rx_set_displaying(RECEIVER *rx) {
   ASSERT_SERVER();
   if (rx->displaying) {
+    if (rx->render_thread == NULL) {
+      char name[32];
+      snprintf(name, sizeof(name), "RX%d render", rx->id + 1);
+      rx->render_thread = thread_new(name, THREAD_ROLE_GUI, rx_render_thread, rx);
+    }
     if (rx->update_timer_id > 0) {
       g_source_remove(rx->update_timer_id);
     }
     rx->update_timer_id = gdk_threads_add_timeout_full(G_PRIORITY_HIGH_IDLE, 1000 / rx->fps, rx_update_display, rx, NULL);
+    pacer_start(&rx->pacer, rx->id, rx->fps);
   } else {
     if (rx->update_timer_id > 0) {
       g_source_remove(rx->update_timer_id);
       rx->update_timer_id = 0;
     }
+    pacer_stop(&rx->pacer);
   }
 }
 
@@ -667,6 +782,8 @@ RECEIVER *rx_create_pure_signal_receiver(int id, int sample_rate, int width, int
     rx_restore_state(rx);  // this may change the adc
     g_mutex_init(&rx->mutex);
     g_mutex_init(&rx->display_mutex);
+    g_mutex_init(&rx->render_mutex);
+    g_cond_init(&rx->render_cond);
     rx->sample_rate = sample_rate;
     rx->fps = fps;
     rx->width = width;
@@ -711,6 +828,9 @@ RECEIVER *rx_create_receiver(int id, int width, int height) {
   rx->id = id;
   g_mutex_init(&rx->mutex);
   g_mutex_init(&rx->display_mutex);
+  g_mutex_init(&rx->render_mutex);
+  g_cond_init(&rx->render_cond);
+  pacer_init(&rx->pacer, rx_update_spectrum, rx);
   switch (id) {
   case 0:
     rx->adc = 0;
@@ -758,11 +878,13 @@ RECEIVER *rx_create_receiver(int id, int width, int height) {
   rx->dsp_size = 2048;
   rx->fft_size = 2048;
   rx->low_latency = 0;
+  rx->dsp_pipeline = 0;
   rx->smetermode = SMETER_AVERAGE;
   rx->fps = 10;
   rx->update_timer_id = 0;
   rx->width = width;
   rx->afft_size = 16384;
+  rx->afft_decim = 1;
   rx->height = height;
   rx->samples = 0;
   rx->displaying = 0;
@@ -958,6 +1080,10 @@ RECEIVER *rx_create_receiver(int id, int width, int height) {
   rx_set_equalizer(rx);
   rx_mode_changed(rx);   // this will call rx_filter_changed() as well
   rx_create_analyzer(rx);
+  if (dsp_profiling) {
+    SetChannelProfile(rx->id, 1);
+    SetAnalyzerProfile(rx->id, 1);
+  }
   rx_set_detector(rx);
   rx_set_average(rx);
   rx_create_visual(rx);
@@ -1090,7 +1216,11 @@ void rx_vfo_changed(RECEIVER *rx) {
 //////////////////////////////////////////////////////////////////////////////////////
 //
 // rx_add_iq_samples (rx_add_div_iq_samples),  rx_full_buffer, and rx_process_buffer
-// form the "RX engine".
+// form the "RX engine". rx_add_iq_block (rx_add_div_iq_block) are the
+// block versions of rx_add_iq_samples (rx_add_div_iq_samples), these should be
+// used by the protocol backends whenever a whole packet of IQ samples is available.
+// rx_feed_iq_block is the part of rx_add_iq_block that bypasses IQ file
+// recording and playback, it is called by the IQ file player.
 //
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -1136,6 +1266,12 @@ static void rx_process_buffer(RECEIVER *rx) {
   lvl = 0.9 * lvl + (0.1 * sum) / rx->output_samples;
   t_print("RX lvl: %5.1f\n", 10.0 * log10(lvl));
 #endif
+  //
+  // P1 audio samples to the radio are collected here and
+  // put into the TX ring buffer as a whole.
+  //
+  int p1audio = (rx == active_receiver && protocol == ORIGINAL_PROTOCOL);
+  double p1buffer[p1audio ? 2 * rx->output_samples : 1];
   for (int i = 0; i < rx->output_samples; i++) {
     double left_sample = rx->audio_output_buffer[i * 2];
     double right_sample = rx->audio_output_buffer[(i * 2) + 1];
@@ -1208,7 +1344,8 @@ static void rx_process_buffer(RECEIVER *rx) {
     if (rx == active_receiver) {
       switch (protocol) {
       case ORIGINAL_PROTOCOL:
-        old_protocol_audio_samples(left_sample, right_sample);
+        p1buffer[2 * i    ] = left_sample;
+        p1buffer[2 * i + 1] = right_sample;
         break;
       case NEW_PROTOCOL:
         new_protocol_audio_samples(left_sample, right_sample);
@@ -1218,6 +1355,9 @@ static void rx_process_buffer(RECEIVER *rx) {
       }
     }
   }
+  if (p1audio) {
+    old_protocol_audio_block(p1buffer, rx->output_samples);
+  }
 }
 
 static void rx_full_buffer(RECEIVER *rx) {
@@ -1260,6 +1400,14 @@ static void rx_full_buffer(RECEIVER *rx) {
 void rx_add_iq_samples(RECEIVER *rx, double i_sample, double q_sample) {
   ASSERT_SERVER();
   //
+  // While an IQ file is played into this receiver,
+  // discard the samples from the radio.
+  //
+  if (rx->id < MAX_RECEIVERS && iqplay_active[rx->id]) {
+    iqplay_ack[rx->id] = 1;
+    return;
+  }
+  //
   // At the end of a TX/RX transition, txrxcount is set to zero,
   // and txrxmax to some suitable value.
   // Then, the first txrxmax RXIQ samples are "silenced"
@@ -1284,6 +1432,73 @@ void rx_add_iq_samples(RECEIVER *rx, double i_sample, double q_sample) {
   }
 }
 
+void rx_add_iq_block(RECEIVER *rx, const double *iq, int n) {
+  ASSERT_SERVER();
+  //
+  // Entry point for blocks of IQ samples from the radio.
+  // If an IQ file is being played into this receiver, the
+  // data is discarded (and this is acknowledged to the player).
+  // If the receiver is being recorded, the data is also passed
+  // to the recorder.
+  //
+  if (rx->id < MAX_RECEIVERS) {
+    if (iqplay_active[rx->id]) {
+      iqplay_ack[rx->id] = 1;
+      return;
+    }
+    if (iqrec_active[rx->id]) { iqrec_add_block(rx, iq, n); }
+  }
+  rx_feed_iq_block(rx, iq, n);
+}
+
+void rx_feed_iq_block(RECEIVER *rx, const double *iq, int n) {
+  ASSERT_SERVER();
+  //
+  // Block version of rx_add_iq_samples(): iq contains n interleaved
+  // IQ sample pairs that are copied into the RX input buffer in
+  // (at most) a few memcpy() calls, splitting only when the input
+  // buffer is full.
+  // The TX/RX "silencing" (see rx_add_iq_samples) is applied
+  // to whole ranges.
+  //
+  while (n > 0) {
+    int chunk = rx->buffer_size - rx->samples;
+    if (chunk > n) { chunk = n; }
+    double *dst = rx->iq_input_buffer + 2 * rx->samples;
+    int silence = rx->txrxmax - rx->txrxcount;
+    if (silence > 0) {
+      if (silence > chunk) { silence = chunk; }
+      memset(dst, 0, 2 * silence * sizeof(double));
+      rx->txrxcount += silence;
+    } else {
+      silence = 0;
+    }
+    memcpy(dst + 2 * silence, iq + 2 * silence, 2 * (chunk - silence) * sizeof(double));
+    iq += 2 * chunk;
+    n -= chunk;
+    rx->samples += chunk;
+    if (rx->samples >= rx->buffer_size) {
+      rx_full_buffer(rx);
+      rx->samples = 0;
+    }
+  }
+}
+
+void rx_add_div_iq_block(RECEIVER *rx, const double *iq0, const double *iq1, int n) {
+  ASSERT_SERVER();
+  //
+  // Block version of rx_add_div_iq_samples()
+  //
+  double iq[2 * n];
+  for (int i = 0; i < n; i++) {
+    double i1 = iq1[2 * i];
+    double q1 = iq1[2 * i + 1];
+    iq[2 * i    ] = iq0[2 * i    ] + (div_cos * i1 - div_sin * q1);
+    iq[2 * i + 1] = iq0[2 * i + 1] + (div_sin * i1 + div_cos * q1);
+  }
+  rx_add_iq_block(rx, iq, n);
+}
+
 void rx_add_div_iq_samples(RECEIVER *rx, double i0, double q0, double i1, double q1) {
   ASSERT_SERVER();
   //
@@ -1300,11 +1515,13 @@ void rx_update_width(RECEIVER *rx) {
   // This is called when the display width changes
   // CALL THIS ONLY with rx->display_mutex locked.
   //
+  g_mutex_lock(&rx->render_mutex);
   rx->pixels = rx->width;
   if (rx->pixel_samples != NULL) {
     g_free(rx->pixel_samples);
   }
   rx->pixel_samples = g_new(float, rx->pixels);
+  g_mutex_unlock(&rx->render_mutex);
   if (!radio_is_remote) {
     rx_set_analyzer(rx);
   }
@@ -1532,10 +1749,31 @@ void rx_create_analyzer(RECEIVER *rx) {
   if (rc != 0) {
     t_print("CreateAnalyzer failed for RXid=%d\n", rx->id);
   } else {
+    rx->analyzer_fft_size = 0;
     rx_set_analyzer(rx);
   }
 }
 
+static void rx_set_display_norm(const RECEIVER *rx) {
+  //
+  // The spectrum is normalized to a "bin width" of sample_rate / afft_size,
+  // which is smaller than the frequency width of one pixel which is sample_rate / (width * zoom).
+  //
+  // A normalization to "1 pixel" is accomplished with the following two calls. Note the noise
+  // floor then depends on the zoom factor (that is, the frequency width of one pixel)
+  //
+  // In effect, this "lifts" the spectrum (in dB) by 10*log10(afft_size/(width*zoom)).
+  //
+  // One can also normalise to 1 Hz,in the case the second parameter to SetDisplaySampleRate
+  // must be (the true) rx->sample_rate, then WDSP adds 10*log10(afft_size/sample_rate) which
+  // normally means the spectrum is down-shifted quite a bit.
+  //
+  if (rx->id != PS_RX_FEEDBACK) {
+    SetDisplayNormOneHz(rx->id, 0, 1);
+    SetDisplaySampleRate(rx->id, rx->width * rx->zoom / rx->afft_decim);
+  }
+}
+
 void rx_set_analyzer(RECEIVER *rx) {
   ASSERT_SERVER();
   //
@@ -1545,6 +1783,10 @@ void rx_set_analyzer(RECEIVER *rx) {
   // So rx_set_analyzer() has to be called whenever fps, pixels,
   // or sample_rate change in rx
   //
+  // If only the pan (or the zoom, but not the FFT size and the decimation)
+  // changes, the running analyzer is just re-clipped. This keeps its input
+  // buffers and averaging history, so the spectrum moves without a gap.
+  //
   int flp[] = {0};
   const double keep_time = 0.1;
   const int n_pixout = 1;
@@ -1562,6 +1804,9 @@ void rx_set_analyzer(RECEIVER *rx) {
   const int pixels = rx->pixels;
   int overlap;
   int max_w;
+  int fft_size;
+  double zoom_shift = 0.0;
+  rx->afft_decim = 1;
   if (rx->id == PS_RX_FEEDBACK) {
     //
     // RX FEEDBACK receiver:
@@ -1569,48 +1814,73 @@ void rx_set_analyzer(RECEIVER *rx) {
     // spectrum thus have to clip off. The sample rate of this rx will
     // be about 192k (zoom = 8), so a fixed width of 16k is fine.
     //
-    rx->afft_size = 16384;
-    fscLin = rx->afft_size * (0.5 - 12000.0 / rx->sample_rate);
-    fscHin = rx->afft_size * (0.5 - 12000.0 / rx->sample_rate);
+    fft_size = 16384;
+    fscLin = fft_size * (0.5 - 12000.0 / rx->sample_rate);
+    fscHin = fft_size * (0.5 - 12000.0 / rx->sample_rate);
   } else {
+    rx->cA  = rx->sample_rate * ((0.005 - 0.005 / rx->zoom) * (rx->pan + 100) - 0.5);
+    rx->cB  = (double)rx->sample_rate / (double)(rx->width * rx->zoom); // Hz per pixel
+    rx->cAp = 1.0 / rx->cB;
+    rx->cBp = -rx->cA / rx->cB;
     //
-    // determine clippings accordint to the Zoom/Pan values
+    // From zoom factor 4 on, the analyzer runs in "zoom mode": it shifts the
+    // centre of the visible span to zero frequency, and decimates by afft_decim
+    // (a power of two not exceeding zoom/2) before doing the FFT. Thus the FFT
+    // size need not grow with the zoom factor, and there are still at least
+    // two bins per pixel.
     //
-    rx->afft_size = rx->width * rx->zoom;
+    while (4 * rx->afft_decim <= rx->zoom && rx->buffer_size % (2 * rx->afft_decim) == 0) {
+      rx->afft_decim *= 2;
+    }
     //
     // For a screen width of 4k pixels, and zoom factor of 32,
     // this can go up to 128k. The program limits this to 256k
     //
-    if (rx->afft_size <= 16384) {
-      rx->afft_size = 16384;
-    } else if (rx->afft_size <= 32768) {
-      rx->afft_size = 32768;
-    } else if (rx->afft_size <= 65536) {
-      rx->afft_size = 65536;
-    } else if (rx->afft_size <= 131072) {
-      rx->afft_size = 131072;
+    int n = rx->width * rx->zoom / rx->afft_decim;
+    fft_size = rx->afft_decim > 1 ? 1024 : 16384;
+    while (fft_size < n && fft_size < 262144) {
+      fft_size *= 2;
+    }
+    //
+    // determine clippings according to the Zoom/Pan values
+    //
+    double zz = fft_size * (1.0 - (double) rx->afft_decim / rx->zoom);
+    if (rx->afft_decim > 1) {
+      fscLin = 0.5 * zz;
+      fscHin = 0.5 * zz;
+      zoom_shift = (rx->cA + 0.5 * rx->sample_rate / rx->zoom) / rx->sample_rate;
     } else {
-      rx->afft_size = 262144;
+      double pl = 0.005 * (rx->pan + 100);
+      double pr = 1.0 - pl;
+      fscLin = pl * zz;
+      fscHin = pr * zz;
     }
-    double zz = rx->afft_size * (1.0 - 1.0 / rx->zoom);
-    double pl = 0.005 * (rx->pan + 100);
-    double pr = 1.0 - pl;
-    fscLin = pl * zz;
-    fscHin = pr * zz;
-    rx->cA  = rx->sample_rate * ((0.005 - 0.005 / rx->zoom) * (rx->pan + 100) - 0.5);
-    rx->cB  = (double)rx->sample_rate / (double)(rx->width * rx->zoom); // Hz per pixel
-    rx->cAp = 1.0 / rx->cB;
-    rx->cBp = -rx->cA / rx->cB;
   }
-  max_w = rx->afft_size + (int) min(keep_time * (double) rx->sample_rate,
-                                    keep_time * (double) rx->afft_size * (double) rx->fps);
-  overlap = (int)fmax(0.0, ceil(rx->afft_size - (double)rx->sample_rate / (double)rx->fps));
+  //
+  // afft_size is the size of an FFT without decimation that has the same bin width
+  //
+  rx->afft_size = fft_size * rx->afft_decim;
+  double fft_rate = (double) rx->sample_rate / rx->afft_decim;
+  max_w = fft_size + (int) min(keep_time * fft_rate, keep_time * (double) fft_size * (double) rx->fps);
+  overlap = (int)fmax(0.0, ceil(fft_size - fft_rate / (double)rx->fps));
+  if (fft_size == rx->analyzer_fft_size && rx->afft_decim == rx->analyzer_decim && pixels == rx->analyzer_pixels
+      && rx->sample_rate == rx->analyzer_rate && rx->fps == rx->analyzer_fps) {
+    SetAnalyzerPan(rx->id, fscLin, fscHin, zoom_shift);
+    rx_set_display_norm(rx);
+    return;
+  }
+  rx->analyzer_fft_size = fft_size;
+  rx->analyzer_decim = rx->afft_decim;
+  rx->analyzer_pixels = pixels;
+  rx->analyzer_rate = rx->sample_rate;
+  rx->analyzer_fps = rx->fps;
+  SetAnalyzerZoom(rx->id, rx->afft_decim, zoom_shift);
   SetAnalyzer(rx->id,
               n_pixout,
               spur_elimination_ffts,                // number of LO frequencies = number of ffts used in elimination
               data_type,                            // 0 for real input data (I only); 1 for complex input data (I & Q)
               flp,                                  // vector with one element for each LO frequency, 1 if high-side LO, 0 otherwise
-              rx->afft_size,                        // size of the fft, i.e., number of input samples
+              fft_size,                             // size of the fft, i.e., number of input samples
               rx->buffer_size,                      // number of samples transferred for each OpenBuffer()/CloseBuffer()
               window_type,                          // integer specifying which window function to use
               kaiser_pi,                            // PiAlpha parameter for Kaiser window
@@ -1625,23 +1895,7 @@ void rx_set_analyzer(RECEIVER *rx) {
               span_max_freq,                        // frequency at last pixel value
               max_w                                 // max samples to hold in input ring buffers
              );
-  //
-  // The spectrum is normalized to a "bin width" of sample_rate / afft_size,
-  // which is smaller than the frequency width of one pixel which is sample_rate / (width * zoom).
-  //
-  // A normalization to "1 pixel" is accomplished with the following two calls. Note the noise
-  // floor then depends on the zoom factor (that is, the frequency width of one pixel)
-  //
-  // In effect, this "lifts" the spectrum (in dB) by 10*log10(afft_size/(width*zoom)).
-  //
-  // One can also normalise to 1 Hz,in the case the second parameter to SetDisplaySampleRate
-  // must be (the true) rx->sample_rate, then WDSP adds 10*log10(afft_size/sample_rate) which
-  // normally means the spectrum is down-shifted quite a bit.
-  //
-  if (rx->id != PS_RX_FEEDBACK) {
-    SetDisplayNormOneHz(rx->id, 0, 1);
-    SetDisplaySampleRate(rx->id, rx->width * rx->zoom);
-  }
+  rx_set_display_norm(rx);
   rx->analyzer_initializing = 1;
 }
 
@@ -1994,6 +2248,7 @@ void rx_set_fft_params(RECEIVER *rx) {
   }
   RXASetNC(rx->id, rx->fft_size);
   RXASetMP(rx->id, rx->low_latency);
+  SetRXAPipeline(rx->id, rx->dsp_pipeline);
   RXANBPSetWindow(rx->id, rx->nbp_window);
   //
   // Increase notch widths if they are too small
@@ -32,6 +32,14 @@
 #endif
 
 #include "atomic.h"
+#include "frame_pacer.h"
+
+//
+// Maximum number of "normal" receivers. This is limited by the number
+// of WDSP RX channels (CHANNEL_RX0 ... CHANNEL_RX7). The two PureSignal
+// feedback receivers use the slots behind these.
+//
+#define MAX_RECEIVERS 8
 
 enum _audio_channel_enum {
   STEREO = 0,
@@ -53,6 +61,7 @@ typedef struct _receiver {
   int buffer_size;
   int fft_size;
   int low_latency;
+  int dsp_pipeline;             // run the RX chain on two threads
 
   int agc;
   double agc_gain;
@@ -186,7 +195,17 @@ typedef struct _receiver {
 
   int width;
   int height;
-  int afft_size;  // FFT size of the display analyzer
+  int afft_size;  // FFT size of the display analyzer (without decimation)
+  int afft_decim; // decimation of the display analyzer (zoom mode)
+  //
+  // analyzer parameters of the last complete re-initialisation. Pan and zoom
+  // changes that leave them unchanged only re-clip the running analyzer.
+  //
+  int analyzer_fft_size;
+  int analyzer_decim;
+  int analyzer_pixels;
+  int analyzer_rate;
+  int analyzer_fps;
 
   GtkWidget *panel;
   GtkWidget *panadapter;
@@ -207,7 +226,21 @@ typedef struct _receiver {
   int waterfall_automatic;
   int waterfall_percent;
   cairo_surface_t *panadapter_surface;
-  GdkPixbuf *pixbuf;
+  cairo_surface_t *panadapter_back;       // surface the render thread draws the next frame into
+  GThread *render_thread;                 // renders the panadapter off the GTK thread
+  GMutex render_mutex;                    // held by the render thread while drawing
+  GCond render_cond;                      // signals a render request
+  int render_request;                     // a new frame is to be rendered
+  int render_busy;                        // set from the render request until the frame is shown
+  gint64 render_time_last;                // render time of the last frame (usec)
+  gint64 render_time_sum;                 // sum of render times since last rx_get_render_stats()
+  gint64 render_time_max;                 // max. render time since last rx_get_render_stats()
+  int render_time_num;                    // number of frames in render_time_sum
+  long render_frames;                     // number of frames shown
+  long render_dropped;                    // number of display updates skipped since a frame was still rendered
+  FRAME_PACER pacer;                      // schedules a display update for each new spectrum
+  cairo_surface_t *waterfall_surface;     // ring of waterfall rows
+  int waterfall_head;                     // row of the waterfall surface holding the newest line
   int mute_when_not_active;
 
   //
@@ -333,6 +366,9 @@ extern gboolean rx_scroll_event(GtkWidget *widget, const GdkEventScroll *event,
 
 extern void   rx_add_iq_samples(RECEIVER *rx, double i_sample, double q_sample);
 extern void   rx_add_div_iq_samples(RECEIVER *rx, double i0, double q0, double i1, double q1);
+extern void   rx_add_iq_block(RECEIVER *rx, const double *iq, int n);
+extern void   rx_add_div_iq_block(RECEIVER *rx, const double *iq0, const double *iq1, int n);
+extern void   rx_feed_iq_block(RECEIVER *rx, const double *iq, int n);
 
 extern void   rx_change_sample_rate(RECEIVER *rx, int sample_rate);
 extern void   rx_change_adc(const RECEIVER *rx);
@@ -363,6 +399,7 @@ extern void   rx_set_detector(const RECEIVER *rx);
 extern void   rx_set_deviation(const RECEIVER *rx);
 extern void   rx_set_sam_mode(const RECEIVER *rx);
 extern void   rx_set_displaying(RECEIVER *rx);
+extern void   rx_get_render_stats(RECEIVER *rx, long *frames, long *dropped, double *avg, double *max);
 extern void   rx_set_equalizer(RECEIVER *rx);
 extern void   rx_set_fm_limiter(const RECEIVER *rx);
 extern void   rx_set_fft_params(RECEIVER *rx);
@@ -51,14 +51,24 @@ static gboolean panadapter_configure_event_cb (GtkWidget *widget, GdkEventConfig
   RECEIVER *rx = (RECEIVER *)data;
   int mywidth = gtk_widget_get_allocated_width (widget);
   int myheight = gtk_widget_get_allocated_height (widget);
+  //
+  // The render thread draws into the "back" surface, so it must
+  // not be active while the surfaces are replaced
+  //
+  g_mutex_lock(&rx->render_mutex);
   if (rx->panadapter_surface) {
     cairo_surface_destroy (rx->panadapter_surface);
   }
+  if (rx->panadapter_back) {
+    cairo_surface_destroy (rx->panadapter_back);
+  }
   rx->panadapter_surface = cairo_image_surface_create (CAIRO_FORMAT_RGB24, mywidth, myheight);
+  rx->panadapter_back = cairo_image_surface_create (CAIRO_FORMAT_RGB24, mywidth, myheight);
   cairo_t *cr = cairo_create(rx->panadapter_surface);
   cairo_set_source_rgba(cr, COLOUR_PAN_BACKGND);
   cairo_paint(cr);
   cairo_destroy(cr);
+  g_mutex_unlock(&rx->render_mutex);
   return TRUE;
 }
 
@@ -117,67 +127,195 @@ static gboolean panadapter_scroll_event_cb(GtkWidget *widget, GdkEventScroll *ev
 
 void rx_panadapter_update(RECEIVER *rx) {
   if (!rx || !rx->panadapter_surface) { return; }
-  float *samples;
-  cairo_text_extents_t extents;
-  long long f;
-  long long divisor;
+  rx_panadapter_render(rx, rx->panadapter_surface);
+  rx_panadapter_messages(rx);
+  gtk_widget_queue_draw (rx->panadapter);
+}
+
+//
+// The alarm messages keep their state in static counters and clear global
+// flags, so they are drawn on the GTK thread (like the TX panadapter does),
+// onto the surface about to be shown, not by the render thread.
+//
+void rx_panadapter_messages(RECEIVER *rx) {
+  if (rx->id != 0 || rx->panadapter_surface == NULL) { return; }
+  cairo_t *cr = cairo_create (rx->panadapter_surface);
+  cairo_select_font_face(cr, DISPLAY_FONT_FACE, CAIRO_FONT_SLANT_NORMAL,
+                         remoteclient.running ? CAIRO_FONT_WEIGHT_NORMAL : CAIRO_FONT_WEIGHT_BOLD);
+  display_panadapter_messages(cr, cairo_image_surface_get_width (rx->panadapter_surface), rx->fps);
+  cairo_destroy (cr);
+}
+
+//
+// Everything below the spectrum (background, 60m channels, filter, grid and
+// frequency labels, band edges, notches, AGC lines and cursor) only changes
+// when tuning, zooming or changing a setting. It is drawn into a layer that
+// is kept for each receiver, and only re-drawn if one of the parameters it is
+// drawn from has changed. In all other frames, it is just copied.
+//
+// All parameters of the layer are collected in a PAN_KEY, and the layer is
+// drawn from the key (not from the receiver) such that it always matches it.
+//
+#define PAN_MAX_CHANNELS UK_CHANNEL_ENTRIES
+
+typedef struct _pan_key {
+  const THEME *theme;
+  CHANNEL channels[PAN_MAX_CHANNELS];
+  int channel_entries;
+  int font;
+  char remote_addr[64];
+  long long frequency;
+  long long frequency_min;
+  long long frequency_max;
+  long long offset;
+  int mode;
+  int vfoband;
+  int active;
+  int remote;
+  int width;
+  int height;
+  int rx_width;
+  int pixels;
+  int sample_rate;
+  int panhi;
+  int panlo;
+  int step;
+  int filter_low;
+  int filter_high;
+  int sidetone;
+  int agc;
+  int notch_enable[3];
+  double notch_center[3];
+  double notch_width[3];
+  double agc_thresh;
+  double agc_hang;
   double soffset;
-  int active = (active_receiver == rx);
-  int mywidth = gtk_widget_get_allocated_width (rx->panadapter);
-  int myheight = gtk_widget_get_allocated_height (rx->panadapter);
-  double scalfac = sqrt(mywidth * 0.00125);
-  samples = rx->pixel_samples;
-  cairo_t *cr;
-  cr = cairo_create (rx->panadapter_surface);
-  cairo_set_source_rgba(cr, COLOUR_PAN_BACKGND);
-  cairo_rectangle(cr, 0, 0, mywidth, myheight);
-  cairo_fill(cr);
-  int mode = vfo[rx->id].mode;
-  long long frequency = vfo[rx->id].frequency;
-  int vfoband = vfo[rx->id].band;
-  double xoffset;
+  double cA;
+  double cB;
+  double cAp;
+  double cBp;
+} PAN_KEY;
+
+typedef struct _pan_layer {
+  cairo_surface_t *surface;
+  PAN_KEY key;
+} PAN_LAYER;
+
+static PAN_LAYER pan_layer[MAX_RECEIVERS];
+
+static void pan_get_key(const RECEIVER *rx, PAN_KEY *k, int width, int height) {
+  //
+  // clear the padding as well, since keys are compared with memcmp
+  //
+  memset(k, 0, sizeof(PAN_KEY));
+  k->theme = theme_get_active();
+  k->mode = vfo[rx->id].mode;
+  k->frequency = vfo[rx->id].frequency;
+  k->vfoband = vfo[rx->id].band;
+  k->offset = vfo[rx->id].offset;
   //
   // soffset contains all corrections for attenuation and preamps
   // Perhaps some adjustment is necessary for those old radios which have
   // switchable preamps.
   //
-  const BAND *band = band_get_band(vfoband);
+  const BAND *band = band_get_band(k->vfoband);
   int calib = rx_gain_calibration - band->gaincalib;
-  soffset = (double) calib + (double)adc[rx->adc].attenuation - adc[rx->adc].gain;
+  k->soffset = (double) calib + (double)adc[rx->adc].attenuation - adc[rx->adc].gain;
   if (filter_board == ALEX && rx->adc == 0) {
-    soffset += (double)(10 * adc[0].alex_attenuation);
+    k->soffset += (double)(10 * adc[0].alex_attenuation);
   }
   if (filter_board == CHARLY25 && rx->adc == 0) {
-    soffset += (double)(12 * adc[0].alex_attenuation - 18 * (adc[0].preamp + adc[0].dither));
+    k->soffset += (double)(12 * adc[0].alex_attenuation - 18 * (adc[0].preamp + adc[0].dither));
   }
   if (have_preamp && filter_board != CHARLY25) {
-    soffset -= (double)(20 * adc[rx->adc].preamp);
+    k->soffset -= (double)(20 * adc[rx->adc].preamp);
   }
+  k->frequency_min = band->frequencyMin;
+  k->frequency_max = band->frequencyMax;
   // In diversity mode, the RX2 frequency tracks the RX1 frequency
   if (diversity_enabled && rx->id == 1) {
-    frequency = vfo[0].frequency;
-    vfoband = vfo[0].band;
-    mode = vfo[0].mode;
+    k->frequency = vfo[0].frequency;
+    k->vfoband = vfo[0].band;
+    k->mode = vfo[0].mode;
+  }
+  if (k->vfoband == band60) {
+    k->channel_entries = MIN(channel_entries, PAN_MAX_CHANNELS);
+    memcpy(k->channels, band_channels_60m, k->channel_entries * sizeof(CHANNEL));
+  }
+  k->font = which_css_font;
+  k->active = (active_receiver == rx);
+  k->remote = remoteclient.running && rx->id == 0;
+  if (k->remote) {
+    inet_ntop(AF_INET, &(((struct sockaddr_in *)&remoteclient.address)->sin_addr), k->remote_addr,
+              sizeof(k->remote_addr));
+  }
+  k->width = width;
+  k->height = height;
+  k->rx_width = rx->width;
+  k->pixels = rx->pixels;
+  k->sample_rate = rx->sample_rate;
+  k->panhi = rx->panadapter_high;
+  k->panlo = rx->panadapter_low;
+  k->step = rx->panadapter_step;
+  k->filter_low = rx->filter_low;
+  k->filter_high = rx->filter_high;
+  k->sidetone = cw_keyer_sidetone_frequency;
+  k->agc = rx->agc;
+  k->agc_thresh = rx->agc_thresh;
+  k->agc_hang = rx->agc_hang;
+  for (int i = 0; i < 3; i++) {
+    k->notch_enable[i] = rx->multi_notch_enable[i];
+    if (k->notch_enable[i]) {
+      k->notch_center[i] = rx->multi_notch_center[i];
+      k->notch_width[i] = rx->multi_notch_width[i];
+    }
   }
-  xoffset = rx->cAp * vfo[rx->id].offset;
-  double rxpos = rx->cBp + xoffset;
-  double filter_left  = rx->cAp * rx->filter_low  + xoffset + rx->cBp;
-  double filter_right = rx->cAp * rx->filter_high + xoffset + rx->cBp;
-  if (mode == modeCWU) {
-    filter_left  -= cw_keyer_sidetone_frequency * rx->cAp;
-    filter_right -= cw_keyer_sidetone_frequency * rx->cAp;
-  } else if (mode == modeCWL) {
-    filter_left  += cw_keyer_sidetone_frequency * rx->cAp;
-    filter_right += cw_keyer_sidetone_frequency * rx->cAp;
+  k->cA = rx->cA;
+  k->cB = rx->cB;
+  k->cAp = rx->cAp;
+  k->cBp = rx->cBp;
+}
+
+static void pan_filter_edges(const PAN_KEY *k, double *left, double *right) {
+  double xoffset = k->cAp * k->offset;
+  *left  = k->cAp * k->filter_low  + xoffset + k->cBp;
+  *right = k->cAp * k->filter_high + xoffset + k->cBp;
+  if (k->mode == modeCWU) {
+    *left  -= k->sidetone * k->cAp;
+    *right -= k->sidetone * k->cAp;
+  } else if (k->mode == modeCWL) {
+    *left  += k->sidetone * k->cAp;
+    *right += k->sidetone * k->cAp;
   }
+}
+
+static void pan_draw_layer(const PAN_KEY *k, cairo_surface_t *surface) {
+  cairo_text_extents_t extents;
+  long long f;
+  long long divisor;
+  double filter_left, filter_right;
+  int active = k->active;
+  int mywidth = k->width;
+  int myheight = k->height;
+  double scalfac = sqrt(mywidth * 0.00125);
+  long long frequency = k->frequency;
+  int vfoband = k->vfoband;
+  double soffset = k->soffset;
+  double rxpos = k->cBp + k->cAp * k->offset;
+  cairo_t *cr;
+  cr = cairo_create (surface);
+  cairo_set_source_rgba(cr, COLOUR_PAN_BACKGND);
+  cairo_rectangle(cr, 0, 0, mywidth, myheight);
+  cairo_fill(cr);
+  pan_filter_edges(k, &filter_left, &filter_right);
   if (vfoband == band60) {
-    for (int i = 0; i < channel_entries; i++) {
-      long long low_freq = band_channels_60m[i].frequency - (band_channels_60m[i].width / (long long)2);
-      long long hi_freq = band_channels_60m[i].frequency + (band_channels_60m[i].width / (long long)2);
-      double x1 = rx->cBp + (low_freq - frequency) * rx->cAp;
-      double x2 = rx->cBp + (hi_freq - frequency) * rx->cAp;
+    for (int i = 0; i < k->channel_entries; i++) {
+      long long low_freq = k->channels[i].frequency - (k->channels[i].width / (long long)2);
+      long long hi_freq = k->channels[i].frequency + (k->channels[i].width / (long long)2);
+      double x1 = k->cBp + (low_freq - frequency) * k->cAp;
+      double x2 = k->cBp + (hi_freq - frequency) * k->cAp;
       if (x1 < 0.0) { x1 = 0.0; }
-      if (x2 > rx->width) { x2 = rx->width; }
+      if (x2 > k->rx_width) { x2 = k->rx_width; }
       if (x2 - x1 > 1.0) {
         cairo_set_source_rgba(cr, COLOUR_PAN_60M);
         cairo_rectangle(cr, x1, 0.0, x2 - x1, myheight);
@@ -197,15 +335,15 @@ void rx_panadapter_update(RECEIVER *rx) {
   } else {
     cairo_set_source_rgba(cr, COLOUR_PAN_LINE_WEAK);
   }
-  int panhi = rx->panadapter_high;
-  int panlo = rx->panadapter_low;
+  int panhi = k->panhi;
+  int panlo = k->panlo;
   double dbm_per_line = (double)myheight / ((double)(panhi - panlo));
   cairo_set_line_width(cr, PAN_LINE_THIN);
-  cairo_select_font_face(cr, DISPLAY_FONT_FACE, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+  cairo_select_font_face(cr, cssfont[k->font], CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
   cairo_set_font_size(cr, 12.0 * scalfac);
   char v[32];
   for (int i = panhi; i >= panlo; i--) {
-    int mod = abs(i) % rx->panadapter_step;
+    int mod = abs(i) % k->step;
     if (mod == 0) {
       double y = (double)(panhi - i) * dbm_per_line;
       cairo_move_to(cr, 0.0, y);
@@ -223,7 +361,7 @@ void rx_panadapter_update(RECEIVER *rx) {
   // pixels distance between frequency markers,
   // and then round upwards to the  next 1/2/5 seris
   //
-  divisor = 65 * scalfac * rx->cB;
+  divisor = 65 * scalfac * k->cB;
   if (divisor > 500000LL) { divisor = 1000000LL; }
   else if (divisor > 200000LL) { divisor = 500000LL; }
   else if (divisor > 100000LL) { divisor = 200000LL; }
@@ -238,9 +376,9 @@ void rx_panadapter_update(RECEIVER *rx) {
   // Calculate the actual distance of frequency markers
   // (in pixels)
   //
-  int marker_distance = (rx->pixels * divisor) / rx->sample_rate;
-  f = (((frequency + (int)(rx->cA + 0.5)) / divisor) * divisor);
-  cairo_select_font_face(cr, DISPLAY_FONT_FACE, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+  int marker_distance = (k->pixels * divisor) / k->sample_rate;
+  f = (((frequency + (int)(k->cA + 0.5)) / divisor) * divisor);
+  cairo_select_font_face(cr, cssfont[k->font], CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
   //
   // If space is available, increase font size of freq. labels a bit
   //
@@ -248,8 +386,8 @@ void rx_panadapter_update(RECEIVER *rx) {
   cairo_set_font_size(cr, (12 + marker_extra) * scalfac);
   for (;;) {
     f += divisor;
-    double x = rx->cBp + (double)(f - frequency) * rx->cAp;
-    if (x > rx->width) { break; }
+    double x = k->cBp + (double)(f - frequency) * k->cAp;
+    if (x > k->rx_width) { break; }
     cairo_move_to(cr, x, 0);
     cairo_line_to(cr, x, myheight);
     //
@@ -257,7 +395,7 @@ void rx_panadapter_update(RECEIVER *rx) {
     // edge, do not print a frequency since this probably won't fit
     // on the screen
     //
-    if ((x >= 32) && (x <= rx->width - 32)) {
+    if ((x >= 32) && (x <= k->rx_width - 32)) {
       //
       // For frequencies larger than 10 GHz, we cannot
       // display all digits here so we give three dots
@@ -278,19 +416,19 @@ void rx_panadapter_update(RECEIVER *rx) {
   cairo_stroke(cr);
   if (vfoband != band60) {
     // band edges
-    if (band->frequencyMin != 0LL) {
+    if (k->frequency_min != 0LL) {
       double x;
       cairo_set_source_rgba(cr, COLOUR_ALARM);
       cairo_set_line_width(cr, PAN_LINE_THICK);
-      x = rx->cBp + (band->frequencyMin - frequency) * rx->cAp;
-      if (x >= 0 && x <= rx->width) {
+      x = k->cBp + (k->frequency_min - frequency) * k->cAp;
+      if (x >= 0 && x <= k->rx_width) {
         cairo_move_to(cr, x, 0);
         cairo_line_to(cr, x, myheight);
         cairo_set_line_width(cr, PAN_LINE_EXTRA);
         cairo_stroke(cr);
       }
-      x = rx->cBp + (band->frequencyMax - frequency) * rx->cAp;
-      if (x >= 0 && x <= rx->width) {
+      x = k->cBp + (k->frequency_max - frequency) * k->cAp;
+      if (x >= 0 && x <= k->rx_width) {
         cairo_move_to(cr, x, 0);
         cairo_line_to(cr, x, myheight);
         cairo_set_line_width(cr, PAN_LINE_EXTRA);
@@ -302,9 +440,9 @@ void rx_panadapter_update(RECEIVER *rx) {
   // (Multi-) Notches
   //
   for (int i = 0; i < 3; i++) {
-    if (rx->multi_notch_enable[i]) {
-      double l = rx->cAp * (rx->multi_notch_center[i] - 0.5 * rx->multi_notch_width[i]) + rx->cBp;
-      double w = rx->cAp *  rx->multi_notch_width[i];
+    if (k->notch_enable[i]) {
+      double l = k->cAp * (k->notch_center[i] - 0.5 * k->notch_width[i]) + k->cBp;
+      double w = k->cAp *  k->notch_width[i];
       cairo_set_source_rgba (cr, COLOUR_PAN_NOTCH);
       cairo_rectangle(cr, l, 0.0, w, myheight);
       cairo_fill(cr);
@@ -315,7 +453,7 @@ void rx_panadapter_update(RECEIVER *rx) {
         // draw a vertical yellow line to help guiding the eye
         //
         const double dash[] = { 12.0, 24.0 };
-        double c = rx->cAp * rx->multi_notch_center[i] + rx->cBp;
+        double c = k->cAp * k->notch_center[i] + k->cBp;
         cairo_set_source_rgba (cr, COLOUR_PAN_NOTCHLINE);
         cairo_set_line_width(cr, PAN_LINE_THICK);
         cairo_set_dash(cr, dash, 2, 0.0);
@@ -327,28 +465,26 @@ void rx_panadapter_update(RECEIVER *rx) {
 #endif
     }
   }
-  if (remoteclient.running && rx->id == 0) {
-    char text[64];
-    cairo_select_font_face(cr, DISPLAY_FONT_FACE, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+  if (k->remote) {
+    cairo_select_font_face(cr, cssfont[k->font], CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
     cairo_set_source_rgba(cr, COLOUR_SHADE);
     cairo_set_font_size(cr, 20.0 * scalfac);
-    inet_ntop(AF_INET, &(((struct sockaddr_in *)&remoteclient.address)->sin_addr), text, 64);
-    cairo_text_extents(cr, text, &extents);
+    cairo_text_extents(cr, k->remote_addr, &extents);
     cairo_move_to(cr, ((double)mywidth / 2.0) - (extents.width / 2.0), (double)myheight / 2.0);
-    cairo_show_text(cr, text);
+    cairo_show_text(cr, k->remote_addr);
   }
   // agc
-  if (rx->agc != AGC_OFF && rx->agc != AGC_FIXED) {
+  if (k->agc != AGC_OFF && k->agc != AGC_FIXED) {
     cairo_set_line_width(cr, PAN_LINE_THICK);
-    double knee_y = rx->agc_thresh + soffset;
+    double knee_y = k->agc_thresh + soffset;
     knee_y = floor((panhi - knee_y)
                    * (double) myheight
                    / (double) (panhi - panlo));
-    double hang_y = rx->agc_hang + soffset;
+    double hang_y = k->agc_hang + soffset;
     hang_y = floor((panhi - hang_y)
                    * (double) myheight
                    / (double) (panhi - panlo));
-    if (rx->agc != AGC_MEDIUM && rx->agc != AGC_FAST) {
+    if (k->agc != AGC_MEDIUM && k->agc != AGC_FAST) {
       if (active) {
         cairo_set_source_rgba(cr, COLOUR_ATTN);
       } else {
@@ -389,7 +525,53 @@ void rx_panadapter_update(RECEIVER *rx) {
   cairo_line_to(cr, rxpos, myheight);
   cairo_set_line_width(cr, PAN_LINE_THICK);
   cairo_stroke(cr);
-  if (rx->pixels_available) {
+  cairo_destroy (cr);
+}
+
+//
+// Draw the panadapter into a surface. This is called from the render thread
+// of the receiver (see receiver.c), so it must not use any GTK functions.
+//
+void rx_panadapter_render(RECEIVER *rx, cairo_surface_t *surface) {
+  float *samples;
+  cairo_text_extents_t extents;
+  PAN_KEY k;
+  double filter_left, filter_right;
+  int mywidth = cairo_image_surface_get_width (surface);
+  int myheight = cairo_image_surface_get_height (surface);
+  double scalfac = sqrt(mywidth * 0.00125);
+  if (rx->id < 0 || rx->id >= MAX_RECEIVERS) { return; }
+  PAN_LAYER *layer = &pan_layer[rx->id];
+  samples = rx->pixel_samples;
+  pan_get_key(rx, &k, mywidth, myheight);
+  if (layer->surface == NULL || layer->key.width != mywidth || layer->key.height != myheight) {
+    if (layer->surface) {
+      cairo_surface_destroy (layer->surface);
+    }
+    layer->surface = cairo_image_surface_create (CAIRO_FORMAT_RGB24, mywidth, myheight);
+    pan_draw_layer(&k, layer->surface);
+    layer->key = k;
+  } else if (memcmp(&k, &layer->key, sizeof(PAN_KEY)) != 0) {
+    pan_draw_layer(&k, layer->surface);
+    layer->key = k;
+  }
+  int active = k.active;
+  int panhi = k.panhi;
+  int panlo = k.panlo;
+  double soffset = k.soffset;
+  pan_filter_edges(&k, &filter_left, &filter_right);
+  cairo_t *cr;
+  cr = cairo_create (surface);
+  cairo_set_source_surface (cr, layer->surface, 0.0, 0.0);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_paint (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+  //
+  // This is the font last selected when drawing the layer
+  //
+  cairo_select_font_face(cr, cssfont[k.font], CAIRO_FONT_SLANT_NORMAL,
+                         k.remote ? CAIRO_FONT_WEIGHT_NORMAL : CAIRO_FONT_WEIGHT_BOLD);
+  if (rx->pixels_available && rx->pixels >= mywidth) {
     //
     // draw spectrum
     //
@@ -613,9 +795,6 @@ void rx_panadapter_update(RECEIVER *rx) {
       }
     }
   }
-  if (rx->id == 0) {
-    display_panadapter_messages(cr, mywidth, rx->fps);
-  }
   //
   // For horizontal stacking, draw a vertical separator,
   // at the right edge of RX1, and at the left
@@ -637,13 +816,13 @@ void rx_panadapter_update(RECEIVER *rx) {
   // DX cluster spots overlay
   // drawn last so it sits on top of trace + grid
   //
-  dxcluster_draw_spots(cr, rx->id, frequency, rx->cAp, rx->cBp, mywidth, myheight);
+  dxcluster_draw_spots(cr, rx->id, k.frequency, k.cAp, k.cBp, mywidth, myheight);
   cairo_destroy (cr);
-  gtk_widget_queue_draw (rx->panadapter);
 }
 
 void rx_panadapter_init(RECEIVER *rx, int width, int height) {
   rx->panadapter_surface = NULL;
+  rx->panadapter_back = NULL;
   rx->panadapter = gtk_drawing_area_new ();
   gtk_widget_set_size_request (rx->panadapter, width, height);
   /* Signals used to handle the backing surface */
@@ -20,5 +20,7 @@
 #include "receiver.h"
 
 void rx_panadapter_update(RECEIVER* rx);
+void rx_panadapter_render(RECEIVER *rx, cairo_surface_t *surface);
+void rx_panadapter_messages(RECEIVER *rx);
 void rx_panadapter_init(RECEIVER *rx, int width, int height);
 void display_panadapter_messages(cairo_t *cr, int width, unsigned int fps);
@@ -58,6 +58,7 @@
 #include "saturndrivers.h"
 #include "saturnmain.h"
 #include "saturnregisters.h"
+#include "threads.h"
 
 static bool HaveMOX;                                   // true if in TX
 static bool SDRActive;                                  // true if this SDR is running at the moment
@@ -879,7 +880,7 @@ static gpointer saturn_rx_thread(gpointer arg) {
           IQReadPtr[DDC] += VIQBYTESPERFRAME;
           if (DDC < 6) {
             SequenceCounter[DDC] = 0;
-            mybuf->free = 1;
+            release_p2buffer(mybuf);
           } else {
             saturn_post_iq_data(DDC - 6, mybuf);
           }
@@ -1055,9 +1056,9 @@ void saturn_init() {
   //
   saturn_init_speaker_audio();
   saturn_init_duc_iq();
-  saturn_rx_thread_id = g_thread_new( "SATURN RX", saturn_rx_thread, NULL);
-  saturn_micaudio_thread_id = g_thread_new( "SATURN MIC", saturn_micaudio_thread, NULL);
-  saturn_high_priority_thread_id = g_thread_new( "SATURN HP OUT", saturn_high_priority_thread, NULL);
+  saturn_rx_thread_id = thread_new("SATURN RX", THREAD_ROLE_NET, saturn_rx_thread, NULL);
+  saturn_micaudio_thread_id = thread_new("SATURN MIC", THREAD_ROLE_NET, saturn_micaudio_thread, NULL);
+  saturn_high_priority_thread_id = thread_new("SATURN HP OUT", THREAD_ROLE_NET, saturn_high_priority_thread, NULL);
 }
 
 void saturn_handle_high_priority(const unsigned char *UDPInBuffer) {
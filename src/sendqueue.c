@@ -0,0 +1,143 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE   // needed for sendmmsg()
+#endif
+
+#include <gtk/gtk.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "message.h"
+#include "sendqueue.h"
+
+static double sendq_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return 1.0E6 * ts.tv_sec + 1.0E-3 * ts.tv_nsec;
+}
+
+void sendq_init(SENDQUEUE *q) {
+  q->count = 0;
+  q->first = 0.0;
+  q->packets = 0;
+  q->syscalls = 0;
+  q->latency_sum = 0.0;
+  q->latency_max = 0.0;
+}
+
+int sendq_add(SENDQUEUE *q, const unsigned char *buf, size_t len, const struct sockaddr_in *addr,
+              socklen_t addrlen) {
+  //
+  // Copy a packet into the queue.
+  // return 0 on success, -1 if the queue is full or the packet is too long
+  //
+  if (q->count >= SENDQ_MAX || len > SENDQ_BUFLEN) {
+    return -1;
+  }
+  if (q->count == 0) {
+    q->first = sendq_now();
+  }
+  memcpy(q->data[q->count], buf, len);
+  q->len[q->count] = len;
+  memcpy(&q->addr[q->count], addr, sizeof(struct sockaddr_in));
+  q->addrlen[q->count] = addrlen;
+  q->count++;
+  return 0;
+}
+
+int sendq_can_add(const SENDQUEUE *q) {
+  //
+  // Check whether there is room for another packet, and
+  // the first packet in the queue has not been waiting too long.
+  //
+  if (q->count >= SENDQ_MAX) { return 0; }
+  if (q->count > 0 && sendq_now() - q->first > SENDQ_MAX_LATENCY) { return 0; }
+  return 1;
+}
+
+int sendq_flush(SENDQUEUE *q, int fd) {
+  //
+  // Send all packets in the queue.
+  // return the number of packets sent, or -1 in case of an error.
+  // An error is reported if a packet could not be sent (network down),
+  // but not if a packet has been sent only partially.
+  //
+  int sent = 0;
+  if (q->count == 0) { return 0; }
+  double latency = sendq_now() - q->first;
+  q->latency_sum += latency;
+  if (latency > q->latency_max) { q->latency_max = latency; }
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+  struct mmsghdr msgs[SENDQ_MAX];
+  struct iovec iovs[SENDQ_MAX];
+  for (int i = 0; i < q->count; i++) {
+    iovs[i].iov_base = q->data[i];
+    iovs[i].iov_len = q->len[i];
+    memset(&msgs[i], 0, sizeof(struct mmsghdr));
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &q->addr[i];
+    msgs[i].msg_hdr.msg_namelen = q->addrlen[i];
+  }
+  while (sent < q->count) {
+    int rc = sendmmsg(fd, &msgs[sent], q->count - sent, 0);
+    q->syscalls++;
+    if (rc < 0) {
+      if (errno == EINTR) { continue; }
+      t_perror("sendq_flush: sendmmsg");
+      q->count = 0;
+      return -1;
+    }
+    for (int i = sent; i < sent + rc; i++) {
+      if (msgs[i].msg_len != q->len[i]) {
+        t_print("%s: %u rather than %ld bytes sent\n", __func__, msgs[i].msg_len, (long) q->len[i]);
+      }
+    }
+    sent += rc;
+  }
+#else
+  for (sent = 0; sent < q->count; sent++) {
+    ssize_t rc = sendto(fd, q->data[sent], q->len[sent], 0, (struct sockaddr *)&q->addr[sent], q->addrlen[sent]);
+    q->syscalls++;
+    if (rc < 0) {
+      t_perror("sendq_flush: sendto");
+      q->count = 0;
+      return -1;
+    } else if ((size_t) rc != q->len[sent]) {
+      t_print("%s: %ld rather than %ld bytes sent\n", __func__, (long) rc, (long) q->len[sent]);
+    }
+  }
+#endif
+  q->packets += sent;
+  q->count = 0;
+  return sent;
+}
+
+void sendq_print_stats(const SENDQUEUE *q, const char *name) {
+  if (q->syscalls > 0) {
+    t_print("%s: %ld packets sent in %ld system calls (%ld saved), avg/max queue latency: %.0f/%.0f usec\n",
+            name, q->packets, q->syscalls, q->packets - q->syscalls,
+            q->latency_sum / q->syscalls, q->latency_max);
+  }
+}
@@ -0,0 +1,62 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// A small queue for outgoing UDP packets, that are then sent with
+// a single sendmmsg() call (LINUX), or with a sequence of sendto()
+// calls (elsewhere).
+//
+// A queue must only be used by a single thread.
+// Packets are only collected if they are ready to be sent anyway,
+// and a queue is never held longer than SENDQ_MAX_LATENCY usec.
+//
+
+#ifndef _SENDQUEUE_H_
+#define _SENDQUEUE_H_
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define SENDQ_MAX          8      // max. number of packets per queue
+#define SENDQ_BUFLEN       1444   // max. packet length (P2 TX IQ and HighPrio)
+#define SENDQ_MAX_LATENCY  250    // usec
+
+typedef struct _sendqueue {
+  int count;
+  double first;                   // time when the first packet was queued
+  unsigned char data[SENDQ_MAX][SENDQ_BUFLEN];
+  size_t len[SENDQ_MAX];
+  struct sockaddr_in addr[SENDQ_MAX];
+  socklen_t addrlen[SENDQ_MAX];
+  //
+  // statistics
+  //
+  long packets;
+  long syscalls;
+  double latency_sum;             // sum of all queue latencies (usec)
+  double latency_max;             // max queue latency (usec)
+} SENDQUEUE;
+
+extern void sendq_init(SENDQUEUE *q);
+extern int  sendq_add(SENDQUEUE *q, const unsigned char *buf, size_t len, const struct sockaddr_in *addr,
+                      socklen_t addrlen);
+extern int  sendq_can_add(const SENDQUEUE *q);
+extern int  sendq_flush(SENDQUEUE *q, int fd);
+extern void sendq_print_stats(const SENDQUEUE *q, const char *name);
+
+#endif
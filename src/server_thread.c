@@ -440,7 +440,7 @@ static void server_loop(void) {
   // receiver since it has a setting (antenna used for feedpack) that
   // can be changed through the GUI
   //
-  for (int i = 0; i < RECEIVERS; i++) {
+  for (int i = 0; i < MIN(RECEIVERS, REMOTE_RECEIVERS); i++) {
     send_rx_data(remoteclient.sock_tcp, i);
   }
   if (protocol == ORIGINAL_PROTOCOL || protocol == NEW_PROTOCOL) {
@@ -1118,10 +1118,16 @@ static gpointer listen_thread(gpointer arg) {
     display_height[1] = display_height[display_size];
     display_size = 1;
     rx_stack_horizontal = 0;
+    //
+    // The client can only handle REMOTE_RECEIVERS receivers
+    //
+    if (receivers > REMOTE_RECEIVERS) {
+      g_idle_add(ext_radio_change_receivers, GINT_TO_POINTER(REMOTE_RECEIVERS));
+    }
     radio_reconfigure_screen_done = 0;
     g_idle_add(ext_radio_reconfigure_screen, NULL);
     while (!radio_reconfigure_screen_done) { usleep(100000); }
-    for (int id = 0; id < RECEIVERS; id++) {
+    for (int id = 0; id < MIN(RECEIVERS, REMOTE_RECEIVERS); id++) {
       remoteclient.send_rx_spectrum[id] = FALSE;
     }
     remoteclient.send_tx_spectrum = FALSE;
@@ -1615,7 +1621,7 @@ static int server_command(gpointer data) {
     // then changes a lot of settings. So send all receiver,
     // transmitter, and VFO data
     //
-    for (int id = 0; id < RECEIVERS; id++) {
+    for (int id = 0; id < MIN(RECEIVERS, REMOTE_RECEIVERS); id++) {
       send_rx_data(remoteclient.sock_tcp, id);
     }
     send_tx_data(remoteclient.sock_tcp);
@@ -1935,11 +1941,11 @@ static int server_command(gpointer data) {
   }
   break;
   case CMD_RECEIVERS: {
-    int r = header->b1;
+    int r = MIN(header->b1, REMOTE_RECEIVERS);
     radio_change_receivers(r);
     send_receivers(remoteclient.sock_tcp, receivers);
     // In P1, activating RX2 aligns its sample rate with RX1
-    if (receivers == 2) {
+    if (receivers > 1) {
       send_rx_data(remoteclient.sock_tcp, 1);
     }
   }
@@ -2234,6 +2240,7 @@ static int server_command(gpointer data) {
     rx->low_latency = command->header.b2;
     rx->fft_size = from_32(command->u32);
     rx->nbp_window = from_16(command->header.s1);
+    rx->dsp_pipeline = from_16(command->header.s2);
     rx_set_fft_params(rx);
     //
     // Changing FFT size may change other things as well
@@ -0,0 +1,66 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "simsignal.h"
+
+void sim_noise_table(double *itab, double *qtab, int len, unsigned int *seed) {
+  double j = RAND_MAX / 2;
+  for (int i = 0; i < len; i++) {
+    itab[i] = ((double) rand_r(seed) / j - 1.0) * 1.41421E-6;
+    qtab[i] = ((double) rand_r(seed) / j - 1.0) * 1.41421E-6;
+  }
+}
+
+double sim_comb_table(double *tab, int len) {
+  double run, off, inc;
+  memset(tab, 0, len * sizeof(double));
+  for (int j = 1; j <= 200; j++) {
+    run = 0.0;
+    off = 0.25 * j * j;
+    inc = j * 0.00039269908169872415480783042290994;
+    for (int i = 0; i < len; i++) {
+      tab[i] += cos(run + off);
+      run += inc;
+    }
+  }
+  //
+  // normalise
+  //
+  off = 0.0;
+  for (int i = 0; i < len; i++) {
+    if ( tab[i] > off) { off = tab[i]; }
+    if (-tab[i] > off) { off = -tab[i]; }
+  }
+  off = 1.0 / off;
+  for (int i = 0; i < len; i++) {
+    tab[i] = tab[i] * off;
+  }
+  return off;
+}
+
+void sim_impulse_table(double *tab, int len, int npulse, int width) {
+  double ampl = sqrt(0.05 / (npulse * width));
+  memset(tab, 0, len * sizeof(double));
+  for (int i = 0; i < npulse; i++) {
+    for (int j = (i * len) / npulse; j < (i * len) / npulse + width && j < len; j++) { tab[j] = ampl; }
+  }
+}
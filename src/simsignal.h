@@ -0,0 +1,46 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// Synthetic RF signals, shared by the HPSDR simulator and
+// the WDSP benchmark. All amplitudes are relative to the
+// full-scale ADC amplitude of 1.0
+//
+
+#ifndef _SIMSIGNAL_H_
+#define _SIMSIGNAL_H_
+
+#define SIM_TWOPI        6.283185307179586476925286766559
+#define SIM_AMPL_73DBM   0.0002239        //  -73 dBm tone
+#define SIM_AMPL_110DBM  0.000003162278   // -110 dBm tone
+
+//
+// sim_noise_table: fill itab/qtab with uniformly distributed noise,
+//                  for a 1 kHz sample rate. The amplitude has to be
+//                  multiplied with sqrt(sample_rate/1000) when used.
+// sim_comb_table:  fill tab with a normalised "comb" of 200 equally
+//                  spaced cosines (man-made noise for diversity tests),
+//                  returns the normalisation factor applied.
+// sim_impulse_table: fill tab with npulse impulses of width samples,
+//                  about -80 dBm in 1000 Hz.
+//
+extern void   sim_noise_table(double *itab, double *qtab, int len, unsigned int *seed);
+extern double sim_comb_table(double *tab, int len);
+extern void   sim_impulse_table(double *tab, int len, int npulse, int width);
+
+#endif
@@ -43,6 +43,7 @@
 #include "radio.h"
 #include "receiver.h"
 #include "soapy_protocol.h"
+#include "threads.h"
 #include "transmitter.h"
 #include "vfo.h"
 
@@ -333,7 +334,7 @@ void soapy_protocol_start_single_receiver(RECEIVER *rx) {
     t_print("%s: ActivateStream failed: %s\n", __func__, SoapySDR_errToStr(rc));
     g_idle_add(fatal_error, "FATAL: Soapy Start RX Stream failed");
   }
-  soapy_receive_thread_id = g_thread_new( "soapy_rx", soapy_receive_single_thread, rx);
+  soapy_receive_thread_id = thread_new("soapy_rx", THREAD_ROLE_NET, soapy_receive_single_thread, rx);
 }
 
 void soapy_protocol_start_dual_receiver(RECEIVER *rx1, RECEIVER *rx2) {
@@ -359,7 +360,7 @@ void soapy_protocol_start_dual_receiver(RECEIVER *rx1, RECEIVER *rx2) {
   RECEIVER **rxpair = g_new(RECEIVER *, 2);
   rxpair[0] = rx1;
   rxpair[1] = rx2;
-  soapy_receive_thread_id = g_thread_new( "soapy_rx", soapy_receive_dual_thread, rxpair);
+  soapy_receive_thread_id = thread_new("soapy_rx", THREAD_ROLE_NET, soapy_receive_dual_thread, rxpair);
 }
 
 void soapy_protocol_create_transmitter(const TRANSMITTER *tx) {
@@ -498,8 +499,19 @@ void soapy_protocol_init(void) {
   SoapySDRKwargs_clear(&args);
 }
 
+static void process_mic_heartbeat(int samples) {
+  //
+  // We have no mic samples, tx_add_mic_sample() is only
+  // called to set the heart beat (one call per 48000 Hz sample)
+  //
+  mic_samples += samples;
+  while (mic_samples >= mic_sample_divisor) { // reduce to 48000
+    tx_add_mic_sample(transmitter, 0.0);
+    mic_samples -= mic_sample_divisor;
+  }
+}
+
 static void process_rx_buffer(RECEIVER *rx, const float *rxbuff, const int elements, const int micflag) {
-  double isample, qsample;
   //
   // The WDSP engine in this program works with CF64 (2 * double) format. Ideally, conversion
   // from the (radio specific) native format to CF64 would be one in the radio's SoapySDR
@@ -520,29 +532,18 @@ static void process_rx_buffer(RECEIVER *rx, const float *rxbuff, const int eleme
     //
     int rxrc = rx->resample_count;
     for (int i = 0; i < elements; i++) {
-      rx->resample_input[rxrc++] = (double)rxbuff[i * 2];
-      rx->resample_input[rxrc++] = (double)rxbuff[(i * 2) + 1];
+      if (soapy_iqswap) {
+        rx->resample_input[rxrc++] = (double)rxbuff[(i * 2) + 1];
+        rx->resample_input[rxrc++] = (double)rxbuff[i * 2];
+      } else {
+        rx->resample_input[rxrc++] = (double)rxbuff[i * 2];
+        rx->resample_input[rxrc++] = (double)rxbuff[(i * 2) + 1];
+      }
       if (rxrc >= 2 * max_rx_samples) {
         int samples = xresample(rx->resampler);
-        for (int j = 0; j < samples; j++) {
-          isample = rx->resample_output[j * 2];
-          qsample = rx->resample_output[(j * 2) + 1];
-          if (soapy_iqswap) {
-            rx_add_iq_samples(rx, qsample, isample);
-          } else {
-            rx_add_iq_samples(rx, isample, qsample);
-          }
-          if (transmitter != NULL && micflag) {
-            mic_samples++;
-            if (mic_samples >= mic_sample_divisor) { // reduce to 48000
-              //
-              // We have no mic samples, this call only
-              // sets the heart beat
-              //
-              tx_add_mic_sample(transmitter, 0.0);
-              mic_samples = 0;
-            }
-          }
+        rx_add_iq_block(rx, rx->resample_output, samples);
+        if (transmitter != NULL && micflag) {
+          process_mic_heartbeat(samples);
         }
         rxrc = 0;
       }
@@ -550,23 +551,29 @@ static void process_rx_buffer(RECEIVER *rx, const float *rxbuff, const int eleme
     rx->resample_count = rxrc;
   } else {
     //
-    // When *not* using the resampler, convert elements in the Soapy buffer
-    // to double and use them on-the-fly
+    // When *not* using the resampler, convert the Soapy buffer
+    // to double in chunks of (at most) 1024 samples and pass
+    // each chunk to the RX engine in one call. The chunk size
+    // limits the stack usage (MacOS threads have small stacks).
     //
-    for (int i = 0; i < elements; i++) {
-      isample = (double)rxbuff[i * 2];
-      qsample = (double)rxbuff[(i * 2) + 1];
+    double iq[2048];
+    for (int i = 0; i < elements; i += 1024) {
+      int n = elements - i;
+      if (n > 1024) { n = 1024; }
+      const float *src = rxbuff + 2 * i;
       if (soapy_iqswap) {
-        rx_add_iq_samples(rx, qsample, isample);
+        for (int j = 0; j < n; j++) {
+          iq[j * 2]       = (double)src[(j * 2) + 1];
+          iq[(j * 2) + 1] = (double)src[j * 2];
+        }
       } else {
-        rx_add_iq_samples(rx, isample, qsample);
+        for (int j = 0; j < 2 * n; j++) {
+          iq[j] = (double)src[j];
+        }
       }
+      rx_add_iq_block(rx, iq, n);
       if (transmitter != NULL && micflag) {
-        mic_samples++;
-        if (mic_samples >= mic_sample_divisor) { // reduce to 48000
-          tx_add_mic_sample(transmitter, 0.0);
-          mic_samples = 0;
-        }
+        process_mic_heartbeat(n);
       }
     }
   }
@@ -0,0 +1,321 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE   // needed for pthread_setaffinity_np()
+#endif
+
+#include <gtk/gtk.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "message.h"
+#include "property.h"
+#include "threads.h"
+#include "wdsp.h"
+
+typedef struct _thread_entry {
+  int used;
+  char name[32];
+  int role;
+  pthread_t thread;
+  //
+  // The following data is only written by the thread itself
+  //
+  double cpu_wake;             // thread CPU time at the last wake-up (sec)
+  long wakeups;
+  double busy_max;             // max. CPU time between two wake-ups (sec)
+} THREAD_ENTRY;
+
+typedef struct _thread_start {
+  char name[32];
+  int role;
+  GThreadFunc func;
+  gpointer data;
+} THREAD_START;
+
+static const char *role_names[THREAD_ROLES] = {
+  "GUI",
+  "Network RX",
+  "RX IQ",
+  "TX Output",
+  "WDSP",
+  "CW Keyer"
+};
+
+//
+// The default is to leave everything to the operating system, that is,
+// SCHED_OTHER and no CPU affinity. This is what piHPSDR always did.
+//
+THREAD_ROLE_SETTING thread_role_setting[THREAD_ROLES] = {
+  { 0, 10, 0 },   // GUI
+  { 0, 60, 0 },   // Network RX
+  { 0, 50, 0 },   // RX IQ
+  { 0, 55, 0 },   // TX Output
+  { 0, 40, 0 },   // WDSP
+  { 0, 70, 0 }    // CW Keyer
+};
+
+//
+// Per-stage DSP profiling of the WDSP channels and their analyzers,
+// switched in the threads menu. Receivers created later inherit it.
+//
+int dsp_profiling = 0;
+
+static THREAD_ENTRY thread_entry[THREAD_MAX];
+static GMutex thread_mutex;
+static __thread THREAD_ENTRY *thread_self = NULL;
+#ifdef __linux__
+//
+// The CPUs piHPSDR may run on (e.g. restricted by a cpuset or taskset),
+// determined at program start. A role without CPU restriction gets this
+// mask, so it is never widened beyond what the process was given.
+//
+static cpu_set_t thread_cpus_allowed;
+#endif
+
+static double thread_cpu_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + 1.0E-9 * ts.tv_nsec;
+}
+
+int threads_num_cpus(void) {
+  long n = sysconf(_SC_NPROCESSORS_CONF);
+  if (n < 1) { n = 1; }
+  if (n > THREAD_MAX_CPUS) { n = THREAD_MAX_CPUS; }
+  return (int) n;
+}
+
+const char *thread_role_name(int role) {
+  if (role < 0 || role >= THREAD_ROLES) { return "???"; }
+  return role_names[role];
+}
+
+static void thread_apply(const THREAD_ENTRY *entry) {
+  //
+  // Apply scheduling policy and CPU affinity of the thread's role.
+  // Setting SCHED_FIFO requires privileges (e.g. an rtprio limit
+  // in /etc/security/limits.conf), so failures are reported but
+  // otherwise ignored.
+  //
+  const THREAD_ROLE_SETTING *set = &thread_role_setting[entry->role];
+  struct sched_param param;
+  int policy = SCHED_OTHER;
+  int rc;
+  memset(&param, 0, sizeof(param));
+  if (set->fifo) {
+    int pmin = sched_get_priority_min(SCHED_FIFO);
+    int pmax = sched_get_priority_max(SCHED_FIFO);
+    policy = SCHED_FIFO;
+    param.sched_priority = set->prio;
+    if (param.sched_priority < pmin) { param.sched_priority = pmin; }
+    if (param.sched_priority > pmax) { param.sched_priority = pmax; }
+  }
+  rc = pthread_setschedparam(entry->thread, policy, &param);
+  if (rc != 0) {
+    t_print("%s: %s: cannot set %s scheduling: %s\n", __func__, entry->name,
+            set->fifo ? "SCHED_FIFO" : "SCHED_OTHER", strerror(rc));
+  }
+#ifdef __linux__
+  cpu_set_t cpuset;
+  int ncpu = threads_num_cpus();
+  CPU_ZERO(&cpuset);
+  for (int i = 0; i < ncpu; i++) {
+    if ((set->cpus & (1 << i)) && CPU_ISSET(i, &thread_cpus_allowed)) {
+      CPU_SET(i, &cpuset);
+    }
+  }
+  if (CPU_COUNT(&cpuset) == 0) {
+    //
+    // No restriction, or none of the selected CPUs is available
+    //
+    cpuset = thread_cpus_allowed;
+  }
+  rc = pthread_setaffinity_np(entry->thread, sizeof(cpuset), &cpuset);
+  if (rc != 0) {
+    t_print("%s: %s: cannot set CPU affinity: %s\n", __func__, entry->name, strerror(rc));
+  }
+#endif
+  //
+  // MacOS does not support binding threads to CPUs
+  //
+}
+
+void thread_role_apply(int role) {
+  if (role < 0 || role >= THREAD_ROLES) { return; }
+  g_mutex_lock(&thread_mutex);
+  for (int i = 0; i < THREAD_MAX; i++) {
+    if (thread_entry[i].used && thread_entry[i].role == role) {
+      thread_apply(&thread_entry[i]);
+    }
+  }
+  g_mutex_unlock(&thread_mutex);
+}
+
+void thread_register(const char *name, int role) {
+  if (role < 0 || role >= THREAD_ROLES) { role = THREAD_ROLE_GUI; }
+  g_mutex_lock(&thread_mutex);
+  for (int i = 0; i < THREAD_MAX; i++) {
+    THREAD_ENTRY *entry = &thread_entry[i];
+    if (!entry->used) {
+      snprintf(entry->name, sizeof(entry->name), "%s", name);
+      entry->role = role;
+      entry->thread = pthread_self();
+      entry->cpu_wake = thread_cpu_time();
+      entry->wakeups = 0;
+      entry->busy_max = 0.0;
+      entry->used = 1;
+      thread_self = entry;
+      thread_apply(entry);
+      break;
+    }
+  }
+  g_mutex_unlock(&thread_mutex);
+  if (thread_self == NULL) {
+    t_print("%s: registry full, cannot register %s\n", __func__, name);
+  }
+}
+
+void thread_unregister(void) {
+  if (thread_self == NULL) { return; }
+  g_mutex_lock(&thread_mutex);
+  thread_self->used = 0;
+  thread_self = NULL;
+  g_mutex_unlock(&thread_mutex);
+}
+
+void thread_wakeup(void) {
+  //
+  // The CPU time consumed between two wake-ups is the time
+  // the thread needs to process one chunk of data.
+  //
+  THREAD_ENTRY *entry = thread_self;
+  if (entry == NULL) { return; }
+  double now = thread_cpu_time();
+  double busy = now - entry->cpu_wake;
+  if (entry->wakeups > 0 && busy > entry->busy_max) {
+    entry->busy_max = busy;
+  }
+  entry->cpu_wake = now;
+  entry->wakeups++;
+}
+
+static gpointer thread_main(gpointer arg) {
+  THREAD_START *start = (THREAD_START *)arg;
+  GThreadFunc func = start->func;
+  gpointer data = start->data;
+  gpointer rc;
+  thread_register(start->name, start->role);
+  g_free(start);
+  rc = func(data);
+  thread_unregister();
+  return rc;
+}
+
+GThread *thread_new(const char *name, int role, GThreadFunc func, gpointer data) {
+  THREAD_START *start = g_new(THREAD_START, 1);
+  snprintf(start->name, sizeof(start->name), "%s", name);
+  start->role = role;
+  start->func = func;
+  start->data = data;
+  return g_thread_new(name, thread_main, start);
+}
+
+int threads_get_info(THREAD_INFO *info, int max) {
+  int n = 0;
+  g_mutex_lock(&thread_mutex);
+  for (int i = 0; i < THREAD_MAX && n < max; i++) {
+    const THREAD_ENTRY *entry = &thread_entry[i];
+    if (!entry->used) { continue; }
+    snprintf(info[n].name, sizeof(info[n].name), "%s", entry->name);
+    info[n].role = entry->role;
+    info[n].wakeups = entry->wakeups;
+    info[n].busy_max = 1.0E6 * entry->busy_max;
+    //
+    // On MacOS, the CPU time is only known at the last wake-up
+    //
+    info[n].cpu = entry->cpu_wake;
+#ifdef __linux__
+    clockid_t cid;
+    if (pthread_getcpuclockid(entry->thread, &cid) == 0) {
+      struct timespec ts;
+      if (clock_gettime(cid, &ts) == 0) {
+        info[n].cpu = ts.tv_sec + 1.0E-9 * ts.tv_nsec;
+      }
+    }
+#endif
+    n++;
+  }
+  g_mutex_unlock(&thread_mutex);
+  return n;
+}
+
+void threads_reset_stats(void) {
+  //
+  // The counters are owned by the threads, so we only reset the
+  // maximum. A concurrent update may survive, which does no harm.
+  //
+  g_mutex_lock(&thread_mutex);
+  for (int i = 0; i < THREAD_MAX; i++) {
+    thread_entry[i].busy_max = 0.0;
+  }
+  g_mutex_unlock(&thread_mutex);
+}
+
+static void wdsp_thread_start(const char *name) {
+  thread_register(name, THREAD_ROLE_WDSP);
+}
+
+void threads_init(void) {
+  //
+  // Register the GTK main thread, and hook into the creation
+  // of WDSP threads. This must be called from the main thread
+  // before any WDSP channel is opened.
+  //
+#ifdef __linux__
+  if (sched_getaffinity(0, sizeof(thread_cpus_allowed), &thread_cpus_allowed) != 0) {
+    CPU_ZERO(&thread_cpus_allowed);
+    for (int i = 0; i < CPU_SETSIZE; i++) {
+      CPU_SET(i, &thread_cpus_allowed);
+    }
+  }
+#endif
+  thread_register("GTK main", THREAD_ROLE_GUI);
+  WDSPSetThreadHooks(wdsp_thread_start, thread_unregister, thread_wakeup);
+}
+
+void threads_save_state(void) {
+  for (int i = 0; i < THREAD_ROLES; i++) {
+    SetPropI1("threads.role.%d.fifo", i,      thread_role_setting[i].fifo);
+    SetPropI1("threads.role.%d.prio", i,      thread_role_setting[i].prio);
+    SetPropI1("threads.role.%d.cpus", i,      thread_role_setting[i].cpus);
+  }
+}
+
+void threads_restore_state(void) {
+  for (int i = 0; i < THREAD_ROLES; i++) {
+    GetPropI1("threads.role.%d.fifo", i,      thread_role_setting[i].fifo);
+    GetPropI1("threads.role.%d.prio", i,      thread_role_setting[i].prio);
+    GetPropI1("threads.role.%d.cpus", i,      thread_role_setting[i].cpus);
+    thread_role_apply(i);
+  }
+}
@@ -0,0 +1,84 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// A registry for the time-critical threads of piHPSDR.
+//
+// Each registered thread has a "role". For each role, the scheduling
+// policy (SCHED_OTHER or SCHED_FIFO), the real-time priority, and the
+// set of CPUs the threads may run on can be configured. Changes are
+// applied immediately to all running threads of that role.
+//
+// For each thread, the number of wake-ups and the maximum CPU time
+// consumed between two wake-ups are recorded. To this end, the thread
+// calls thread_wakeup() each time it returns from a blocking wait.
+//
+// Threads are either started with thread_new() (a drop-in replacement
+// for g_thread_new), or register/unregister themselves. WDSP threads
+// are registered through the WDSP thread hooks.
+//
+
+#ifndef _THREADS_H_
+#define _THREADS_H_
+
+#include <gtk/gtk.h>
+
+enum _thread_role {
+  THREAD_ROLE_GUI = 0,   // GTK main loop
+  THREAD_ROLE_NET,       // receiving data from the radio
+  THREAD_ROLE_RXIQ,      // processing RX IQ and mic samples
+  THREAD_ROLE_TXOUT,     // sending TX IQ and audio data to the radio
+  THREAD_ROLE_WDSP,      // WDSP channel threads
+  THREAD_ROLE_KEYER,     // CW keyer
+  THREAD_ROLES
+};
+
+#define THREAD_MAX 64          // max. number of registered threads
+#define THREAD_MAX_CPUS 16     // max. number of CPUs in the affinity mask
+
+typedef struct _thread_role_setting {
+  int fifo;                    // 0: SCHED_OTHER, 1: SCHED_FIFO
+  int prio;                    // real-time priority (only used with SCHED_FIFO)
+  int cpus;                    // bit mask of allowed CPUs, 0 means "all"
+} THREAD_ROLE_SETTING;
+
+typedef struct _thread_info {
+  char name[32];
+  int role;
+  double cpu;                  // CPU time consumed so far (sec)
+  long wakeups;                // number of wake-ups
+  double busy_max;             // max. CPU time between two wake-ups (usec)
+} THREAD_INFO;
+
+extern THREAD_ROLE_SETTING thread_role_setting[THREAD_ROLES];
+extern int dsp_profiling;
+
+extern void threads_init(void);
+extern GThread *thread_new(const char *name, int role, GThreadFunc func, gpointer data);
+extern void thread_register(const char *name, int role);
+extern void thread_unregister(void);
+extern void thread_wakeup(void);
+extern const char *thread_role_name(int role);
+extern void thread_role_apply(int role);
+extern int  threads_get_info(THREAD_INFO *info, int max);
+extern void threads_reset_stats(void);
+extern int  threads_num_cpus(void);
+extern void threads_save_state(void);
+extern void threads_restore_state(void);
+
+#endif
@@ -0,0 +1,538 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "message.h"
+#include "new_menu.h"
+#include "radio.h"
+#include "receiver.h"
+#include "threads.h"
+#include "threads_menu.h"
+#include "transmitter.h"
+#include "wdsp.h"
+
+#define STAT_COLS 5
+#define PROF_COLS 5
+#define PROF_ROWS 96
+#define PROF_MAX  64
+
+static GtkWidget *dialog = NULL;
+static GtkWidget *stat_grid = NULL;
+static GtkWidget *stat_label[THREAD_MAX][STAT_COLS];
+static GtkWidget *pool_label = NULL;
+static GtkWidget *latency_label = NULL;
+static GtkWidget *render_label = NULL;
+static GtkWidget *pacer_label = NULL;
+static GtkWidget *wisdom_label = NULL;
+static GtkWidget *prof_grid = NULL;
+static GtkWidget *prof_label[PROF_ROWS][PROF_COLS];
+static guint stat_timer_id = 0;
+static guint log_timer_id = 0;
+static gint64 prof_start = 0;
+
+//
+// Utilisation of the WDSP analyzer worker pool, and the FFT latency
+// (from the start of the FFT until the pixels are ready) of the
+// displays, both averaged over the last update period. For the
+// receivers, the time needed to render the panadapter and the number
+// of display updates skipped because the previous frame was not ready.
+// Finally, the frame rate of the displays, the latency from the analyzer
+// to the screen, and the number of spectra that have not been shown.
+//
+static void pool_update(void) {
+  char text[256];
+  int workers, queue_max;
+  long items, frames;
+  double util, avg, max;
+  size_t len;
+  WDSPGetPoolStats(&workers, &util, &queue_max, &items);
+  snprintf(text, sizeof(text), "Analyzer pool: %d workers, %0.1f%% busy, max. queue %d, %ld FFTs",
+           workers, 100.0 * util, queue_max, items);
+  gtk_label_set_text(GTK_LABEL(pool_label), text);
+  snprintf(text, sizeof(text), "FFT latency avg/max (ms):");
+  for (int i = 0; i < receivers; i++) {
+    if (receiver[i] == NULL) { continue; }
+    GetAnalyzerLatency(receiver[i]->id, &avg, &max, &frames);
+    len = strlen(text);
+    snprintf(text + len, sizeof(text) - len, "  RX%d %0.1f/%0.1f", i + 1, 1000.0 * avg, 1000.0 * max);
+  }
+  if (transmitter != NULL) {
+    GetAnalyzerLatency(transmitter->id, &avg, &max, &frames);
+    len = strlen(text);
+    snprintf(text + len, sizeof(text) - len, "  TX %0.1f/%0.1f", 1000.0 * avg, 1000.0 * max);
+  }
+  gtk_label_set_text(GTK_LABEL(latency_label), text);
+  snprintf(text, sizeof(text), "Render avg/max (ms), dropped:");
+  for (int i = 0; i < receivers; i++) {
+    long dropped;
+    if (receiver[i] == NULL) { continue; }
+    rx_get_render_stats(receiver[i], &frames, &dropped, &avg, &max);
+    len = strlen(text);
+    snprintf(text + len, sizeof(text) - len, "  RX%d %0.1f/%0.1f %ld", i + 1, avg, max, dropped);
+  }
+  gtk_label_set_text(GTK_LABEL(render_label), text);
+  snprintf(text, sizeof(text), "Display fps, latency avg/max (ms), skipped:");
+  for (int i = 0; i < receivers; i++) {
+    double fps;
+    long skipped;
+    if (receiver[i] == NULL) { continue; }
+    pacer_get_stats(&receiver[i]->pacer, &fps, &avg, &max, &skipped);
+    len = strlen(text);
+    snprintf(text + len, sizeof(text) - len, "  RX%d %0.1f %0.1f/%0.1f %ld", i + 1, fps, avg, max, skipped);
+  }
+  if (transmitter != NULL) {
+    double fps;
+    long skipped;
+    pacer_get_stats(&transmitter->pacer, &fps, &avg, &max, &skipped);
+    len = strlen(text);
+    snprintf(text + len, sizeof(text) - len, "  TX %0.1f %0.1f/%0.1f %ld", fps, avg, max, skipped);
+  }
+  gtk_label_set_text(GTK_LABEL(pacer_label), text);
+  //
+  // FFT sizes in use, those marked with '*' have optimal FFTW wisdom
+  //
+  char wtext[1100];
+  snprintf(wtext, sizeof(wtext), "FFTW wisdom: %s", wisdom_get_status());
+  gtk_label_set_text(GTK_LABEL(wisdom_label), wtext);
+}
+
+typedef struct _prof_entry {
+  const char *name;
+  long long ns;
+  long long calls;
+  long long worst;
+} PROF_ENTRY;
+
+//
+// Collect the counters of one WDSP channel and of its display.
+// The counters of the chains come first, each followed by
+// those of its stages.
+//
+static int prof_get(int id, PROF_ENTRY *e, int *nchan) {
+  const char *names[PROF_MAX];
+  long long ns[PROF_MAX], calls[PROF_MAX], worst[PROF_MAX];
+  int n = GetChannelProfile(id, PROF_MAX, names, ns, calls, worst);
+  *nchan = n;
+  n += GetAnalyzerProfile(id, PROF_MAX - n, names + n, ns + n, calls + n, worst + n);
+  for (int i = 0; i < n; i++) {
+    e[i].name = names[i];
+    e[i].ns = ns[i];
+    e[i].calls = calls[i];
+    e[i].worst = worst[i];
+  }
+  return n;
+}
+
+static void prof_apply(int run) {
+  for (int i = 0; i < receivers; i++) {
+    if (receiver[i] == NULL) { continue; }
+    SetChannelProfile(receiver[i]->id, run);
+    SetAnalyzerProfile(receiver[i]->id, run);
+  }
+  if (transmitter != NULL) {
+    SetChannelProfile(transmitter->id, run);
+    SetAnalyzerProfile(transmitter->id, run);
+  }
+  prof_start = g_get_monotonic_time();
+}
+
+//
+// The load is the time spent in a stage relative to the wall-clock
+// time since profiling was switched on, that is, the fraction of one
+// CPU core.
+//
+static double prof_load(const PROF_ENTRY *e) {
+  double wall = 1000.0 * (double)(g_get_monotonic_time() - prof_start);
+  return wall > 0.0 ? 100.0 * (double)e->ns / wall : 0.0;
+}
+
+static int prof_rows(int row, const char *title, int id) {
+  PROF_ENTRY e[PROF_MAX];
+  int nchan;
+  int n = prof_get(id, e, &nchan);
+  for (int i = 0; i < n && row < PROF_ROWS; i++, row++) {
+    char text[PROF_COLS][64];
+    if (prof_label[row][0] == NULL) {
+      for (int j = 0; j < PROF_COLS; j++) {
+        GtkWidget *label = gtk_label_new(NULL);
+        gtk_widget_set_halign(label, j == 0 ? GTK_ALIGN_START : GTK_ALIGN_END);
+        gtk_grid_attach(GTK_GRID(prof_grid), label, j, row + 1, 1, 1);
+        gtk_widget_show(label);
+        prof_label[row][j] = label;
+      }
+    }
+    snprintf(text[0], 64, "%s %s%s", title, i >= nchan ? "display " : "", e[i].name);
+    snprintf(text[1], 64, "%lld", e[i].calls);
+    snprintf(text[2], 64, "%0.1f", e[i].calls > 0 ? 0.001 * (double)e[i].ns / (double)e[i].calls : 0.0);
+    snprintf(text[3], 64, "%0.1f", 0.001 * (double)e[i].worst);
+    snprintf(text[4], 64, "%0.2f", prof_load(&e[i]));
+    for (int j = 0; j < PROF_COLS; j++) {
+      gtk_label_set_text(GTK_LABEL(prof_label[row][j]), text[j]);
+    }
+  }
+  return row;
+}
+
+//
+// Update the profile table. Rows are created when needed,
+// and cleared if no longer used.
+//
+static void prof_update(void) {
+  char title[16];
+  int row = 0;
+  for (int i = 0; i < receivers; i++) {
+    if (receiver[i] == NULL) { continue; }
+    snprintf(title, sizeof(title), "RX%d", i + 1);
+    row = prof_rows(row, title, receiver[i]->id);
+  }
+  if (transmitter != NULL) {
+    row = prof_rows(row, "TX", transmitter->id);
+  }
+  for (; row < PROF_ROWS && prof_label[row][0] != NULL; row++) {
+    for (int j = 0; j < PROF_COLS; j++) {
+      gtk_label_set_text(GTK_LABEL(prof_label[row][j]), "");
+    }
+  }
+}
+
+//
+// The periodic log line lists, for each channel, all chains and stages
+// with a load of at least 0.1 percent. It continues when the menu is closed.
+//
+static void prof_log_channel(const char *title, int id) {
+  PROF_ENTRY e[PROF_MAX];
+  char text[1024];
+  int nchan;
+  int n = prof_get(id, e, &nchan);
+  snprintf(text, sizeof(text), "DSP profile %s:", title);
+  for (int i = 0; i < n; i++) {
+    double load = prof_load(&e[i]);
+    if (load < 0.1) { continue; }
+    size_t len = strlen(text);
+    snprintf(text + len, sizeof(text) - len, " %s%s %0.1f%%", i >= nchan ? "display " : "", e[i].name, load);
+  }
+  t_print("%s\n", text);
+}
+
+static int prof_log(gpointer arg) {
+  char title[16];
+  if (!dsp_profiling) { return G_SOURCE_CONTINUE; }
+  for (int i = 0; i < receivers; i++) {
+    if (receiver[i] == NULL) { continue; }
+    snprintf(title, sizeof(title), "RX%d", i + 1);
+    prof_log_channel(title, receiver[i]->id);
+  }
+  if (transmitter != NULL) {
+    prof_log_channel("TX", transmitter->id);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+//
+// Update the thread statistics table. Rows are created
+// when needed, and cleared if the thread has gone.
+//
+static int stat_update(gpointer arg) {
+  THREAD_INFO info[THREAD_MAX];
+  int n = threads_get_info(info, THREAD_MAX);
+  for (int i = 0; i < THREAD_MAX; i++) {
+    char text[STAT_COLS][64];
+    if (i >= n && stat_label[i][0] == NULL) { break; }
+    if (stat_label[i][0] == NULL) {
+      for (int j = 0; j < STAT_COLS; j++) {
+        GtkWidget *label = gtk_label_new(NULL);
+        gtk_widget_set_halign(label, j == 0 ? GTK_ALIGN_START : GTK_ALIGN_END);
+        gtk_grid_attach(GTK_GRID(stat_grid), label, j, i + 1, 1, 1);
+        gtk_widget_show(label);
+        stat_label[i][j] = label;
+      }
+    }
+    if (i < n) {
+      snprintf(text[0], 64, "%s", info[i].name);
+      snprintf(text[1], 64, "%s", thread_role_name(info[i].role));
+      snprintf(text[2], 64, "%0.2f", info[i].cpu);
+      snprintf(text[3], 64, "%ld", info[i].wakeups);
+      snprintf(text[4], 64, "%0.0f", info[i].busy_max);
+    } else {
+      for (int j = 0; j < STAT_COLS; j++) { *text[j] = 0; }
+    }
+    for (int j = 0; j < STAT_COLS; j++) {
+      gtk_label_set_text(GTK_LABEL(stat_label[i][j]), text[j]);
+    }
+  }
+  pool_update();
+  prof_update();
+  return G_SOURCE_CONTINUE;
+}
+
+static void cleanup(void) {
+  if (stat_timer_id != 0) {
+    g_source_remove(stat_timer_id);
+    stat_timer_id = 0;
+  }
+  if (dialog != NULL) {
+    GtkWidget *tmp = dialog;
+    dialog = NULL;
+    gtk_widget_destroy(tmp);
+    sub_menu = NULL;
+    active_menu  = NO_MENU;
+    radio_save_state();
+  }
+}
+
+static gboolean close_cb(void) {
+  cleanup();
+  return TRUE;
+}
+
+// cppcheck-suppress constParameterCallback
+static gboolean reset_cb(GtkWidget *widget, GdkEventButton *event, gpointer data) {
+  threads_reset_stats();
+  return TRUE;
+}
+
+static void profile_cb(GtkWidget *widget, gpointer data) {
+  dsp_profiling = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+  prof_apply(dsp_profiling);
+  prof_update();
+}
+
+static void log_cb(GtkWidget *widget, gpointer data) {
+  if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget))) {
+    if (log_timer_id == 0) { log_timer_id = g_timeout_add_seconds(10, prof_log, NULL); }
+  } else if (log_timer_id != 0) {
+    g_source_remove(log_timer_id);
+    log_timer_id = 0;
+  }
+}
+
+// cppcheck-suppress constParameterCallback
+static gboolean prof_reset_cb(GtkWidget *widget, GdkEventButton *event, gpointer data) {
+  if (dsp_profiling) {
+    prof_apply(0);
+    prof_apply(1);
+    prof_update();
+  }
+  return TRUE;
+}
+
+static void policy_cb(GtkWidget *widget, gpointer data) {
+  int role = GPOINTER_TO_INT(data);
+  thread_role_setting[role].fifo = gtk_combo_box_get_active(GTK_COMBO_BOX(widget));
+  thread_role_apply(role);
+}
+
+static void prio_cb(GtkWidget *widget, gpointer data) {
+  int role = GPOINTER_TO_INT(data);
+  thread_role_setting[role].prio = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(widget));
+  thread_role_apply(role);
+}
+
+static void cpu_cb(GtkWidget *widget, gpointer data) {
+  int role = GPOINTER_TO_INT(data) / THREAD_MAX_CPUS;
+  int cpu = GPOINTER_TO_INT(data) % THREAD_MAX_CPUS;
+  if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget))) {
+    thread_role_setting[role].cpus |= (1 << cpu);
+  } else {
+    thread_role_setting[role].cpus &= ~(1 << cpu);
+  }
+  thread_role_apply(role);
+}
+
+void threads_menu(GtkWidget *parent) {
+  GtkWidget *label;
+  int row;
+  //
+  // Affinity can only be set on Linux, and the menu
+  // has only space for eight CPUs
+  //
+#ifdef __linux__
+  int ncpu = MIN(threads_num_cpus(), 8);
+#else
+  int ncpu = 0;
+#endif
+  const char *heading[STAT_COLS] = { "Thread", "Role", "CPU (s)", "Wakeups", "Max (us)" };
+  const char *prof_heading[PROF_COLS] = { "Chain / Stage", "Calls", "Avg (us)", "Max (us)", "Load (%)" };
+  for (int i = 0; i < THREAD_MAX; i++) {
+    for (int j = 0; j < STAT_COLS; j++) {
+      stat_label[i][j] = NULL;
+    }
+  }
+  for (int i = 0; i < PROF_ROWS; i++) {
+    for (int j = 0; j < PROF_COLS; j++) {
+      prof_label[i][j] = NULL;
+    }
+  }
+  dialog = gtk_dialog_new();
+  gtk_window_set_transient_for(GTK_WINDOW(dialog), GTK_WINDOW(parent));
+  GtkWidget *headerbar = gtk_header_bar_new();
+  gtk_window_set_titlebar(GTK_WINDOW(dialog), headerbar);
+  gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(headerbar), TRUE);
+  gtk_header_bar_set_title(GTK_HEADER_BAR(headerbar), "piHPSDR - Threads");
+  g_signal_connect (dialog, "delete_event", G_CALLBACK (close_cb), NULL);
+  g_signal_connect (dialog, "destroy", G_CALLBACK (close_cb), NULL);
+  GtkWidget *content = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+  GtkWidget *grid = gtk_grid_new();
+  gtk_grid_set_column_spacing (GTK_GRID(grid), 10);
+  gtk_grid_set_row_spacing (GTK_GRID(grid), 5);
+  GtkWidget *close_b = gtk_button_new_with_label("Close");
+  gtk_widget_set_name(close_b, "close_button");
+  g_signal_connect (close_b, "button-press-event", G_CALLBACK(close_cb), NULL);
+  gtk_grid_attach(GTK_GRID(grid), close_b, 0, 0, 1, 1);
+  GtkWidget *reset_b = gtk_button_new_with_label("Reset Max");
+  g_signal_connect (reset_b, "button-press-event", G_CALLBACK(reset_cb), NULL);
+  gtk_grid_attach(GTK_GRID(grid), reset_b, 1, 0, 1, 1);
+  //
+  // Per-role settings: policy, priority, CPUs
+  //
+  row = 1;
+  label = gtk_label_new("Role");
+  gtk_widget_set_name(label, "boldlabel");
+  gtk_widget_set_halign(label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), label, 0, row, 1, 1);
+  label = gtk_label_new("Policy");
+  gtk_widget_set_name(label, "boldlabel");
+  gtk_grid_attach(GTK_GRID(grid), label, 1, row, 1, 1);
+  label = gtk_label_new("Priority");
+  gtk_widget_set_name(label, "boldlabel");
+  gtk_grid_attach(GTK_GRID(grid), label, 2, row, 1, 1);
+  if (ncpu > 0) {
+    label = gtk_label_new("CPUs (none checked: all)");
+    gtk_widget_set_name(label, "boldlabel");
+    gtk_widget_set_halign(label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(grid), label, 3, row, ncpu, 1);
+  }
+  for (int role = 0; role < THREAD_ROLES; role++) {
+    row++;
+    label = gtk_label_new(thread_role_name(role));
+    gtk_widget_set_name(label, "boldlabel");
+    gtk_widget_set_halign(label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, row, 1, 1);
+    GtkWidget *policy_combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(policy_combo), NULL, "Normal");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(policy_combo), NULL, "FIFO");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(policy_combo), thread_role_setting[role].fifo ? 1 : 0);
+    my_combo_attach(GTK_GRID(grid), policy_combo, 1, row, 1, 1);
+    g_signal_connect(policy_combo, "changed", G_CALLBACK(policy_cb), GINT_TO_POINTER(role));
+    GtkWidget *prio_b = gtk_spin_button_new_with_range(1.0, 99.0, 1.0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(prio_b), (double)thread_role_setting[role].prio);
+    gtk_grid_attach(GTK_GRID(grid), prio_b, 2, row, 1, 1);
+    g_signal_connect(prio_b, "value_changed", G_CALLBACK(prio_cb), GINT_TO_POINTER(role));
+    for (int cpu = 0; cpu < ncpu; cpu++) {
+      char text[8];
+      snprintf(text, sizeof(text), "%d", cpu);
+      GtkWidget *cpu_b = gtk_check_button_new_with_label(text);
+      gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(cpu_b), (thread_role_setting[role].cpus & (1 << cpu)) != 0);
+      gtk_grid_attach(GTK_GRID(grid), cpu_b, 3 + cpu, row, 1, 1);
+      g_signal_connect(cpu_b, "toggled", G_CALLBACK(cpu_cb), GINT_TO_POINTER(role * THREAD_MAX_CPUS + cpu));
+    }
+  }
+  //
+  // Statistics of the registered threads
+  //
+  row++;
+  GtkWidget *sep = gtk_separator_new(GTK_ORIENTATION_HORIZONTAL);
+  gtk_widget_set_size_request(sep, -1, 3);
+  gtk_grid_attach(GTK_GRID(grid), sep, 0, row, 3 + ncpu, 1);
+  row++;
+  stat_grid = gtk_grid_new();
+  gtk_grid_set_column_spacing (GTK_GRID(stat_grid), 20);
+  for (int j = 0; j < STAT_COLS; j++) {
+    label = gtk_label_new(heading[j]);
+    gtk_widget_set_name(label, "boldlabel");
+    gtk_widget_set_halign(label, j == 0 ? GTK_ALIGN_START : GTK_ALIGN_END);
+    gtk_grid_attach(GTK_GRID(stat_grid), label, j, 0, 1, 1);
+  }
+  GtkWidget *scrolled = gtk_scrolled_window_new(NULL, NULL);
+  gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+  gtk_widget_set_size_request(scrolled, -1, 150);
+  gtk_container_add(GTK_CONTAINER(scrolled), stat_grid);
+  gtk_grid_attach(GTK_GRID(grid), scrolled, 0, row, 3 + ncpu, 1);
+  row++;
+  pool_label = gtk_label_new(NULL);
+  gtk_widget_set_halign(pool_label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), pool_label, 0, row, 3 + ncpu, 1);
+  row++;
+  latency_label = gtk_label_new(NULL);
+  gtk_widget_set_halign(latency_label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), latency_label, 0, row, 3 + ncpu, 1);
+  row++;
+  render_label = gtk_label_new(NULL);
+  gtk_widget_set_halign(render_label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), render_label, 0, row, 3 + ncpu, 1);
+  row++;
+  pacer_label = gtk_label_new(NULL);
+  gtk_widget_set_halign(pacer_label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), pacer_label, 0, row, 3 + ncpu, 1);
+  row++;
+  wisdom_label = gtk_label_new(NULL);
+  gtk_widget_set_halign(wisdom_label, GTK_ALIGN_START);
+  gtk_label_set_line_wrap(GTK_LABEL(wisdom_label), TRUE);
+  gtk_label_set_max_width_chars(GTK_LABEL(wisdom_label), 100);
+  gtk_grid_attach(GTK_GRID(grid), wisdom_label, 0, row, 3 + ncpu, 1);
+  //
+  // Per-stage DSP profile: counters of the chains, their stages, and the displays
+  //
+  row++;
+  sep = gtk_separator_new(GTK_ORIENTATION_HORIZONTAL);
+  gtk_widget_set_size_request(sep, -1, 3);
+  gtk_grid_attach(GTK_GRID(grid), sep, 0, row, 3 + ncpu, 1);
+  row++;
+  GtkWidget *prof_ctrl = gtk_grid_new();
+  gtk_grid_set_column_spacing (GTK_GRID(prof_ctrl), 10);
+  GtkWidget *profile_b = gtk_check_button_new_with_label("DSP Profiling");
+  gtk_widget_set_name(profile_b, "boldlabel");
+  gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(profile_b), dsp_profiling);
+  gtk_grid_attach(GTK_GRID(prof_ctrl), profile_b, 0, 0, 1, 1);
+  g_signal_connect(profile_b, "toggled", G_CALLBACK(profile_cb), NULL);
+  GtkWidget *log_b = gtk_check_button_new_with_label("Log every 10 sec");
+  gtk_widget_set_name(log_b, "boldlabel");
+  gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(log_b), log_timer_id != 0);
+  gtk_grid_attach(GTK_GRID(prof_ctrl), log_b, 1, 0, 1, 1);
+  g_signal_connect(log_b, "toggled", G_CALLBACK(log_cb), NULL);
+  GtkWidget *prof_reset_b = gtk_button_new_with_label("Reset Profile");
+  g_signal_connect (prof_reset_b, "button-press-event", G_CALLBACK(prof_reset_cb), NULL);
+  gtk_grid_attach(GTK_GRID(prof_ctrl), prof_reset_b, 2, 0, 1, 1);
+  gtk_grid_attach(GTK_GRID(grid), prof_ctrl, 0, row, 3 + ncpu, 1);
+  row++;
+  prof_grid = gtk_grid_new();
+  gtk_grid_set_column_spacing (GTK_GRID(prof_grid), 15);
+  for (int j = 0; j < PROF_COLS; j++) {
+    label = gtk_label_new(prof_heading[j]);
+    gtk_widget_set_name(label, "boldlabel");
+    gtk_widget_set_halign(label, j == 0 ? GTK_ALIGN_START : GTK_ALIGN_END);
+    gtk_grid_attach(GTK_GRID(prof_grid), label, j, 0, 1, 1);
+  }
+  scrolled = gtk_scrolled_window_new(NULL, NULL);
+  gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+  gtk_widget_set_size_request(scrolled, -1, 200);
+  gtk_container_add(GTK_CONTAINER(scrolled), prof_grid);
+  gtk_grid_attach(GTK_GRID(grid), scrolled, 0, row, 3 + ncpu, 1);
+  row++;
+  label = gtk_label_new("Load is the time spent relative to the time since profiling has been\n"
+                        "switched on or reset, that is, the fraction of one CPU core.");
+  gtk_widget_set_halign(label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), label, 0, row, 3 + ncpu, 1);
+  gtk_container_add(GTK_CONTAINER(content), grid);
+  sub_menu = dialog;
+  gtk_widget_show_all(dialog);
+  stat_update(NULL);
+  stat_timer_id = g_timeout_add(1000, stat_update, NULL);
+}
@@ -742,75 +742,96 @@ static gboolean tx_update_display(gpointer data) {
     if (!duplex) {
       txmeter_update(tx->fps, tx->fwd, tx->alc, tx->swr, tx->micpeak, tx->outavg);
     }
-    // if "MON" button is active (tx->feedback is TRUE),
-    // then obtain spectrum pixels from PS_RX_FEEDBACK,
-    // that is, display the (attenuated) TX signal from the "antenna"
     //
-    g_mutex_lock(&tx->display_mutex);
+    // The spectrum comes from the TX analyzer, or from that of the
+    // PS feedback receiver if the MON button is active. The display
+    // is updated by tx_update_spectrum() through the frame pacer.
+    //
     if (tx->puresignal && tx->feedback) {
-      RECEIVER *rx_feedback = receiver[PS_RX_FEEDBACK];
-      g_mutex_lock(&rx_feedback->display_mutex);
-      rx_get_pixels(rx_feedback);
-      rc = rx_feedback->pixels_available;
-      if (rc) {
-        //
-        // The number of pixels that we need to copy depends on the "duplex" state.
-        // If duplex, then there is a separate TX window that is narrower than
-        // the window size.
-        //
-        int full  = rx_feedback->pixels;  // number of pixels in the feedback spectrum
-        int width = tx->pixels;           // number of pixels to copy from the feedback spectrum
-        int start = (full - width) / 2;   // Copy from start ... (end-1)
-        float *tfp = tx->pixel_samples;
-        const float *rfp = rx_feedback->pixel_samples + start;
-        float offset;
-        int i;
-        //
-        // The TX panadapter shows a RELATIVE signal strength. A CW or single-tone signal at
-        // full drive appears at 0dBm, the two peaks of a full-drive two-tone signal appear
-        // at -6 dBm each. THIS DOES NOT DEPEND ON THE POSITION OF THE DRIVE LEVEL SLIDER.
-        // The strength of the feedback signal, however, depends on the drive, on the PA and
-        // on the attenuation effective in the feedback path.
-        // We try to shift the RX feeback signal such that is looks like a "normal" TX
-        // panadapter if the feedback is optimal for PureSignal (that is, if the attenuation
-        // is optimal). The correction (offset) depends on the FPGA software inside the radio
-        // (diffent peak levels in the TX feedback channel).
-        //
-        // The (empirically) determined offset is 4.2 - 20*Log10(GetPk value), it is the larger
-        // the smaller the amplitude of the RX feedback signal is.
-        //
-        switch (protocol) {
-        case ORIGINAL_PROTOCOL:
-          // TX dac feedback peak = 0.406, on HermesLite2 0.230
-          offset = (device == DEVICE_HERMES_LITE2) ? 17.0 : 12.0;
-          break;
-        case NEW_PROTOCOL:
-          // TX dac feedback peak = 0.2899, on SATURN 0.6121
-          offset = (device == NEW_DEVICE_SATURN) ? 8.5 : 15.0;
-          break;
-        default:
-          // we probably never come here
-          offset = 0.0;
-          break;
-        }
-        for (i = 0; i < width; i++) {
-          *tfp++ = *rfp++ + offset;
-        }
-      }
-      g_mutex_unlock(&rx_feedback->display_mutex);
+      pacer_start(&tx->pacer, receiver[PS_RX_FEEDBACK]->id, tx->fps);
     } else {
-      rc = tx_get_pixels(tx);
+      pacer_start(&tx->pacer, tx->id, tx->fps);
     }
+    return TRUE; // keep going
+  }
+  return FALSE; // no more timer events
+}
+
+static gboolean tx_update_spectrum(gpointer data) {
+  TRANSMITTER *tx = (TRANSMITTER *)data;
+  int rc;
+  if (!tx->displaying) {
+    return G_SOURCE_REMOVE;
+  }
+  //
+  // if "MON" button is active (tx->feedback is TRUE),
+  // then obtain spectrum pixels from PS_RX_FEEDBACK,
+  // that is, display the (attenuated) TX signal from the "antenna"
+  //
+  g_mutex_lock(&tx->display_mutex);
+  if (tx->puresignal && tx->feedback) {
+    RECEIVER *rx_feedback = receiver[PS_RX_FEEDBACK];
+    g_mutex_lock(&rx_feedback->display_mutex);
+    rx_get_pixels(rx_feedback);
+    rc = rx_feedback->pixels_available;
     if (rc) {
-      if (remoteclient.running) {
-        send_txspectrum();
+      //
+      // The number of pixels that we need to copy depends on the "duplex" state.
+      // If duplex, then there is a separate TX window that is narrower than
+      // the window size.
+      //
+      int full  = rx_feedback->pixels;  // number of pixels in the feedback spectrum
+      int width = tx->pixels;           // number of pixels to copy from the feedback spectrum
+      int start = (full - width) / 2;   // Copy from start ... (end-1)
+      float *tfp = tx->pixel_samples;
+      const float *rfp = rx_feedback->pixel_samples + start;
+      float offset;
+      int i;
+      //
+      // The TX panadapter shows a RELATIVE signal strength. A CW or single-tone signal at
+      // full drive appears at 0dBm, the two peaks of a full-drive two-tone signal appear
+      // at -6 dBm each. THIS DOES NOT DEPEND ON THE POSITION OF THE DRIVE LEVEL SLIDER.
+      // The strength of the feedback signal, however, depends on the drive, on the PA and
+      // on the attenuation effective in the feedback path.
+      // We try to shift the RX feeback signal such that is looks like a "normal" TX
+      // panadapter if the feedback is optimal for PureSignal (that is, if the attenuation
+      // is optimal). The correction (offset) depends on the FPGA software inside the radio
+      // (diffent peak levels in the TX feedback channel).
+      //
+      // The (empirically) determined offset is 4.2 - 20*Log10(GetPk value), it is the larger
+      // the smaller the amplitude of the RX feedback signal is.
+      //
+      switch (protocol) {
+      case ORIGINAL_PROTOCOL:
+        // TX dac feedback peak = 0.406, on HermesLite2 0.230
+        offset = (device == DEVICE_HERMES_LITE2) ? 17.0 : 12.0;
+        break;
+      case NEW_PROTOCOL:
+        // TX dac feedback peak = 0.2899, on SATURN 0.6121
+        offset = (device == NEW_DEVICE_SATURN) ? 8.5 : 15.0;
+        break;
+      default:
+        // we probably never come here
+        offset = 0.0;
+        break;
+      }
+      for (i = 0; i < width; i++) {
+        *tfp++ = *rfp++ + offset;
       }
-      tx_panadapter_update(tx);
     }
-    g_mutex_unlock(&tx->display_mutex);
-    return TRUE; // keep going
+    g_mutex_unlock(&rx_feedback->display_mutex);
+  } else {
+    rc = tx_get_pixels(tx);
   }
-  return FALSE; // no more timer events
+  if (rc) {
+    if (remoteclient.running) {
+      send_txspectrum();
+    }
+    tx_panadapter_update(tx);
+    pacer_frame_shown(&tx->pacer);
+  }
+  g_mutex_unlock(&tx->display_mutex);
+  return G_SOURCE_REMOVE;
 }
 
 void tx_set_vox(const TRANSMITTER *tx) {
@@ -916,6 +937,7 @@ TRANSMITTER *tx_create_transmitter(int id, int pixels, int width, int height) {
   tx->alcmode = ALC_PEAK;
   tx->metermode = 0;  // PEP
   g_mutex_init(&tx->display_mutex);
+  pacer_init(&tx->pacer, tx_update_spectrum, tx);
   tx->update_timer_id = 0;
   tx->out_of_band_timer_id = 0;
   switch (protocol) {
@@ -1628,10 +1650,7 @@ static void tx_full_buffer(TRANSMITTER *tx) {
         // An inspection of the IQ samples produced by WDSP when TUNEing shows
         // that the amplitude of the pulse is in I (in the range 0.0 - 1.0)
         // and Q should be zero
-        for (j = 0; j < tx->output_samples; j++) {
-          double isample = gain * tx->cw_sig_rf[j];
-          old_protocol_iq_samples(isample, 0.0, tx->p1stone[j]);
-        }
+        old_protocol_iq_block(tx->cw_sig_rf, NULL, 1, tx->p1stone, gain, tx->output_samples);
       }
       break;
       case NEW_PROTOCOL:
@@ -1669,28 +1688,33 @@ static void tx_full_buffer(TRANSMITTER *tx) {
       //
       // Original code without pulse shaping and without side tone
       //
-      for (j = 0; j < tx->output_samples; j++) {
-        double isample = gain * tx->iq_output_buffer[j * 2];
-        double qsample = gain * tx->iq_output_buffer[(j * 2) + 1];
-        switch (protocol) {
-        case ORIGINAL_PROTOCOL:
-          //
-          // Normally, tx->p1stone[j] will be zero. It can be non-zero
-          // e.g. when producing a side tone while TUNE-ing
-          //
-          old_protocol_iq_samples(isample, qsample, tx->p1stone[j]);
-          break;
-        case NEW_PROTOCOL:
+      switch (protocol) {
+      case ORIGINAL_PROTOCOL:
+        //
+        // Normally, tx->p1stone[j] will be zero. It can be non-zero
+        // e.g. when producing a side tone while TUNE-ing
+        //
+        old_protocol_iq_block(tx->iq_output_buffer, tx->iq_output_buffer + 1, 2, tx->p1stone, gain,
+                              tx->output_samples);
+        break;
+      case NEW_PROTOCOL:
+        for (j = 0; j < tx->output_samples; j++) {
+          double isample = gain * tx->iq_output_buffer[j * 2];
+          double qsample = gain * tx->iq_output_buffer[(j * 2) + 1];
           new_protocol_iq_samples(isample, qsample);
-          break;
-        case SOAPYSDR_PROTOCOL:
+        }
+        break;
+      case SOAPYSDR_PROTOCOL:
+        for (j = 0; j < tx->output_samples; j++) {
 #ifdef SOAPYSDR
           // conversion from the native WDSP (double,double) format to
           // the radio format is done within the soapy layer
+          double isample = gain * tx->iq_output_buffer[j * 2];
+          double qsample = gain * tx->iq_output_buffer[(j * 2) + 1];
           soapy_protocol_iq_samples(isample, qsample);
 #endif
-          break;
         }
+        break;
       }
     }
   } else {
@@ -2038,11 +2062,13 @@ void tx_set_displaying(TRANSMITTER *tx) {
     }
     tx->update_timer_id = gdk_threads_add_timeout_full(G_PRIORITY_HIGH_IDLE, 1000 / tx->fps, tx_update_display,
       (gpointer)tx, NULL);
+    pacer_start(&tx->pacer, tx->id, tx->fps);
   } else {
     if (tx->update_timer_id > 0) {
       g_source_remove(tx->update_timer_id);
       tx->update_timer_id = 0;
     }
+    pacer_stop(&tx->pacer);
   }
 }
 
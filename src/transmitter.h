@@ -23,6 +23,7 @@
 #include <gtk/gtk.h>
 
 #include "atomic.h"
+#include "frame_pacer.h"
 
 #define CTCSS_FREQUENCIES 38
 extern double ctcss_frequencies[CTCSS_FREQUENCIES];
@@ -59,6 +60,7 @@ typedef struct _transmitter {
   int display_waterfall;
   guint update_timer_id;
   GMutex display_mutex;
+  FRAME_PACER pacer;                      // schedules a display update for each new spectrum
   int display_detector_mode;
   int display_average_mode;
   double display_average_time;
@@ -259,7 +259,7 @@ void vfo_xvtr_changed(void) {
       vfo[1].ctun = 0;
       vfo[1].frequency = vfo[1].lo + (radio->frequency_min + radio->frequency_max) / 2;
       vfo_id_adjust_band(1, vfo[1].frequency);
-      if (receivers == 2) {
+      if (receivers > 1) {
         rx_set_frequency(receiver[1], vfo[1].frequency);
       }
     }
@@ -495,7 +495,7 @@ void vfo_vfos_changed(void) {
   rx_vfo_changed(receiver[0]);
   radio_tx_vfo_changed();
   radio_apply_band_settings(1, 0);
-  if (receivers == 2) {
+  if (receivers > 1) {
     rx_vfo_changed(receiver[1]);
     radio_apply_band_settings(1, 1);
   }
@@ -514,7 +514,7 @@ void vfo_a_to_b(void) {
   }
   int oldmode = vfo[VFO_B].mode;
   vfo[VFO_B] = vfo[VFO_A];
-  if (vfo[VFO_B].mode != oldmode && receivers == 2) {
+  if (vfo[VFO_B].mode != oldmode && receivers > 1) {
     profiles_load_rxtx_profile(receiver[1]);
   }
   vfo_vfos_changed();
@@ -543,7 +543,7 @@ void vfo_a_swap_b(void) {
   vfo[VFO_B]        = temp;
   if (vfo[VFO_A].mode != vfo[VFO_B].mode) {
     profiles_load_rxtx_profile(receiver[0]);
-    if (receivers == 2) {
+    if (receivers > 1) {
       profiles_load_rxtx_profile(receiver[1]);
     }
   }
@@ -648,8 +648,11 @@ void vfo_id_step(int id, int st) {
       delta = vfo[id].frequency - delta;
       vfo_id_adjust_band(id, vfo[id].frequency);
     }
+    //
+    // The SAT modes only couple VFO_A and VFO_B
+    //
     int sid = 1 - id;
-    switch (sat_mode) {
+    switch (id > VFO_B ? SAT_NONE : sat_mode) {
     case SAT_NONE:
       break;
     case SAT_MODE:
@@ -767,8 +770,11 @@ void vfo_id_move(int id, long long hz, int round) {
       delta = vfo[id].frequency - delta;
       vfo_id_adjust_band(id, vfo[id].frequency);
     }
+    //
+    // The SAT modes only couple VFO_A and VFO_B
+    //
     int sid = 1 - id;
-    switch (sat_mode) {
+    switch (id > VFO_B ? SAT_NONE : sat_mode) {
     case SAT_NONE:
       break;
     case SAT_MODE:
@@ -826,8 +832,11 @@ void vfo_id_move_to(int id, long long f, int round) {
       delta = vfo[id].frequency - delta;
       vfo_id_adjust_band(id, vfo[id].frequency);
     }
+    //
+    // The SAT modes only couple VFO_A and VFO_B
+    //
     int sid = 1 - id;
-    switch (sat_mode) {
+    switch (id > VFO_B ? SAT_NONE : sat_mode) {
     case SAT_NONE:
       break;
     case SAT_MODE:
@@ -1667,20 +1676,24 @@ GtkWidget* vfo_init(int width, int height) {
 //
 
 int vfo_get_tx_vfo(void) {
+  //
+  // Only VFO_A and VFO_B can control the transmitter. If one of
+  // the additional receivers (RX3 and beyond) is active, VFO_A
+  // is used for TX (or VFO_B if SPLIT is engaged).
+  //
   int txvfo = active_receiver->id;
+  if (txvfo > VFO_B) { txvfo = VFO_A; }
   if (split) { txvfo = 1 - txvfo; }
   return txvfo;
 }
 
 int vfo_get_tx_mode(void) {
-  int txvfo = active_receiver->id;
-  if (split) { txvfo = 1 - txvfo; }
+  int txvfo = vfo_get_tx_vfo();
   return vfo[txvfo].mode;
 }
 
 long long vfo_get_tx_freq(void) {
-  int txvfo = active_receiver->id;
-  if (split) { txvfo = 1 - txvfo; }
+  int txvfo = vfo_get_tx_vfo();
   if (vfo[txvfo].ctun) {
     return  vfo[txvfo].ctun_frequency;
   } else {
@@ -1811,7 +1824,7 @@ void vfo_id_set_frequency(int v, long long f) {
     // VFO without telling WDSP about it.
     // If VFO_B controls a (running) receiver, do the "full job".
     //
-    if (receivers == 2) {
+    if (receivers > 1) {
       rx_set_frequency(receiver[1], f);
     } else {
       vfo[v].frequency = f;
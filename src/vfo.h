@@ -27,10 +27,15 @@
 
 enum _vfo_enum {
   VFO_A = 0,
-  VFO_B,
-  MAX_VFOS
+  VFO_B
 };
 
+//
+// There is one VFO per receiver. VFO_A and VFO_B (that is, those of
+// RX1 and RX2) play a special role for SPLIT and the SAT modes.
+//
+#define MAX_VFOS MAX_RECEIVERS
+
 struct _vfo {
   //
   // Band data
@@ -22,6 +22,7 @@
 #include <math.h>
 #include <unistd.h>
 #include <semaphore.h>
+#include <stdint.h>
 #include <string.h>
 #include "radio.h"
 #include "vfo.h"
@@ -37,33 +38,100 @@ static int colorHighR = 255; // yellow
 static int colorHighG = 255;
 static int colorHighB = 0;
 
+//
+// Colour lookup table, indexed by the position of a sample between the lower
+// and upper waterfall level (0 ... WF_LUT_SIZE-1). The last entry is the colour
+// for samples above the upper level. The table does not depend on the levels,
+// so it is built only once.
+//
+#define WF_LUT_SIZE 1024
+static uint32_t wf_lut[WF_LUT_SIZE + 1];
+static int wf_lut_ready = 0;
+
+static uint32_t wf_rgb(int r, int g, int b) {
+  return ((uint32_t) r << 16) | ((uint32_t) g << 8) | (uint32_t) b;
+}
+
+static void wf_lut_init(void) {
+  for (int i = 0; i < WF_LUT_SIZE; i++) {
+    float percent = (float) i / (float)(WF_LUT_SIZE - 1);
+    if (percent < 0.222222f) {
+      float local_percent = percent * 4.5f;
+      wf_lut[i] = wf_rgb((int)((1.0f - local_percent) * colorLowR), (int)((1.0f - local_percent) * colorLowG),
+                         (int)(colorLowB + local_percent * (255 - colorLowB)));
+    } else if (percent < 0.333333f) {
+      float local_percent = (percent - 0.222222f) * 9.0f;
+      wf_lut[i] = wf_rgb(0, (int)(local_percent * 255), 255);
+    } else if (percent < 0.444444f) {
+      float local_percent = (percent - 0.333333) * 9.0f;
+      wf_lut[i] = wf_rgb(0, 255, (int)((1.0f - local_percent) * 255));
+    } else if (percent < 0.555555f) {
+      float local_percent = (percent - 0.444444f) * 9.0f;
+      wf_lut[i] = wf_rgb((int)(local_percent * 255), 255, 0);
+    } else if (percent < 0.777777f) {
+      float local_percent = (percent - 0.555555f) * 4.5f;
+      wf_lut[i] = wf_rgb(255, (int)((1.0f - local_percent) * 255), 0);
+    } else if (percent < 0.888888f) {
+      float local_percent = (percent - 0.777777f) * 9.0f;
+      wf_lut[i] = wf_rgb(255, 0, (int)(local_percent * 255));
+    } else {
+      float local_percent = (percent - 0.888888f) * 9.0f;
+      wf_lut[i] = wf_rgb((int)((0.75f + 0.25f * (1.0f - local_percent)) * 255.0f),
+                         (int)(local_percent * 255.0f * 0.5f), 255);
+    }
+  }
+  wf_lut[WF_LUT_SIZE] = wf_rgb(colorHighR, colorHighG, colorHighB);
+  wf_lut_ready = 1;
+}
+
+static void waterfall_clear(RECEIVER *rx) {
+  unsigned char *pixels = cairo_image_surface_get_data(rx->waterfall_surface);
+  int height = cairo_image_surface_get_height(rx->waterfall_surface);
+  int stride = cairo_image_surface_get_stride(rx->waterfall_surface);
+  memset(pixels, 0, height * stride);
+  rx->waterfall_head = 0;
+}
+
 /* Create a new surface of the appropriate size to store our scribbles */
 static gboolean
 waterfall_configure_event_cb (GtkWidget *widget, GdkEventConfigure *event, gpointer data) {
   RECEIVER *rx = (RECEIVER *)data;
-  if (rx->pixbuf) {
-    g_object_unref(rx->pixbuf);
+  if (rx->waterfall_surface) {
+    cairo_surface_destroy(rx->waterfall_surface);
   }
   int width = gtk_widget_get_allocated_width (widget);
   int heigt = gtk_widget_get_allocated_height (widget);
-  rx->pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, width, heigt);
-  unsigned char *pixels = gdk_pixbuf_get_pixels (rx->pixbuf);
-  memset(pixels, 0, width * heigt * 3);
+  rx->waterfall_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, heigt);
+  waterfall_clear(rx);
+  cairo_surface_mark_dirty(rx->waterfall_surface);
   return TRUE;
 }
 
 /* Redraw the screen from the surface. Note that the ::draw
  * signal receives a ready-to-be-used cairo_t that is already
  * clipped to only draw the exposed areas of the widget
+ *
+ * The rows of the surface form a ring with the newest row at
+ * waterfall_head, so it is painted in two pieces: from the head
+ * to the bottom of the surface, followed by the rows above the head.
  */
 static gboolean
 waterfall_draw_cb (GtkWidget *widget,
                    cairo_t   *cr,
                    gpointer   data) {
   const RECEIVER *rx = (RECEIVER *)data;
-  if (rx->pixbuf) {
-    gdk_cairo_set_source_pixbuf (cr, rx->pixbuf, 0, 0);
-    cairo_paint (cr);
+  if (rx->waterfall_surface) {
+    int width = cairo_image_surface_get_width(rx->waterfall_surface);
+    int height = cairo_image_surface_get_height(rx->waterfall_surface);
+    int head = rx->waterfall_head;
+    cairo_set_source_surface (cr, rx->waterfall_surface, 0, -head);
+    cairo_rectangle(cr, 0, 0, width, height - head);
+    cairo_fill(cr);
+    if (head > 0) {
+      cairo_set_source_surface (cr, rx->waterfall_surface, 0, height - head);
+      cairo_rectangle(cr, 0, height - head, width, head);
+      cairo_fill(cr);
+    }
   }
   return FALSE;
 }
@@ -86,14 +154,15 @@ static gboolean waterfall_scroll_event_cb (GtkWidget *widget, GdkEventScroll *ev
 }
 
 void waterfall_update(RECEIVER *rx) {
-  if (rx->pixbuf && rx->pixels_available) {
+  if (rx->waterfall_surface && rx->pixels_available) {
     const float *samples;
     long long frequency = vfo[rx->id].frequency; // access only once to be thread-safe
     int  freq_changed = 0;                    // flag whether we have just "rotated"
-    unsigned char *pixels = gdk_pixbuf_get_pixels (rx->pixbuf);
-    int width = gdk_pixbuf_get_width(rx->pixbuf);
-    int height = gdk_pixbuf_get_height(rx->pixbuf);
-    int rowstride = gdk_pixbuf_get_rowstride(rx->pixbuf);
+    cairo_surface_flush(rx->waterfall_surface);
+    unsigned char *pixels = cairo_image_surface_get_data(rx->waterfall_surface);
+    int width = cairo_image_surface_get_width(rx->waterfall_surface);
+    int height = cairo_image_surface_get_height(rx->waterfall_surface);
+    int rowstride = cairo_image_surface_get_stride(rx->waterfall_surface);
     //
     // The existing waterfall corresponds to a center frequency rx->waterfall_frequency, a zoom value rx->waterfall_zoom and
     // a pan value rx->waterfall_pan. If the zoom value changes, or if the waterfill needs horizontal shifting larger
@@ -116,7 +185,7 @@ void waterfall_update(RECEIVER *rx) {
           //
           // If horizontal shift is too large, re-init waterfall
           //
-          memset(pixels, 0, width * height * 3);
+          waterfall_clear(rx);
           rx->waterfall_frequency = frequency;
           rx->waterfall_cBp = rx->cBp;
         } else {
@@ -125,17 +194,16 @@ void waterfall_update(RECEIVER *rx) {
           // calculated which VFO/pan value combination the shifted waterfall corresponds to
           //
           //
-          if (rotate_pixels < 0) {
-            // shift left, and clear the right-most part
-            memmove(pixels, &pixels[-rotate_pixels * 3], ((width * height) + rotate_pixels) * 3);
-            for (int i = 0; i < height; i++) {
-              memset(&pixels[((i * width) + (width + rotate_pixels)) * 3], 0, -rotate_pixels * 3);
-            }
-          } else if (rotate_pixels > 0) {
-            // shift right, and clear left-most part
-            memmove(&pixels[rotate_pixels * 3], pixels, ((width * height) - rotate_pixels) * 3);
-            for (int i = 0; i < height; i++) {
-              memset(&pixels[(i * width) * 3], 0, rotate_pixels * 3);
+          for (int i = 0; i < height && rotate_pixels != 0; i++) {
+            unsigned char *row = &pixels[i * rowstride];
+            if (rotate_pixels < 0) {
+              // shift left, and clear the right-most part
+              memmove(row, &row[-rotate_pixels * 4], (width + rotate_pixels) * 4);
+              memset(&row[(width + rotate_pixels) * 4], 0, -rotate_pixels * 4);
+            } else {
+              // shift right, and clear left-most part
+              memmove(&row[rotate_pixels * 4], row, (width - rotate_pixels) * 4);
+              memset(row, 0, rotate_pixels * 4);
             }
           }
           if (rotfreq != 0) {
@@ -150,7 +218,7 @@ void waterfall_update(RECEIVER *rx) {
       // waterfall frequency not (yet) set, sample rate changed, or zoom value changed:
       // (re-) init waterfall
       //
-      memset(pixels, 0, width * height * 3);
+      waterfall_clear(rx);
       rx->waterfall_frequency = frequency;
       rx->waterfall_cBp = rx->cBp;
       rx->waterfall_cB = rx->cB;
@@ -165,13 +233,16 @@ void waterfall_update(RECEIVER *rx) {
     // stabilised. This will not remove the artifacts in any case but is a big
     // improvement.
     //
-    if (!freq_changed) {
-      memmove(&pixels[rowstride], pixels, (height - 1)*rowstride);
+    if (!freq_changed && height > 0) {
+      //
+      // The new line goes to the row above the current head, such that only
+      // one row of pixels is written per update
+      //
+      rx->waterfall_head = (rx->waterfall_head + height - 1) % height;
+      uint32_t *p = (uint32_t *)&pixels[rx->waterfall_head * rowstride];
       float soffset;
-      unsigned char *p;
-      p = pixels;
       samples = rx->pixel_samples;
-      float wf_low, wf_high, rangei;
+      float wf_low, wf_high, scale;
       int id = rx->id;
       int b = vfo[id].band;
       const BAND *band = band_get_band(b);
@@ -200,64 +271,28 @@ void waterfall_update(RECEIVER *rx) {
         wf_low  = (float) rx->waterfall_low;
         wf_high = (float) rx->waterfall_high;
       }
-      rangei = 1.0F / (wf_high - wf_low);
+      //
+      // Map each sample to an index into the colour table. Samples below the
+      // lower level get the first entry (the "low" colour), samples above
+      // the upper level the extra last entry (the "high" colour).
+      //
+      scale = (float)(WF_LUT_SIZE - 1) / (wf_high - wf_low);
+      wf_low -= soffset;
       for (int i = 0; i < width; i++) {
-        float sample = samples[i] + soffset;
-        if (sample < wf_low) {
-          *p++ = colorLowR;
-          *p++ = colorLowG;
-          *p++ = colorLowB;
-        } else if (sample > wf_high) {
-          *p++ = colorHighR;
-          *p++ = colorHighG;
-          *p++ = colorHighB;
-        } else {
-          float percent = (sample - wf_low) * rangei;
-          if (percent < 0.222222f) {
-            float local_percent = percent * 4.5f;
-            *p++ = (int)((1.0f - local_percent) * colorLowR);
-            *p++ = (int)((1.0f - local_percent) * colorLowG);
-            *p++ = (int)(colorLowB + local_percent * (255 - colorLowB));
-          } else if (percent < 0.333333f) {
-            float local_percent = (percent - 0.222222f) * 9.0f;
-            *p++ = 0;
-            *p++ = (int)(local_percent * 255);
-            *p++ = 255;
-          } else if (percent < 0.444444f) {
-            float local_percent = (percent - 0.333333) * 9.0f;
-            *p++ = 0;
-            *p++ = 255;
-            *p++ = (int)((1.0f - local_percent) * 255);
-          } else if (percent < 0.555555f) {
-            float local_percent = (percent - 0.444444f) * 9.0f;
-            *p++ = (int)(local_percent * 255);
-            *p++ = 255;
-            *p++ = 0;
-          } else if (percent < 0.777777f) {
-            float local_percent = (percent - 0.555555f) * 4.5f;
-            *p++ = 255;
-            *p++ = (int)((1.0f - local_percent) * 255);
-            *p++ = 0;
-          } else if (percent < 0.888888f) {
-            float local_percent = (percent - 0.777777f) * 9.0f;
-            *p++ = 255;
-            *p++ = 0;
-            *p++ = (int)(local_percent * 255);
-          } else {
-            float local_percent = (percent - 0.888888f) * 9.0f;
-            *p++ = (int)((0.75f + 0.25f * (1.0f - local_percent)) * 255.0f);
-            *p++ = (int)(local_percent * 255.0f * 0.5f);
-            *p++ = 255;
-          }
-        }
+        float x = (samples[i] - wf_low) * scale;
+        int k = (x <= 0.0F) ? 0 : (x > (float)(WF_LUT_SIZE - 1)) ? WF_LUT_SIZE : (int) x;
+        p[i] = wf_lut[k];
       }
     }
+    cairo_surface_mark_dirty(rx->waterfall_surface);
     gtk_widget_queue_draw (rx->waterfall);
   }
 }
 
 void waterfall_init(RECEIVER *rx, int width, int height) {
-  rx->pixbuf = NULL;
+  if (!wf_lut_ready) { wf_lut_init(); }
+  rx->waterfall_surface = NULL;
+  rx->waterfall_head = 0;
   rx->waterfall_frequency = 0;
   rx->waterfall = gtk_drawing_area_new ();
   gtk_widget_set_size_request (rx->waterfall, width, height);
@@ -0,0 +1,438 @@
+/* Copyright (C)
+*  2026 - Christoph van Wüllen, DL1YCF
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+/*
+ * wdspbench: measure the throughput of the WDSP library without
+ * a radio and without a GUI.
+ *
+ * For a number of configurations (sample rate, buffer size, noise
+ * reduction, noise blanker, AGC, filter taps, TX, PureSignal), a
+ * WDSP channel is opened and fed with synthetic IQ data (noise plus
+ * a -73 dBm tone, the same signals hpsdrsim produces) through
+ * fexchange0() as fast as possible. For each configuration the
+ * number of input samples processed per second, the real-time
+ * factor (signal duration / elapsed time), and the longest fexchange0()
+ * call (hand-off of the input block until its output is available)
+ * is reported.
+ *
+ * Usage: wdspbench [-t seconds] [-j file.json] [-w wisdom-dir] [-c pattern] [-l] [-p]
+ *
+ *  -t seconds  amount of signal to process per configuration (default: 5)
+ *  -j file     write the results in JSON format to this file
+ *  -w dir      directory of the WDSP wisdom file (default: current directory)
+ *  -c pattern  only run configurations whose name contains pattern
+ *  -l          list configurations and exit
+ *  -p          print the dispatch plan (active DSP stages) of each configuration
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+
+#include <wdsp.h>
+
+#include "mode.h"
+#include "simsignal.h"
+
+#ifndef GIT_COMMIT
+  #define GIT_COMMIT "unknown"
+#endif
+
+#define BENCH_RX 0
+#define BENCH_TX 1
+#define BENCH_PS 2
+
+#define LENTAB   262144            // length of signal table, multiple of all buffer sizes
+#define DSPSIZE  2048              // the number of filter taps must not be smaller
+
+typedef struct _bench_config {
+  const char *name;
+  int type;                        // BENCH_RX, BENCH_TX, BENCH_PS
+  int rate;                        // RX: input sample rate, TX: DSP sample rate
+  int bufsize;                     // input buffer size (complex samples)
+  int nr;                          // noise reduction 0 (off), 1 - 4
+  int nb;                          // noise blanker 0 (off), 1, 2
+  int snb;                         // spectral noise blanker
+  int agc;                         // WDSP AGC mode 0 (fixed) to 4 (fast)
+  int nc;                          // filter taps, 0: default
+  int pipe;                        // RX: pipelined execution
+} BENCH_CONFIG;
+
+typedef struct _bench_result {
+  double seconds;                  // elapsed wall clock time
+  double samples_per_sec;          // input samples per second
+  double realtime;                 // real-time factor
+  double call_max;                 // longest fexchange0() call (seconds)
+} BENCH_RESULT;
+
+static const BENCH_CONFIG configs[] = {
+  { "rx-48k",           BENCH_RX,   48000, 1024, 0, 0, 0, 3,     0, 0 },
+  { "rx-96k",           BENCH_RX,   96000, 1024, 0, 0, 0, 3,     0, 0 },
+  { "rx-192k",          BENCH_RX,  192000, 1024, 0, 0, 0, 3,     0, 0 },
+  { "rx-384k",          BENCH_RX,  384000, 1024, 0, 0, 0, 3,     0, 0 },
+  { "rx-768k",          BENCH_RX,  768000, 1024, 0, 0, 0, 3,     0, 0 },
+  { "rx-1536k",         BENCH_RX, 1536000, 1024, 0, 0, 0, 3,     0, 0 },
+  { "rx-1536k-pipe",    BENCH_RX, 1536000, 1024, 0, 0, 0, 3,     0, 1 },
+  { "rx-192k-buf512",   BENCH_RX,  192000,  512, 0, 0, 0, 3,     0, 0 },
+  { "rx-192k-buf2048",  BENCH_RX,  192000, 2048, 0, 0, 0, 3,     0, 0 },
+  { "rx-192k-buf4096",  BENCH_RX,  192000, 4096, 0, 0, 0, 3,     0, 0 },
+  { "rx-192k-nr1",      BENCH_RX,  192000, 1024, 1, 0, 0, 3,     0, 0 },
+  { "rx-192k-nr2",      BENCH_RX,  192000, 1024, 2, 0, 0, 3,     0, 0 },
+  { "rx-192k-nr3",      BENCH_RX,  192000, 1024, 3, 0, 0, 3,     0, 0 },
+  { "rx-192k-nr4",      BENCH_RX,  192000, 1024, 4, 0, 0, 3,     0, 0 },
+  { "rx-192k-nb1",      BENCH_RX,  192000, 1024, 0, 1, 0, 3,     0, 0 },
+  { "rx-192k-nb2",      BENCH_RX,  192000, 1024, 0, 2, 0, 3,     0, 0 },
+  { "rx-192k-snb",      BENCH_RX,  192000, 1024, 0, 0, 1, 3,     0, 0 },
+  { "rx-192k-agc-off",  BENCH_RX,  192000, 1024, 0, 0, 0, 0,     0, 0 },
+  { "rx-192k-agc-long", BENCH_RX,  192000, 1024, 0, 0, 0, 1,     0, 0 },
+  { "rx-192k-agc-slow", BENCH_RX,  192000, 1024, 0, 0, 0, 2,     0, 0 },
+  { "rx-192k-agc-fast", BENCH_RX,  192000, 1024, 0, 0, 0, 4,     0, 0 },
+  { "rx-192k-taps4096", BENCH_RX,  192000, 1024, 0, 0, 0, 3,  4096, 0 },
+  { "rx-192k-taps8192", BENCH_RX,  192000, 1024, 0, 0, 0, 3,  8192, 0 },
+  { "rx-192k-taps16k",  BENCH_RX,  192000, 1024, 0, 0, 0, 3, 16384, 0 },
+  { "rx-192k-all",      BENCH_RX,  192000, 1024, 2, 2, 1, 3,  8192, 0 },
+  { "tx-48k",           BENCH_TX,   48000, 1024, 0, 0, 0, 0,     0, 0 },
+  { "tx-96k",           BENCH_TX,   96000, 1024, 0, 0, 0, 0,     0, 0 },
+  { "tx-96k-taps8192",  BENCH_TX,   96000, 1024, 0, 0, 0, 0,  8192, 0 },
+  { "tx-96k-ps",        BENCH_PS,   96000, 1024, 0, 0, 0, 0,     0, 0 },
+};
+
+#define NUMCONFIGS (int)(sizeof(configs) / sizeof(configs[0]))
+
+static const char *type_string[3] = { "rx", "tx", "ps" };
+
+static double noiseItab[LENTAB];
+static double noiseQtab[LENTAB];
+static double sigtab[2 * LENTAB];
+static int show_plan = 0;
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.0E-9 * ts.tv_nsec;
+}
+
+//
+// RX input: noise at the ADC noise floor plus a -73 dBm tone 1 kHz above
+// the centre frequency. For the noise blanker tests, impulse noise
+// (100 pulses per second) is added. For TX, a 1 kHz tone at half
+// amplitude is used as the microphone signal.
+//
+static void make_signal(const BENCH_CONFIG *cfg) {
+  static double pulses[LENTAB];
+  double arg = 0.0;
+  double fac = sqrt(cfg->rate / 1000.0);
+  double delta;
+  if (cfg->type == BENCH_RX) {
+    delta = SIM_TWOPI * 1000.0 / cfg->rate;
+    if (cfg->nb) {
+      sim_impulse_table(pulses, LENTAB, (int)(100.0 * LENTAB / cfg->rate), cfg->rate / 48000 + 1);
+    } else {
+      memset(pulses, 0, sizeof(pulses));
+    }
+    for (int i = 0; i < LENTAB; i++) {
+      sigtab[2 * i]     = noiseItab[i] * fac + cos(arg) * SIM_AMPL_73DBM + 0.1 * pulses[i];
+      sigtab[2 * i + 1] = noiseQtab[i] * fac + sin(arg) * SIM_AMPL_73DBM;
+      arg += delta;
+      if (arg > SIM_TWOPI) { arg -= SIM_TWOPI; }
+    }
+  } else {
+    delta = SIM_TWOPI * 1000.0 / 48000.0;
+    for (int i = 0; i < LENTAB; i++) {
+      sigtab[2 * i]     = 0.5 * cos(arg);
+      sigtab[2 * i + 1] = 0.0;
+      arg += delta;
+      if (arg > SIM_TWOPI) { arg -= SIM_TWOPI; }
+    }
+  }
+}
+
+static void setup_rx(int ch, const BENCH_CONFIG *cfg) {
+  OpenChannel(ch, cfg->bufsize, DSPSIZE, cfg->rate, 48000, 48000, 0, 1, 0.000, 0.025, 0.0, 0.010, 1);
+  create_anbEXT(ch, 1, cfg->bufsize, cfg->rate, 0.0001, 0.0001, 0.0001, 0.05, 20);
+  create_nobEXT(ch, 1, 0, cfg->bufsize, cfg->rate, 0.0001, 0.0001, 0.0001, 0.05, 20);
+  SetRXABandpassRun(ch, 1);
+  SetRXAPanelRun(ch, 1);
+  SetRXAPanelSelect(ch, 3);
+  SetRXAMode(ch, modeUSB);
+  RXASetPassband(ch, 150.0, 2850.0);
+  if (cfg->nc > 0) { RXASetNC(ch, cfg->nc); }
+  if (cfg->agc == 0) { SetRXAAGCFixed(ch, 60.0); }
+  SetRXAAGCMode(ch, cfg->agc);
+  SetRXAAGCTop(ch, 80.0);
+  switch (cfg->nr) {
+  case 1:
+    SetRXAANRVals(ch, 64, 16, 16e-4, 10e-7);
+    SetRXAANRRun(ch, 1);
+    break;
+  case 2:
+    SetRXAEMNRRun(ch, 1);
+    break;
+  case 3:
+    SetRXARNNRRun(ch, 1);
+    break;
+  case 4:
+    SetRXASBNRRun(ch, 1);
+    break;
+  }
+  SetRXASNBARun(ch, cfg->snb);
+  SetRXAPipeline(ch, cfg->pipe);
+}
+
+static void setup_tx(int ch, const BENCH_CONFIG *cfg) {
+  int outrate = (cfg->rate == 48000) ? 48000 : 192000;
+  OpenChannel(ch, cfg->bufsize, DSPSIZE, 48000, cfg->rate, outrate, 1, 1, 0.000, 0.025, 0.0, 0.010, 1);
+  SetTXABandpassRun(ch, 1);
+  SetTXAPanelRun(ch, 1);
+  SetTXAPanelSelect(ch, 2);
+  SetTXAALCSt(ch, 1);
+  SetTXAMode(ch, modeUSB);
+  SetTXABandpassFreqs(ch, 150.0, 2850.0);
+  if (cfg->nc > 0) { TXASetNC(ch, cfg->nc); }
+  if (cfg->type == BENCH_PS) {
+    SetPSFeedbackRate(ch, outrate);
+    SetPSHWPeak(ch, 0.2899);
+    SetPSMox(ch, 1);
+    SetPSControl(ch, 0, 0, 1, 0);
+  }
+}
+
+//
+// Feed nblocks buffers through fexchange0, return the elapsed time
+// and the longest fexchange0() call.
+// For PureSignal, the TX output is "distorted" (soft compression with
+// some AM-PM conversion) and fed back to pscc together with the TX output.
+//
+static double run_blocks(int ch, const BENCH_CONFIG *cfg, int nblocks, double *in, double *out, int outsize,
+                         double *fb, double *call_max) {
+  int err;
+  int ptr = 0;
+  double t0 = now();
+  *call_max = 0.0;
+  for (int n = 0; n < nblocks; n++) {
+    memcpy(in, sigtab + 2 * ptr, 2 * cfg->bufsize * sizeof(double));
+    ptr += cfg->bufsize;
+    if (ptr >= LENTAB) { ptr = 0; }
+    if (cfg->type == BENCH_RX) {
+      switch (cfg->nb) {
+      case 1:
+        xanbEXT(ch, in, in);
+        break;
+      case 2:
+        xnobEXT(ch, in, in);
+        break;
+      }
+    }
+    double tc = now();
+    fexchange0(ch, in, out, &err);
+    tc = now() - tc;
+    if (tc > *call_max) { *call_max = tc; }
+    if (cfg->type == BENCH_PS) {
+      for (int i = 0; i < outsize; i++) {
+        double re = out[2 * i];
+        double im = out[2 * i + 1];
+        double mag = re * re + im * im;
+        double gain = 0.5 * (1.0 - 0.3 * mag);
+        double phi = 0.2 * mag;
+        fb[2 * i]     = gain * (re * cos(phi) - im * sin(phi));
+        fb[2 * i + 1] = gain * (re * sin(phi) + im * cos(phi));
+      }
+      pscc(ch, outsize, out, fb);
+    }
+  }
+  return now() - t0;
+}
+
+static void setup_channel(int ch, const BENCH_CONFIG *cfg) {
+  if (cfg->type == BENCH_RX) {
+    setup_rx(ch, cfg);
+  } else {
+    setup_tx(ch, cfg);
+  }
+}
+
+static void close_channel(int ch, const BENCH_CONFIG *cfg) {
+  if (cfg->type == BENCH_PS) {
+    SetPSControl(ch, 1, 0, 0, 0);
+    SetPSMox(ch, 0);
+  }
+  CloseChannel(ch);
+  if (cfg->type == BENCH_RX) {
+    destroy_anbEXT(ch);
+    destroy_nobEXT(ch);
+  }
+}
+
+static void run_config(const BENCH_CONFIG *cfg, double seconds, BENCH_RESULT *result) {
+  int ch = (cfg->type == BENCH_RX) ? 0 : 1;
+  int inrate = (cfg->type == BENCH_RX) ? cfg->rate : 48000;
+  int outrate;
+  if (cfg->type == BENCH_RX) {
+    outrate = 48000;
+  } else {
+    outrate = (cfg->rate == 48000) ? 48000 : 192000;
+  }
+  int outsize = (int)(((long) cfg->bufsize * outrate) / inrate);
+  int nblocks = (int)(seconds * inrate / cfg->bufsize) + 1;
+  int warmup = inrate / (2 * cfg->bufsize) + 1;
+  double *in = malloc(2 * cfg->bufsize * sizeof(double));
+  double *out = malloc(2 * outsize * sizeof(double));
+  double *fb = malloc(2 * outsize * sizeof(double));
+  make_signal(cfg);
+  setup_channel(ch, cfg);
+  //
+  // FFT sizes used for the first time are planned quickly and optimised
+  // in the background. Wait for this and re-open the channel, so that
+  // only optimal plans are timed.
+  //
+  if (wisdom_pending() > 0) {
+    while (wisdom_pending() > 0) { usleep(100000); }
+    close_channel(ch, cfg);
+    setup_channel(ch, cfg);
+  }
+  //
+  // Let filters and noise estimates settle before timing
+  //
+  run_blocks(ch, cfg, warmup, in, out, outsize, fb, &result->call_max);
+  if (show_plan) {
+    char plan[4096];
+    if (cfg->type == BENCH_RX) {
+      GetRXADispatch(ch, plan, sizeof(plan));
+    } else {
+      GetTXADispatch(ch, plan, sizeof(plan));
+    }
+    printf("Dispatch plan of %s: %s", cfg->name, plan);
+  }
+  result->seconds = run_blocks(ch, cfg, nblocks, in, out, outsize, fb, &result->call_max);
+  result->samples_per_sec = (double) nblocks * cfg->bufsize / result->seconds;
+  result->realtime = result->samples_per_sec / inrate;
+  close_channel(ch, cfg);
+  free(in);
+  free(out);
+  free(fb);
+}
+
+static void write_json(const char *filename, double seconds, const BENCH_RESULT *results, const int *selected) {
+  char host[256];
+  struct utsname uts;
+  FILE *fp = fopen(filename, "w");
+  if (fp == NULL) {
+    perror(filename);
+    return;
+  }
+  if (gethostname(host, sizeof(host)) < 0) { snprintf(host, sizeof(host), "unknown"); }
+  host[sizeof(host) - 1] = 0;
+  if (uname(&uts) < 0) {
+    snprintf(uts.sysname, sizeof(uts.sysname), "unknown");
+    snprintf(uts.machine, sizeof(uts.machine), "unknown");
+  }
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"commit\": \"%s\",\n", GIT_COMMIT);
+  fprintf(fp, "  \"host\": \"%s\",\n", host);
+  fprintf(fp, "  \"os\": \"%s\",\n", uts.sysname);
+  fprintf(fp, "  \"machine\": \"%s\",\n", uts.machine);
+  fprintf(fp, "  \"time\": %ld,\n", (long) time(NULL));
+  fprintf(fp, "  \"seconds\": %g,\n", seconds);
+  fprintf(fp, "  \"results\": [");
+  int first = 1;
+  for (int i = 0; i < NUMCONFIGS; i++) {
+    const BENCH_CONFIG *cfg = &configs[i];
+    if (!selected[i]) { continue; }
+    fprintf(fp, "%s\n    { \"name\": \"%s\", \"type\": \"%s\", \"rate\": %d, \"bufsize\": %d,"
+            " \"nr\": %d, \"nb\": %d, \"snb\": %d, \"agc\": %d, \"taps\": %d, \"pipe\": %d,"
+            " \"samples_per_sec\": %.0f, \"realtime_factor\": %.2f, \"call_max_us\": %.1f }",
+            first ? "" : ",", cfg->name, type_string[cfg->type], cfg->rate, cfg->bufsize,
+            cfg->nr, cfg->nb, cfg->snb, cfg->agc, cfg->nc > 0 ? cfg->nc : DSPSIZE, cfg->pipe,
+            results[i].samples_per_sec, results[i].realtime, 1.0E6 * results[i].call_max);
+    first = 0;
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  fclose(fp);
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr, "Usage: %s [-t seconds] [-j file.json] [-w wisdom-dir] [-c pattern] [-l] [-p]\n", prog);
+  exit(1);
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = 5.0;
+  const char *jsonfile = NULL;
+  const char *pattern = NULL;
+  char wisdom_dir[1024];
+  int list = 0;
+  int opt;
+  unsigned int seed = 1234;
+  BENCH_RESULT results[NUMCONFIGS];
+  int selected[NUMCONFIGS];
+  snprintf(wisdom_dir, sizeof(wisdom_dir), "./");
+  while ((opt = getopt(argc, argv, "t:j:w:c:lp")) != -1) {
+    switch (opt) {
+    case 't':
+      seconds = atof(optarg);
+      if (seconds <= 0.0) { usage(argv[0]); }
+      break;
+    case 'j':
+      jsonfile = optarg;
+      break;
+    case 'w':
+      snprintf(wisdom_dir, sizeof(wisdom_dir), "%s/", optarg);
+      break;
+    case 'c':
+      pattern = optarg;
+      break;
+    case 'l':
+      list = 1;
+      break;
+    case 'p':
+      show_plan = 1;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  for (int i = 0; i < NUMCONFIGS; i++) {
+    selected[i] = (pattern == NULL || strstr(configs[i].name, pattern) != NULL);
+    if (list && selected[i]) { printf("%s\n", configs[i].name); }
+  }
+  if (list) { return 0; }
+  //
+  // The noise table has the same statistics as the one in hpsdrsim, a fixed
+  // seed makes the input reproducible from run to run.
+  //
+  sim_noise_table(noiseItab, noiseQtab, LENTAB, &seed);
+  if (WDSPwisdom(wisdom_dir)) {
+    printf("No WDSP wisdom file yet, FFT sizes are optimised when first used.\n");
+  }
+  printf("%-20s %10s %8s %14s %10s %14s\n", "Configuration", "Rate", "Buffer", "Samples/sec", "Realtime",
+         "Max call (us)");
+  for (int i = 0; i < NUMCONFIGS; i++) {
+    if (!selected[i]) { continue; }
+    run_config(&configs[i], seconds, &results[i]);
+    printf("%-20s %10d %8d %14.0f %9.1fx %14.1f\n", configs[i].name, configs[i].rate, configs[i].bufsize,
+           results[i].samples_per_sec, results[i].realtime, 1.0E6 * results[i].call_max);
+    fflush(stdout);
+  }
+  if (jsonfile) { write_json(jsonfile, seconds, results, selected); }
+  return 0;
+}
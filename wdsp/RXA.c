@@ -28,6 +28,136 @@ warren@wpratt.com
 
 struct _rxa rxa[MAX_CHANNELS];
 
+static void pipe_buffers (int channel)
+{
+	// (re-)allocate the hand-over buffers of pipelined execution
+	_aligned_free (rxa[channel].pipe.abuff);
+	rxa[channel].pipe.abuff = (double *) malloc0 (1 * ch[channel].dsp_size    * sizeof (complex));
+	_aligned_free (rxa[channel].pipe.pbuff);
+	rxa[channel].pipe.pbuff = (double *) malloc0 (1 * ch[channel].dsp_outsize * sizeof (complex));
+}
+
+static double* front_buff (int channel)
+{
+	// output buffer of the input resampler
+	return rxa[channel].pipe.run ? rxa[channel].pipe.abuff : rxa[channel].midbuff;
+}
+
+DISPATCH_ADAPTER (xshift, SHIFT)
+DISPATCH_ADAPTER (xHBResampler, HBResampler)
+DISPATCH_ADAPTER (xgen, GEN)
+DISPATCH_ADAPTER (xmeter, METER)
+DISPATCH_ADAPTER_POS (xbpsnbain, BPSNBA)
+DISPATCH_ADAPTER_POS (xbpsnbaout, BPSNBA)
+DISPATCH_ADAPTER_POS (xnbp, NBP)
+DISPATCH_ADAPTER (xsender, SENDER)
+DISPATCH_ADAPTER (xamsqcap, AMSQ)
+DISPATCH_ADAPTER (xamd, AMD)
+DISPATCH_ADAPTER (xwbfm, WBFM)
+DISPATCH_ADAPTER (xfmd, FMD)
+DISPATCH_ADAPTER (xfmsq, FMSQ)
+DISPATCH_ADAPTER (xsnba, SNBA)
+DISPATCH_ADAPTER (xeqp, EQP)
+DISPATCH_ADAPTER_POS (xanf, ANF)
+DISPATCH_ADAPTER_POS (xanr, ANR)
+DISPATCH_ADAPTER_POS (xemnr, EMNR)
+DISPATCH_ADAPTER_POS (xrnnr, RNNR)
+DISPATCH_ADAPTER_POS (xsbnr, SBNR)
+DISPATCH_ADAPTER_POS (xbandpass, BANDPASS)
+DISPATCH_ADAPTER (xwcpagc, WCPAGC)
+DISPATCH_ADAPTER_POS (xsiphon, SIPHON)
+DISPATCH_ADAPTER (xcbl, CBL)
+DISPATCH_ADAPTER_POS (xdoublepole, DOUBLEPOLE)
+DISPATCH_ADAPTER_POS (xmatched, MATCHED)
+DISPATCH_ADAPTER_POS (xgaussian, GAUSSIAN)
+DISPATCH_ADAPTER (xspeak, SPEAK)
+DISPATCH_ADAPTER (xmpeak, MPEAK)
+DISPATCH_ADAPTER (xssql, SSQL)
+DISPATCH_ADAPTER (xpanel, PANEL)
+DISPATCH_ADAPTER (xamsq, AMSQ)
+DISPATCH_ADAPTER (xresample, RESAMPLE)
+
+static void create_rxa_dispatch (int channel)
+{
+	// the front end, xrxa_front()
+	DISPATCH f = rxa[channel].front = create_dispatch ("rx front", 2);
+	SHIFT shift = rxa[channel].shift.p;
+	// the chain of xrxa_back(), in execution order
+	DISPATCH d = rxa[channel].disp = create_dispatch ("rx chain", 48);
+	GEN gen0 = rxa[channel].gen0.p;
+	BPSNBA bpsnba = rxa[channel].bpsnba.p;
+	NBP nbp0 = rxa[channel].nbp0.p;
+	SENDER sender = rxa[channel].sender.p;
+	AMSQ amsq = rxa[channel].amsq.p;
+	AMD amd = rxa[channel].amd.p;
+	WBFM wbfm = rxa[channel].wbfm.p;
+	FMD fmd = rxa[channel].fmd.p;
+	FMSQ fmsq = rxa[channel].fmsq.p;
+	SNBA snba = rxa[channel].snba.p;
+	EQP eqp = rxa[channel].eqp.p;
+	ANF anf = rxa[channel].anf.p;
+	ANR anr = rxa[channel].anr.p;
+	EMNR emnr = rxa[channel].emnr.p;
+	RNNR rnnr = rxa[channel].rnnr.p;
+	SBNR sbnr = rxa[channel].sbnr.p;
+	BANDPASS bp1 = rxa[channel].bp1.p;
+	WCPAGC agc = rxa[channel].agc.p;
+	SIPHON sip1 = rxa[channel].sip1.p;
+	CBL cbl = rxa[channel].cbl.p;
+	DOUBLEPOLE doublepole = rxa[channel].doublepole.p;
+	MATCHED matched = rxa[channel].matched.p;
+	GAUSSIAN gaussian = rxa[channel].gaussian.p;
+	SPEAK speak = rxa[channel].speak.p;
+	MPEAK mpeak = rxa[channel].mpeak.p;
+	SSQL ssql = rxa[channel].ssql.p;
+	RESAMPLE rsmpout = rxa[channel].rsmpout.p;
+	int pos;
+	add_dispatch (f, "shift",      d_xshift,     shift, 0, &shift->run, 0, 0, &shift->in, &shift->out);
+	add_dispatch (f, "rsmpin",     d_xHBResampler, rxa[channel].rsmpin.p, 0, 0, 0, 0, 0, 0);
+	add_dispatch (d, "gen0",       d_xgen,       gen0, 0, &gen0->run, 0, 0, &gen0->in, &gen0->out);
+	add_dispatch (d, "adcmeter",   d_xmeter,     rxa[channel].adcmeter.p, 0, 0, 0, 0, 0, 0);
+	add_dispatch (d, "bpsnbain",   d_xbpsnbain,  bpsnba, 0, &bpsnba->run, 0, &bpsnba->position, 0, 0);
+	add_dispatch (d, "nbp0",       d_xnbp,       nbp0, 0, &nbp0->run, 0, &nbp0->position, &nbp0->in, &nbp0->out);
+	add_dispatch (d, "smeter",     d_xmeter,     rxa[channel].smeter.p, 0, 0, 0, 0, 0, 0);
+	add_dispatch (d, "sender",     d_xsender,    sender, 0, &sender->run, &sender->flag, 0, 0, 0);
+	add_dispatch (d, "amsqcap",    d_xamsqcap,   amsq, 0, &amsq->run, 0, 0, 0, 0);
+	add_dispatch (d, "bpsnbaout",  d_xbpsnbaout, bpsnba, 0, &bpsnba->run, 0, &bpsnba->position, 0, 0);
+	add_dispatch (d, "amd",        d_xamd,       amd, 0, &amd->run, 0, 0, &amd->in_buff, &amd->out_buff);
+	add_dispatch (d, "wbfm",       d_xwbfm,      wbfm, 0, &wbfm->run, 0, 0, &wbfm->in, &wbfm->out);
+	add_dispatch (d, "fmd",        d_xfmd,       fmd, 0, &fmd->run, 0, 0, &fmd->in, &fmd->out);
+	add_dispatch (d, "fmsq",       d_xfmsq,      fmsq, 0, &fmsq->run, 0, 0, &fmsq->insig, &fmsq->outsig);
+	add_dispatch (d, "bpsnbain",   d_xbpsnbain,  bpsnba, 1, &bpsnba->run, 0, &bpsnba->position, 0, 0);
+	add_dispatch (d, "bpsnbaout",  d_xbpsnbaout, bpsnba, 1, &bpsnba->run, 0, &bpsnba->position, 0, 0);
+	add_dispatch (d, "snba",       d_xsnba,      snba, 0, &snba->run, 0, 0, &snba->in, &snba->out);
+	add_dispatch (d, "eqp",        d_xeqp,       eqp, 0, &eqp->run, 0, 0, &eqp->in, &eqp->out);
+	for (pos = 0; pos < 2; pos++)
+	{
+		// noise reduction and bandpass either before (0) or after (1) the AGC
+		add_dispatch (d, "anf",    d_xanf,       anf, pos, &anf->run, 0, &anf->position, &anf->in_buff, &anf->out_buff);
+		add_dispatch (d, "anr",    d_xanr,       anr, pos, &anr->run, 0, &anr->position, &anr->in_buff, &anr->out_buff);
+		add_dispatch (d, "emnr",   d_xemnr,      emnr, pos, &emnr->run, 0, &emnr->position, &emnr->in, &emnr->out);
+		add_dispatch (d, "rnnr",   d_xrnnr,      rnnr, pos, &rnnr->run, 0, &rnnr->position, &rnnr->in, &rnnr->out);
+		add_dispatch (d, "sbnr",   d_xsbnr,      sbnr, pos, &sbnr->run, 0, &sbnr->position, &sbnr->in, &sbnr->out);
+		add_dispatch (d, "bp1",    d_xbandpass,  bp1, pos, &bp1->run, 0, &bp1->position, &bp1->in, &bp1->out);
+		if (pos == 0)
+			add_dispatch (d, "agc", d_xwcpagc,   agc, 0, &agc->run, 0, 0, &agc->in, &agc->out);
+	}
+	add_dispatch (d, "agcmeter",   d_xmeter,     rxa[channel].agcmeter.p, 0, 0, 0, 0, 0, 0);
+	add_dispatch (d, "sip1",       d_xsiphon,    sip1, 0, &sip1->run, 0, &sip1->position, 0, 0);
+	add_dispatch (d, "cbl",        d_xcbl,       cbl, 0, &cbl->run, 0, 0, &cbl->in_buff, &cbl->out_buff);
+	add_dispatch (d, "doublepole", d_xdoublepole, doublepole, 0, &doublepole->run, 0, &doublepole->position,
+		&doublepole->in, &doublepole->out);
+	add_dispatch (d, "matched",    d_xmatched,   matched, 0, &matched->run, 0, &matched->position, &matched->in, &matched->out);
+	add_dispatch (d, "gaussian",   d_xgaussian,  gaussian, 0, &gaussian->run, 0, &gaussian->position,
+		&gaussian->in, &gaussian->out);
+	add_dispatch (d, "speak",      d_xspeak,     speak, 0, &speak->run, 0, 0, &speak->in, &speak->out);
+	add_dispatch (d, "mpeak",      d_xmpeak,     mpeak, 0, &mpeak->run, 0, 0, &mpeak->in, &mpeak->out);
+	add_dispatch (d, "ssql",       d_xssql,      ssql, 0, &ssql->run, 0, 0, &ssql->in, &ssql->out);
+	add_dispatch (d, "panel",      d_xpanel,     rxa[channel].panel.p, 0, 0, 0, 0, 0, 0);
+	add_dispatch (d, "amsq",       d_xamsq,      amsq, 0, &amsq->run, 0, 0, &amsq->in, &amsq->out);
+	add_dispatch (d, "rsmpout",    d_xresample,  rsmpout, 0, &rsmpout->run, 0, 0, &rsmpout->in, &rsmpout->out);
+}
+
 void create_rxa (int channel)
 {
 	rxa[channel].mode = RXA_LSB;
@@ -35,6 +165,18 @@ void create_rxa (int channel)
 	rxa[channel].outbuff = (double *) malloc0 (1 * ch[channel].dsp_outsize * sizeof (complex));
 	rxa[channel].midbuff = (double *) malloc0 (2 * ch[channel].dsp_size    * sizeof (complex));
 
+	// pipelined execution, off until requested
+	rxa[channel].pipe.run = 0;
+	rxa[channel].pipe.req = 0;
+	rxa[channel].pipe.quit = 0;
+	rxa[channel].pipe.started = 0;
+	rxa[channel].pipe.abuff = 0;
+	rxa[channel].pipe.pbuff = 0;
+	pipe_buffers (channel);
+	rxa[channel].pipe.Sem_Go   = CreateSemaphore (0, 0, 1, 0);
+	rxa[channel].pipe.Sem_Done = CreateSemaphore (0, 1, 1, 0);
+	InitializeCriticalSectionAndSpinCount (&rxa[channel].pipe.csFront, 2500);
+
 	// shift to select a slice of spectrum
 	rxa[channel].shift.p = create_shift (
 		1,												// run
@@ -558,10 +700,30 @@ void create_rxa (int channel)
 
 	// turn OFF / ON resamplers as needed
 	RXAResCheck (channel);
+
+	// dispatch plan
+	create_rxa_dispatch (channel);
 }
 
 void destroy_rxa (int channel)
 {
+	destroy_dispatch (rxa[channel].disp);
+	destroy_dispatch (rxa[channel].front);
+	if (rxa[channel].pipe.started)
+	{
+		// wait until stage 2 is idle, then let its thread terminate
+		WaitForSingleObject (rxa[channel].pipe.Sem_Done, INFINITE);
+		InterlockedBitTestAndSet (&rxa[channel].pipe.quit, 0);
+		ReleaseSemaphore (rxa[channel].pipe.Sem_Go, 1, 0);
+		WaitForSingleObject (rxa[channel].pipe.Sem_Done, INFINITE);
+	}
+	DeleteCriticalSection (&rxa[channel].pipe.csFront);
+	CloseHandle (rxa[channel].pipe.Sem_Done);
+	CloseHandle (rxa[channel].pipe.Sem_Go);
+	_aligned_free (rxa[channel].pipe.pbuff);
+	_aligned_free (rxa[channel].pipe.abuff);
+	rxa[channel].pipe.pbuff = 0;
+	rxa[channel].pipe.abuff = 0;
 	destroy_resample (rxa[channel].rsmpout.p);
 	destroy_panel (rxa[channel].panel.p);
 	destroy_ssql (rxa[channel].ssql.p);
@@ -605,9 +767,11 @@ void destroy_rxa (int channel)
 
 void flush_rxa (int channel)
 {
+	// called by flushChannel() between RXAPipeHold() and RXAPipeRelease()
 	memset (rxa[channel].inbuff,  0, 1 * ch[channel].dsp_insize  * sizeof (complex));
 	memset (rxa[channel].outbuff, 0, 1 * ch[channel].dsp_outsize * sizeof (complex));
 	memset (rxa[channel].midbuff, 0, 2 * ch[channel].dsp_size    * sizeof (complex));
+	memset (rxa[channel].pipe.pbuff, 0, 1 * ch[channel].dsp_outsize * sizeof (complex));
 	flush_shift (rxa[channel].shift.p);
 	//flush_resample (rxa[channel].rsmpin.p);
 	flush_HBResampler(rxa[channel].rsmpin.p);
@@ -642,56 +806,171 @@ void flush_rxa (int channel)
 	flush_resample (rxa[channel].rsmpout.p);
 }
 
+void xrxa_front (int channel)
+{
+	// runs at the input sample rate
+	xdispatch (rxa[channel].front);
+}
+
+void xrxa_back (int channel)
+{
+	// runs at the dsp sample rate
+	xdispatch (rxa[channel].disp);
+}
+
 void xrxa (int channel)
 {
-	xshift (rxa[channel].shift.p);
-	//xresample (rxa[channel].rsmpin.p);
-	xHBResampler(rxa[channel].rsmpin.p);
-	xgen (rxa[channel].gen0.p);
-	xmeter (rxa[channel].adcmeter.p);
-	xbpsnbain (rxa[channel].bpsnba.p, 0);
-	xnbp (rxa[channel].nbp0.p, 0);
-	xmeter (rxa[channel].smeter.p);
-	xsender (rxa[channel].sender.p);
-	xamsqcap (rxa[channel].amsq.p);
-	xbpsnbaout (rxa[channel].bpsnba.p, 0);
-	xamd (rxa[channel].amd.p);
-	xwbfm(rxa[channel].wbfm.p);
-	xfmd (rxa[channel].fmd.p);
-	xfmsq (rxa[channel].fmsq.p);
-	xbpsnbain (rxa[channel].bpsnba.p, 1);
-	xbpsnbaout (rxa[channel].bpsnba.p, 1);
-	xsnba (rxa[channel].snba.p);
-	xeqp (rxa[channel].eqp.p);
-	xanf (rxa[channel].anf.p, 0);
-	xanr (rxa[channel].anr.p, 0);
-	xemnr (rxa[channel].emnr.p, 0);
-    xrnnr (rxa[channel].rnnr.p, 0);   // NR3 + NR4 support (nr3)
-    xsbnr (rxa[channel].sbnr.p, 0);   // NR3 + NR4 support (nr4)
-	xbandpass (rxa[channel].bp1.p, 0);
-	xwcpagc (rxa[channel].agc.p);
-	xanf (rxa[channel].anf.p, 1);
-	xanr (rxa[channel].anr.p, 1);
-	xemnr (rxa[channel].emnr.p, 1);
-    xrnnr (rxa[channel].rnnr.p, 1);   // NR3 + NR4 support (nr3)
-    xsbnr (rxa[channel].sbnr.p, 1);   // NR3 + NR4 support (nr4)
-	xbandpass (rxa[channel].bp1.p, 1);
-	xmeter (rxa[channel].agcmeter.p);
-	xsiphon (rxa[channel].sip1.p, 0);
-	xcbl (rxa[channel].cbl.p);
-	xdoublepole (rxa[channel].doublepole.p, 0);
-	xmatched (rxa[channel].matched.p, 0);
-	xgaussian (rxa[channel].gaussian.p, 0);
-	xspeak (rxa[channel].speak.p);
-	xmpeak (rxa[channel].mpeak.p);
-	xssql (rxa[channel].ssql.p);
-	xpanel (rxa[channel].panel.p);
-	xamsq (rxa[channel].amsq.p);
-	xresample (rxa[channel].rsmpout.p);
+	xrxa_front (channel);
+	xrxa_back (channel);
+}
+
+PORT
+void GetRXADispatch (int channel, char* text, int size)
+{
+	// debug dump of the current dispatch plans
+	int n;
+	EnterCriticalSection (&ch[channel].csDSP);
+	EnterCriticalSection (&rxa[channel].pipe.csFront);
+	dump_dispatch (rxa[channel].front, text, size);
+	LeaveCriticalSection (&rxa[channel].pipe.csFront);
+	n = (int)strlen (text);
+	dump_dispatch (rxa[channel].disp, text + n, size - n);
+	LeaveCriticalSection (&ch[channel].csDSP);
+}
+
+/********************************************************************************************************
+*																										*
+*											Pipelined Execution											*
+*																										*
+********************************************************************************************************/
+
+// If requested, the chain is split in two stages running on different threads.  The channel's DSP thread
+// (wdspmain) runs the front end, that is, shift and input resampler which dominate the load at high input
+// sample rates, under csFront.  A second thread runs the rest of the chain under csDSP, so all property
+// setters except those of the front end remain synchronized as before.  The stages hand over buffers once
+// per block; this adds one dsp buffer of latency.  Flushes and re-builds of the buffers stop both stages
+// with RXAPipeHold().
+
+void rxa_pipeline (void* arg)
+{
+	int channel = (int)(uintptr_t)arg;
+	while (1)
+	{
+		WaitForSingleObject (rxa[channel].pipe.Sem_Go, INFINITE);
+		if (_InterlockedAnd (&rxa[channel].pipe.quit, 1)) break;
+#if defined(linux) || defined(__APPLE__)
+		WDSPThreadWakeup();
+#endif
+		EnterCriticalSection (&ch[channel].csDSP);
+		xrxa_back (channel);
+		LeaveCriticalSection (&ch[channel].csDSP);
+		ReleaseSemaphore (rxa[channel].pipe.Sem_Done, 1, 0);
+	}
+	ReleaseSemaphore (rxa[channel].pipe.Sem_Done, 1, 0);
+}
+
+static void pipe_switch (int channel, int run)
+{
+	// called by the channel's DSP thread between two blocks
+	if (run)
+	{
+		EnterCriticalSection (&ch[channel].csDSP);
+		rxa[channel].pipe.run = 1;
+		setBuffers_HBResampler(rxa[channel].rsmpin.p, (complex_t*)(void*)rxa[channel].inbuff, (complex_t*)(void*)rxa[channel].pipe.abuff);
+		// the last block computed in one piece is output next, then one block of silence
+		memcpy (rxa[channel].pipe.pbuff, rxa[channel].outbuff, ch[channel].dsp_outsize * sizeof (complex));
+		memset (rxa[channel].outbuff, 0, ch[channel].dsp_outsize * sizeof (complex));
+		LeaveCriticalSection (&ch[channel].csDSP);
+	}
+	else
+	{
+		// the block in pbuff is dropped
+		WaitForSingleObject (rxa[channel].pipe.Sem_Done, INFINITE);
+		EnterCriticalSection (&ch[channel].csDSP);
+		rxa[channel].pipe.run = 0;
+		setBuffers_HBResampler(rxa[channel].rsmpin.p, (complex_t*)(void*)rxa[channel].inbuff, (complex_t*)(void*)rxa[channel].midbuff);
+		LeaveCriticalSection (&ch[channel].csDSP);
+		ReleaseSemaphore (rxa[channel].pipe.Sem_Done, 1, 0);
+	}
+}
+
+int xrxa_pipe (int channel)
+{
+	// called by the channel's DSP thread for each block, returns 0 if the block has to be processed by xrxa()
+	int req = _InterlockedAnd (&rxa[channel].pipe.req, 1);
+	int seq = 0;
+	int go = 0;
+	if (req != rxa[channel].pipe.run)
+		pipe_switch (channel, req);
+	if (!rxa[channel].pipe.run)
+		return 0;
+	// run and exec_bypass do not change while csFront is held, see pre_main_destroy()
+	EnterCriticalSection (&rxa[channel].pipe.csFront);
+	if (_InterlockedAnd (&ch[channel].run, 1) && !_InterlockedAnd (&ch[channel].iob.pd->exec_bypass, 1))
+	{
+		dexchange (channel, rxa[channel].pipe.pbuff, rxa[channel].inbuff);
+		xrxa_front (channel);
+		seq = rxa[channel].pipe.seq;
+		go = 1;
+	}
+	LeaveCriticalSection (&rxa[channel].pipe.csFront);
+	if (go)
+	{
+		WaitForSingleObject (rxa[channel].pipe.Sem_Done, INFINITE);
+		EnterCriticalSection (&ch[channel].csDSP);
+		// a block that has passed the front end before a flush or re-build is dropped
+		go = (seq == rxa[channel].pipe.seq) && !_InterlockedAnd (&ch[channel].iob.pd->exec_bypass, 1);
+		if (go)
+		{
+			memcpy (rxa[channel].midbuff, rxa[channel].pipe.abuff, ch[channel].dsp_size * sizeof (complex));
+			memcpy (rxa[channel].pipe.pbuff, rxa[channel].outbuff, ch[channel].dsp_outsize * sizeof (complex));
+		}
+		LeaveCriticalSection (&ch[channel].csDSP);
+		ReleaseSemaphore (go ? rxa[channel].pipe.Sem_Go : rxa[channel].pipe.Sem_Done, 1, 0);
+	}
+	return 1;
+}
+
+void RXAPipeIdle (int channel)
+{
+	// waits until stage 2 has completed its block
+	WaitForSingleObject (rxa[channel].pipe.Sem_Done, INFINITE);
+	ReleaseSemaphore (rxa[channel].pipe.Sem_Done, 1, 0);
+}
+
+void RXAPipeHold (int channel)
+{
+	// Called before buffers or the front end are flushed or re-built.  Waits until stage 2 is idle and the
+	// front end is not running, and keeps them so until RXAPipeRelease().  A block that has passed the front
+	// end but not yet been handed over is dropped.  The lock order is Sem_Done, csDSP, csFront.
+	WaitForSingleObject (rxa[channel].pipe.Sem_Done, INFINITE);
+	EnterCriticalSection (&ch[channel].csDSP);
+	EnterCriticalSection (&rxa[channel].pipe.csFront);
+	rxa[channel].pipe.seq++;
+}
+
+void RXAPipeRelease (int channel)
+{
+	LeaveCriticalSection (&rxa[channel].pipe.csFront);
+	LeaveCriticalSection (&ch[channel].csDSP);
+	ReleaseSemaphore (rxa[channel].pipe.Sem_Done, 1, 0);
+}
+
+PORT
+void SetRXAPipeline (int channel, int run)
+{
+	// takes effect at the next block
+	if (run && !rxa[channel].pipe.started)
+	{
+		rxa[channel].pipe.started = 1;
+		_beginthread (rxa_pipeline, 0, (void *)(uintptr_t)channel);
+	}
+	InterlockedExchange (&rxa[channel].pipe.req, run ? 1 : 0);
 }
 
 void setInputSamplerate_rxa (int channel)
 {
+	RXAPipeHold (channel);
 	// buffers
 	_aligned_free (rxa[channel].inbuff);
 	rxa[channel].inbuff = (double *)malloc0(1 * ch[channel].dsp_insize  * sizeof(complex));
@@ -701,38 +980,44 @@ void setInputSamplerate_rxa (int channel)
 	setSamplerate_shift (rxa[channel].shift.p, ch[channel].in_rate);
 	// input resampler
 	//setBuffers_resample (rxa[channel].rsmpin.p, rxa[channel].inbuff, rxa[channel].midbuff);
-	setBuffers_HBResampler(rxa[channel].rsmpin.p, (complex_t*)(void*)rxa[channel].inbuff, (complex_t*)(void*)rxa[channel].midbuff);
+	setBuffers_HBResampler(rxa[channel].rsmpin.p, (complex_t*)(void*)rxa[channel].inbuff, (complex_t*)(void*)front_buff (channel));
 	//setSize_resample (rxa[channel].rsmpin.p, ch[channel].dsp_insize);
 	setSize_HBResampler(rxa[channel].rsmpin.p, ch[channel].dsp_insize);
 	//setInRate_resample (rxa[channel].rsmpin.p, ch[channel].in_rate);
 	setInRate_HBResampler(rxa[channel].rsmpin.p, ch[channel].in_rate);
 	RXAResCheck (channel);
+	RXAPipeRelease (channel);
 }
 
 void setOutputSamplerate_rxa (int channel)
 {
+	RXAPipeHold (channel);
 	// buffers
 	_aligned_free (rxa[channel].outbuff);
 	rxa[channel].outbuff = (double *)malloc0(1 * ch[channel].dsp_outsize * sizeof(complex));
+	pipe_buffers (channel);
 	// output resampler
 	setBuffers_resample (rxa[channel].rsmpout.p, rxa[channel].midbuff, rxa[channel].outbuff);
 	setOutRate_resample (rxa[channel].rsmpout.p, ch[channel].out_rate);
 	RXAResCheck (channel);
+	RXAPipeRelease (channel);
 }
 
 void setDSPSamplerate_rxa (int channel)
 {
+	RXAPipeHold (channel);
 	// buffers
 	_aligned_free (rxa[channel].inbuff);
 	rxa[channel].inbuff = (double *)malloc0(1 * ch[channel].dsp_insize  * sizeof(complex));
 	_aligned_free (rxa[channel].outbuff);
 	rxa[channel].outbuff = (double *)malloc0(1 * ch[channel].dsp_outsize * sizeof(complex));
+	pipe_buffers (channel);
 	// shift
 	setBuffers_shift (rxa[channel].shift.p, rxa[channel].inbuff, rxa[channel].inbuff);
 	setSize_shift (rxa[channel].shift.p, ch[channel].dsp_insize);
 	// input resampler
 	//setBuffers_resample (rxa[channel].rsmpin.p, rxa[channel].inbuff, rxa[channel].midbuff);
-	setBuffers_HBResampler(rxa[channel].rsmpin.p, (complex_t*)(void*)rxa[channel].inbuff, (complex_t*)(void*)rxa[channel].midbuff);
+	setBuffers_HBResampler(rxa[channel].rsmpin.p, (complex_t*)(void*)rxa[channel].inbuff, (complex_t*)(void*)front_buff (channel));
 	//setSize_resample (rxa[channel].rsmpin.p, ch[channel].dsp_insize);
 	setSize_HBResampler(rxa[channel].rsmpin.p, ch[channel].dsp_insize);
 	//setOutRate_resample (rxa[channel].rsmpin.p, ch[channel].dsp_rate);
@@ -773,10 +1058,12 @@ void setDSPSamplerate_rxa (int channel)
 	setBuffers_resample (rxa[channel].rsmpout.p, rxa[channel].midbuff, rxa[channel].outbuff);
 	setInRate_resample (rxa[channel].rsmpout.p, ch[channel].dsp_rate);
 	RXAResCheck (channel);
+	RXAPipeRelease (channel);
 }
 
 void setDSPBuffsize_rxa (int channel)
 {
+	RXAPipeHold (channel);
 	// buffers
 	_aligned_free(rxa[channel].inbuff);
 	rxa[channel].inbuff = (double *)malloc0(1 * ch[channel].dsp_insize  * sizeof(complex));
@@ -784,12 +1071,13 @@ void setDSPBuffsize_rxa (int channel)
 	rxa[channel].midbuff = (double *)malloc0(2 * ch[channel].dsp_size * sizeof(complex));
 	_aligned_free (rxa[channel].outbuff);
 	rxa[channel].outbuff = (double *)malloc0(1 * ch[channel].dsp_outsize * sizeof(complex));
+	pipe_buffers (channel);
 	// shift
 	setBuffers_shift (rxa[channel].shift.p, rxa[channel].inbuff, rxa[channel].inbuff);
 	setSize_shift (rxa[channel].shift.p, ch[channel].dsp_insize);
 	// input resampler
 	//setBuffers_resample (rxa[channel].rsmpin.p, rxa[channel].inbuff, rxa[channel].midbuff);
-	setBuffers_HBResampler(rxa[channel].rsmpin.p, (complex_t*)(void*)rxa[channel].inbuff, (complex_t*)(void*)rxa[channel].midbuff);
+	setBuffers_HBResampler(rxa[channel].rsmpin.p, (complex_t*)(void*)rxa[channel].inbuff, (complex_t*)(void*)front_buff (channel));
 	//setSize_resample (rxa[channel].rsmpin.p, ch[channel].dsp_insize);
 	setSize_HBResampler(rxa[channel].rsmpin.p, ch[channel].dsp_insize);
 	// dsp_size blocks
@@ -856,6 +1144,7 @@ void setDSPBuffsize_rxa (int channel)
 	// output resampler
 	setBuffers_resample (rxa[channel].rsmpout.p, rxa[channel].midbuff, rxa[channel].outbuff);
 	setSize_resample (rxa[channel].rsmpout.p, ch[channel].dsp_size);
+	RXAPipeRelease (channel);
 }
 
 /********************************************************************************************************
@@ -197,6 +197,21 @@ struct _rxa
 	{
 		SSQL p;
 	} ssql;
+	DISPATCH front;					// dispatch plan of xrxa_front()
+	DISPATCH disp;					// dispatch plan of xrxa_back()
+	struct
+	{
+		int run;					// pipelined execution active
+		volatile long req;			// pipelined execution requested
+		volatile long quit;			// terminate stage-2 thread
+		int started;				// stage-2 thread has been started
+		int seq;					// incremented by RXAPipeHold(), blocks of an older sequence are dropped
+		double* abuff;				// front end output, handed over to midbuff
+		double* pbuff;				// stage-2 output, handed over to dexchange() one block later
+		HANDLE Sem_Go;				// stage 2 may process midbuff
+		HANDLE Sem_Done;			// stage 2 is idle
+		CRITICAL_SECTION csFront;	// front end (shift, input resampler) while pipelined
+	} pipe;
 };
 
 extern struct _rxa rxa[];
@@ -209,6 +224,20 @@ extern void flush_rxa (int channel);
 
 extern void xrxa (int channel);
 
+extern void xrxa_front (int channel);
+
+extern void xrxa_back (int channel);
+
+extern int xrxa_pipe (int channel);
+
+extern void rxa_pipeline (void* arg);
+
+extern void RXAPipeIdle (int channel);
+
+extern void RXAPipeHold (int channel);
+
+extern void RXAPipeRelease (int channel);
+
 extern void setInputSamplerate_rxa (int channel);
 
 extern void setOutputSamplerate_rxa (int channel);
@@ -232,4 +261,8 @@ extern void RXAbpsnbaCheck (int channel, int mode, int notch_run);
 
 extern void RXAbpsnbaSet (int channel);
 
+extern __declspec (dllexport) void SetRXAPipeline (int channel, int run);
+
+extern __declspec (dllexport) void GetRXADispatch (int channel, char* text, int size);
+
 #endif
@@ -28,6 +28,85 @@ warren@wpratt.com
 
 struct _txa txa[MAX_CHANNELS];
 
+DISPATCH_ADAPTER (xresample, RESAMPLE)
+DISPATCH_ADAPTER (xgen, GEN)
+DISPATCH_ADAPTER (xpanel, PANEL)
+DISPATCH_ADAPTER (xphrot, PHROT)
+DISPATCH_ADAPTER (xmeter, METER)
+DISPATCH_ADAPTER (xamsqcap, AMSQ)
+DISPATCH_ADAPTER (xamsq, AMSQ)
+DISPATCH_ADAPTER (xeqp, EQP)
+DISPATCH_ADAPTER_POS (xemphp, EMPHP)
+DISPATCH_ADAPTER (xwcpagc, WCPAGC)
+DISPATCH_ADAPTER_POS (xcfcomp, CFCOMP)
+DISPATCH_ADAPTER_POS (xbandpass, BANDPASS)
+DISPATCH_ADAPTER (xcompressor, COMPRESSOR)
+DISPATCH_ADAPTER (xosctrl, OSCTRL)
+DISPATCH_ADAPTER (xammod, AMMOD)
+DISPATCH_ADAPTER (xfmmod, FMMOD)
+DISPATCH_ADAPTER (xuslew, USLEW)
+DISPATCH_ADAPTER_POS (xsiphon, SIPHON)
+DISPATCH_ADAPTER (xiqc, IQC)
+DISPATCH_ADAPTER (xcfir, CFIR)
+
+static void create_txa_dispatch (int channel)
+{
+	// the chain of xtxa(), in execution order
+	DISPATCH d = txa[channel].disp = create_dispatch ("tx chain", 40);
+	RESAMPLE rsmpin = txa[channel].rsmpin.p;
+	GEN gen0 = txa[channel].gen0.p;
+	AMSQ amsq = txa[channel].amsq.p;
+	EQP eqp = txa[channel].eqp.p;
+	EMPHP preemph = txa[channel].preemph.p;
+	WCPAGC leveler = txa[channel].leveler.p;
+	CFCOMP cfcomp = txa[channel].cfcomp.p;
+	BANDPASS bp0 = txa[channel].bp0.p;
+	COMPRESSOR compressor = txa[channel].compressor.p;
+	BANDPASS bp1 = txa[channel].bp1.p;
+	OSCTRL osctrl = txa[channel].osctrl.p;
+	BANDPASS bp2 = txa[channel].bp2.p;
+	WCPAGC alc = txa[channel].alc.p;
+	AMMOD ammod = txa[channel].ammod.p;
+	FMMOD fmmod = txa[channel].fmmod.p;
+	GEN gen1 = txa[channel].gen1.p;
+	SIPHON sip1 = txa[channel].sip1.p;
+	CFIR cfir = txa[channel].cfir.p;
+	RESAMPLE rsmpout = txa[channel].rsmpout.p;
+	add_dispatch (d, "rsmpin",     d_xresample,   rsmpin, 0, &rsmpin->run, 0, 0, &rsmpin->in, &rsmpin->out);	// input resampler
+	add_dispatch (d, "gen0",       d_xgen,        gen0, 0, &gen0->run, 0, 0, &gen0->in, &gen0->out);	// input signal generator
+	add_dispatch (d, "panel",      d_xpanel,      txa[channel].panel.p, 0, 0, 0, 0, 0, 0);	// includes MIC gain
+	add_dispatch (d, "phrot",      d_xphrot,      txa[channel].phrot.p, 0, 0, 0, 0, 0, 0);	// phase rotator
+	add_dispatch (d, "micmeter",   d_xmeter,      txa[channel].micmeter.p, 0, 0, 0, 0, 0, 0);	// MIC meter
+	add_dispatch (d, "amsqcap",    d_xamsqcap,    amsq, 0, &amsq->run, 0, 0, 0, 0);	// downward expander capture
+	add_dispatch (d, "amsq",       d_xamsq,       amsq, 0, &amsq->run, 0, 0, &amsq->in, &amsq->out);	// downward expander action
+	add_dispatch (d, "eqp",        d_xeqp,        eqp, 0, &eqp->run, 0, 0, &eqp->in, &eqp->out);	// pre-EQ
+	add_dispatch (d, "eqmeter",    d_xmeter,      txa[channel].eqmeter.p, 0, 0, 0, 0, 0, 0);	// EQ meter
+	add_dispatch (d, "preemph",    d_xemphp,      preemph, 0, &preemph->run, 0, &preemph->position, &preemph->in, &preemph->out);	// FM pre-emphasis (first option)
+	add_dispatch (d, "leveler",    d_xwcpagc,     leveler, 0, &leveler->run, 0, 0, &leveler->in, &leveler->out);	// Leveler
+	add_dispatch (d, "lvlrmeter",  d_xmeter,      txa[channel].lvlrmeter.p, 0, 0, 0, 0, 0, 0);	// Leveler Meter
+	add_dispatch (d, "cfcomp",     d_xcfcomp,     cfcomp, 0, &cfcomp->run, 0, &cfcomp->position, &cfcomp->in, &cfcomp->out);	// Continuous Frequency Compressor with post-EQ
+	add_dispatch (d, "cfcmeter",   d_xmeter,      txa[channel].cfcmeter.p, 0, 0, 0, 0, 0, 0);	// CFC+PostEQ Meter
+	add_dispatch (d, "bp0",        d_xbandpass,   bp0, 0, &bp0->run, 0, &bp0->position, &bp0->in, &bp0->out);	// primary bandpass filter
+	add_dispatch (d, "compressor", d_xcompressor, compressor, 0, &compressor->run, 0, 0,
+		&compressor->inbuff, &compressor->outbuff);	// COMP compressor
+	add_dispatch (d, "bp1",        d_xbandpass,   bp1, 0, &bp1->run, 0, &bp1->position, &bp1->in, &bp1->out);	// aux bandpass (runs if COMP)
+	add_dispatch (d, "osctrl",     d_xosctrl,     osctrl, 0, &osctrl->run, 0, 0, &osctrl->inbuff, &osctrl->outbuff);	// CESSB Overshoot Control
+	add_dispatch (d, "bp2",        d_xbandpass,   bp2, 0, &bp2->run, 0, &bp2->position, &bp2->in, &bp2->out);	// aux bandpass (runs if CESSB)
+	add_dispatch (d, "compmeter",  d_xmeter,      txa[channel].compmeter.p, 0, 0, 0, 0, 0, 0);	// COMP meter
+	add_dispatch (d, "alc",        d_xwcpagc,     alc, 0, &alc->run, 0, 0, &alc->in, &alc->out);	// ALC
+	add_dispatch (d, "ammod",      d_xammod,      ammod, 0, &ammod->run, 0, 0, &ammod->in, &ammod->out);	// AM Modulator
+	add_dispatch (d, "preemph",    d_xemphp,      preemph, 1, &preemph->run, 0, &preemph->position, &preemph->in, &preemph->out);	// FM pre-emphasis (second option)
+	add_dispatch (d, "fmmod",      d_xfmmod,      fmmod, 0, &fmmod->run, 0, 0, &fmmod->in, &fmmod->out);	// FM Modulator
+	add_dispatch (d, "gen1",       d_xgen,        gen1, 0, &gen1->run, 0, 0, &gen1->in, &gen1->out);	// output signal generator (TUN and Two-tone)
+	add_dispatch (d, "uslew",      d_xuslew,      txa[channel].uslew.p, 0, 0, 0, 0, 0, 0);	// up-slew for AM, FM, and gens
+	add_dispatch (d, "alcmeter",   d_xmeter,      txa[channel].alcmeter.p, 0, 0, 0, 0, 0, 0);	// ALC Meter
+	add_dispatch (d, "sip1",       d_xsiphon,     sip1, 0, &sip1->run, 0, &sip1->position, 0, 0);	// siphon data for display
+	add_dispatch (d, "iqc",        d_xiqc,        txa[channel].iqc.p, 0, 0, 0, 0, 0, 0);	// PureSignal correction
+	add_dispatch (d, "cfir",       d_xcfir,       cfir, 0, &cfir->run, 0, 0, &cfir->in, &cfir->out);	// compensating FIR filter (used Protocol_2 only)
+	add_dispatch (d, "rsmpout",    d_xresample,   rsmpout, 0, &rsmpout->run, 0, 0, &rsmpout->in, &rsmpout->out);	// output resampler
+	add_dispatch (d, "outmeter",   d_xmeter,      txa[channel].outmeter.p, 0, 0, 0, 0, 0, 0);	// output meter
+}
+
 void create_txa (int channel)
 {
 	txa[channel].mode   = TXA_LSB;
@@ -467,11 +546,15 @@ void create_txa (int channel)
 
 	// turn OFF / ON resamplers as needed
 	TXAResCheck (channel);
+
+	// dispatch plan
+	create_txa_dispatch (channel);
 }
 
 void destroy_txa (int channel)
 {
 	// in reverse order, free each item we created
+	destroy_dispatch (txa[channel].disp);
 	destroy_meter (txa[channel].outmeter.p);
 	destroy_resample (txa[channel].rsmpout.p);
 	destroy_cfir(txa[channel].cfir.p);
@@ -548,42 +631,19 @@ void flush_txa (int channel)
 //void xsnoop(channel);
 void xtxa (int channel)
 {
-	xresample (txa[channel].rsmpin.p);				// input resampler
-	xgen (txa[channel].gen0.p);						// input signal generator
-	xpanel (txa[channel].panel.p);					// includes MIC gain
-	xphrot (txa[channel].phrot.p);					// phase rotator
-	xmeter (txa[channel].micmeter.p);				// MIC meter
-	xamsqcap (txa[channel].amsq.p);					// downward expander capture
-	xamsq (txa[channel].amsq.p);					// downward expander action
-	xeqp (txa[channel].eqp.p);						// pre-EQ
-	xmeter (txa[channel].eqmeter.p);				// EQ meter
-	xemphp (txa[channel].preemph.p, 0);				// FM pre-emphasis (first option)
-	xwcpagc (txa[channel].leveler.p);				// Leveler
-	xmeter (txa[channel].lvlrmeter.p);				// Leveler Meter
-	xcfcomp (txa[channel].cfcomp.p, 0);				// Continuous Frequency Compressor with post-EQ
-	xmeter (txa[channel].cfcmeter.p);				// CFC+PostEQ Meter
-	xbandpass (txa[channel].bp0.p, 0);				// primary bandpass filter
-	xcompressor (txa[channel].compressor.p);		// COMP compressor
-	xbandpass (txa[channel].bp1.p, 0);				// aux bandpass (runs if COMP)
-	xosctrl (txa[channel].osctrl.p);				// CESSB Overshoot Control
-	xbandpass (txa[channel].bp2.p, 0);				// aux bandpass (runs if CESSB)
-	xmeter (txa[channel].compmeter.p);				// COMP meter
-	xwcpagc (txa[channel].alc.p);					// ALC
-	xammod (txa[channel].ammod.p);					// AM Modulator
-	xemphp (txa[channel].preemph.p, 1);				// FM pre-emphasis (second option)
-	xfmmod (txa[channel].fmmod.p);					// FM Modulator
-	xgen (txa[channel].gen1.p);						// output signal generator (TUN and Two-tone)
-	xuslew (txa[channel].uslew.p);					// up-slew for AM, FM, and gens
-	xmeter (txa[channel].alcmeter.p);				// ALC Meter
-	xsiphon (txa[channel].sip1.p, 0);				// siphon data for display
-	xiqc (txa[channel].iqc.p);						// PureSignal correction
-	xcfir(txa[channel].cfir.p);						// compensating FIR filter (used Protocol_2 only)
-	//xsnoop(channel);
-	xresample (txa[channel].rsmpout.p);				// output resampler
-	xmeter (txa[channel].outmeter.p);				// output meter
+	xdispatch (txa[channel].disp);
 	// print_peak_env ("env_exception.txt", ch[channel].dsp_outsize, txa[channel].outbuff, 0.7);
 }
 
+PORT
+void GetTXADispatch (int channel, char* text, int size)
+{
+	// debug dump of the current dispatch plan
+	EnterCriticalSection (&ch[channel].csDSP);
+	dump_dispatch (txa[channel].disp, text, size);
+	LeaveCriticalSection (&ch[channel].csDSP);
+}
+
 void setInputSamplerate_txa (int channel)
 {
 	// buffers
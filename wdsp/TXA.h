@@ -159,6 +159,7 @@ struct _txa
 	{
 		CFIR p;
 	} cfir;
+	DISPATCH disp;					// dispatch plan of xtxa()
 };
 
 extern struct _txa txa[];
@@ -189,4 +190,6 @@ extern void TXAResCheck (int channel);
 
 extern void TXASetupBPFilters (int channel);
 
+extern __declspec (dllexport) void GetTXADispatch (int channel, char* text, int size);
+
 #endif
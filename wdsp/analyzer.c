@@ -559,6 +559,9 @@ void stitch(int disp)
 	int i, j, k, n, m;
 	double* ptr;
 
+	// The span (begin_ss, end_ss, ss_bins) and the bin-to-pixel mapping are changed by SetAnalyzerPan()
+	// with ResampleSection held, so it is held for the complete frame.
+	EnterCriticalSection(&a->ResampleSection);
 	// stitch
 	m = 0;
 	ptr = a->pre_av_out;
@@ -570,7 +573,6 @@ void stitch(int disp)
 	}
 	for (i = 0; i < a->num_pixout; i++)	// for each output
 	{
-		EnterCriticalSection(&a->ResampleSection);
 		// if a detection of the same 'det_type' has already been done, use that result
 		j = i - 1;
 		k = i;
@@ -590,7 +592,6 @@ void stitch(int disp)
 		avenger (a->av_mode[i], a->num_pixels, &a->avail_frames[i], a->num_average[i], &a->av_in_idx[i], &a->av_out_idx[i],
 			a->av_backmult[i], a->scale, a->t_pixels[i], a->av_sum[i], a->av_buff[i], a->cd, a->normalize[i], a->norm_oneHz,
 			a->pixels[i][a->w_pix_buff[i]]);
-		LeaveCriticalSection(&a->ResampleSection);
 
 		EnterCriticalSection(&a->PB_ControlsSection[i]);
 			a->last_pix_buff[i] = a->w_pix_buff[i];
@@ -598,6 +599,53 @@ void stitch(int disp)
 		LeaveCriticalSection(&a->PB_ControlsSection[i]);
 		InterlockedBitTestAndSet(&(a->pb_ready[i][a->last_pix_buff[i]]), 0);
 	}
+	LeaveCriticalSection(&a->ResampleSection);
+}
+
+static void dispatch (int disp);
+
+static double analyzer_time (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+// record the latency of a completed frame, from the start of its first fft to the end of stitch(),
+// then tell the application (if it has asked for it) that new pixels can be read
+static void frame_done (DP a, double t0)
+{
+	double latency = 0.0;
+	void (*notify)(void*);
+	void* arg;
+	if (t0 != 0.0)
+		latency = analyzer_time() - t0;
+	EnterCriticalSection(&a->StitchSection);
+	if (t0 != 0.0)
+	{
+		a->frames++;
+		a->latency_sum += latency;
+		a->latency_num++;
+		if (latency > a->latency_max)
+			a->latency_max = latency;
+	}
+	notify = a->notify;
+	arg = a->notify_arg;
+	LeaveCriticalSection(&a->StitchSection);
+	if (notify)
+		(*notify) (arg);
+}
+
+// profile:  add the time elapsed since t0 to counter k (0: fft, 1: stitch)
+static void profile_done (DP a, int k, long long t0)
+{
+	long long dt = profile_ns() - t0;
+	EnterCriticalSection(&a->StitchSection);
+	a->prof_ns[k] += dt;
+	a->prof_calls[k]++;
+	if (dt > a->prof_worst[k])
+		a->prof_worst[k] = dt;
+	LeaveCriticalSection(&a->StitchSection);
 }
 
 DWORD WINAPI spectra (void *pargs)
@@ -607,6 +655,8 @@ DWORD WINAPI spectra (void *pargs)
 	int ss = (((int)(uintptr_t)pargs) >> 4) & 255;
 	int LO = ((int)(uintptr_t)pargs) & 15;
 	DP a = pdisp[disp];
+	int prof = a->profile;
+	long long pt0 = 0;
 
 	if (a->stop)
 	{
@@ -616,6 +666,8 @@ DWORD WINAPI spectra (void *pargs)
 
 	if ((ss >= a->begin_ss) && (ss <= a->end_ss))
 	{
+		if (prof)
+			pt0 = profile_ns();
 		for (i = 0; i < a->size; i++)
 		{
 			(a->fft_in[ss][LO])[i] = a->window[i] * (double)((a->I_samples[ss][LO])[a->IQO_idx[ss][LO]]);
@@ -629,6 +681,8 @@ DWORD WINAPI spectra (void *pargs)
 			return 0;
 		}
 		fftw_execute (a->plan[ss][LO]);
+		if (prof)
+			profile_done(a, 0, pt0);
 	}
 	if (a->stop)
 	{
@@ -651,12 +705,21 @@ DWORD WINAPI spectra (void *pargs)
 
 		if (a->stitch_flag == ((((uint64_t)1) << a->num_stitch) - 1))
 		{
+			double t0 = a->frame_t0;
 			a->stitch_flag = 0;
+			a->frame_t0 = 0.0;
 			LeaveCriticalSection(&a->StitchSection);
 			for (j = 0; j < dMAX_STITCH; j++)
 				for (i = 0; i < dMAX_NUM_FFT; i++)
 					InterlockedBitTestAndReset(&(a->input_busy[j][i]), 0);
+			if (prof)
+				pt0 = profile_ns();
 			stitch(disp);
+			if (prof)
+				profile_done(a, 1, pt0);
+			frame_done(a, t0);
+			// input buffers that became ready while this frame was processed
+			dispatch(disp);
 		}
 		else
 			LeaveCriticalSection(&a->StitchSection);
@@ -842,6 +905,8 @@ DWORD WINAPI Cspectra (void *pargs)
 	int LO = ((int)(uintptr_t)pargs) & 15;
 	DP a = pdisp[disp];
 	int trans_size = a->size * sizeof(double);
+	int prof = a->profile;
+	long long pt0 = 0;
 
 	if (a->stop)
 	{
@@ -851,6 +916,8 @@ DWORD WINAPI Cspectra (void *pargs)
 
 	if ((ss >= a->begin_ss) && (ss <= a->end_ss))
 	{
+		if (prof)
+			pt0 = profile_ns();
 		for (i = 0; i < a->size; i++)
 		{
 			(a->Cfft_in[ss][LO])[i][0] = a->window[i] * (double)((a->I_samples[ss][LO])[a->IQO_idx[ss][LO]]);
@@ -869,7 +936,8 @@ DWORD WINAPI Cspectra (void *pargs)
 		// Detect value of Max FFT Bin in a freq range
 		DetectMaxBin(disp, ss, LO);
 		//
-
+		if (prof)
+			profile_done(a, 0, pt0);
 	}
 
 	if (a->stop)
@@ -900,12 +968,21 @@ DWORD WINAPI Cspectra (void *pargs)
 
 		if (a->stitch_flag == ((((uint64_t)1) << a->num_stitch) - 1))
 		{
+			double t0 = a->frame_t0;
 			a->stitch_flag = 0;
+			a->frame_t0 = 0.0;
 			LeaveCriticalSection(&a->StitchSection);
 			for (j = 0; j < dMAX_STITCH; j++)
 				for (i = 0; i < dMAX_NUM_FFT; i++)
 					InterlockedBitTestAndReset(&(a->input_busy[j][i]), 0);
+			if (prof)
+				pt0 = profile_ns();
 			stitch(disp);
+			if (prof)
+				profile_done(a, 1, pt0);
+			frame_done(a, t0);
+			// input buffers that became ready while this frame was processed
+			dispatch(disp);
 		}
 		else
 			LeaveCriticalSection(&a->StitchSection);
@@ -1055,39 +1132,322 @@ int build_interpolants(int disp, int set, int n, int m, double *x, double (*y)[d
     return 0;
 }
 
-void __cdecl sendbuf(void *arg)
+//
+// Start the ffts of all sub-spans and LO positions whose input buffer is ready
+// and not busy. The ffts are executed by the worker pool (QueueUserWorkItem).
+// This is called when new samples have been stored, and by the worker that
+// completed a frame, so no dispatcher thread polling the buffers is needed.
+//
+static void dispatch (int disp)
 {
-	DP a = pdisp[(int)(uintptr_t)arg];
-	while(!a->end_dispatcher)
+	DP a = pdisp[disp];
+	int ss, LO;
+	EnterCriticalSection(&a->DispatchSection);
+	if (!a->end_dispatcher)
 	{
-		for (a->ss = 0; a->ss < a->num_stitch; a->ss++)
-			for (a->LO = 0; a->LO < a->num_fft; a->LO++)
+		for (ss = 0; ss < a->num_stitch; ss++)
+			for (LO = 0; LO < a->num_fft; LO++)
 			{
-				if (!_InterlockedAnd(&(a->input_busy[a->ss][a->LO]), 1) && _InterlockedAnd(&(a->buff_ready[a->ss][a->LO]), 1))
+				if (!_InterlockedAnd(&(a->input_busy[ss][LO]), 1) && _InterlockedAnd(&(a->buff_ready[ss][LO]), 1))
 				{
-					InterlockedBitTestAndSet(&(a->input_busy[a->ss][a->LO]), 0);
+					InterlockedBitTestAndSet(&(a->input_busy[ss][LO]), 0);
 
-					a->IQO_idx[a->ss][a->LO] = a->IQout_index[a->ss][a->LO];
+					a->IQO_idx[ss][LO] = a->IQout_index[ss][LO];
+					if (a->frame_t0 == 0.0)
+						a->frame_t0 = analyzer_time();
 
 					InterlockedIncrement(a->pnum_threads);
 					if (a->type == 0)
-						QueueUserWorkItem(spectra, (void *)(((uintptr_t)arg << 12) + (a->ss << 4) + a->LO), 0);
+						QueueUserWorkItem(spectra, (void *)(((uintptr_t)disp << 12) + (ss << 4) + LO), 0);
 					else
-						QueueUserWorkItem(Cspectra, (void *)(((uintptr_t)arg << 12) + (a->ss << 4) + a->LO), 0);
+						QueueUserWorkItem(Cspectra, (void *)(((uintptr_t)disp << 12) + (ss << 4) + LO), 0);
 
-					if((a->IQout_index[a->ss][a->LO] += a->incr) >= a->bsize)
-						a->IQout_index[a->ss][a->LO] -= a->bsize;
+					if((a->IQout_index[ss][LO] += a->incr) >= a->bsize)
+						a->IQout_index[ss][LO] -= a->bsize;
 
-					EnterCriticalSection(&(a->BufferControlSection[a->ss][a->LO]));
-					if ((a->have_samples[a->ss][a->LO] -= a->incr) < a->size)
-						InterlockedBitTestAndReset(&(a->buff_ready[a->ss][a->LO]), 0);
-					LeaveCriticalSection(&(a->BufferControlSection[a->ss][a->LO]));
+					EnterCriticalSection(&(a->BufferControlSection[ss][LO]));
+					if ((a->have_samples[ss][LO] -= a->incr) < a->size)
+						InterlockedBitTestAndReset(&(a->buff_ready[ss][LO]), 0);
+					LeaveCriticalSection(&(a->BufferControlSection[ss][LO]));
 				}
 			}
+	}
+	LeaveCriticalSection(&a->DispatchSection);
+}
+
+// stop dispatching and wait until all ffts in progress have finished
+static void quiesce (DP a)
+{
+	EnterCriticalSection(&a->DispatchSection);
+	a->end_dispatcher = 1;
+	LeaveCriticalSection(&a->DispatchSection);
+	a->stop = 1;
+	while (_InterlockedAnd(a->pnum_threads, 1023))
 		Sleep(1);
+}
+
+/********************************************************************************************************
+*																										*
+*											Zoom Mode													*
+*																										*
+********************************************************************************************************/
+
+// In zoom mode, Spectrum0() shifts the centre of the visible span to zero frequency, low-pass filters
+// and decimates the input before storing it in the sample buffers.  The fft then only has to cover
+// the visible span, so its size (and the cpu load) does not grow with the zoom factor.  Only the
+// output samples that are kept are calculated.
+
+#define ZOOM_TAPS_PER_PHASE 24
+
+static void zoom_setup (DP a, int bf_sz)
+{
+	int decim = a->zoom_decim_req;
+	if (decim < 2 || a->type != 1 || bf_sz % decim != 0)
+		decim = 1;
+	if (decim != a->zoom_decim)
+	{
+		_aligned_free (a->zoom_taps);
+		_aligned_free (a->zoom_hist);
+		a->zoom_taps = NULL;
+		a->zoom_hist = NULL;
+		if (decim > 1)
+		{
+			// -6dB point at the new Nyquist frequency; the visible span never exceeds half of it
+			a->zoom_ntaps = ZOOM_TAPS_PER_PHASE * decim;
+			a->zoom_taps = fir_bandpass (a->zoom_ntaps, -0.5 / decim, +0.5 / decim, 1.0, 0, 0, 1.0);
+			a->zoom_hist = (double *) malloc0 (4 * a->zoom_ntaps * sizeof (double));
+		}
+		a->zoom_decim = decim;
+	}
+	if (decim > 1)
+	{
+		memset (a->zoom_hist, 0, 4 * a->zoom_ntaps * sizeof (double));
+		a->zoom_idx = 0;
+		a->zoom_phase = 0;
+		a->zoom_osc[0] = 1.0;
+		a->zoom_osc[1] = 0.0;
+		a->zoom_delta[0] = +cos (TWOPI * a->zoom_shift);
+		a->zoom_delta[1] = -sin (TWOPI * a->zoom_shift);
+	}
+	a->buff_size = bf_sz / decim;
+}
+
+static void zoom_decimate (DP a, double* pbuff, dINREAL* Ipointer, dINREAL* Qpointer)
+{
+	int i, k;
+	int n = 0;
+	int L = a->zoom_ntaps;
+	double* h = a->zoom_taps;
+	double* x;
+	double I, Q, sI, sQ, t;
+	for (i = 0; i < a->buff_size * a->zoom_decim; i++)
+	{
+		I = pbuff[2 * i + 0] * a->zoom_osc[0] - pbuff[2 * i + 1] * a->zoom_osc[1];
+		Q = pbuff[2 * i + 0] * a->zoom_osc[1] + pbuff[2 * i + 1] * a->zoom_osc[0];
+		t = a->zoom_osc[0] * a->zoom_delta[0] - a->zoom_osc[1] * a->zoom_delta[1];
+		a->zoom_osc[1] = a->zoom_osc[0] * a->zoom_delta[1] + a->zoom_osc[1] * a->zoom_delta[0];
+		a->zoom_osc[0] = t;
+		// each sample is stored twice, so the last L samples are always contiguous
+		x = a->zoom_hist + 2 * a->zoom_idx;
+		x[0] = x[2 * L + 0] = I;
+		x[1] = x[2 * L + 1] = Q;
+		if (++a->zoom_idx == L)
+			a->zoom_idx = 0;
+		if (++a->zoom_phase == a->zoom_decim)
+		{
+			a->zoom_phase = 0;
+			x = a->zoom_hist + 2 * a->zoom_idx;
+			sI = sQ = 0.0;
+			for (k = 0; k < L; k++)
+			{
+				sI += h[k] * x[2 * k + 0];
+				sQ += h[k] * x[2 * k + 1];
+			}
+			// same I/Q order as the copy loop in Spectrum0()
+			Ipointer[n] = (dINREAL)sQ;
+			Qpointer[n] = (dINREAL)sI;
+			n++;
+		}
+	}
+	t = 1.0 / sqrt (a->zoom_osc[0] * a->zoom_osc[0] + a->zoom_osc[1] * a->zoom_osc[1]);
+	a->zoom_osc[0] *= t;
+	a->zoom_osc[1] *= t;
+}
+
+PORT
+void SetAnalyzerZoom (int disp, int decim, double shift)
+{
+	// decim > 1 enables zoom mode for complex input via Spectrum0(), shifting the frequency
+	// 'shift' (in units of the input sample rate) to zero.  The values take effect with the
+	// next SetAnalyzer() call; there, bf_sz is the number of input samples per Spectrum0()
+	// call while sz is the size of the fft of the decimated data.
+	DP a = pdisp[disp];
+	EnterCriticalSection(&a->SetAnalyzerSection);
+	a->zoom_decim_req = decim;
+	a->zoom_shift = shift;
+	LeaveCriticalSection(&a->SetAnalyzerSection);
+}
+
+/********************************************************************************************************
+*																										*
+*										FFT Cache and Panning											*
+*																										*
+********************************************************************************************************/
+
+// The fft plans and the window of the last dNUM_FFT_CACHE fft sizes are kept, so changing the zoom
+// back and forth does not re-plan the ffts.  All plans use the same input and output vectors.
+
+static void select_fft (int disp, int sz, int win_type, double pi)
+{
+	DP a = pdisp[disp];
+	int i, j, k;
+	fft_cache* e = NULL;
+	for (k = 0; k < dNUM_FFT_CACHE; k++)
+		if (a->cache[k].size == sz)
+			e = &a->cache[k];
+	if (e == NULL)
+	{
+		// re-use the least recently used entry
+		e = &a->cache[0];
+		for (k = 1; k < dNUM_FFT_CACHE; k++)
+			if (a->cache[k].last_use < e->last_use)
+				e = &a->cache[k];
+		for (i = 0; i < a->max_stitch; i++)
+			for (j = 0; j < a->max_num_fft; j++)
+			{
+				if (e->plan[i][j])		fftw_destroy_plan (e->plan[i][j]);
+				if (e->Cplan[i][j])		fftw_destroy_plan (e->Cplan[i][j]);
+				e->plan[i][j] = wisdom_plan_dft_r2c_1d(sz, a->fft_in[i][j], a->fft_out[i][j]);
+				e->Cplan[i][j] = wisdom_plan_dft_1d(sz, a->Cfft_in[i][j], a->fft_out[i][j], FFTW_FORWARD);
+			}
+		_aligned_free (e->window);
+		e->window = (double*) malloc0 (sizeof(double) * sz);
+		e->size = sz;
+		e->window_type = -1;
+	}
+	a->window = e->window;
+	if ((win_type != e->window_type) || (pi != e->PiAlpha))
+	{
+		new_window(disp, win_type, sz, pi);
+		e->window_type = win_type;
+		e->PiAlpha = pi;
+		e->inv_coherent_gain = a->inv_coherent_gain;
+		e->inherent_power_gain = a->inherent_power_gain;
+		e->inv_enb = a->inv_enb;
+	}
+	else
+	{
+		a->inv_coherent_gain = e->inv_coherent_gain;
+		a->inherent_power_gain = e->inherent_power_gain;
+		a->inv_enb = e->inv_enb;
+	}
+	for (i = 0; i < a->max_stitch; i++)
+		for (j = 0; j < a->max_num_fft; j++)
+		{
+			a->plan[i][j] = e->plan[i][j];
+			a->Cplan[i][j] = e->Cplan[i][j];
+		}
+	e->last_use = ++a->cache_clock;
+}
+
+static void calc_span (DP a)
+{
+	a->begin_ss = 0;
+	a->end_ss = a->num_stitch - 1;
+	a->fscL = (int)a->fsclipL;
+	a->fscH = (int)a->fsclipH;
+	while (a->fscL >= (a->out_size - 1 - 2 * a->clip))
+	{
+		a->fscL -= a->out_size - 1 - 2 * a->clip;
+		a->ss_bins[a->begin_ss] = 0;
+		a->begin_ss++;
+	}
+	while (a->fscH >= (a->out_size - 1 - 2 * a->clip))
+	{
+		a->fscH -= a->out_size - 1 - 2 * a->clip;
+		a->ss_bins[a->end_ss] = 0;
+		a->end_ss--;
+	}
+
+	a->pix_per_bin = (double)a->num_pixels / ((double)(a->num_stitch * (a->out_size - 1 - 2 * a->clip)) - a->fsclipL - a->fsclipH - 1.0);
+	a->det_offset = -a->pix_per_bin * (a->fsclipL - floor(a->fsclipL));
+	a->bin_per_pix = ((double)(a->num_stitch * (a->out_size - 1 - 2 * a->clip)) - 1.0 - a->fsclipL - a->fsclipH) / ((double)a->num_pixels - 1.0);
+}
+
+// Frequency of the first pixel and frequency step per pixel, both in units of the input sample rate.
+// Only a single, non-flipped sub-span is supported; returns 0 otherwise.
+static int span_map (DP a, double* f0, double* df)
+{
+	if ((a->num_stitch != 1) || a->flip[0] || (a->num_pixels < 2))
+		return 0;
+	*df = a->bin_per_pix / ((double)a->size * (double)a->zoom_decim);
+	if (a->type == 0)
+		*f0 = (a->fsclipL + (double)a->clip) / (double)a->size;
+	else
+		*f0 = ((a->fsclipL + (double)a->clip + 1.0) / (double)a->size - 0.5) / (double)a->zoom_decim;
+	if (a->zoom_decim > 1)
+		*f0 += a->zoom_shift;
+	return 1;
+}
+
+static void remap_pixels (double* buff, double* tmp, int old_n, int n, double x0, double dx)
+{
+	int i, k;
+	double x, f;
+	for (i = 0; i < n; i++)
+	{
+		x = x0 + (double)i * dx;
+		if (x <= 0.0)
+			tmp[i] = buff[0];
+		else if (x >= (double)(old_n - 1))
+			tmp[i] = buff[old_n - 1];
+		else
+		{
+			k = (int)x;
+			f = x - (double)k;
+			tmp[i] = (1.0 - f) * buff[k] + f * buff[k + 1];
+		}
+	}
+	memcpy (buff, tmp, n * sizeof (double));
+}
+
+// After a change of the span, move the averaging history to the new pixel frequencies, such that the
+// averaged spectrum does not smear while panning or zooming.  Pixels outside of the previous span take
+// the value of the nearest edge.  If the spans do not overlap at all, the history is left as it is.
+// Must be called with ResampleSection held (or the analyzer quiesced); t_pixels[] serves as scratch.
+static void remap_average (DP a)
+{
+	int i, j, k;
+	double f0, df, x0, dx, x1;
+	if (!span_map (a, &f0, &df))
+	{
+		a->map_valid = 0;
+		return;
+	}
+	if (a->map_valid && ((f0 != a->map_f0) || (df != a->map_df) || (a->num_pixels != a->map_pixels)))
+	{
+		x0 = (f0 - a->map_f0) / a->map_df;
+		dx = df / a->map_df;
+		x1 = x0 + (double)(a->num_pixels - 1) * dx;
+		if ((x1 > 0.0) && (x0 < (double)(a->map_pixels - 1)))
+			for (i = 0; i < a->num_pixout; i++)
+			{
+				if (a->av_mode[i] == 0)
+					continue;
+				remap_pixels (a->av_sum[i], a->t_pixels[i], a->map_pixels, a->num_pixels, x0, dx);
+				if (a->av_mode[i] == 2)
+					for (j = 0, k = a->av_in_idx[i]; j < a->avail_frames[i]; j++)
+					{
+						if (--k < 0)
+							k = dMAX_AVERAGE - 1;
+						remap_pixels (a->av_buff[i][k], a->t_pixels[i], a->map_pixels, a->num_pixels, x0, dx);
+					}
+			}
 	}
-	InterlockedBitTestAndReset(&a->dispatcher, 0);
-	_endthread();
+	a->map_valid = 1;
+	a->map_f0 = f0;
+	a->map_df = df;
+	a->map_pixels = a->num_pixels;
 }
 
 void CalcBandwidthNormalization (DP a)
@@ -1195,16 +1555,11 @@ void SetAnalyzer (	int disp,			// display identifier
 	int i, j;
 
 	EnterCriticalSection(&a->SetAnalyzerSection);
-	a->end_dispatcher = 1;
-	while (InterlockedAnd(&a->dispatcher, 1))
-		Sleep(1);
-	a->stop = 1;
-	while (_InterlockedAnd(a->pnum_threads, 1023))
-		Sleep(1);
+	quiesce(a);
 	a->num_pixout = n_pixout;
 	a->num_fft = n_fft;
 	a->type = typ;
-	a->buff_size = bf_sz;
+	zoom_setup (a, bf_sz);
 	for (i = 0; i < a->num_fft; i++)
 		a->flip[i] = *(flp + i);
 	a->overlap = ovrlp;
@@ -1213,26 +1568,15 @@ void SetAnalyzer (	int disp,			// display identifier
 	a->fsclipH = fscHin;
 	a->num_stitch = n_stch;
 
+	select_fft (disp, sz, win_type, pi);
 	if (sz != a->size)
 	{
-		for (i = 0; i < a->max_stitch; i++)
-			for (j = 0; j < a->max_num_fft; j++)
-			{
-				if (a->plan[i][j])		fftw_destroy_plan (a->plan[i][j]);
-				if (a->Cplan[i][j])		fftw_destroy_plan (a->Cplan[i][j]);
-				a->plan[i][j] = fftw_plan_dft_r2c_1d(sz, a->fft_in[i][j], a->fft_out[i][j], FFTW_PATIENT);
-				a->Cplan[i][j] = fftw_plan_dft_1d(sz, a->Cfft_in[i][j], a->fft_out[i][j], FFTW_FORWARD, FFTW_PATIENT);
-			}
-
 		// Setup DetectMaxBin for a 'size' change.
 		calc_dmb(disp, sz);
 		//
 
 	}
 
-	if ((sz != a->size) || (win_type != a->window_type) || (pi != a->PiAlpha))
-		new_window(disp, win_type, sz, pi);
-
 	a->size = sz;
 	a->window_type = win_type;
 	a->PiAlpha = pi;
@@ -1263,26 +1607,10 @@ void SetAnalyzer (	int disp,			// display identifier
 		a->scale = 1.0 / ((double)a->size * (double)a->size);
 	}
 
-	a->begin_ss = 0;
-	a->end_ss = a->num_stitch - 1;
-	a->fscL = (int)a->fsclipL;
-	a->fscH = (int)a->fsclipH;
-	while (a->fscL >= (a->out_size - 1 - 2 * a->clip))
-	{
-		a->fscL -= a->out_size - 1 - 2 * a->clip;
-		a->ss_bins[a->begin_ss] = 0;
-		a->begin_ss++;
-	}
-	while (a->fscH >= (a->out_size - 1 - 2 * a->clip))
-	{
-		a->fscH -= a->out_size - 1 - 2 * a->clip;
-		a->ss_bins[a->end_ss] = 0;
-		a->end_ss--;
-	}
-
-	a->pix_per_bin = (double)a->num_pixels / ((double)(a->num_stitch * (a->out_size - 1 - 2 * a->clip)) - a->fsclipL - a->fsclipH - 1.0);
-	a->det_offset = -a->pix_per_bin * (a->fsclipL - floor(a->fsclipL));
-	a->bin_per_pix = ((double)(a->num_stitch * (a->out_size - 1 - 2 * a->clip)) - 1.0 - a->fsclipL - a->fsclipH) / ((double)a->num_pixels - 1.0);
+	calc_span (a);
+	EnterCriticalSection(&a->ResampleSection);
+	remap_average (a);
+	LeaveCriticalSection(&a->ResampleSection);
 
 	for (i = 0; i < dMAX_STITCH; i++)
 		for (j = 0; j < dMAX_NUM_FFT; j++)
@@ -1311,7 +1639,41 @@ void SetAnalyzer (	int disp,			// display identifier
 		}
 
 	a->stop = 0;
+	EnterCriticalSection(&a->DispatchSection);
 	a->end_dispatcher = 0;
+	LeaveCriticalSection(&a->DispatchSection);
+	LeaveCriticalSection(&a->SetAnalyzerSection);
+}
+
+PORT
+void SetAnalyzerPan (int disp, double fscLin, double fscHin, double shift)
+{
+	// Move the visible span without re-initializing the analyzer:  only the clipping and, in zoom mode,
+	// the zoom oscillator change.  The input buffers, the fft in progress, and the averaging history
+	// are kept.  The fft size, the zoom decimation and the number of pixels stay the same; the width of
+	// the span may change (zoom without a change of the fft size or decimation).
+	DP a = pdisp[disp];
+	int i;
+
+	EnterCriticalSection(&a->SetAnalyzerSection);
+	EnterCriticalSection(&a->ResampleSection);
+	for (i = 0; i < a->max_stitch; i++)
+		EnterCriticalSection(&(a->EliminateSection[i]));
+	a->fsclipL = fscLin;
+	a->fsclipH = fscHin;
+	a->zoom_shift = shift;
+	if (a->zoom_decim > 1)
+	{
+		// keep the oscillator phase, only change its frequency; Spectrum0() reads both components
+		// with SetAnalyzerSection held
+		a->zoom_delta[0] = +cos (TWOPI * a->zoom_shift);
+		a->zoom_delta[1] = -sin (TWOPI * a->zoom_shift);
+	}
+	calc_span (a);
+	for (i = a->max_stitch - 1; i >= 0; i--)
+		LeaveCriticalSection(&(a->EliminateSection[i]));
+	remap_average (a);
+	LeaveCriticalSection(&a->ResampleSection);
 	LeaveCriticalSection(&a->SetAnalyzerSection);
 }
 
@@ -1334,6 +1696,8 @@ void XCreateAnalyzer(	int disp,
 	a->max_stitch = m_stitch;
 
 	a->pnum_threads = (LONG*) malloc0 (sizeof (LONG));
+	a->zoom_decim = 1;
+	a->zoom_decim_req = 1;
 
 	for (i = 0; i < a->max_stitch; i++)
 		for (j = 0; j < a->max_num_fft; j++)
@@ -1344,6 +1708,7 @@ void XCreateAnalyzer(	int disp,
 	InitializeCriticalSectionAndSpinCount(&a->ResampleSection, 0);
 	InitializeCriticalSectionAndSpinCount(&a->SetAnalyzerSection, 0);
 	InitializeCriticalSectionAndSpinCount(&a->StitchSection, 0);
+	InitializeCriticalSectionAndSpinCount(&a->DispatchSection, 0);
 	for (i = 0; i < dMAX_PIXOUTS; i++)
 		InitializeCriticalSectionAndSpinCount(&a->PB_ControlsSection[i], 0);
 	for (i = 0; i < dMAX_STITCH; i++)
@@ -1353,8 +1718,6 @@ void XCreateAnalyzer(	int disp,
 			InitializeCriticalSectionAndSpinCount(&(a->BufferControlSection[i][j]), 0);
 	}
 
-	a->window = (double*) malloc0 (sizeof(double) * a->max_size);
-
 	for (i = 0; i < a->max_stitch; i++)
 	{
 		a->result[i] = (double*) malloc0 (sizeof(double) * a->max_size);
@@ -1421,15 +1784,78 @@ void XCreateAnalyzer(	int disp,
 	*success = 0;
 }
 
+PORT
+void GetAnalyzerLatency(int disp, double *avg, double *max, long *frames)
+{
+	// average and maximum frame latency (seconds) since the previous call
+	DP a = pdisp[disp];
+	EnterCriticalSection(&a->StitchSection);
+	*avg = (a->latency_num > 0) ? a->latency_sum / a->latency_num : 0.0;
+	*max = a->latency_max;
+	*frames = a->frames;
+	a->latency_sum = 0.0;
+	a->latency_num = 0;
+	a->latency_max = 0.0;
+	LeaveCriticalSection(&a->StitchSection);
+}
+
+PORT
+void SetAnalyzerNotify(int disp, void (*notify)(void*), void* arg)
+{
+	// notify(arg) is called from an analyzer thread each time new pixels have been published;
+	// it must return quickly.  Use notify = 0 to stop the notifications.
+	DP a = pdisp[disp];
+	EnterCriticalSection(&a->StitchSection);
+	a->notify = notify;
+	a->notify_arg = arg;
+	LeaveCriticalSection(&a->StitchSection);
+}
+
+PORT
+void SetAnalyzerProfile(int disp, int run)
+{
+	// switching on resets the counters
+	DP a = pdisp[disp];
+	int k;
+	EnterCriticalSection(&a->StitchSection);
+	if (run && !a->profile)
+		for (k = 0; k < 2; k++)
+		{
+			a->prof_ns[k] = 0;
+			a->prof_calls[k] = 0;
+			a->prof_worst[k] = 0;
+		}
+	a->profile = run;
+	LeaveCriticalSection(&a->StitchSection);
+}
+
+PORT
+int GetAnalyzerProfile(int disp, int n, const char** names, long long* ns, long long* calls, long long* worst)
+{
+	// cumulative time (nsec), number of calls, and longest call (nsec) of the ffts (including windowing)
+	// and of stitch();  returns the number of entries
+	static const char* prof_name[2] = { "fft", "stitch" };
+	DP a = pdisp[disp];
+	int k;
+	EnterCriticalSection(&a->StitchSection);
+	for (k = 0; k < 2 && k < n; k++)
+	{
+		names[k] = prof_name[k];
+		ns[k] = a->prof_ns[k];
+		calls[k] = a->prof_calls[k];
+		worst[k] = a->prof_worst[k];
+	}
+	LeaveCriticalSection(&a->StitchSection);
+	return k;
+}
+
 PORT
 void DestroyAnalyzer(int disp)
 {
 	DP a = pdisp[disp];
-	int i, j;
+	int i, j, k;
 
-	a->end_dispatcher = 1;
-	while (InterlockedAnd(&a->dispatcher, 1))
-		Sleep(1);
+	quiesce(a);
 
 	for (i = 0; i < a->max_stitch; i++)
 		for (j = 0; j < a->max_num_fft; j++)
@@ -1465,16 +1891,26 @@ void DestroyAnalyzer(int disp)
 	for (i = 0; i < a->max_stitch; i++)
 		for (j = 0; j < a->max_num_fft; j++)
 		{
-			fftw_destroy_plan (a->plan[i][j]);
-			fftw_destroy_plan (a->Cplan[i][j]);
 			fftw_free (a->Cfft_in[i][j]);
 			_aligned_free (a->fft_in[i][j]);
 			fftw_free (a->fft_out[i][j]);
 		}
 
+	for (k = 0; k < dNUM_FFT_CACHE; k++)
+	{
+		for (i = 0; i < a->max_stitch; i++)
+			for (j = 0; j < a->max_num_fft; j++)
+			{
+				if (a->cache[k].plan[i][j])		fftw_destroy_plan (a->cache[k].plan[i][j]);
+				if (a->cache[k].Cplan[i][j])	fftw_destroy_plan (a->cache[k].Cplan[i][j]);
+			}
+		_aligned_free (a->cache[k].window);
+	}
+
 	for (i = 0; i < a->max_stitch; i++)
 		_aligned_free (a->result[i]);
-	_aligned_free (a->window);
+	_aligned_free (a->zoom_taps);
+	_aligned_free (a->zoom_hist);
 
 	for (i = 0; i < dMAX_STITCH; i++)
 	{
@@ -1485,6 +1921,7 @@ void DestroyAnalyzer(int disp)
 	for (i = 0; i < dMAX_PIXOUTS; i++)
 		DeleteCriticalSection(&a->PB_ControlsSection[i]);
 	DeleteCriticalSection(&a->StitchSection);
+	DeleteCriticalSection(&a->DispatchSection);
 	DeleteCriticalSection(&a->SetAnalyzerSection);
 	DeleteCriticalSection(&a->ResampleSection);
 
@@ -1627,14 +2064,8 @@ void CloseBuffer(int disp, int ss, int LO)
 	if((a->IQin_index[ss][LO] += a->buff_size) >= a->bsize)	//REQUIRES buff_size IS A SUB-MULTIPLE OF SIZE OF INPUT SAMPLE BUFFS!
 		a->IQin_index[ss][LO] = 0;
 
-	if (!InterlockedAnd(&a->dispatcher, 1))
-	{
-		InterlockedBitTestAndSet (&a->dispatcher, 0);
-		LeaveCriticalSection(&a->SetAnalyzerSection);
-		_beginthread(sendbuf, 0, (void *)(uintptr_t)disp);
-	}
-	else
-		LeaveCriticalSection(&a->SetAnalyzerSection);
+	LeaveCriticalSection(&a->SetAnalyzerSection);
+	dispatch(disp);
 }
 
 PORT
@@ -1666,14 +2097,8 @@ void Spectrum(int disp, int ss, int LO, dINREAL* pI, dINREAL* pQ)
 	if((a->IQin_index[ss][LO] += a->buff_size) >= a->bsize)	//REQUIRES buff_size IS A SUB-MULTIPLE OF SIZE OF INPUT SAMPLE BUFFS!
 		a->IQin_index[ss][LO] = 0;
 
-	if (!InterlockedAnd(&a->dispatcher, 1))
-	{
-		InterlockedBitTestAndSet(&a->dispatcher, 0);
-		LeaveCriticalSection(&a->SetAnalyzerSection);
-		_beginthread(sendbuf, 0, (void *)(uintptr_t)disp);
-	}
-	else
-		LeaveCriticalSection(&a->SetAnalyzerSection);
+	LeaveCriticalSection(&a->SetAnalyzerSection);
+	dispatch(disp);
 }
 
 PORT
@@ -1711,14 +2136,8 @@ void Spectrum2(int run, int disp, int ss, int LO, dINREAL* pbuff)
 		if((a->IQin_index[ss][LO] += a->buff_size) >= a->bsize)	//REQUIRES buff_size IS A SUB-MULTIPLE OF SIZE OF INPUT SAMPLE BUFFS!
 			a->IQin_index[ss][LO] = 0;
 
-		if (!InterlockedAnd(&a->dispatcher, 1))
-		{
-			InterlockedBitTestAndSet(&a->dispatcher, 0);
-			LeaveCriticalSection(&a->SetAnalyzerSection);
-			_beginthread(sendbuf, 0, (void *)(uintptr_t)disp);
-		}
-		else
-			LeaveCriticalSection(&a->SetAnalyzerSection);
+		LeaveCriticalSection(&a->SetAnalyzerSection);
+		dispatch(disp);
 	}
 }
 
@@ -1734,12 +2153,20 @@ void Spectrum0(int run, int disp, int ss, int LO, double* pbuff)
 		EnterCriticalSection(&a->SetAnalyzerSection);
 		Ipointer = &((a->I_samples[ss][LO])[a->IQin_index[ss][LO]]);
 		Qpointer = &((a->Q_samples[ss][LO])[a->IQin_index[ss][LO]]);
-		LeaveCriticalSection(&a->SetAnalyzerSection);
-
-		for (i = 0; i < a->buff_size; i++)
+		if (a->zoom_decim > 1)
+		{
+			// the zoom state must not change while decimating
+			zoom_decimate (a, pbuff, Ipointer, Qpointer);
+			LeaveCriticalSection(&a->SetAnalyzerSection);
+		}
+		else
 		{
-			Ipointer[i] = (dINREAL)pbuff[2 * i + 1];
-			Qpointer[i] = (dINREAL)pbuff[2 * i + 0];
+			LeaveCriticalSection(&a->SetAnalyzerSection);
+			for (i = 0; i < a->buff_size; i++)
+			{
+				Ipointer[i] = (dINREAL)pbuff[2 * i + 1];
+				Qpointer[i] = (dINREAL)pbuff[2 * i + 0];
+			}
 		}
 
 		EnterCriticalSection(&a->SetAnalyzerSection);
@@ -1757,14 +2184,8 @@ void Spectrum0(int run, int disp, int ss, int LO, double* pbuff)
 		if((a->IQin_index[ss][LO] += a->buff_size) >= a->bsize)	//REQUIRES buff_size IS A SUB-MULTIPLE OF SIZE OF INPUT SAMPLE BUFFS!
 			a->IQin_index[ss][LO] = 0;
 
-		if (!InterlockedAnd(&a->dispatcher, 1))
-		{
-			InterlockedBitTestAndSet(&a->dispatcher, 0);
-			LeaveCriticalSection(&a->SetAnalyzerSection);
-			_beginthread(sendbuf, 0, (void *)(uintptr_t)disp);
-		}
-		else
-			LeaveCriticalSection(&a->SetAnalyzerSection);
+		LeaveCriticalSection(&a->SetAnalyzerSection);
+		dispatch(disp);
 	}
 }
 
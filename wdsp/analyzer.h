@@ -28,6 +28,22 @@ warren@wpratt.com
 #define _analyzer_h
 #include "comm.h"
 
+#define dNUM_FFT_CACHE					4					// number of fft sizes for which plans and windows are kept
+
+typedef struct _fft_cache
+{
+	int size;												// fft size, 0 if the entry is not used
+	int window_type;										// window function of the window coefficients
+	double PiAlpha;											// Kaiser window parameter of the window coefficients
+	double *window;											// window coefficients
+	double inv_coherent_gain;								// gains of the window, see new_window()
+	double inherent_power_gain;
+	double inv_enb;
+	fftw_plan plan[dMAX_STITCH][dMAX_NUM_FFT];				// fftw plans for this size
+	fftw_plan Cplan[dMAX_STITCH][dMAX_NUM_FFT];
+	int last_use;											// value of cache_clock when last used
+} fft_cache;
+
 typedef struct _dp
 {
 	int max_size;											// maximum fft size to be used
@@ -94,13 +110,25 @@ typedef struct _dp
 
 	fftw_plan plan[dMAX_STITCH][dMAX_NUM_FFT];				// fftw plans
 	fftw_plan Cplan[dMAX_STITCH][dMAX_NUM_FFT];
+	fft_cache cache[dNUM_FFT_CACHE];						// plans and windows of the recently used fft sizes
+	int cache_clock;										// incremented each time a cache entry is used
 	double *fft_in[dMAX_STITCH][dMAX_NUM_FFT];				// pointers to fftw real input vectors
 	fftw_complex *Cfft_in[dMAX_STITCH][dMAX_NUM_FFT];		// pointers to fftw complex input vectors
 	fftw_complex *fft_out[dMAX_STITCH][dMAX_NUM_FFT];		// pointers to fftw complex output vectors
 	volatile LONG *pnum_threads;							// pointer to current number of active worker threads
 	int stop;												// when set, fft threads will be returned to the pool
-	int end_dispatcher;										// set this flag to one to destroy the dispatcher thread
-	volatile int dispatcher;								// one if the dispatcher thread is alive & active
+	int end_dispatcher;										// set this flag to one to stop dispatching ffts
+	double frame_t0;										// start time of the frame being processed, 0.0 if none
+	long frames;											// number of frames completed
+	double latency_sum;										// sum of frame latencies since last GetAnalyzerLatency()
+	int latency_num;										// number of frame latencies in latency_sum
+	double latency_max;										// max. frame latency since last GetAnalyzerLatency()
+	void (*notify)(void*);									// called when new pixels have been published, if non-zero
+	void* notify_arg;										// argument of notify()
+	int profile;											// measure the execution times of fft and stitch
+	long long prof_ns[2];									// profile:  cumulative time of the ffts, stitch
+	long long prof_calls[2];								// profile:  number of ffts, stitches
+	long long prof_worst[2];								// profile:  longest fft, stitch
 	int ss;													// sub-span being processed
 	int LO;													// LO (within current sub-span) being processed
 	int flag;
@@ -116,6 +144,20 @@ typedef struct _dp
 	int IQin_index[dMAX_STITCH][dMAX_NUM_FFT];				// current input index for I_samples[ss][LO] and Q_samples[ss][LO]
 	volatile LONG buff_ready[dMAX_STITCH][dMAX_NUM_FFT];	// 1 if buffer ready to read; 0 if needs to be filled
 	int max_writeahead;										// max allowed input samples ahead of where reading output samples
+	int zoom_decim_req;										// zoom decimation requested by SetAnalyzerZoom()
+	double zoom_shift;										// zoom centre frequency (fraction of the input sample rate)
+	int zoom_decim;											// active zoom decimation, 1 if zoom mode is off
+	int zoom_ntaps;											// length of the zoom low-pass filter
+	double* zoom_taps;										// zoom low-pass filter coefficients
+	double* zoom_hist;										// complex filter history, stored twice (2 * zoom_ntaps samples)
+	int zoom_idx;											// write position in zoom_hist
+	int zoom_phase;											// input samples since the last output sample
+	double zoom_osc[2];										// zoom oscillator (cos, sin)
+	double zoom_delta[2];									// zoom oscillator phase increment
+	int map_valid;											// map_f0, map_df, map_pixels describe the averaging history
+	int map_pixels;											// number of pixels of the averaging history
+	double map_f0;											// frequency of its first pixel (fraction of the input sample rate)
+	double map_df;											// frequency step between its pixels
 
 	volatile LONG snap[dMAX_STITCH][dMAX_NUM_FFT];			// set to 1 to allow a snap of raw spectrum data
 	HANDLE hSnapEvent[dMAX_STITCH][dMAX_NUM_FFT];			// mutex handles; mutexes will be used to signal a snap is complete
@@ -125,6 +167,7 @@ typedef struct _dp
 	CRITICAL_SECTION SetAnalyzerSection;
 	CRITICAL_SECTION BufferControlSection[dMAX_STITCH][dMAX_NUM_FFT];
 	CRITICAL_SECTION StitchSection;
+	CRITICAL_SECTION DispatchSection;
 	CRITICAL_SECTION EliminateSection[dMAX_STITCH];
 	CRITICAL_SECTION ResampleSection;
 
@@ -176,6 +219,24 @@ void XCreateAnalyzer (	int disp,
 extern __declspec( dllexport )
 void DestroyAnalyzer(int disp);
 
+extern __declspec( dllexport )
+void GetAnalyzerLatency(int disp, double *avg, double *max, long *frames);
+
+extern __declspec( dllexport )
+void SetAnalyzerNotify(int disp, void (*notify)(void*), void* arg);
+
+extern __declspec( dllexport )
+void SetAnalyzerProfile(int disp, int run);
+
+extern __declspec( dllexport )
+int GetAnalyzerProfile(int disp, int n, const char** names, long long* ns, long long* calls, long long* worst);
+
+extern __declspec( dllexport )
+void SetAnalyzerZoom (int disp, int decim, double shift);
+
+extern __declspec( dllexport )
+void SetAnalyzerPan (int disp, double fscLin, double fscHin, double shift);
+
 extern __declspec( dllexport )
 void SetCalibration (	int disp,
 						int set_num,				//identifier for this calibration data set
@@ -300,8 +300,8 @@ void calc_cfcomp(CFCOMP a)
 	a->outaccum = (double *)malloc0(a->oasize * sizeof(double));
 	a->nsamps = 0;
 	a->saveidx = 0;
-	a->Rfor = fftw_plan_dft_r2c_1d(a->fsize, a->forfftin, (fftw_complex *)a->forfftout, FFTW_ESTIMATE);
-	a->Rrev = fftw_plan_dft_c2r_1d(a->fsize, (fftw_complex *)a->revfftin, a->revfftout, FFTW_ESTIMATE);
+	a->Rfor = wisdom_plan_dft_r2c_1d(a->fsize, a->forfftin, (fftw_complex *)a->forfftout);
+	a->Rrev = wisdom_plan_dft_c2r_1d(a->fsize, (fftw_complex *)a->revfftin, a->revfftout);
 	calc_cfcwindow(a);
 
 	a->pregain  = (2.0 * a->winfudge) / (double)a->fsize;
@@ -106,10 +106,15 @@ void pre_main_destroy (int channel)
 {
 	IOB a = ch[channel].iob.pc;
 	InterlockedBitTestAndReset (&ch[channel].exchange, 0);
+	// a pipelined RXA front end tests run and exec_bypass under csFront
+	if (ch[channel].type == 0) EnterCriticalSection (&rxa[channel].pipe.csFront);
 	InterlockedBitTestAndReset (&ch[channel].run, 0);
 	InterlockedBitTestAndSet (&ch[channel].iob.pc->exec_bypass, 0);
-	ReleaseSemaphore (a->Sem_BuffReady, 1, 0);
+	if (ch[channel].type == 0) LeaveCriticalSection (&rxa[channel].pipe.csFront);
+	release_lwsem (&a->BuffReady, 1);
 	Sleep (25);
+	// stage 2 must not hold csDSP when it is deleted
+	if (ch[channel].type == 0) RXAPipeIdle (channel);
 }
 
 void post_main_destroy (int channel)
@@ -136,6 +141,8 @@ void flushChannel (void* p)
 		WaitForSingleObject(a->Sem_Flush, INFINITE);
 		if (!InterlockedAnd(&a->flush_bypass, 0xffffffff))
 		{
+			// a pipelined RXA front end runs dexchange() under csFront
+			if (ch[channel].type == 0) RXAPipeHold(channel);
 			EnterCriticalSection(&ch[channel].csDSP);
 			EnterCriticalSection(&ch[channel].csEXCH);
 			flush_iobuffs(channel);
@@ -143,6 +150,7 @@ void flushChannel (void* p)
 			flush_main(channel);
 			LeaveCriticalSection(&ch[channel].csEXCH);
 			LeaveCriticalSection(&ch[channel].csDSP);
+			if (ch[channel].type == 0) RXAPipeRelease(channel);
 			InterlockedBitTestAndReset(&ch[channel].flushflag, 0);
 		}
 	}
@@ -345,3 +353,53 @@ void SetChannelTSlewDown (int channel, double time)
 	create_slews (a);
 	LeaveCriticalSection (&ch[channel].csEXCH);
 }
+
+/********************************************************************************************************
+*																										*
+*												Profiling												*
+*																										*
+********************************************************************************************************/
+
+PORT
+void SetChannelProfile (int channel, int run)
+{
+	// switching on resets the counters
+	EnterCriticalSection (&ch[channel].csDSP);
+	switch (ch[channel].type)
+	{
+	case 0:
+		EnterCriticalSection (&rxa[channel].pipe.csFront);
+		profile_dispatch (rxa[channel].front, run);
+		LeaveCriticalSection (&rxa[channel].pipe.csFront);
+		profile_dispatch (rxa[channel].disp, run);
+		break;
+	case 1:
+		profile_dispatch (txa[channel].disp, run);
+		break;
+	}
+	LeaveCriticalSection (&ch[channel].csDSP);
+}
+
+PORT
+int GetChannelProfile (int channel, int n, const char** names, long long* ns, long long* calls, long long* worst)
+{
+	// For each chain of the channel, an entry for the whole chain followed by the entries of the stages that
+	// have been executed, with cumulative time (nsec), number of calls, and longest call (nsec).
+	// Returns the number of entries.
+	int k = 0;
+	EnterCriticalSection (&ch[channel].csDSP);
+	switch (ch[channel].type)
+	{
+	case 0:
+		EnterCriticalSection (&rxa[channel].pipe.csFront);
+		k = get_profile_dispatch (rxa[channel].front, n, names, ns, calls, worst);
+		LeaveCriticalSection (&rxa[channel].pipe.csFront);
+		k += get_profile_dispatch (rxa[channel].disp, n - k, names + k, ns + k, calls + k, worst + k);
+		break;
+	case 1:
+		k = get_profile_dispatch (txa[channel].disp, n, names, ns, calls, worst);
+		break;
+	}
+	LeaveCriticalSection (&ch[channel].csDSP);
+	return k;
+}
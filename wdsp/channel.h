@@ -81,4 +81,8 @@ PORT void SetAllRates (int channel, int in_rate, int dsp_rate, int out_rate);
 
 PORT int SetChannelState (int channel, int state, int dmode);
 
+PORT void SetChannelProfile (int channel, int run);
+
+PORT int GetChannelProfile (int channel, int n, const char** names, long long* ns, long long* calls, long long* worst);
+
 #endif
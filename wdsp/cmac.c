@@ -0,0 +1,231 @@
+/*  cmac.c
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2026 Christoph van Wüllen, DL1YCF
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include "comm.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CMAC_X86
+#include <immintrin.h>
+#endif
+#if defined(__GNUC__) && defined(__aarch64__)
+#define CMAC_NEON
+#endif
+#if defined(__GNUC__) && defined(__ARM_NEON)
+#define CMAC_NEON_F
+#include <arm_neon.h>
+#endif
+
+/********************************************************************************************************
+*																										*
+*									Complex Multiply-Accumulate Kernels									*
+*																										*
+********************************************************************************************************/
+
+// These are the inner loop of the partitioned overlap-save convolution (xfircore), where x is
+// the spectrum of an input partition and (mre, mim) the matching partition of the filter mask.
+
+static void cmac_c (double* accum, const double* x, const double* mre, const double* mim, int n)
+{
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		accum[2 * i + 0] += x[2 * i + 0] * mre[i] - x[2 * i + 1] * mim[i];
+		accum[2 * i + 1] += x[2 * i + 0] * mim[i] + x[2 * i + 1] * mre[i];
+	}
+}
+
+#ifdef CMAC_X86
+__attribute__((target("sse2")))
+static void cmac_sse2 (double* accum, const double* x, const double* mre, const double* mim, int n)
+{
+	int i;
+	const __m128d sign = _mm_set_pd (+1.0, -1.0);
+	for (i = 0; i < n; i++)
+	{
+		__m128d xv = _mm_loadu_pd (x + 2 * i);						// (xr, xi)
+		__m128d xs = _mm_shuffle_pd (xv, xv, 1);					// (xi, xr)
+		__m128d mr = _mm_set1_pd (mre[i]);
+		__m128d mi = _mm_mul_pd (_mm_set1_pd (mim[i]), sign);		// (-mi, mi)
+		__m128d av = _mm_loadu_pd (accum + 2 * i);
+		av = _mm_add_pd (av, _mm_mul_pd (xv, mr));
+		av = _mm_add_pd (av, _mm_mul_pd (xs, mi));
+		_mm_storeu_pd (accum + 2 * i, av);
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void cmac_avx2 (double* accum, const double* x, const double* mre, const double* mim, int n)
+{
+	int i;
+	for (i = 0; i + 2 <= n; i += 2)
+	{
+		// two complex values per register
+		__m256d mr = _mm256_permute4x64_pd (_mm256_castpd128_pd256 (_mm_loadu_pd (mre + i)), 0x50);	// (mr0, mr0, mr1, mr1)
+		__m256d mi = _mm256_permute4x64_pd (_mm256_castpd128_pd256 (_mm_loadu_pd (mim + i)), 0x50);	// (mi0, mi0, mi1, mi1)
+		__m256d xv = _mm256_loadu_pd (x + 2 * i);													// (xr0, xi0, xr1, xi1)
+		__m256d xs = _mm256_permute_pd (xv, 0x5);													// (xi0, xr0, xi1, xr1)
+		__m256d y  = _mm256_fmaddsub_pd (xv, mr, _mm256_mul_pd (xs, mi));
+		_mm256_storeu_pd (accum + 2 * i, _mm256_add_pd (_mm256_loadu_pd (accum + 2 * i), y));
+	}
+	if (i < n)
+		cmac_c (accum + 2 * i, x + 2 * i, mre + i, mim + i, n - i);
+}
+#endif
+
+#ifdef CMAC_NEON
+static void cmac_neon (double* accum, const double* x, const double* mre, const double* mim, int n)
+{
+	int i;
+	const float64x2_t sign = { -1.0, +1.0 };
+	for (i = 0; i < n; i++)
+	{
+		float64x2_t xv = vld1q_f64 (x + 2 * i);						// (xr, xi)
+		float64x2_t xs = vextq_f64 (xv, xv, 1);						// (xi, xr)
+		float64x2_t av = vld1q_f64 (accum + 2 * i);
+		av = vfmaq_n_f64 (av, xv, mre[i]);
+		av = vfmaq_f64 (av, xs, vmulq_n_f64 (sign, mim[i]));
+		vst1q_f64 (accum + 2 * i, av);
+	}
+}
+#endif
+
+/********************************************************************************************************
+*																										*
+*										Single Precision Kernels										*
+*																										*
+********************************************************************************************************/
+
+static void cmac_c_f (float* accum, const float* x, const float* mre, const float* mim, int n)
+{
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		accum[2 * i + 0] += x[2 * i + 0] * mre[i] - x[2 * i + 1] * mim[i];
+		accum[2 * i + 1] += x[2 * i + 0] * mim[i] + x[2 * i + 1] * mre[i];
+	}
+}
+
+#ifdef CMAC_X86
+__attribute__((target("sse2")))
+static void cmac_sse2_f (float* accum, const float* x, const float* mre, const float* mim, int n)
+{
+	int i;
+	for (i = 0; i + 2 <= n; i += 2)
+	{
+		__m128 xv = _mm_loadu_ps (x + 2 * i);										// (xr0, xi0, xr1, xi1)
+		__m128 xs = _mm_shuffle_ps (xv, xv, _MM_SHUFFLE (2, 3, 0, 1));				// (xi0, xr0, xi1, xr1)
+		__m128 mr = _mm_set_ps (mre[i + 1], mre[i + 1], mre[i], mre[i]);
+		__m128 mi = _mm_set_ps (mim[i + 1], -mim[i + 1], mim[i], -mim[i]);
+		__m128 av = _mm_loadu_ps (accum + 2 * i);
+		av = _mm_add_ps (av, _mm_mul_ps (xv, mr));
+		av = _mm_add_ps (av, _mm_mul_ps (xs, mi));
+		_mm_storeu_ps (accum + 2 * i, av);
+	}
+	if (i < n)
+		cmac_c_f (accum + 2 * i, x + 2 * i, mre + i, mim + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+static void cmac_avx2_f (float* accum, const float* x, const float* mre, const float* mim, int n)
+{
+	int i;
+	const __m256i dup = _mm256_set_epi32 (3, 3, 2, 2, 1, 1, 0, 0);
+	for (i = 0; i + 4 <= n; i += 4)
+	{
+		// four complex values per register
+		__m256 mr = _mm256_permutevar8x32_ps (_mm256_castps128_ps256 (_mm_loadu_ps (mre + i)), dup);	// (mr0, mr0, ..., mr3, mr3)
+		__m256 mi = _mm256_permutevar8x32_ps (_mm256_castps128_ps256 (_mm_loadu_ps (mim + i)), dup);	// (mi0, mi0, ..., mi3, mi3)
+		__m256 xv = _mm256_loadu_ps (x + 2 * i);
+		__m256 xs = _mm256_permute_ps (xv, 0xB1);														// swap re/im
+		__m256 y  = _mm256_fmaddsub_ps (xv, mr, _mm256_mul_ps (xs, mi));
+		_mm256_storeu_ps (accum + 2 * i, _mm256_add_ps (_mm256_loadu_ps (accum + 2 * i), y));
+	}
+	if (i < n)
+		cmac_c_f (accum + 2 * i, x + 2 * i, mre + i, mim + i, n - i);
+}
+#endif
+
+#ifdef CMAC_NEON_F
+static void cmac_neon_f (float* accum, const float* x, const float* mre, const float* mim, int n)
+{
+	// also available on 32-bit ARM
+	int i;
+	const float32x4_t sign = { -1.0f, +1.0f, -1.0f, +1.0f };
+	for (i = 0; i + 2 <= n; i += 2)
+	{
+		float32x2_t r = vld1_f32 (mre + i);
+		float32x2_t m = vld1_f32 (mim + i);
+		float32x2x2_t rz = vzip_f32 (r, r);
+		float32x2x2_t mz = vzip_f32 (m, m);
+		float32x4_t mr = vcombine_f32 (rz.val[0], rz.val[1]);							// (mr0, mr0, mr1, mr1)
+		float32x4_t mi = vmulq_f32 (vcombine_f32 (mz.val[0], mz.val[1]), sign);		// (-mi0, mi0, -mi1, mi1)
+		float32x4_t xv = vld1q_f32 (x + 2 * i);
+		float32x4_t xs = vrev64q_f32 (xv);											// (xi0, xr0, xi1, xr1)
+		float32x4_t av = vld1q_f32 (accum + 2 * i);
+		av = vmlaq_f32 (av, xv, mr);
+		av = vmlaq_f32 (av, xs, mi);
+		vst1q_f32 (accum + 2 * i, av);
+	}
+	if (i < n)
+		cmac_c_f (accum + 2 * i, x + 2 * i, mre + i, mim + i, n - i);
+}
+#endif
+
+static void cmac_select (double* accum, const double* x, const double* mre, const double* mim, int n)
+{
+	// runs once, then the function pointer leads to the selected kernel directly
+	void (*kernel) (double*, const double*, const double*, const double*, int) = cmac_c;
+#ifdef CMAC_X86
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+		kernel = cmac_avx2;
+	else if (__builtin_cpu_supports ("sse2"))
+		kernel = cmac_sse2;
+#endif
+#ifdef CMAC_NEON
+	kernel = cmac_neon;
+#endif
+	cmac_split = kernel;
+	kernel (accum, x, mre, mim, n);
+}
+
+void (*cmac_split) (double* accum, const double* x, const double* mre, const double* mim, int n) = cmac_select;
+
+
+static void cmac_select_f (float* accum, const float* x, const float* mre, const float* mim, int n)
+{
+	void (*kernel) (float*, const float*, const float*, const float*, int) = cmac_c_f;
+#ifdef CMAC_X86
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+		kernel = cmac_avx2_f;
+	else if (__builtin_cpu_supports ("sse2"))
+		kernel = cmac_sse2_f;
+#endif
+#ifdef CMAC_NEON_F
+	kernel = cmac_neon_f;
+#endif
+	cmac_split_f = kernel;
+	kernel (accum, x, mre, mim, n);
+}
+
+void (*cmac_split_f) (float* accum, const float* x, const float* mre, const float* mim, int n) = cmac_select_f;
@@ -0,0 +1,40 @@
+/*  cmac.h
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2026 Christoph van Wüllen, DL1YCF
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+/********************************************************************************************************
+*																										*
+*									Complex Multiply-Accumulate Kernels									*
+*																										*
+********************************************************************************************************/
+
+#ifndef _cmac_h
+#define _cmac_h
+
+// accum[k] += x[k] * (mre[k] + j * mim[k]), k = 0 ... n - 1
+// accum and x hold interleaved complex data, the mask is stored split into real and imaginary parts.
+// The kernel is selected at run time (AVX2/FMA, SSE2, NEON or plain C) on the first call.
+extern void (*cmac_split) (double* accum, const double* x, const double* mre, const double* mim, int n);
+
+// the same in single precision, for the WDSP_FLOAT build
+extern void (*cmac_split_f) (float* accum, const float* x, const float* mre, const float* mim, int n);
+
+#endif
@@ -46,6 +46,28 @@ warren@wpratt.com
 #include <assert.h>
 #include "fftw3.h"
 
+// sample type of the partitioned convolution (fircore), compile with -DWDSP_FLOAT for single precision
+// Filter design, mask generation and all other modules stay in double precision, samples are converted
+// when entering and leaving the convolution.
+#ifdef WDSP_FLOAT
+typedef float wreal;
+#define wfftw_complex					fftwf_complex
+#define wfftw_plan						fftwf_plan
+#define wfftw_execute					fftwf_execute
+#define wfftw_destroy_plan				fftwf_destroy_plan
+#define wisdom_plan_wdft_1d				wisdom_plan_dft_1d_f
+#define cmac_wsplit						cmac_split_f
+#else
+typedef double wreal;
+#define wfftw_complex					fftw_complex
+#define wfftw_plan						fftw_plan
+#define wfftw_execute					fftw_execute
+#define wfftw_destroy_plan				fftw_destroy_plan
+#define wisdom_plan_wdft_1d				wisdom_plan_dft_1d
+#define cmac_wsplit						cmac_split
+#endif
+typedef wreal wcomplex[2];
+
 #include "amd.h"
 #include "ammod.h"
 #include "amsq.h"
@@ -59,10 +81,12 @@ warren@wpratt.com
 #include "cfcomp.h"
 #include "cfir.h"
 #include "channel.h"
+#include "cmac.h"
 #include "cmath.h"
 #include "compress.h"
 #include "delay.h"
 #include "dexp.h"
+#include "dispatch.h"
 #include "div.h"
 #include "doublepole.h"
 #include "eer.h"
@@ -113,6 +137,7 @@ warren@wpratt.com
 #include "varsamp.h"
 #include "wbfm.h"
 #include "wcpAGC.h"
+#include "wisdom.h"
 
 // manage differences among consoles
 #define _Thetis
@@ -0,0 +1,221 @@
+/*  dispatch.c
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2026 Christoph van Wüllen, DL1YCF
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include "comm.h"
+
+/********************************************************************************************************
+*																										*
+*											Stage Dispatch Plan											*
+*																										*
+********************************************************************************************************/
+
+// A dispatch plan holds the stages of a processing chain in execution order, together with the
+// conditions under which each module does any work.  Only the active stages are called.  Stages
+// that are off cost nothing if they operate in place;  a stage that is off but has different input
+// and output buffers still runs, since it has to copy its data.  Stages without a 'run' condition
+// (resamplers, meters, patch panel, ...) always run.  The plan is re-compiled whenever one of the
+// conditions, or the aliasing of a stage's buffers, has changed since the last compile.
+
+DISPATCH create_dispatch (const char* name, int maxstages)
+{
+	DISPATCH a = (DISPATCH) malloc0 (sizeof (dispatchplan));
+	a->name = name;
+	a->maxstages = maxstages;
+	a->stages = (DSTAGE) malloc0 (maxstages * sizeof (dstage));
+	a->state  = (int *) malloc0 (maxstages * sizeof (int));
+	a->active = (int *) malloc0 (maxstages * sizeof (int));
+	return a;
+}
+
+void destroy_dispatch (DISPATCH a)
+{
+	_aligned_free (a->active);
+	_aligned_free (a->state);
+	_aligned_free (a->stages);
+	_aligned_free (a);
+}
+
+void add_dispatch (DISPATCH a, const char* name, dispfunc xfunc, void* p, int pos,
+	int* run, int* run2, int* position, double** in, double** out)
+{
+	DSTAGE s;
+	if (a->nstages >= a->maxstages) return;
+	s = &a->stages[a->nstages];
+	s->name = name;
+	s->xfunc = xfunc;
+	s->a = p;
+	s->pos = pos;
+	s->run = run;
+	s->run2 = run2;
+	s->position = position;
+	s->in = in;
+	s->out = out;
+	// the first call of xdispatch() compiles the plan
+	a->state[a->nstages] = -1;
+	a->nstages++;
+}
+
+static __inline int state_stage (DSTAGE s)
+{
+	if (s->run == 0)
+		return 1;
+	if (*s->run && (s->run2 == 0 || *s->run2) && (s->position == 0 || *s->position == s->pos))
+		return 1;
+	if (s->in != 0 && *s->in != *s->out)
+		return 2;
+	return 0;
+}
+
+static void compile_dispatch (DISPATCH a)
+{
+	int i;
+	a->nactive = 0;
+	for (i = 0; i < a->nstages; i++)
+	{
+		a->state[i] = state_stage (&a->stages[i]);
+		if (a->state[i])
+			a->active[a->nactive++] = i;
+	}
+	a->compiles++;
+}
+
+void xdispatch (DISPATCH a)
+{
+	int i;
+	DSTAGE s;
+	for (i = 0; i < a->nstages; i++)
+	{
+		if (state_stage (&a->stages[i]) != a->state[i])
+		{
+			compile_dispatch (a);
+			break;
+		}
+	}
+	if (a->profile)
+	{
+		long long t0, t1, dt, tb;
+		t0 = tb = profile_ns ();
+		for (i = 0; i < a->nactive; i++)
+		{
+			s = &a->stages[a->active[i]];
+			(*s->xfunc) (s->a, s->pos);
+			t1 = profile_ns ();
+			dt = t1 - t0;
+			s->ns += dt;
+			s->calls++;
+			if (dt > s->worst) s->worst = dt;
+			t0 = t1;
+		}
+		dt = t0 - tb;
+		a->ns += dt;
+		a->calls++;
+		if (dt > a->worst) a->worst = dt;
+	}
+	else
+	{
+		for (i = 0; i < a->nactive; i++)
+		{
+			s = &a->stages[a->active[i]];
+			(*s->xfunc) (s->a, s->pos);
+		}
+	}
+}
+
+void dump_dispatch (DISPATCH a, char* text, int size)
+{
+	// one line per stage, in execution order
+	static const char* state_name[3] = { "off", "run", "copy" };
+	int i, n;
+	n = snprintf (text, size, "%s: %d of %d stages active, %d compiles\n", a->name, a->nactive, a->nstages,
+		a->compiles);
+	for (i = 0; i < a->nstages && n >= 0 && n < size; i++)
+		n += snprintf (text + n, size - n, "%2d %-14s %s\n", i, a->stages[i].name,
+			a->state[i] >= 0 ? state_name[a->state[i]] : "-");
+}
+
+/********************************************************************************************************
+*																										*
+*												Profiling												*
+*																										*
+********************************************************************************************************/
+
+// If profiling is on, the execution time of each stage and of the whole chain is measured.  The
+// counters are reset each time profiling is switched on.  If it is off, the only cost is one test
+// per block.
+
+long long profile_ns (void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER count, freq;
+	QueryPerformanceCounter (&count);
+	QueryPerformanceFrequency (&freq);
+	return (long long)((double)count.QuadPart * 1.0e9 / (double)freq.QuadPart);
+#else
+	struct timespec ts;
+#if defined(CLOCK_MONOTONIC_RAW)
+	clock_gettime (CLOCK_MONOTONIC_RAW, &ts);
+#else
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+#endif
+	return 1000000000LL * ts.tv_sec + ts.tv_nsec;
+#endif
+}
+
+void profile_dispatch (DISPATCH a, int run)
+{
+	int i;
+	if (run && !a->profile)
+	{
+		for (i = 0; i < a->nstages; i++)
+		{
+			a->stages[i].ns = 0;
+			a->stages[i].calls = 0;
+			a->stages[i].worst = 0;
+		}
+		a->ns = 0;
+		a->calls = 0;
+		a->worst = 0;
+	}
+	a->profile = run;
+}
+
+int get_profile_dispatch (DISPATCH a, int n, const char** names, long long* ns, long long* calls, long long* worst)
+{
+	// the whole chain first, then the stages that have been executed; returns the number of entries
+	int i, k = 0;
+	if (n <= 0) return 0;
+	names[k] = a->name;
+	ns[k] = a->ns;
+	calls[k] = a->calls;
+	worst[k] = a->worst;
+	k++;
+	for (i = 0; i < a->nstages && k < n; i++)
+	{
+		if (a->stages[i].calls == 0) continue;
+		names[k] = a->stages[i].name;
+		ns[k] = a->stages[i].ns;
+		calls[k] = a->stages[i].calls;
+		worst[k] = a->stages[i].worst;
+		k++;
+	}
+	return k;
+}
@@ -0,0 +1,87 @@
+/*  dispatch.h
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2026 Christoph van Wüllen, DL1YCF
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+/********************************************************************************************************
+*																										*
+*											Stage Dispatch Plan											*
+*																										*
+********************************************************************************************************/
+
+#ifndef _dispatch_h
+#define _dispatch_h
+
+typedef void (*dispfunc) (void* a, int pos);
+
+typedef struct _stage
+{
+	const char* name;			// name shown in the dump
+	dispfunc xfunc;				// execution function
+	void* a;					// module
+	int pos;					// position argument of the execution function
+	int* run;					// stage is skipped if *run == 0; never skipped if run == 0
+	int* run2;					// secondary 'run', AND'd with 'run'
+	int* position;				// if non-zero, stage is skipped unless *position == pos
+	double** in;				// if non-zero, the module's buffer pointers:  a stage that is
+	double** out;				//   off but not in place must still run to copy its data
+	long long ns;				// profile:  cumulative execution time
+	long long calls;			// profile:  number of calls
+	long long worst;			// profile:  longest execution time
+} dstage, *DSTAGE;
+
+typedef struct _dispatch
+{
+	const char* name;			// name of the chain
+	int nstages;				// number of stages in execution order
+	int maxstages;				// allocated number of stages
+	DSTAGE stages;				// all stages
+	int* state;					// 0: skipped, 1: active, 2: off but copying, at the last compile
+	int nactive;				// number of active stages
+	int* active;				// compiled plan, indices of the active stages
+	int compiles;				// number of compiles since creation
+	int profile;				// measure the execution times of the stages
+	long long ns;				// profile:  cumulative execution time of the chain
+	long long calls;			// profile:  number of blocks
+	long long worst;			// profile:  longest execution time of a block
+} dispatchplan, *DISPATCH;
+
+extern DISPATCH create_dispatch (const char* name, int maxstages);
+
+extern void destroy_dispatch (DISPATCH a);
+
+extern void add_dispatch (DISPATCH a, const char* name, dispfunc xfunc, void* p, int pos,
+	int* run, int* run2, int* position, double** in, double** out);
+
+extern void xdispatch (DISPATCH a);
+
+extern void dump_dispatch (DISPATCH a, char* text, int size);
+
+extern void profile_dispatch (DISPATCH a, int run);
+
+extern int get_profile_dispatch (DISPATCH a, int n, const char** names, long long* ns, long long* calls, long long* worst);
+
+extern long long profile_ns (void);
+
+// adapters from the execution functions of the modules to a dispfunc
+#define DISPATCH_ADAPTER(xfunc, type)		static void d_##xfunc (void* a, int pos) { (void)pos; xfunc ((type)a); }
+#define DISPATCH_ADAPTER_POS(xfunc, type)	static void d_##xfunc (void* a, int pos) { xfunc ((type)a, pos); }
+
+#endif
@@ -129,8 +129,8 @@ double* build_doublepole_2sided (int nc, double rate, double fcenter, double ban
 		H_i[2 * i + 0] = Hres[0] * mult;
 		H_i[2 * i + 1] = Hres[1] * mult;
 	}
-	fftw_plan prev = fftw_plan_dft_1d (nc, (fftw_complex*)H_i,
-		(fftw_complex*)h_i, FFTW_BACKWARD, FFTW_PATIENT);
+	fftw_plan prev = wisdom_plan_dft_1d (nc, (fftw_complex*)H_i,
+		(fftw_complex*)h_i, FFTW_BACKWARD);
 	fftw_execute      (prev);
 	fftw_destroy_plan (prev);
 	_aligned_free     (H_i);
@@ -30,8 +30,8 @@ double* fftcv_mults (int NM, double* c_impulse)
 {
 	double* mults        = (double *) malloc0 (NM * sizeof (complex));
 	double* cfft_impulse = (double *) malloc0 (NM * sizeof (complex));
-	fftw_plan ptmp = fftw_plan_dft_1d(NM, (fftw_complex *) cfft_impulse,
-			(fftw_complex *) mults, FFTW_FORWARD, FFTW_PATIENT);
+	fftw_plan ptmp = wisdom_plan_dft_1d(NM, (fftw_complex *) cfft_impulse,
+			(fftw_complex *) mults, FFTW_FORWARD);
 	memset (cfft_impulse, 0, NM * sizeof (complex));
 	// store complex coefs right-justified in the buffer
 	memcpy (&(cfft_impulse[NM - 2]), c_impulse, (NM / 2 + 1) * sizeof(complex));
@@ -116,7 +116,7 @@ double* fir_fsamp_odd (int N, double* A, int rtype, double scale, int wintype)
 	double* window;
 	double *fcoef     = (double *) malloc0 (N * sizeof (complex));
 	double *c_impulse = (double *) malloc0 (N * sizeof (complex));
-	fftw_plan ptmp = fftw_plan_dft_1d(N, (fftw_complex *)fcoef, (fftw_complex *)c_impulse, FFTW_BACKWARD, FFTW_PATIENT);
+	fftw_plan ptmp = wisdom_plan_dft_1d(N, (fftw_complex *)fcoef, (fftw_complex *)c_impulse, FFTW_BACKWARD);
 	double local_scale = 1.0 / (double)N;
 	for (i = 0; i <= mid; i++)
 	{
@@ -361,10 +361,10 @@ void analytic (int N, double* in, double* out)
 	double inv_N = 1.0 / (double)N;
 	double two_inv_N = 2.0 * inv_N;
 	double* x = (double *) malloc0 (N * sizeof (complex));
-	fftw_plan pfor = fftw_plan_dft_1d (N, (fftw_complex *) in,
-			(fftw_complex *) x, FFTW_FORWARD, FFTW_PATIENT);
-	fftw_plan prev = fftw_plan_dft_1d (N, (fftw_complex *) x,
-			(fftw_complex *) out, FFTW_BACKWARD, FFTW_PATIENT);
+	fftw_plan pfor = wisdom_plan_dft_1d (N, (fftw_complex *) in,
+			(fftw_complex *) x, FFTW_FORWARD);
+	fftw_plan prev = wisdom_plan_dft_1d (N, (fftw_complex *) x,
+			(fftw_complex *) out, FFTW_BACKWARD);
 	fftw_execute (pfor);
 	x[0] *= inv_N;
 	x[1] *= inv_N;
@@ -423,10 +423,10 @@ void mp_imp (int N, double* fir, double* mpfir, int pfactor, int polarity)
 	double* impulse = (double *) malloc0 (size * sizeof (complex));
 	double* newfreq = (double *) malloc0 (size * sizeof (complex));
 	memcpy (firpad, fir, N * sizeof (complex));
-	fftw_plan pfor = fftw_plan_dft_1d (size, (fftw_complex *) firpad,
-			(fftw_complex *) firfreq, FFTW_FORWARD, FFTW_PATIENT);
-	fftw_plan prev = fftw_plan_dft_1d (size, (fftw_complex *) newfreq,
-			(fftw_complex *) impulse, FFTW_BACKWARD, FFTW_PATIENT);
+	fftw_plan pfor = wisdom_plan_dft_1d (size, (fftw_complex *) firpad,
+			(fftw_complex *) firfreq, FFTW_FORWARD);
+	fftw_plan prev = wisdom_plan_dft_1d (size, (fftw_complex *) newfreq,
+			(fftw_complex *) impulse, FFTW_BACKWARD);
 	// print_impulse("orig_imp.txt", N, fir, 1, 0);
 	fftw_execute (pfor);
 	for (i = 0; i < size; i++)
@@ -533,10 +533,10 @@ MINPHASE create_minphase (int N, int pfactor)
     a->newfreq = (double *) malloc0 (a->size * sizeof (complex));
     a->impulse = (double *) malloc0 (a->size * sizeof (complex));
 
-    a->p_fir    = fftw_plan_dft_1d (a->size, (fftw_complex *) a->firpad,  (fftw_complex *) a->firfreq, FFTW_FORWARD,  FFTW_PATIENT);
-    a->p_anafor = fftw_plan_dft_1d (a->size, (fftw_complex *) a->ana,     (fftw_complex *) a->anax,    FFTW_FORWARD,  FFTW_PATIENT);
-    a->p_anainv = fftw_plan_dft_1d (a->size, (fftw_complex *) a->anax,    (fftw_complex *) a->ana,     FFTW_BACKWARD, FFTW_PATIENT);
-    a->p_imp    = fftw_plan_dft_1d (a->size, (fftw_complex *) a->newfreq, (fftw_complex *) a->impulse, FFTW_BACKWARD, FFTW_PATIENT);
+    a->p_fir    = wisdom_plan_dft_1d (a->size, (fftw_complex *) a->firpad,  (fftw_complex *) a->firfreq, FFTW_FORWARD);
+    a->p_anafor = wisdom_plan_dft_1d (a->size, (fftw_complex *) a->ana,     (fftw_complex *) a->anax,    FFTW_FORWARD);
+    a->p_anainv = wisdom_plan_dft_1d (a->size, (fftw_complex *) a->anax,    (fftw_complex *) a->ana,     FFTW_BACKWARD);
+    a->p_imp    = wisdom_plan_dft_1d (a->size, (fftw_complex *) a->newfreq, (fftw_complex *) a->impulse, FFTW_BACKWARD);
 
     memset (a->firpad, 0, a->size * sizeof (complex));
     return a;
@@ -635,7 +635,7 @@ FSAMP create_fsamp (int N, int wintype)
     a->window  = get_fsamp_window (N, wintype);
     a->X       = (double *) malloc0 (a->nh * sizeof (complex));
     a->impulse = (double *) malloc0 (N      * sizeof (double));
-    a->p_c2r = fftw_plan_dft_c2r_1d (N, (fftw_complex *) a->X, a->impulse, FFTW_PATIENT);
+    a->p_c2r = wisdom_plan_dft_c2r_1d (N, (fftw_complex *) a->X, a->impulse);
     return a;
 }
 
@@ -145,11 +145,11 @@ void plan_firopt (FIROPT a)
 	{
 		a->fftout[i] = (double *) malloc0 (2 * a->size * sizeof (complex));
 		a->fmask[i] = (double *) malloc0 (2 * a->size * sizeof (complex));
-		a->pcfor[i] = fftw_plan_dft_1d(2 * a->size, (fftw_complex *)a->fftin, (fftw_complex *)a->fftout[i], FFTW_FORWARD, FFTW_PATIENT);
-		a->maskplan[i] = fftw_plan_dft_1d(2 * a->size, (fftw_complex *)a->maskgen, (fftw_complex *)a->fmask[i], FFTW_FORWARD, FFTW_PATIENT);
+		a->pcfor[i] = wisdom_plan_dft_1d(2 * a->size, (fftw_complex *)a->fftin, (fftw_complex *)a->fftout[i], FFTW_FORWARD);
+		a->maskplan[i] = wisdom_plan_dft_1d(2 * a->size, (fftw_complex *)a->maskgen, (fftw_complex *)a->fmask[i], FFTW_FORWARD);
 	}
 	a->accum = (double *) malloc0 (2 * a->size * sizeof (complex));
-	a->crev = fftw_plan_dft_1d(2 * a->size, (fftw_complex *)a->accum, (fftw_complex *)a->out, FFTW_BACKWARD, FFTW_PATIENT);
+	a->crev = wisdom_plan_dft_1d(2 * a->size, (fftw_complex *)a->accum, (fftw_complex *)a->out, FFTW_BACKWARD);
 }
 
 void calc_firopt (FIROPT a)
@@ -293,38 +293,57 @@ void plan_fircore (FIRCORE a)
 	int i;
 	a->nfor = a->nc / a->size;
 	a->cset = 0;
+	a->busy = 0;
 	a->buffidx = 0;
 	a->idxmask = a->nfor - 1;
-	a->fftin = (double *) malloc0 (2 * a->size * sizeof (complex));
-	a->fftout   = (double **) malloc0 (a->nfor * sizeof (double *));
-	a->fmask    = (double ***) malloc0 (2 * sizeof (double **));
-	a->fmask[0] = (double **) malloc0 (a->nfor * sizeof (double *));
-	a->fmask[1] = (double **) malloc0 (a->nfor * sizeof (double *));
+	a->fftin = (wreal *) malloc0 (2 * a->size * sizeof (wcomplex));
+	a->fftout   = (wreal **) malloc0 (a->nfor * sizeof (wreal *));
+	// the masks of all partitions are stored contiguously, split into real and imaginary parts
+	a->mre[0] = (wreal *) malloc0 (a->nfor * 2 * a->size * sizeof (wreal));
+	a->mre[1] = (wreal *) malloc0 (a->nfor * 2 * a->size * sizeof (wreal));
+	a->mim[0] = (wreal *) malloc0 (a->nfor * 2 * a->size * sizeof (wreal));
+	a->mim[1] = (wreal *) malloc0 (a->nfor * 2 * a->size * sizeof (wreal));
 	a->maskgen = (double *) malloc0 (2 * a->size * sizeof (complex));
-	a->pcfor = (fftw_plan *) malloc0 (a->nfor * sizeof (fftw_plan));
-	a->maskplan    = (fftw_plan **) malloc0 (2 * sizeof (fftw_plan *));
-	a->maskplan[0] = (fftw_plan *) malloc0 (a->nfor * sizeof (fftw_plan));
-	a->maskplan[1] = (fftw_plan *) malloc0 (a->nfor * sizeof (fftw_plan));
+	a->maskout = (double *) malloc0 (2 * a->size * sizeof (complex));
+	a->pcfor = (wfftw_plan *) malloc0 (a->nfor * sizeof (wfftw_plan));
 	for (i = 0; i < a->nfor; i++)
 	{
-		a->fftout[i]   = (double *) malloc0 (2 * a->size * sizeof (complex));
-		a->fmask[0][i] = (double *) malloc0 (2 * a->size * sizeof (complex));
-		a->fmask[1][i] = (double *) malloc0 (2 * a->size * sizeof (complex));
-		a->pcfor[i] = fftw_plan_dft_1d(2 * a->size, (fftw_complex *)a->fftin, (fftw_complex *)a->fftout[i], FFTW_FORWARD, FFTW_PATIENT);
-		a->maskplan[0][i] = fftw_plan_dft_1d(2 * a->size, (fftw_complex *)a->maskgen, (fftw_complex *)a->fmask[0][i], FFTW_FORWARD, FFTW_PATIENT);
-		a->maskplan[1][i] = fftw_plan_dft_1d(2 * a->size, (fftw_complex *)a->maskgen, (fftw_complex *)a->fmask[1][i], FFTW_FORWARD, FFTW_PATIENT);
+		a->fftout[i]   = (wreal *) malloc0 (2 * a->size * sizeof (wcomplex));
+		a->pcfor[i] = wisdom_plan_wdft_1d(2 * a->size, (wfftw_complex *)a->fftin, (wfftw_complex *)a->fftout[i], FFTW_FORWARD);
 	}
-	a->accum = (double *) malloc0 (2 * a->size * sizeof (complex));
-	a->crev = fftw_plan_dft_1d(2 * a->size, (fftw_complex *)a->accum, (fftw_complex *)a->out, FFTW_BACKWARD, FFTW_PATIENT);
+	a->maskplan = wisdom_plan_dft_1d(2 * a->size, (fftw_complex *)a->maskgen, (fftw_complex *)a->maskout, FFTW_FORWARD);
+	a->accum = (wreal *) malloc0 (2 * a->size * sizeof (wcomplex));
+#ifdef WDSP_FLOAT
+	a->fout = (float *) malloc0 (2 * a->size * sizeof (wcomplex));
+	a->crev = wisdom_plan_wdft_1d(2 * a->size, (wfftw_complex *)a->accum, (wfftw_complex *)a->fout, FFTW_BACKWARD);
+#else
+	a->crev = wisdom_plan_wdft_1d(2 * a->size, (wfftw_complex *)a->accum, (wfftw_complex *)a->out, FFTW_BACKWARD);
+#endif
 	a->masks_ready = 0;
 	a->pminphase = create_minphase (a->nc, a->pfactor);
 }
 
+static void flip_fircore (FIRCORE a)
+{
+	// Make the new mask set current. xfircore() never waits for this: if it is just
+	// reading the old set, wait here until that pass is complete, such that the old
+	// set may be overwritten by the next call to calc_fircore().
+	LONG b;
+	InterlockedXor (&a->cset, 1);
+	b = _InterlockedAnd (&a->busy, ~0L);
+	if (b & 1)
+		while (_InterlockedAnd (&a->busy, ~0L) == b)
+			Sleep (0);
+	a->masks_ready = 0;
+}
+
 void calc_fircore (FIRCORE a, int flip)
 {
 	// call for change in frequency, rate, wintype, gain
 	// must also call after a call to plan_firopt()
-	int i;
+	int i, j;
+	int n = 2 * a->size;
+	int nset = 1 - _InterlockedAnd (&a->cset, 1);
 	if (a->mp)
 		mp_imp_exec (a->pminphase, a->impulse, a->imp);
 	else
@@ -333,17 +352,19 @@ void calc_fircore (FIRCORE a, int flip)
 	{
 		// I right-justified the impulse response => take output from left side of output buff, discard right side
 		// Be careful about flipping an asymmetrical impulse response.
+		wreal* mre = a->mre[nset] + i * n;
+		wreal* mim = a->mim[nset] + i * n;
 		memcpy (&(a->maskgen[2 * a->size]), &(a->imp[2 * a->size * i]), a->size * sizeof(complex));
-		fftw_execute (a->maskplan[1 - a->cset][i]);
+		fftw_execute (a->maskplan);
+		for (j = 0; j < n; j++)
+		{
+			mre[j] = (wreal)a->maskout[2 * j + 0];
+			mim[j] = (wreal)a->maskout[2 * j + 1];
+		}
 	}
 	a->masks_ready = 1;
 	if (flip)
-	{
-		EnterCriticalSection (&a->update);
-		a->cset = 1 - a->cset;
-		LeaveCriticalSection (&a->update);
-		a->masks_ready = 0;
-	}
+		flip_fircore (a);
 }
 
 FIRCORE create_fircore (int size, double* in, double* out, int nc,
@@ -356,7 +377,6 @@ FIRCORE create_fircore (int size, double* in, double* out, int nc,
 	a->nc = nc;
 	a->mp = mp;
 	a->pfactor = pfactor;
-	InitializeCriticalSectionAndSpinCount (&a->update, 2500);
 	plan_fircore (a);
 	a->impulse = (double *) malloc0 (a->nc * sizeof (complex));
 	a->imp     = (double *) malloc0 (a->nc * sizeof (complex));
@@ -368,25 +388,24 @@ FIRCORE create_fircore (int size, double* in, double* out, int nc,
 void deplan_fircore (FIRCORE a)
 {
 	destroy_minphase(a->pminphase);
-	fftw_destroy_plan (a->crev);
+	wfftw_destroy_plan (a->crev);
+#ifdef WDSP_FLOAT
+	_aligned_free (a->fout);
+#endif
 	_aligned_free (a->accum);
+	fftw_destroy_plan (a->maskplan);
 	for (int i = 0; i < a->nfor; i++)
 	{
 		_aligned_free (a->fftout[i]);
-		_aligned_free (a->fmask[0][i]);
-		_aligned_free (a->fmask[1][i]);
-		fftw_destroy_plan (a->pcfor[i]);
-		fftw_destroy_plan (a->maskplan[0][i]);
-		fftw_destroy_plan (a->maskplan[1][i]);
+		wfftw_destroy_plan (a->pcfor[i]);
 	}
-	_aligned_free (a->maskplan[0]);
-	_aligned_free (a->maskplan[1]);
-	_aligned_free (a->maskplan);
 	_aligned_free (a->pcfor);
+	_aligned_free (a->maskout);
 	_aligned_free (a->maskgen);
-	_aligned_free (a->fmask[0]);
-	_aligned_free (a->fmask[1]);
-	_aligned_free (a->fmask);
+	_aligned_free (a->mim[1]);
+	_aligned_free (a->mim[0]);
+	_aligned_free (a->mre[1]);
+	_aligned_free (a->mre[0]);
 	_aligned_free (a->fftout);
 	_aligned_free (a->fftin);
 }
@@ -396,47 +415,52 @@ void destroy_fircore (FIRCORE a)
 	deplan_fircore (a);
 	_aligned_free (a->imp);
 	_aligned_free (a->impulse);
-	DeleteCriticalSection (&a->update);
 	_aligned_free (a);
 }
 
 void flush_fircore (FIRCORE a)
 {
 	int i;
-	memset (a->fftin, 0, 2 * a->size * sizeof (complex));
+	memset (a->fftin, 0, 2 * a->size * sizeof (wcomplex));
 	for (i = 0; i < a->nfor; i++)
-		memset (a->fftout[i], 0, 2 * a->size * sizeof (complex));
+		memset (a->fftout[i], 0, 2 * a->size * sizeof (wcomplex));
 	a->buffidx = 0;
 }
 
 void xfircore (FIRCORE a)
 {
-	int i, j, k;
+	int j, k;
+#ifdef WDSP_FLOAT
+	for (j = 0; j < 2 * a->size; j++)
+		a->fftin[2 * a->size + j] = (float)a->in[j];
+#else
 	memcpy (&(a->fftin[2 * a->size]), a->in, a->size * sizeof (complex));
-	fftw_execute (a->pcfor[a->buffidx]);
+#endif
+	wfftw_execute (a->pcfor[a->buffidx]);
 	k = a->buffidx;
-	memset (a->accum, 0, 2 * a->size * sizeof (complex));
-	EnterCriticalSection (&a->update);
-	double* accum = a->accum;
-	double** fftout = a->fftout;
-	double*** fmask = a->fmask;
-	int cset = a->cset;
+	memset (a->accum, 0, 2 * a->size * sizeof (wcomplex));
+	InterlockedIncrement (&a->busy);
+	int cset = _InterlockedAnd (&a->cset, 1);
+	wreal* accum = a->accum;
+	wreal** fftout = a->fftout;
+	wreal* mre = a->mre[cset];
+	wreal* mim = a->mim[cset];
 	int idxmask = a->idxmask;
-	int sz = a->size;
+	int n = 2 * a->size;
 	int nfor = a->nfor;
 	for (j = 0; j < nfor; j++)
 	{
-		for (i = 0; i < 2 * sz; i++)
-		{
-			accum[2 * i + 0] += fftout[k][2 * i + 0] * fmask[cset][j][2 * i + 0] - fftout[k][2 * i + 1] * fmask[cset][j][2 * i + 1];
-			accum[2 * i + 1] += fftout[k][2 * i + 0] * fmask[cset][j][2 * i + 1] + fftout[k][2 * i + 1] * fmask[cset][j][2 * i + 0];
-		}
+		cmac_wsplit (accum, fftout[k], mre + j * n, mim + j * n, n);
 		k = (k + idxmask) & idxmask;
 	}
-	LeaveCriticalSection (&a->update);
+	InterlockedIncrement (&a->busy);
 	a->buffidx = (a->buffidx + 1) & idxmask;
-	fftw_execute (a->crev);
-	memcpy (a->fftin, &(a->fftin[2 * a->size]), a->size * sizeof(complex));
+	wfftw_execute (a->crev);
+#ifdef WDSP_FLOAT
+	for (j = 0; j < 2 * a->size; j++)
+		a->out[j] = (double)a->fout[j];
+#endif
+	memcpy (a->fftin, &(a->fftin[2 * a->size]), a->size * sizeof(wcomplex));
 }
 
 void setBuffers_fircore (FIRCORE a, double* in, double* out)
@@ -485,10 +509,5 @@ void setMp_fircore (FIRCORE a, int mp)
 void setUpdate_fircore (FIRCORE a)
 {
 	if (a->masks_ready)
-	{
-		EnterCriticalSection (&a->update);
-		a->cset = 1 - a->cset;
-		LeaveCriticalSection (&a->update);
-		a->masks_ready = 0;
-	}
+		flip_fircore (a);
 }
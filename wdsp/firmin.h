@@ -146,18 +146,23 @@ typedef struct _fircore
 	double* impulse;		// impulse response of filter
 	double* imp;
 	int nfor;				// number of buffers in delay line
-	double* fftin;			// fft input buffer
-	double*** fmask;		// frequency domain masks
-	double** fftout;		// fftout delay line
-	double* accum;			// frequency domain accumulator
+	wreal* fftin;			// fft input buffer
+	wreal** fftout;			// fftout delay line
+	wreal* accum;			// frequency domain accumulator
 	int buffidx;			// fft out buffer index
 	int idxmask;			// mask for index computations
 	double* maskgen;		// input for mask generation FFT
-	fftw_plan* pcfor;		// array of forward FFT plans
-	fftw_plan crev;			// reverse fft plan
-	fftw_plan** maskplan;	// plans for frequency domain masks
-	CRITICAL_SECTION update;
-	int cset;
+	wfftw_plan* pcfor;		// array of forward FFT plans
+	wfftw_plan crev;		// reverse fft plan
+#ifdef WDSP_FLOAT
+	float* fout;			// output of reverse fft, converted to 'out'
+#endif
+	double* maskout;		// output of mask generation FFT
+	wreal* mre[2];			// frequency domain masks, two sets, real parts
+	wreal* mim[2];			// frequency domain masks, two sets, imaginary parts
+	fftw_plan maskplan;		// plan for frequency domain masks
+	volatile LONG cset;		// mask set in use by xfircore()
+	volatile LONG busy;		// odd while xfircore() reads the masks
 	int mp;
 	int masks_ready;
 	int pfactor;
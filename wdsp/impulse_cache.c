@@ -76,140 +76,219 @@ mw0lge@grange-lane.co.uk
 	}
 #endif
 
+// Each bucket is an open-addressing hash table (linear probing, at most half full) for the lookup,
+// plus a doubly linked list in LRU order for eviction and for saving.  All accesses are serialised
+// by _cs_cache, since impulses are calculated from several channel threads.
+
 typedef struct _cache_entry {
 	HASH_T  hash;
 	int		N;							// N complex entries in impulse. Leave as signed int as that is used everywhere
 	double* impulse;
-	struct _cache_entry* next;
+	struct _cache_entry* prev;			// towards the most recently used entry
+	struct _cache_entry* next;			// towards the least recently used entry
 } cache_entry;
 
-static size_t _cache_counts[CACHE_BUCKETS] = { 0 };
-static cache_entry* _cache_heads[CACHE_BUCKETS] = { NULL };
-static CRITICAL_SECTION _cs_use_cache;
+typedef struct _cache_table {
+	cache_entry* slot[CACHE_SLOTS];
+	cache_entry* head;					// most recently used
+	cache_entry* tail;					// least recently used
+	size_t count;
+	long hits;
+	long misses;
+} cache_table;
+
+static cache_table _cache[CACHE_BUCKETS];
+static CRITICAL_SECTION _cs_cache;
 static int _run = 0;
 static int _use_cache = 1;
+static int _dirty = 0;					// cache changed since it was last read or saved
 
-void remove_impulse_cache_tail(size_t bucket)
+static size_t home_slot(HASH_T hash, int N)
 {
-	if (bucket >= CACHE_BUCKETS) return;
+	return (size_t)(hash ^ ((HASH_T)N * GOLDEN_RATIO)) & (CACHE_SLOTS - 1);
+}
 
-	cache_entry** pp = &_cache_heads[bucket];
+// slot holding (hash, N), or the empty slot where it is to be inserted
+static size_t find_slot(cache_table* t, HASH_T hash, int N)
+{
+	size_t i = home_slot(hash, N);
+	while (t->slot[i] && (t->slot[i]->hash != hash || t->slot[i]->N != N))
+		i = (i + 1) & (CACHE_SLOTS - 1);
+	return i;
+}
 
-	while (*pp && (*pp)->next)
+// empty a slot, moving up entries of the same probe sequence so no tombstones are needed
+static void clear_slot(cache_table* t, size_t i)
+{
+	size_t j = i;
+	size_t k;
+	t->slot[i] = NULL;
+	for (;;)
 	{
-		pp = &(*pp)->next;
+		j = (j + 1) & (CACHE_SLOTS - 1);
+		if (!t->slot[j]) break;
+		k = home_slot(t->slot[j]->hash, t->slot[j]->N);
+		if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j))
+		{
+			t->slot[i] = t->slot[j];
+			t->slot[j] = NULL;
+			i = j;
+		}
 	}
+}
 
-	if (*pp)
-	{
-		_aligned_free((*pp)->impulse);
-		_aligned_free(*pp);
-		*pp = NULL;
-		_cache_counts[bucket]--;
-	}
+static void lru_unlink(cache_table* t, cache_entry* e)
+{
+	if (e->prev) e->prev->next = e->next; else t->head = e->next;
+	if (e->next) e->next->prev = e->prev; else t->tail = e->prev;
+	e->prev = e->next = NULL;
+}
+
+static void lru_push_head(cache_table* t, cache_entry* e)
+{
+	e->prev = NULL;
+	e->next = t->head;
+	if (t->head) t->head->prev = e; else t->tail = e;
+	t->head = e;
+}
+
+static void lru_push_tail(cache_table* t, cache_entry* e)
+{
+	e->next = NULL;
+	e->prev = t->tail;
+	if (t->tail) t->tail->next = e; else t->head = e;
+	t->tail = e;
+}
+
+static cache_entry* new_entry(cache_table* t, size_t i, HASH_T hash, int N, double* impulse)
+{
+	cache_entry* e = (cache_entry*)malloc0(sizeof(cache_entry));
+	e->hash = hash;
+	e->N = N;
+	e->impulse = impulse;
+	t->slot[i] = e;
+	t->count++;
+	return e;
+}
+
+void remove_impulse_cache_tail(size_t bucket)
+{
+	if (bucket >= CACHE_BUCKETS) return;
+
+	cache_table* t = &_cache[bucket];
+	cache_entry* e = t->tail;
+	if (!e) return;
+
+	clear_slot(t, find_slot(t, e->hash, e->N));
+	lru_unlink(t, e);
+	_aligned_free(e->impulse);
+	_aligned_free(e);
+	t->count--;
 }
 
 void free_impulse_cache(void)
 {
 	for (size_t b = 0; b < CACHE_BUCKETS; ++b) {
-		cache_entry* e = _cache_heads[b];
+		cache_table* t = &_cache[b];
+		cache_entry* e = t->head;
 		while (e) {
 			cache_entry* next = e->next;
 			_aligned_free(e->impulse);
 			_aligned_free(e);
 			e = next;
 		}
-		_cache_heads[b] = NULL;
-		_cache_counts[b] = 0;
+		memset(t->slot, 0, sizeof(t->slot));
+		t->head = t->tail = NULL;
+		t->count = 0;
 	}
 }
 
 double* get_impulse_cache_entry(size_t bucket, HASH_T hash, int N)
 {
-	if (!_run) return NULL;
-
-	int use;
-	EnterCriticalSection(&_cs_use_cache);
-	use = _use_cache;
-	LeaveCriticalSection(&_cs_use_cache);
-
-	if (!use || bucket >= CACHE_BUCKETS) return NULL;
+	if (!_run || bucket >= CACHE_BUCKETS) return NULL;
 
-	// lru, least recently used, moves cache hit to head
-	// old cache entries will move towards the tail and eventually be dumped
-	cache_entry* prev = NULL;
-	cache_entry* e = _cache_heads[bucket];
-
-	while (e) {
-		if (e->hash == hash && e->N == N)
+	double* imp = NULL;
+	EnterCriticalSection(&_cs_cache);
+	if (_use_cache)
+	{
+		// lru, least recently used, moves cache hit to head
+		// old cache entries will move towards the tail and eventually be dumped
+		cache_table* t = &_cache[bucket];
+		cache_entry* e = t->slot[find_slot(t, hash, N)];
+		if (e)
 		{
-			if (prev)
-			{
-				prev->next = e->next;
-				e->next = _cache_heads[bucket];
-				_cache_heads[bucket] = e;
-			}
-			double* imp = (double*) malloc0(e->N * sizeof(complex));
+			lru_unlink(t, e);
+			lru_push_head(t, e);
+			imp = (double*) malloc0(e->N * sizeof(complex));
 			memcpy(imp, e->impulse, e->N * sizeof(complex));
-			return imp;
+			t->hits++;
 		}
-		prev = e;
-		e = e->next;
+		else
+			t->misses++;
 	}
-
-	return NULL;
+	LeaveCriticalSection(&_cs_cache);
+	return imp;
 }
 
 void add_impulse_to_cache(size_t bucket, HASH_T hash, int N, double* impulse)
 {
-	if (!_run) return;
-
-	int use;
-	EnterCriticalSection(&_cs_use_cache);
-	use = _use_cache;
-	LeaveCriticalSection(&_cs_use_cache);
-
-	if (!use || bucket >= CACHE_BUCKETS) return;
-
-	if (_cache_counts[bucket] >= MAX_CACHE_ENTRIES) remove_impulse_cache_tail(bucket);
+	if (!_run || bucket >= CACHE_BUCKETS) return;
 
-	cache_entry* e = malloc0(sizeof(cache_entry));
-	e->hash = hash;
-	e->N = N;
-	e->impulse = (double *) malloc0(N * sizeof(complex));
-	memcpy(e->impulse, impulse, N * sizeof(complex));
-	e->next = _cache_heads[bucket];
-	_cache_heads[bucket] = e;
-	_cache_counts[bucket]++;
+	EnterCriticalSection(&_cs_cache);
+	if (_use_cache)
+	{
+		cache_table* t = &_cache[bucket];
+		size_t i = find_slot(t, hash, N);
+		cache_entry* e = t->slot[i];
+		if (e)
+		{
+			// another thread has just added the same impulse
+			lru_unlink(t, e);
+		}
+		else
+		{
+			if (t->count >= MAX_CACHE_ENTRIES)
+			{
+				remove_impulse_cache_tail(bucket);
+				i = find_slot(t, hash, N);
+			}
+			double* imp = (double *) malloc0(N * sizeof(complex));
+			memcpy(imp, impulse, N * sizeof(complex));
+			e = new_entry(t, i, hash, N, imp);
+			_dirty = 1;
+		}
+		lru_push_head(t, e);
+	}
+	LeaveCriticalSection(&_cs_cache);
 }
 
 PORT
 int save_impulse_cache(const char* path)
 {
+	// entries are written most recently used first, so the LRU order survives a restart
 	if (!_run) return 0;
 
-	int use;
-	EnterCriticalSection(&_cs_use_cache);
-	use = _use_cache;
-	LeaveCriticalSection(&_cs_use_cache);
-	if (!use) return 0;
-
-	FILE* fp = fopen(path, "wb");
-	if (!fp) return -1;
-	uint32_t buckets = CACHE_BUCKETS;
-	if (fwrite(&buckets, sizeof(buckets), 1, fp) != 1) { fclose(fp); return -1; }
-	for (size_t b = 0; b < CACHE_BUCKETS; b++) {
-		uint32_t count = 0;
-		for (cache_entry* e = _cache_heads[b]; e; e = e->next) count++;
-		if (fwrite(&count, sizeof(count), 1, fp) != 1) { fclose(fp); return -1; }
-		for (cache_entry* e = _cache_heads[b]; e; e = e->next) {
-			if (fwrite(&e->hash, sizeof(HASH_T), 1, fp) != 1) { fclose(fp); return -1; }
-			if (fwrite(&e->N, sizeof(e->N), 1, fp) != 1) { fclose(fp); return -1; }
-			if (fwrite(e->impulse, sizeof(complex), e->N, fp) != (size_t)e->N) { fclose(fp); return -1; }
+	int rc = 0;
+	EnterCriticalSection(&_cs_cache);
+	if (_use_cache && _dirty)
+	{
+		FILE* fp = fopen(path, "wb");
+		uint32_t buckets = CACHE_BUCKETS;
+		if (!fp || fwrite(&buckets, sizeof(buckets), 1, fp) != 1) rc = -1;
+		for (size_t b = 0; b < CACHE_BUCKETS && rc == 0; b++) {
+			uint32_t count = (uint32_t)_cache[b].count;
+			if (fwrite(&count, sizeof(count), 1, fp) != 1) rc = -1;
+			for (cache_entry* e = _cache[b].head; e && rc == 0; e = e->next) {
+				if (fwrite(&e->hash, sizeof(HASH_T), 1, fp) != 1) rc = -1;
+				else if (fwrite(&e->N, sizeof(e->N), 1, fp) != 1) rc = -1;
+				else if (fwrite(e->impulse, sizeof(complex), e->N, fp) != (size_t)e->N) rc = -1;
+			}
 		}
+		if (fp && fclose(fp) != 0) rc = -1;
+		if (rc == 0) _dirty = 0;
 	}
-	fclose(fp);
-	return 0;
+	LeaveCriticalSection(&_cs_cache);
+	return rc;
 }
 
 PORT
@@ -217,64 +296,78 @@ int read_impulse_cache(const char* path)
 {
 	if (!_run) return 0;
 
+	int rc = 0;
+	EnterCriticalSection(&_cs_cache);
 	free_impulse_cache();
-
-	int use;
-	EnterCriticalSection(&_cs_use_cache);
-	use = _use_cache;
-	LeaveCriticalSection(&_cs_use_cache);
-	if (!use) return 0;
-
-	FILE* fp = fopen(path, "rb");
-	if (!fp) return -1;
-	uint32_t buckets;
-	if (fread(&buckets, sizeof(buckets), 1, fp) != 1) { fclose(fp); return -1; }
-	if (buckets != CACHE_BUCKETS) { fclose(fp); return -1; }
-	for (size_t b = 0; b < buckets; b++) {
-		uint32_t count;
-		if (fread(&count, sizeof(count), 1, fp) != 1) { fclose(fp); return -1; }
-		cache_entry* tail = NULL;
-		for (uint32_t i = 0; i < count; i++) {
-			HASH_T hash;
-			int    N;
-			if (fread(&hash, sizeof(HASH_T), 1, fp) != 1) { fclose(fp); return -1; }
-			if (fread(&N, sizeof(N), 1, fp) != 1) { fclose(fp); return -1; }
-			double* data = (double*)malloc0(N * sizeof(complex));
-			if (fread(data, sizeof(complex), N, fp) != (size_t)N) { _aligned_free(data); fclose(fp); return -1; }
-			cache_entry* e = (cache_entry*)malloc0(sizeof(cache_entry));
-			e->hash = hash;
-			e->N = N;
-			e->impulse = data;
-			e->next = NULL;
-			if (tail)
-				tail->next = e;
-			else
-				_cache_heads[b] = e;
-			tail = e;
-			_cache_counts[b]++;
+	if (_use_cache)
+	{
+		FILE* fp = fopen(path, "rb");
+		uint32_t buckets;
+		if (!fp || fread(&buckets, sizeof(buckets), 1, fp) != 1 || buckets != CACHE_BUCKETS) rc = -1;
+		for (size_t b = 0; b < CACHE_BUCKETS && rc == 0; b++) {
+			cache_table* t = &_cache[b];
+			uint32_t count;
+			if (fread(&count, sizeof(count), 1, fp) != 1 || count > MAX_CACHE_ENTRIES) { rc = -1; break; }
+			for (uint32_t i = 0; i < count; i++) {
+				HASH_T hash;
+				int    N;
+				if (fread(&hash, sizeof(HASH_T), 1, fp) != 1) { rc = -1; break; }
+				if (fread(&N, sizeof(N), 1, fp) != 1 || N <= 0 || N > MAX_CACHE_IMPULSE) { rc = -1; break; }
+				double* data = (double*)malloc0(N * sizeof(complex));
+				if (fread(data, sizeof(complex), N, fp) != (size_t)N) { _aligned_free(data); rc = -1; break; }
+				size_t s = find_slot(t, hash, N);
+				if (t->slot[s])
+				{
+					_aligned_free(data);
+					continue;
+				}
+				lru_push_tail(t, new_entry(t, s, hash, N, data));
+			}
 		}
+		if (fp) fclose(fp);
+		// a damaged file is discarded as a whole
+		if (rc != 0) free_impulse_cache();
+		_dirty = 0;
+	}
+	LeaveCriticalSection(&_cs_cache);
+	return rc;
+}
+
+PORT
+void get_impulse_cache_stats(long* hits, long* misses, int* entries)
+{
+	// totals over all buckets since init_impulse_cache()
+	*hits = *misses = 0;
+	*entries = 0;
+	if (!_run) return;
+	EnterCriticalSection(&_cs_cache);
+	for (size_t b = 0; b < CACHE_BUCKETS; b++) {
+		*hits += _cache[b].hits;
+		*misses += _cache[b].misses;
+		*entries += (int)_cache[b].count;
 	}
-	fclose(fp);
-	return 0;
+	LeaveCriticalSection(&_cs_cache);
 }
 
 PORT
 void use_impulse_cache(int use)
 {
-	EnterCriticalSection(&_cs_use_cache);
+	EnterCriticalSection(&_cs_cache);
 	_use_cache = use;
-	LeaveCriticalSection(&_cs_use_cache);
+	LeaveCriticalSection(&_cs_cache);
 }
 
 PORT
 void init_impulse_cache(int use)
 {
-	//InitializeCriticalSection(&_cs_use_cache);
-	InitializeCriticalSectionAndSpinCount(&_cs_use_cache, 2500);
+	//InitializeCriticalSection(&_cs_cache);
+	InitializeCriticalSectionAndSpinCount(&_cs_cache, 2500);
 
-	EnterCriticalSection(&_cs_use_cache);
+	EnterCriticalSection(&_cs_cache);
 	_use_cache = use;
-	LeaveCriticalSection(&_cs_use_cache);
+	for (size_t b = 0; b < CACHE_BUCKETS; b++)
+		_cache[b].hits = _cache[b].misses = 0;
+	LeaveCriticalSection(&_cs_cache);
 
 	_run = 1;
 }
@@ -284,7 +377,7 @@ void destroy_impulse_cache(void)
 {
 	_run = 0;
 
-	DeleteCriticalSection(&_cs_use_cache);
+	DeleteCriticalSection(&_cs_cache);
 
 	free_impulse_cache();
 }
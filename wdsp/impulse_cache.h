@@ -64,6 +64,8 @@ mw0lge@grange-lane.co.uk
 #endif
 
 #define MAX_CACHE_ENTRIES		4096	// max number of cache entires per cache bucket
+#define CACHE_SLOTS				8192	// hash table size per cache bucket, power of 2 and >= 2 * MAX_CACHE_ENTRIES
+#define MAX_CACHE_IMPULSE		(1 << 22)	// sanity limit for the impulse length when reading a cache file
 #define CACHE_BUCKETS			4		// 4 cache buckets, for fir_bandpass, mp, eq, fc. Unique indexes in the #defines below
 
 #define FIR_CACHE	0
@@ -77,6 +79,7 @@ void add_impulse_to_cache(size_t bucket, HASH_T hash, int N, double* impulse);
 __declspec (dllexport) int save_impulse_cache(const char* path);
 __declspec (dllexport) int read_impulse_cache(const char* path);
 __declspec (dllexport) void use_impulse_cache(int use);
+__declspec (dllexport) void get_impulse_cache_stats(long* hits, long* misses, int* entries);
 
 __declspec (dllexport) void init_impulse_cache(int use);
 __declspec (dllexport) void destroy_impulse_cache(void);
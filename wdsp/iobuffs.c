@@ -375,6 +375,54 @@ void downslew2 (IOB a, OUTREAL* pIout, OUTREAL* pQout)
 	}
 }
 
+/********************************************************************************************************
+*																										*
+*										Begin Hand-Off Semaphore										*
+*																										*
+********************************************************************************************************/
+
+// Each ring has one producer and one consumer.  The kernel semaphore is only used if the consumer
+// has to sleep because the ring is empty, and to wake it up again.  With a single cpu core the consumer
+// sleeps on nearly every block, and wdspbench shows no difference to a plain semaphore there.
+
+void create_lwsem (LWSEM s, int count)
+{
+	s->count = count;
+	s->sem = CreateSemaphore (0, 0, 1000, 0);
+}
+
+void destroy_lwsem (LWSEM s)
+{
+	CloseHandle (s->sem);
+}
+
+void wait_lwsem (LWSEM s)
+{
+	if (InterlockedExchangeAdd (&s->count, -1) <= 0)
+		WaitForSingleObject (s->sem, INFINITE);
+}
+
+int trywait_lwsem (LWSEM s)
+{
+	long c = s->count;
+	long old;
+	while (c > 0)
+	{
+		if ((old = InterlockedCompareExchange (&s->count, c - 1, c)) == c)
+			return 1;
+		c = old;
+	}
+	return 0;
+}
+
+void release_lwsem (LWSEM s, int n)
+{
+	long old = InterlockedExchangeAdd (&s->count, n);
+	long wake = (-old < n) ? -old : n;
+	if (wake > 0)
+		ReleaseSemaphore (s->sem, wake, 0);
+}
+
 /********************************************************************************************************
 *																										*
 *										  Begin Buffer Code												*
@@ -411,9 +459,8 @@ void create_iobuffs (int channel)
 	a->r2_havesamps = (DSP_MULT - 1) * a->r2_size;
 	n = a->r2_havesamps / a->out_size;
 	a->r2_unqueuedsamps = a->r2_havesamps - n * a->out_size;
-	InitializeCriticalSectionAndSpinCount(&a->r2_ControlSection, 2500);
-	a->Sem_BuffReady = CreateSemaphore(0, 0, 1000, 0);
-	a->Sem_OutReady  = CreateSemaphore(0, n, 1000, 0);
+	create_lwsem (&a->BuffReady, 0);
+	create_lwsem (&a->OutReady, n);
 	a->bfo = ch[channel].bfo;
 	create_slews (a);
 
@@ -432,9 +479,8 @@ void destroy_iobuffs (int channel)
 	CloseHandle(a->Sem_Flush);
 
 	destroy_slews (a);
-	CloseHandle (a->Sem_OutReady);
-	CloseHandle (a->Sem_BuffReady);
-	DeleteCriticalSection(&a->r2_ControlSection);
+	destroy_lwsem (&a->OutReady);
+	destroy_lwsem (&a->BuffReady);
 	_aligned_free (a->r2_baseptr);
 	_aligned_free (a->r1_baseptr);
 	_aligned_free (a);
@@ -452,14 +498,25 @@ void flush_iobuffs (int channel)
 	a->r2_inidx = (DSP_MULT - 1) * a->r2_size;
 	a->r2_outidx = 0;
 	a->r2_havesamps = (DSP_MULT - 1) * a->r2_size;
-	while (!WaitForSingleObject (a->Sem_BuffReady, 1));
+	while (trywait_lwsem (&a->BuffReady));
 	n = a->r2_havesamps / a->out_size;
 	a->r2_unqueuedsamps = a->r2_havesamps - n * a->out_size;
-	CloseHandle (a->Sem_OutReady);
-	a->Sem_OutReady  = CreateSemaphore(0, n, 1000, 0);
+	destroy_lwsem (&a->OutReady);
+	create_lwsem (&a->OutReady, n);
 	flush_slews (a);
 }
 
+// take one output buffer from r2, returns 1 if enough processed samples were available
+static int take_r2 (IOB a)
+{
+	long have, left;
+	do
+	{
+		have = a->r2_havesamps;
+		if ((left = have - a->out_size) < 0) left = 0;
+	} while (InterlockedCompareExchange (&a->r2_havesamps, left, have) != have);
+	return have >= a->out_size;
+}
 
 PORT	//double, interleaved I/Q
 void fexchange0 (int channel, double* in, double* out, int* error)
@@ -480,18 +537,14 @@ void fexchange0 (int channel, double* in, double* out, int* error)
 		if ((a->r1_unqueuedsamps += a->in_size) >= a->r1_outsize)
 		{
 			n = a->r1_unqueuedsamps / a->r1_outsize;
-			ReleaseSemaphore(a->Sem_BuffReady, n, 0);
+			release_lwsem (&a->BuffReady, n);
 			a->r1_unqueuedsamps -= n * a->r1_outsize;
 		}
 		if ((a->r1_inidx += a->in_size) == a->r1_active_buffsize)
 			a->r1_inidx = 0;
 
-		EnterCriticalSection (&a->r2_ControlSection);
-		if (a->r2_havesamps >= a->out_size)
-			doit = 1;
-		if ((a->r2_havesamps -= a->out_size) < 0) a->r2_havesamps = 0;
-		LeaveCriticalSection (&a->r2_ControlSection);
-		if (a->bfo) WaitForSingleObject (a->Sem_OutReady, INFINITE);
+		doit = take_r2 (a);
+		if (a->bfo) wait_lwsem (&a->OutReady);
 		if (a->bfo || doit)
 			if (_InterlockedAnd (&a->slew.downflag, 1))
 			{
@@ -538,18 +591,14 @@ void fexchange2 (int channel, INREAL *Iin, INREAL *Qin, OUTREAL *Iout, OUTREAL *
 		if ((a->r1_unqueuedsamps += a->in_size) >= a->r1_outsize)
 		{
 			n = a->r1_unqueuedsamps / a->r1_outsize;
-			ReleaseSemaphore(a->Sem_BuffReady, n, 0);
+			release_lwsem (&a->BuffReady, n);
 			a->r1_unqueuedsamps -= n * a->r1_outsize;
 		}
 		if ((a->r1_inidx += a->in_size) == a->r1_active_buffsize)
 			a->r1_inidx = 0;
 
-		EnterCriticalSection (&a->r2_ControlSection);
-		if (a->r2_havesamps >= a->out_size)
-			doit = 1;
-		if ((a->r2_havesamps -= a->out_size) < 0) a->r2_havesamps = 0;
-		LeaveCriticalSection (&a->r2_ControlSection);
-		if (a->bfo) WaitForSingleObject (a->Sem_OutReady, INFINITE);
+		doit = take_r2 (a);
+		if (a->bfo) wait_lwsem (&a->OutReady);
 		if (a->bfo || doit)
 		{
 			if (_InterlockedAnd (&a->slew.downflag, 1))
@@ -586,16 +635,15 @@ void dexchange (int channel, double* in, double* out)
 	IOB a = ch[channel].iob.pd;
 	if (!_InterlockedAnd (&ch[channel].run, 1)) _endthread();
 
-	EnterCriticalSection (&a->r2_ControlSection);
-	a->r2_havesamps += a->r2_insize;
-	LeaveCriticalSection (&a->r2_ControlSection);
 	memcpy (a->r2_baseptr + 2 * a->r2_inidx, in, a->r2_insize * sizeof (complex));
 	if ((a->r2_inidx += a->r2_insize) == a->r2_active_buffsize)
 		a->r2_inidx = 0;
+	// publish the samples only after they have been written
+	InterlockedExchangeAdd (&a->r2_havesamps, a->r2_insize);
 	if (a->bfo && (a->r2_unqueuedsamps += a->r2_insize) >= a->out_size)
 	{
 		n = a->r2_unqueuedsamps / a->out_size;
-		ReleaseSemaphore(a->Sem_OutReady, n, 0);
+		release_lwsem (&a->OutReady, n);
 		a->r2_unqueuedsamps -= n * a->out_size;
 	}
 	memcpy (out, a->r1_baseptr + 2 * a->r1_outidx, a->r1_outsize * sizeof (complex));
@@ -27,6 +27,25 @@ warren@wpratt.com
 #ifndef _iobuffs_h
 #define _iobuffs_h
 #include "comm.h"
+
+// Semaphore with a user-space count.  Only a transition into, or out of, the empty state (a waiter
+// present) goes through the kernel semaphore; otherwise 'wait' and 'release' are a single atomic add.
+typedef struct _lwsem
+{
+	volatile long count;						// available units; negative: number of waiters
+	HANDLE sem;									// waiters sleep here
+} lwsem, *LWSEM;
+
+extern void create_lwsem (LWSEM s, int count);
+
+extern void destroy_lwsem (LWSEM s);
+
+extern void wait_lwsem (LWSEM s);
+
+extern int trywait_lwsem (LWSEM s);
+
+extern void release_lwsem (LWSEM s, int n);
+
 typedef struct _iobf
 {
 	int   channel;
@@ -47,13 +66,12 @@ typedef struct _iobf
 	double* r2_baseptr;							// pointer to output pseudo-ring
 	int   r2_inidx;								// in 'double', actual index into the buffer is 2 times this
 	int   r2_outidx;							// in 'double', actual index into the buffer is 2 times this
-	int   r2_havesamps;							// number of processed samples in output pseudo-ring
+	volatile long r2_havesamps;					// number of processed samples in output pseudo-ring, updated atomically
 	int   r2_unqueuedsamps;						// number of output samples not yet queued / released for output
-	CRITICAL_SECTION r2_ControlSection;
 
 	int bfo;									// block_for_output, wait until output is available before proceeding
-	HANDLE Sem_OutReady;						// count = number of 'out_size' buffers processed and available for output
-	HANDLE Sem_BuffReady;						// count = number of 'dsp_size' buffers queued for processing
+	lwsem OutReady;								// count = number of 'out_size' buffers processed and available for output
+	lwsem BuffReady;							// count = number of 'dsp_size' buffers queued for processing
 	volatile long exec_bypass;
 	volatile long flush_bypass;
 	HANDLE Sem_Flush;
@@ -38,11 +38,6 @@ john.d.melton@googlemail.com
 
 #if defined(linux) || defined(__APPLE__)
 
-void QueueUserWorkItem(void *function,void *context,int flags) {
-	pthread_t t;
-	pthread_create(&t, NULL, function, context);
-	pthread_join(t, NULL);
-}
 
 static inline void init_crit_section(pthread_mutex_t *mutex) {
 	pthread_mutexattr_t mAttr;
@@ -239,9 +234,65 @@ void LinuxResetEvent(HANDLE handle) {
   while (sem_trywait(sem) == 0) ;
 }
 
+//
+// The host program may register hooks that are called when a WDSP
+// thread starts or terminates, and when the DSP thread of a channel
+// wakes up to process a buffer. This allows the host to apply its
+// own scheduling policy, CPU affinity and statistics to WDSP threads.
+//
+static void (*thread_start_hook)(const char *name) = NULL;
+static void (*thread_stop_hook)(void) = NULL;
+static void (*thread_wake_hook)(void) = NULL;
+
+PORT
+void WDSPSetThreadHooks(void (*start)(const char *name), void (*stop)(void), void (*wake)(void)) {
+  thread_start_hook = start;
+  thread_stop_hook = stop;
+  thread_wake_hook = wake;
+}
+
+void WDSPThreadWakeup(void) {
+  if (thread_wake_hook) { thread_wake_hook(); }
+}
+
+static void pool_worker(void *arg);
+
+struct _wdsp_thread {
+  void (*start_address)(void *);
+  void *arglist;
+  char name[16];
+};
+
+static void wdsp_thread_cleanup(void *arg) {
+  if (thread_stop_hook) { thread_stop_hook(); }
+}
+
+static void *wdsp_thread_main(void *arg) {
+  //
+  // The cleanup handler makes the stop hook run even if
+  // the thread terminates through _endthread()
+  //
+  struct _wdsp_thread t = *(struct _wdsp_thread *)arg;
+  free(arg);
+  if (t.start_address == &wisdom_planner) {
+    //
+    // The FFTW planner runs with SCHED_IDLE. It is not passed to
+    // the hooks, such that the host cannot raise its priority.
+    //
+    t.start_address(t.arglist);
+    return NULL;
+  }
+  if (thread_start_hook) { thread_start_hook(t.name); }
+  pthread_cleanup_push(wdsp_thread_cleanup, NULL);
+  t.start_address(t.arglist);
+  pthread_cleanup_pop(1);
+  return NULL;
+}
+
 HANDLE _beginthread( void( __cdecl *start_address )( void * ), unsigned stack_size, void *arglist) {
   pthread_t threadid;
   pthread_attr_t	attr;
+  struct _wdsp_thread *t;
 
   if (pthread_attr_init(&attr)) {
    	return (HANDLE)-1;
@@ -257,7 +308,42 @@ HANDLE _beginthread( void( __cdecl *start_address )( void * ), unsigned stack_si
 	return (HANDLE)-1;
   }
 
-  if (pthread_create(&threadid, &attr, (void*(*)(void*))start_address, arglist)) {
+  //
+  // The thread name is used for pthread_setname_np() and is
+  // passed to the start hook.
+  //
+  t = (struct _wdsp_thread *) malloc(sizeof(struct _wdsp_thread));
+  if (t == NULL) {
+    return (HANDLE)-1;
+  }
+  t->start_address = start_address;
+  t->arglist = arglist;
+  if (start_address == &wdspmain) {
+    snprintf(t->name, sizeof(t->name), "Wchan%d", (int)(uintptr_t)arglist);
+  } else if (start_address == &pool_worker) {
+    snprintf(t->name, sizeof(t->name), "Wpool%d", (int)(uintptr_t)arglist);
+  } else if (start_address == &flushChannel) {
+    snprintf(t->name, sizeof(t->name), "Wflush%d", (int)(uintptr_t)arglist);
+  } else if (start_address == &syncb_main) {
+    snprintf(t->name, sizeof(t->name), "WSync");
+  } else	if (start_address == &doPSCorrChange) {
+    snprintf(t->name, sizeof(t->name), "PS");
+  } else if (start_address == &rxa_pipeline) {
+    snprintf(t->name, sizeof(t->name), "Wpipe%d", (int)(uintptr_t)arglist);
+  } else if (start_address == &wisdom_planner) {
+    snprintf(t->name, sizeof(t->name), "Wisdom");
+  } else {
+    // unknown worker type
+    snprintf(t->name, sizeof(t->name), "WDSP");
+  }
+
+#if !defined(__APPLE__) && !defined(NO_PTHREAD_SETNAME_NP)
+  char tname[16];
+  snprintf(tname, sizeof(tname), "%s", t->name);
+#endif
+
+  if (pthread_create(&threadid, &attr, wdsp_thread_main, t)) {
+     free(t);
      return (HANDLE)-1;
   }
 
@@ -270,23 +356,7 @@ HANDLE _beginthread( void( __cdecl *start_address )( void * ), unsigned stack_si
   // Using pthread_setname_np() serves no function except that
   // one sees what the individual threads are doing when
   // watching the system via "top -h"
-  //
-  void sendbuf(void *arg); // declared in analyzer.c but not in header file
-  char tname[64];
-  if (start_address == &wdspmain) {
-    snprintf(tname, sizeof(tname), "Wchan%d", (int)(uintptr_t)arglist);
-  } else if (start_address == &sendbuf) {
-    snprintf(tname, sizeof(tname), "Wdisp%d", (int)(uintptr_t)arglist);
-  } else if (start_address == &flushChannel) {
-    snprintf(tname, sizeof(tname), "Wflush%d", (int)(uintptr_t)arglist);
-  } else if (start_address == &syncb_main) {
-    snprintf(tname, sizeof(tname), "WSync");
-  } else	if (start_address == &doPSCorrChange) {
-    snprintf(tname, sizeof(tname), "PS");
-  } else {
-    // unknown worker type
-    snprintf(tname, sizeof(tname), "WDSP");
-  }
+  // Note the new thread may already have released t.
   //
   // Ignore return value since we continue anyway.
   //
@@ -301,6 +371,112 @@ void _endthread() {
 	pthread_exit(NULL);
 }
 
+//
+// Worker pool for QueueUserWorkItem(). On Windows, work items are executed
+// asynchronously by a system thread pool. Here, a fixed number of worker
+// threads is started upon first use. They sleep on a condition variable
+// and take the work items from a queue. If the queue is full, the work item
+// is executed by the caller.
+// The pool is used by the display analyzer, so the FFTs of different
+// displays (and sub-spans) run in parallel on different cores.
+//
+#define POOL_QUEUE_SIZE  256
+#define POOL_MAX_WORKERS 8
+
+typedef struct _pool_item {
+  DWORD (*function)(void *);
+  void *context;
+} POOL_ITEM;
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static POOL_ITEM pool_queue[POOL_QUEUE_SIZE];
+static int pool_inptr = 0;
+static int pool_outptr = 0;
+static int pool_count = 0;                 // number of items in the queue
+static int pool_count_max = 0;             // max. queue length since last statistics call
+static int pool_workers = 0;
+static long pool_items = 0;                // number of work items executed
+static double pool_busy = 0.0;             // sum of execution times since last statistics call
+static double pool_stat_time = 0.0;        // time of last statistics call
+
+static double pool_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.0E-9 * ts.tv_nsec;
+}
+
+static void pool_worker(void *arg) {
+  pthread_mutex_lock(&pool_mutex);
+  for (;;) {
+    while (pool_count == 0) {
+      pthread_cond_wait(&pool_cond, &pool_mutex);
+    }
+    POOL_ITEM item = pool_queue[pool_outptr];
+    pool_outptr = (pool_outptr + 1) % POOL_QUEUE_SIZE;
+    pool_count--;
+    pthread_mutex_unlock(&pool_mutex);
+    WDSPThreadWakeup();
+    double t0 = pool_time();
+    item.function(item.context);
+    double t1 = pool_time();
+    pthread_mutex_lock(&pool_mutex);
+    pool_items++;
+    pool_busy += t1 - t0;
+  }
+}
+
+void QueueUserWorkItem(void *function,void *context,int flags) {
+  pthread_mutex_lock(&pool_mutex);
+  if (pool_workers == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 2) { n = 2; }
+    if (n > POOL_MAX_WORKERS) { n = POOL_MAX_WORKERS; }
+    pool_stat_time = pool_time();
+    for (int i = 0; i < n; i++) {
+      if (_beginthread(pool_worker, 0, (void *)(uintptr_t)i) != (HANDLE)-1) { pool_workers++; }
+    }
+  }
+  if (pool_workers == 0 || pool_count >= POOL_QUEUE_SIZE) {
+    //
+    // No workers, or queue full: execute the work item right here
+    //
+    pthread_mutex_unlock(&pool_mutex);
+    ((DWORD (*)(void *)) function)(context);
+    return;
+  }
+  pool_queue[pool_inptr].function = (DWORD (*)(void *)) function;
+  pool_queue[pool_inptr].context = context;
+  pool_inptr = (pool_inptr + 1) % POOL_QUEUE_SIZE;
+  pool_count++;
+  if (pool_count > pool_count_max) { pool_count_max = pool_count; }
+  pthread_cond_signal(&pool_cond);
+  pthread_mutex_unlock(&pool_mutex);
+}
+
+//
+// Statistics of the worker pool. The utilisation (0.0 - 1.0, busy time
+// of all workers divided by the number of workers) and the maximum
+// queue length refer to the time since the previous call.
+//
+PORT
+void WDSPGetPoolStats(int *workers, double *utilisation, int *queue_max, long *items) {
+  pthread_mutex_lock(&pool_mutex);
+  double now = pool_time();
+  *workers = pool_workers;
+  *items = pool_items;
+  *queue_max = pool_count_max;
+  if (pool_workers > 0 && now > pool_stat_time) {
+    *utilisation = pool_busy / ((now - pool_stat_time) * pool_workers);
+  } else {
+    *utilisation = 0.0;
+  }
+  pool_busy = 0.0;
+  pool_count_max = pool_count;
+  pool_stat_time = now;
+  pthread_mutex_unlock(&pool_mutex);
+}
+
 void SetThreadPriority(HANDLE thread, int priority)	 {
 //
 // In Linux, the scheduling priority only affects
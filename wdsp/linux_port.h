@@ -54,8 +54,11 @@ john.d.melton@googlemail.com
 #define InterlockedBitTestAndReset(base,bit) __sync_fetch_and_and(base,~(1L<<bit))
 
 #define InterlockedExchange(target,value) __sync_lock_test_and_set(target,value)
+#define InterlockedExchangeAdd(base,value) __sync_fetch_and_add(base,value)
+#define InterlockedCompareExchange(base,value,comparand) __sync_val_compare_and_swap(base,comparand,value)
 #define InterlockedAnd(base,mask) __sync_fetch_and_and(base,mask)
 #define _InterlockedAnd(base,mask) __sync_fetch_and_and(base,mask)
+#define InterlockedXor(base,mask) __sync_fetch_and_xor(base,mask)
 #define __declspec(x)
 #define __cdecl
 #define __stdcall
@@ -120,6 +123,8 @@ HANDLE _beginthread( void( __cdecl *start_address )( void * ), unsigned stack_si
 
 void _endthread();
 
+void WDSPThreadWakeup(void);
+
 void SetThreadPriority(HANDLE thread, int priority);
 
 void CloseHandle(HANDLE hObject);
@@ -38,7 +38,11 @@ void wdspmain (void *pargs)
 	int channel = (int)(uintptr_t)pargs;
 	while (_InterlockedAnd (&ch[channel].run, 1))
 	{
-		WaitForSingleObject(ch[channel].iob.pd->Sem_BuffReady,INFINITE);
+		wait_lwsem (&ch[channel].iob.pd->BuffReady);
+#if defined(linux) || defined(__APPLE__)
+		WDSPThreadWakeup();
+#endif
+		if (ch[channel].type == 0 && xrxa_pipe (channel)) continue;
 		EnterCriticalSection (&ch[channel].csDSP);
 		if (!_InterlockedAnd (&ch[channel].iob.pd->exec_bypass, 1))
 		{
@@ -59,6 +63,7 @@ void wdspmain (void *pargs)
 		}
 		LeaveCriticalSection (&ch[channel].csDSP);
 	}
+	if (ch[channel].type == 0) RXAPipeIdle (channel);
 #if defined(_WIN32)
 	if (hTask != 0) AvRevertMmThreadCharacteristics (hTask);
 #endif
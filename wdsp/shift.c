@@ -113,7 +113,9 @@ PORT
 void SetRXAShiftRun (int channel, int run)
 {
 	EnterCriticalSection (&ch[channel].csDSP);
+	EnterCriticalSection (&rxa[channel].pipe.csFront);
 	rxa[channel].shift.p->run = run;
+	LeaveCriticalSection (&rxa[channel].pipe.csFront);
 	LeaveCriticalSection (&ch[channel].csDSP);
 }
 
@@ -121,7 +123,9 @@ PORT
 void SetRXAShiftFreq (int channel, double fshift)
 {
 	EnterCriticalSection (&ch[channel].csDSP);
+	EnterCriticalSection (&rxa[channel].pipe.csFront);
 	rxa[channel].shift.p->shift = fshift;
 	calc_shift (rxa[channel].shift.p);
+	LeaveCriticalSection (&rxa[channel].pipe.csFront);
 	LeaveCriticalSection (&ch[channel].csDSP);
 }
@@ -194,7 +194,7 @@ void print_buffer_parameters (const char* filename, int channel)
 		fprintf(file, "r1_unqueuedsamps   = %d\n", a->r1_unqueuedsamps);
 		fprintf(file, "r2_inidx           = %d\n", a->r2_inidx);
 		fprintf(file, "r2_outidx          = %d\n", a->r2_outidx);
-		fprintf(file, "r2_havesamps       = %d\n", a->r2_havesamps);
+		fprintf(file, "r2_havesamps       = %ld\n", a->r2_havesamps);
 		fprintf(file, "in_rate            = %d\n", ch[channel].in_rate);
 		fprintf(file, "dsp_rate           = %d\n", ch[channel].dsp_rate);
 		fprintf(file, "out_rate           = %d\n", ch[channel].out_rate);
@@ -455,7 +455,7 @@ double* model_bandpass(int nc, double f_low, double f_high, double rate, int wty
 	double* in = (double*)malloc0(points * sizeof(complex));
 	double* out = (double*)malloc0(points * sizeof(complex));
 	memcpy(in, h, nc * sizeof(complex));
-	fftw_plan p = fftw_plan_dft_1d(points, (fftw_complex*)in, (fftw_complex*)out, FFTW_FORWARD, FFTW_PATIENT);
+	fftw_plan p = wisdom_plan_dft_1d(points, (fftw_complex*)in, (fftw_complex*)out, FFTW_FORWARD);
 	fftw_execute(p);
 	fftw_destroy_plan(p);
 	double* mag = (double*)malloc0(points * sizeof(double));
@@ -95,6 +95,8 @@ extern void SetRXAMode (int channel, int mode);
 extern void RXASetPassband (int channel, double f_low, double f_high);
 extern void RXASetNC (int channel, int nc);
 extern void RXASetMP (int channel, int mp);
+extern void SetRXAPipeline (int channel, int run);
+extern void GetRXADispatch (int channel, char* text, int size);
 
 //
 // Interfaces from TXA.c
@@ -104,6 +106,7 @@ extern void SetTXAMode (int channel, int mode);
 extern void SetTXABandpassFreqs (int channel, double f_low, double f_high);
 extern void TXASetNC (int channel, int nc);
 extern void TXASetMP (int channel, int mp);
+extern void GetTXADispatch (int channel, char* text, int size);
 extern void SetTXAFMAFFilter (int channel, double low, double high);
 
 //
@@ -139,6 +142,13 @@ extern void SetupDetectMaxBin(int run, int disp, int ss, int LO, double rate,
 	double fLow, double fHigh, double tau, int frame_rate);
 extern double GetDetectMaxBin(int disp);
 extern void ResetPixelBuffers(int disp);
+extern void GetAnalyzerLatency(int disp, double *avg, double *max, long *frames);
+extern void SetAnalyzerNotify(int disp, void (*notify)(void *), void *arg);
+extern void SetAnalyzerProfile(int disp, int run);
+extern int GetAnalyzerProfile(int disp, int n, const char** names, long long* ns, long long* calls,
+	long long* worst);
+extern void SetAnalyzerZoom(int disp, int decim, double shift);
+extern void SetAnalyzerPan(int disp, double fscLin, double fscHin, double shift);
 extern void SetAnalyzer (	int disp,
 					int n_pixout,
 					int n_fft,
@@ -332,6 +342,9 @@ extern void SetChannelTDelayUp (int channel, double time);
 extern void SetChannelTSlewUp (int channel, double time);
 extern void SetChannelTDelayDown (int channel, double time);
 extern void SetChannelTSlewDown (int channel, double time);
+extern void SetChannelProfile (int channel, int run);
+extern int GetChannelProfile (int channel, int n, const char** names, long long* ns, long long* calls,
+	long long* worst);
 
 //
 // Interfaces from compress.c
@@ -630,6 +643,7 @@ extern void SetRXAmpeakFilGain (int channel, int fil, double gain);
 extern int save_impulse_cache(const char* path);
 extern int read_impulse_cache(const char* path);
 extern void use_impulse_cache(int use);
+extern void get_impulse_cache_stats(long* hits, long* misses, int* entries);
 extern void init_impulse_cache(int use);
 extern void destroy_impulse_cache(void);
 
@@ -640,6 +654,13 @@ extern void destroy_impulse_cache(void);
 extern void fexchange0 (int channel, double* in, double* out, int* error);
 extern void fexchange2 (int channel, INREAL *Iin, INREAL *Qin, OUTREAL *Iout, OUTREAL *Qout, int* error);
 
+//
+// Interfaces from linux_port.c
+//
+
+extern void WDSPSetThreadHooks(void (*start)(const char *name), void (*stop)(void), void (*wake)(void));
+extern void WDSPGetPoolStats(int *workers, double *utilisation, int *queue_max, long *items);
+
 //
 // Interfaces from matchedCW.c
 //
@@ -1023,4 +1044,5 @@ extern void SetTXALevelerTop (int channel, double maxgain);
 //
 
 extern char* wisdom_get_status(void);
+extern int wisdom_pending(void);
 extern int WDSPwisdom (char* directory);
@@ -26,91 +26,269 @@ warren@pratt.one
 
 #define _CRT_SECURE_NO_WARNINGS
 #include "comm.h"
+#include <specbleach_adenoiser.h>
 
-static char status[128];
+/********************************************************************************************************
+*																										*
+*										Lazy FFTW Planning												*
+*																										*
+********************************************************************************************************/
 
-PORT
-char* wisdom_get_status()
+// FFTW plans are no longer created up-front for all sizes.  A plan is made from existing wisdom if
+// there is any, otherwise with FFTW_ESTIMATE, and the size is queued.  A low-priority planner thread
+// then creates optimal wisdom for the queued sizes and merges it into the wisdom file, so the
+// optimal plan is used the next time an object of that size is created.  Single precision (fftwf)
+// transforms of libspecbleach, and of the convolution in a WDSP_FLOAT build, are handled the same way,
+// using a separate wisdom file.
+//
+// The planner is made thread-safe with a lock that is held for a complete plan.  Foreground plans (filter
+// changes, zoom, opening a channel) are made with existing wisdom or FFTW_ESTIMATE and take very little time,
+// but they have to wait while the planner thread holds the lock.  Therefore all planning is limited to
+// WISDOM_TIMELIMIT seconds.  FFTW plans at increasing patience and keeps the wisdom of the last level that
+// completed within the limit, for large sizes on a slow CPU this may be FFTW_MEASURE instead of FFTW_PATIENT.
+// The lock is released between the sizes, and between a plan and the wisdom export.
+
+#define MAX_WISDOM_ENTRIES	256
+#define PATIENT_LIMIT		32768		// larger sizes are planned with FFTW_MEASURE only
+#define WISDOM_TIMELIMIT	0.5			// seconds, the longest a foreground plan waits for the planner
+
+enum {
+	WISDOM_QUEUED = 0,
+	WISDOM_PLANNING,
+	WISDOM_OPTIMAL
+};
+
+typedef struct _wisdom_entry
 {
-	return status;
+	int kind;
+	int size;
+	int inplace;
+	int state;
+} wisdom_entry;
+
+static const char* kind_name[WISDOM_KINDS] = { "C2C+", "C2C-", "R2C", "C2R", "R2HCf", "HC2Rf", "C2Cf+", "C2Cf-" };
+static wisdom_entry entries[MAX_WISDOM_ENTRIES];
+static int num_entries = 0;
+static int planner_running = 0;
+static HANDLE planner_sem;
+static CRITICAL_SECTION wisdom_section;
+static char wisdom_file[1024];
+static char wisdom_file_f[1024];
+static char status[1024];
+
+static unsigned wisdom_flags (int size)
+{
+	return (size <= PATIENT_LIMIT) ? FFTW_PATIENT : FFTW_MEASURE;
 }
 
-PORT
-int WDSPwisdom (char* directory)
+// accepts wisdom made with FFTW_MEASURE or FFTW_PATIENT
+#define WISDOM_LOOKUP		(FFTW_MEASURE | FFTW_WISDOM_ONLY)
+
+void wisdom_note_size (int kind, int size, int inplace, int optimal)
 {
-	int wisdom_return = 0; // 0 from existing, 1 rebuilt
-	fftw_plan tplan;
-	int psize;
-#ifdef _WIN32
-	FILE *stream;
-#endif
-	double* fftin;
-	double* fftout;
-	char wisdom_file[1024];
-	const int maxsize = MAX_WISDOM_SIZE + 1;
-	strcpy (wisdom_file, directory);
-	strncat (wisdom_file, "wdspWisdom01", 16);
-	if(!fftw_import_wisdom_from_filename(wisdom_file))
+	int i;
+	if (!planner_running) return;
+	EnterCriticalSection (&wisdom_section);
+	for (i = 0; i < num_entries; i++)
+		if (entries[i].kind == kind && entries[i].size == size && entries[i].inplace == inplace)
+			break;
+	if (i == num_entries && num_entries < MAX_WISDOM_ENTRIES)
 	{
-		fftin =  (double *) malloc0 (maxsize * sizeof (complex));
-		fftout = (double *) malloc0 (maxsize * sizeof (complex));
-#ifdef _WIN32
-		AllocConsole();								// create console
-	    freopen_s(&stream, "conout$", "w", stdout); // redirect output to console
-#endif
-		fprintf(stdout, "Optimizing FFT sizes through %d\n\n", maxsize);
-		fprintf(stdout, "Please do not close this window until wisdom plans are completed.\n\n");
-		sprintf(status, "Optimizing FFT sizes through %d", maxsize);
-		psize = 64;
-		while (psize <= MAX_WISDOM_SIZE)
+		entries[i].kind = kind;
+		entries[i].size = size;
+		entries[i].inplace = inplace;
+		entries[i].state = optimal ? WISDOM_OPTIMAL : WISDOM_QUEUED;
+		num_entries++;
+		if (!optimal)
+			ReleaseSemaphore (planner_sem, 1, 0);
+	}
+	LeaveCriticalSection (&wisdom_section);
+}
+
+static void note_float_size (uint32_t fft_size, bool from_wisdom)
+{
+	wisdom_note_size (WISDOM_R2HC_F, (int)fft_size, 0, from_wisdom);
+	wisdom_note_size (WISDOM_HC2R_F, (int)fft_size, 0, from_wisdom);
+}
+
+fftw_plan wisdom_plan_dft_1d (int n, fftw_complex* in, fftw_complex* out, int sign)
+{
+	int kind = (sign == FFTW_FORWARD) ? WISDOM_C2C_FWD : WISDOM_C2C_BWD;
+	fftw_plan p = fftw_plan_dft_1d (n, in, out, sign, WISDOM_LOOKUP);
+	wisdom_note_size (kind, n, in == out, p != NULL);
+	if (!p)
+		p = fftw_plan_dft_1d (n, in, out, sign, FFTW_ESTIMATE);
+	return p;
+}
+
+fftw_plan wisdom_plan_dft_r2c_1d (int n, double* in, fftw_complex* out)
+{
+	fftw_plan p = fftw_plan_dft_r2c_1d (n, in, out, WISDOM_LOOKUP);
+	wisdom_note_size (WISDOM_R2C, n, (void*)in == (void*)out, p != NULL);
+	if (!p)
+		p = fftw_plan_dft_r2c_1d (n, in, out, FFTW_ESTIMATE);
+	return p;
+}
+
+fftw_plan wisdom_plan_dft_c2r_1d (int n, fftw_complex* in, double* out)
+{
+	fftw_plan p = fftw_plan_dft_c2r_1d (n, in, out, WISDOM_LOOKUP);
+	wisdom_note_size (WISDOM_C2R, n, (void*)in == (void*)out, p != NULL);
+	if (!p)
+		p = fftw_plan_dft_c2r_1d (n, in, out, FFTW_ESTIMATE);
+	return p;
+}
+
+fftwf_plan wisdom_plan_dft_1d_f (int n, fftwf_complex* in, fftwf_complex* out, int sign)
+{
+	int kind = (sign == FFTW_FORWARD) ? WISDOM_C2C_FWD_F : WISDOM_C2C_BWD_F;
+	fftwf_plan p = fftwf_plan_dft_1d (n, in, out, sign, WISDOM_LOOKUP);
+	wisdom_note_size (kind, n, in == out, p != NULL);
+	if (!p)
+		p = fftwf_plan_dft_1d (n, in, out, sign, FFTW_ESTIMATE);
+	return p;
+}
+
+static void plan_entry (const wisdom_entry* e)
+{
+	// buffers large enough for complex data, also for the c2r output
+	unsigned flags = wisdom_flags (e->size);
+	if (e->kind == WISDOM_R2HC_F || e->kind == WISDOM_HC2R_F)
+	{
+		float* in = (float*) fftwf_malloc ((e->size + 2) * sizeof (float));
+		float* out = e->inplace ? in : (float*) fftwf_malloc ((e->size + 2) * sizeof (float));
+		fftwf_plan p = fftwf_plan_r2r_1d (e->size, in, out, (e->kind == WISDOM_R2HC_F) ? FFTW_R2HC : FFTW_HC2R, flags);
+		fftwf_destroy_plan (p);
+		if (out != in) fftwf_free (out);
+		fftwf_free (in);
+		fftwf_export_wisdom_to_filename (wisdom_file_f);
+	}
+	else if (e->kind == WISDOM_C2C_FWD_F || e->kind == WISDOM_C2C_BWD_F)
+	{
+		float* in = (float*) fftwf_malloc (e->size * 2 * sizeof (float));
+		float* out = e->inplace ? in : (float*) fftwf_malloc (e->size * 2 * sizeof (float));
+		fftwf_plan p = fftwf_plan_dft_1d (e->size, (fftwf_complex*)in, (fftwf_complex*)out,
+			(e->kind == WISDOM_C2C_FWD_F) ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+		fftwf_destroy_plan (p);
+		if (out != in) fftwf_free (out);
+		fftwf_free (in);
+		fftwf_export_wisdom_to_filename (wisdom_file_f);
+	}
+	else
+	{
+		double* in = (double*) fftw_malloc ((e->size + 2) * sizeof (complex));
+		double* out = e->inplace ? in : (double*) fftw_malloc ((e->size + 2) * sizeof (complex));
+		fftw_plan p;
+		switch (e->kind)
 		{
-			fprintf(stdout, "Planning COMPLEX FORWARD  FFT size %d\n", psize);
-			fflush(stdout);
-			sprintf(status, "Planning COMPLEX FORWARD  FFT size %d\n", psize);
-			tplan = fftw_plan_dft_1d(psize, (fftw_complex *)fftin, (fftw_complex *)fftout, FFTW_FORWARD, FFTW_PATIENT);
-			fftw_execute (tplan);
-			fftw_destroy_plan (tplan);
-			fprintf(stdout, "Planning COMPLEX BACKWARD FFT size %d\n", psize);
-			fflush(stdout);
-			sprintf(status, "Planning COMPLEX BACKWARD FFT size %d\n", psize);
-			tplan = fftw_plan_dft_1d(psize, (fftw_complex *)fftin, (fftw_complex *)fftout, FFTW_BACKWARD, FFTW_PATIENT);
-			fftw_execute (tplan);
-			fftw_destroy_plan (tplan);
-			fprintf(stdout, "Planning COMPLEX BACKWARD FFT size %d\n", psize + 1);
-			fflush(stdout);
-			sprintf(status, "Planning COMPLEX BACKWARD FFT size %d\n", psize + 1);
-			tplan = fftw_plan_dft_1d(psize + 1, (fftw_complex *)fftin, (fftw_complex *)fftout, FFTW_BACKWARD, FFTW_PATIENT);
-			fftw_execute (tplan);
-			fftw_destroy_plan (tplan);
-			psize *= 2;
+		case WISDOM_C2C_FWD:
+			p = fftw_plan_dft_1d (e->size, (fftw_complex*)in, (fftw_complex*)out, FFTW_FORWARD, flags);
+			break;
+		case WISDOM_C2C_BWD:
+			p = fftw_plan_dft_1d (e->size, (fftw_complex*)in, (fftw_complex*)out, FFTW_BACKWARD, flags);
+			break;
+		case WISDOM_R2C:
+			p = fftw_plan_dft_r2c_1d (e->size, in, (fftw_complex*)out, flags);
+			break;
+		default:
+			p = fftw_plan_dft_c2r_1d (e->size, (fftw_complex*)in, out, flags);
+			break;
 		}
-		psize = 64;
-		while (psize <= MAX_WISDOM_SIZE)
+		fftw_destroy_plan (p);
+		if (out != in) fftw_free (out);
+		fftw_free (in);
+		fftw_export_wisdom_to_filename (wisdom_file);
+	}
+}
+
+void wisdom_planner (void* arg)
+{
+	int i;
+	wisdom_entry e;
+#if defined(SCHED_IDLE) && !defined(_WIN32)
+	// only run when the cpu is otherwise idle
+	struct sched_param param;
+	memset (&param, 0, sizeof (param));
+	pthread_setschedparam (pthread_self(), SCHED_IDLE, &param);
+#endif
+	while (1)
+	{
+		WaitForSingleObject (planner_sem, INFINITE);
+		EnterCriticalSection (&wisdom_section);
+		for (i = 0; i < num_entries; i++)
+			if (entries[i].state == WISDOM_QUEUED)
+				break;
+		if (i == num_entries)
 		{
-			fprintf(stdout, "Planning REAL    FORWARD  FFT size %d\n", psize);
-				fflush(stdout);
-			sprintf(status, "Planning REAL    FORWARD  FFT size %d\n", psize);
-			tplan = fftw_plan_dft_r2c_1d(psize, fftin, (fftw_complex *)fftout, FFTW_PATIENT);
-				fftw_execute (tplan);
-				fftw_destroy_plan (tplan);
-			fprintf(stdout, "Planning REAL    INVERSE  FFT size %d\n", psize);
-			fflush(stdout);
-			sprintf(status, "Planning REAL    INVERSE  FFT size %d\n", psize);
-			tplan = fftw_plan_dft_c2r_1d(psize, (fftw_complex *)fftin, fftout, FFTW_PATIENT);
-			fftw_execute (tplan);
-			fftw_destroy_plan (tplan);
-			psize *= 2;
+			LeaveCriticalSection (&wisdom_section);
+			continue;
 		}
-		fprintf(stdout, "\nFFTW planning complete.\n");
-		fflush(stdout);
-		sprintf(status, "\nFFTW planning complete.\n");
-		fftw_export_wisdom_to_filename(wisdom_file);
-		_aligned_free (fftout);
-		_aligned_free (fftin);
-#ifdef _WIN32
-		FreeConsole();							// dismiss console
-#endif
-		wisdom_return = 1;
+		entries[i].state = WISDOM_PLANNING;
+		e = entries[i];
+		LeaveCriticalSection (&wisdom_section);
+		plan_entry (&e);
+		EnterCriticalSection (&wisdom_section);
+		entries[i].state = WISDOM_OPTIMAL;
+		LeaveCriticalSection (&wisdom_section);
+	}
+}
+
+PORT
+int wisdom_pending()
+{
+	// number of sizes still waiting for optimal wisdom
+	int i, n = 0;
+	if (!planner_running) return 0;
+	EnterCriticalSection (&wisdom_section);
+	for (i = 0; i < num_entries; i++)
+		if (entries[i].state != WISDOM_OPTIMAL)
+			n++;
+	LeaveCriticalSection (&wisdom_section);
+	return n;
+}
+
+PORT
+char* wisdom_get_status()
+{
+	// list of the sizes in use, '*' marks the ones with optimal wisdom
+	int i, n, len;
+	int optimal = 0;
+	if (!planner_running) return status;
+	EnterCriticalSection (&wisdom_section);
+	for (i = 0; i < num_entries; i++)
+		if (entries[i].state == WISDOM_OPTIMAL)
+			optimal++;
+	len = snprintf (status, sizeof (status), "%d of %d FFT sizes optimal:", optimal, num_entries);
+	for (i = 0; i < num_entries && len < (int)sizeof (status); i++)
+	{
+		n = snprintf (status + len, sizeof (status) - len, " %s %d%s", kind_name[entries[i].kind], entries[i].size,
+			entries[i].state == WISDOM_OPTIMAL ? "*" : (entries[i].state == WISDOM_PLANNING ? " (planning)" : ""));
+		len += n;
 	}
+	LeaveCriticalSection (&wisdom_section);
+	return status;
+}
+
+PORT
+int WDSPwisdom (char* directory)
+{
+	// returns 0 if an existing wisdom file has been imported, 1 if there is none yet
+	int wisdom_return = 0;
+	if (planner_running) return 0;
+	snprintf (wisdom_file, sizeof (wisdom_file), "%swdspWisdom01", directory);
+	snprintf (wisdom_file_f, sizeof (wisdom_file_f), "%swdspWisdomF01", directory);
+	// the planner thread plans while other threads create and destroy plans
+	fftw_make_planner_thread_safe();
+	fftwf_make_planner_thread_safe();
+	fftw_set_timelimit (WISDOM_TIMELIMIT);
+	fftwf_set_timelimit (WISDOM_TIMELIMIT);
+	if (!fftw_import_wisdom_from_filename (wisdom_file))
+		wisdom_return = 1;
+	fftwf_import_wisdom_from_filename (wisdom_file_f);
+	InitializeCriticalSectionAndSpinCount (&wisdom_section, 0);
+	planner_sem = CreateSemaphore (0, 0, MAX_WISDOM_ENTRIES, 0);
+	planner_running = 1;
+	specbleach_set_fft_plan_hook (note_float_size);
+	_beginthread (wisdom_planner, 0, NULL);
 	return wisdom_return;
 }
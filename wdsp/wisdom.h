@@ -0,0 +1,56 @@
+/*  wisdom.h
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2013-2026 Warren Pratt, NR0V
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+The author can be reached by email at
+
+warren@pratt.one
+
+*/
+
+#ifndef _wisdom_h
+#define _wisdom_h
+
+// transform kinds known to the background planner
+#define WISDOM_C2C_FWD		0
+#define WISDOM_C2C_BWD		1
+#define WISDOM_R2C			2
+#define WISDOM_C2R			3
+#define WISDOM_R2HC_F		4		// single precision, libspecbleach
+#define WISDOM_HC2R_F		5		// single precision, libspecbleach
+#define WISDOM_C2C_FWD_F	6		// single precision, WDSP_FLOAT build
+#define WISDOM_C2C_BWD_F	7		// single precision, WDSP_FLOAT build
+#define WISDOM_KINDS		8
+
+// drop-in replacements for fftw_plan_xxx(..., FFTW_PATIENT)
+extern fftw_plan wisdom_plan_dft_1d (int n, fftw_complex* in, fftw_complex* out, int sign);
+extern fftw_plan wisdom_plan_dft_r2c_1d (int n, double* in, fftw_complex* out);
+extern fftw_plan wisdom_plan_dft_c2r_1d (int n, fftw_complex* in, double* out);
+extern fftwf_plan wisdom_plan_dft_1d_f (int n, fftwf_complex* in, fftwf_complex* out, int sign);
+
+extern void wisdom_note_size (int kind, int size, int inplace, int optimal);
+extern void wisdom_planner (void* arg);
+
+extern __declspec (dllexport) int wisdom_pending (void);
+
+extern __declspec (dllexport) char* wisdom_get_status (void);
+
+extern __declspec (dllexport) int WDSPwisdom (char* directory);
+
+#endif